@@ -1,6 +1,8 @@
 #ifndef SAFEHERON_SGX_TRUSTED_CONFIG_H
 #define SAFEHERON_SGX_TRUSTED_CONFIG_H
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -116,6 +118,10 @@ std::vector<TomlKey> MakeArgs(T first, Types... args) {
     return vec;
 }
 
+namespace internal {
+class TomlDocument;
+} // namespace internal
+
 /**
  * @brief A trusted wrapper around [the untrusted toml library](https://github.com/ToruNiina/toml11/tree/v3.8.1)
  * @details
@@ -125,9 +131,20 @@ std::vector<TomlKey> MakeArgs(T first, Types... args) {
  *  -# We do not support reading dates and times or their arrays.
  *  -# We do not support reading floating-point numbers or their arrays.
  *  -# We do not support reading booleans or their arrays.
+ *
+ * The file can also be parsed inside the enclave (LoadMode::Enclave): it is then read with a single OCALL, kept in
+ * enclave memory, and the getters make no OCALL at all.
  */
 class TomlConfig {
   public:
+    /**
+     * @brief Where the TOML file is parsed and kept
+     */
+    enum class LoadMode {
+        Untrusted = 0, ///< Parsed and kept by the host, each getter makes an OCALL
+        Enclave = 1    ///< Read once, then parsed and kept in the enclave, the getters make no OCALL
+    };
+
     /**
      * @brief Default constructor for the TOML class
      */
@@ -143,6 +160,8 @@ class TomlConfig {
      * @brief Load a TOML file and initialize the TOML object
      *
      * @param[in] toml_file_path The path to the TOML file to parse
+     * @param[in] mode Where the file is parsed and kept. With LoadMode::Enclave, a file of up to 128KB is read into the
+     * enclave, and its SHA-256 digest is available from GetFileDigest().
      *
      * @return True if the TOML object was successfully created; false otherwise
      *
@@ -150,11 +169,30 @@ class TomlConfig {
      * @code
      *      bool ok;
      *      TomlConfig toml;
-     *      ok = toml.LoadFile(toml, "/root/config");
+     *      ok = toml.LoadFile("/root/config", TomlConfig::LoadMode::Enclave);
      *      if (!ok) return false;
      * @endcode
      */
-    bool LoadFile(const char* toml_file_path);
+    bool LoadFile(const char* toml_file_path, LoadMode mode = LoadMode::Untrusted);
+
+    /**
+     * @brief Parse TOML content inside the enclave, e.g. a configuration which has been unsealed
+     *
+     * @param[in] toml_content The TOML content
+     *
+     * @return True if the content was successfully parsed; false otherwise
+     */
+    bool LoadString(const std::string& toml_content);
+
+    /**
+     * @brief The SHA-256 digest of the content parsed in the enclave
+     *
+     * @return The 32 bytes digest of the content loaded with LoadMode::Enclave or LoadString(), empty if the file has
+     * been loaded with LoadMode::Untrusted.
+     */
+    [[nodiscard]] std::vector<uint8_t> GetFileDigest() const {
+        return digest_;
+    }
 
     /**
      * @brief Finds an integer value in the TOML file
@@ -339,10 +377,26 @@ class TomlConfig {
      */
     bool GetArrayValues(uint64_t ptr_toml, const std::string &path_str, std::string &values);
 
+    /**
+     * @brief Parse TOML content in the enclave, and use it instead of any TOML object loaded before
+     *
+     * @param[in] toml_content The TOML content
+     *
+     * @return true if success, otherwise return false.
+     */
+    bool LoadDocument(const std::string& toml_content);
+
+    /**
+     * @brief Release the untrusted TOML object, if any
+     */
+    void FreeUntrustedObject();
+
   private:
     uint64_t ref_untrusted_toml_obj_; ///< Reference to the untrusted TOML object
                                       ///< in memory
-    std::string err_msg_;             ///< Error code
+    std::shared_ptr<const internal::TomlDocument> document_; ///< The TOML document parsed in the enclave, if any
+    std::vector<uint8_t> digest_;                            ///< SHA-256 of the content of document_
+    std::string err_msg_;                                    ///< Error code
 };
 
 } // namespace config_t
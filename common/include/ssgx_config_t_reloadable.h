@@ -0,0 +1,250 @@
+#ifndef SAFEHERON_SGX_TRUSTED_CONFIG_RELOADABLE_H
+#define SAFEHERON_SGX_TRUSTED_CONFIG_RELOADABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "ssgx_config_t.h"
+
+/**
+ * The number of snapshots a ReloadableTomlConfig can hold at the same time: the current one, and those which are still
+ * used by readers. A reload fails if all of them are in use.
+ */
+#ifndef SSGX_CONFIG_SNAPSHOT_SLOTS
+#define SSGX_CONFIG_SNAPSHOT_SLOTS 8
+#endif
+
+namespace ssgx {
+namespace config_t {
+
+namespace internal {
+struct TomlSnapshotSlot;
+} // namespace internal
+
+/**
+ * @brief An immutable version of a ReloadableTomlConfig, which stays the same while it is held
+ * @details A snapshot is meant to be held by one thread for the duration of a request, and must not outlive the
+ * ReloadableTomlConfig it comes from. Its getters are those of TomlConfig, and make no OCALL.
+ *
+ * @par Example
+ * @code
+ *      TomlSnapshot config = reloadable_config.GetSnapshot();
+ *      if (!config) return false;
+ *      std::optional<int64_t> rate_limit = config.GetInteger("server", "rate_limit");
+ * @endcode
+ */
+class TomlSnapshot {
+  public:
+    /**
+     * @brief An empty snapshot, as returned before any configuration is loaded
+     */
+    TomlSnapshot() = default;
+
+    /**
+     * @brief Release the snapshot, it is reclaimed by a later reload if it is no longer the current one
+     */
+    ~TomlSnapshot();
+
+    TomlSnapshot(TomlSnapshot&& other) noexcept;
+    TomlSnapshot& operator=(TomlSnapshot&& other) noexcept;
+    TomlSnapshot(const TomlSnapshot&) = delete;
+    TomlSnapshot& operator=(const TomlSnapshot&) = delete;
+
+    /**
+     * @brief Whether the snapshot holds a configuration
+     */
+    explicit operator bool() const {
+        return slot_ != nullptr;
+    }
+
+    /**
+     * @brief The version of the configuration, starting from 1 and incremented by every load or reload
+     * @return The version, 0 for an empty snapshot
+     */
+    [[nodiscard]] uint64_t GetVersion() const;
+
+    /**
+     * @brief The SHA-256 digest of the content of this version of the configuration
+     * @return The 32 bytes digest, empty for an empty snapshot
+     */
+    [[nodiscard]] std::vector<uint8_t> GetFileDigest() const;
+
+    /**
+     * @brief Finds an integer value, see TomlConfig::GetInteger()
+     */
+    template <typename... Types>
+    std::optional<int64_t> GetInteger(Types... args) {
+        std::vector<TomlKey> path = std::move(MakeArgs(args...));
+        return GetInteger(path);
+    }
+
+    /**
+     * @brief Finds a string value, see TomlConfig::GetString()
+     */
+    template <typename... Types>
+    std::optional<std::string> GetString(Types... args) {
+        std::vector<TomlKey> path = std::move(MakeArgs(args...));
+        return GetString(path);
+    }
+
+    /**
+     * @brief Finds an integer array of values, see TomlConfig::GetIntegerArray()
+     */
+    template <typename... Types>
+    std::optional<std::vector<int64_t>> GetIntegerArray(Types... args) {
+        std::vector<TomlKey> path = std::move(MakeArgs(args...));
+        return GetIntegerArray(path);
+    }
+
+    /**
+     * @brief Finds a string array of values, see TomlConfig::GetStringArray()
+     */
+    template <typename... Types>
+    std::optional<std::vector<std::string>> GetStringArray(Types... args) {
+        std::vector<TomlKey> path = std::move(MakeArgs(args...));
+        return GetStringArray(path);
+    }
+
+    /**
+     * @brief Get the error message when a getter returns std::nullopt
+     * @return error message
+     */
+    [[nodiscard]] std::string GetLastErrorMsg() const {
+        return err_msg_;
+    }
+
+  private:
+    friend class ReloadableTomlConfig;
+
+    explicit TomlSnapshot(internal::TomlSnapshotSlot* slot) : slot_(slot) {
+    }
+
+    std::optional<int64_t> GetInteger(const std::vector<TomlKey>& path);
+    std::optional<std::string> GetString(const std::vector<TomlKey>& path);
+    std::optional<std::vector<int64_t>> GetIntegerArray(const std::vector<TomlKey>& path);
+    std::optional<std::vector<std::string>> GetStringArray(const std::vector<TomlKey>& path);
+
+    void Release();
+
+  private:
+    internal::TomlSnapshotSlot* slot_ = nullptr; ///< The slot holding the configuration, nullptr if empty
+    std::string err_msg_;                        ///< Error message of the last getter
+};
+
+/**
+ * @brief A TOML configuration parsed in the enclave, which can be reloaded while it is read
+ * @details Every load or reload parses the file into a new version of the configuration, then publishes it atomically.
+ * Readers on any thread take a TomlSnapshot of the current version with GetSnapshot(), which never takes a lock nor
+ * waits for a reload: it only retries in the unlikely case where a reload retired the version it was taking. A version
+ * which is no longer the current one is reclaimed by the next reload once no snapshot of it is held.
+ *
+ * A failed reload, e.g. because the new file can not be parsed, keeps the current version.
+ *
+ * A configuration loaded from a file can be reloaded by the host, by the ssgx_ecall_config_reload() ECALL which
+ * ssgx::config_u::TomlFileWatcher makes when the file changes.
+ *
+ * @par Example
+ * @code
+ *      static ReloadableTomlConfig g_config;
+ *      if (!g_config.LoadFile("/root/config.toml")) return false;
+ *      ...
+ *      // on any thread
+ *      TomlSnapshot config = g_config.GetSnapshot();
+ *      std::optional<std::string> upstream = config.GetString("upstream", "url");
+ * @endcode
+ */
+class ReloadableTomlConfig {
+  public:
+    ReloadableTomlConfig();
+
+    /**
+     * @brief Destruction, no snapshot of this configuration may still be held
+     */
+    ~ReloadableTomlConfig();
+
+    ReloadableTomlConfig(const ReloadableTomlConfig&) = delete;
+    ReloadableTomlConfig& operator=(const ReloadableTomlConfig&) = delete;
+
+    /**
+     * @brief Load a TOML file of up to 128KB into the enclave, and register the configuration to be reloaded by the
+     * host from this file
+     *
+     * @param[in] toml_file_path The path to the TOML file to parse
+     *
+     * @return True if the file was loaded and published as the current version; false otherwise
+     */
+    bool LoadFile(const char* toml_file_path);
+
+    /**
+     * @brief Load the file given to LoadFile() again
+     *
+     * @return True if the file was loaded and published as the current version; false otherwise, the current version
+     * being kept
+     */
+    bool Reload();
+
+    /**
+     * @brief Parse TOML content inside the enclave, e.g. a configuration which has been unsealed, and publish it
+     *
+     * @param[in] toml_content The TOML content
+     *
+     * @return True if the content was parsed and published as the current version; false otherwise
+     */
+    bool LoadString(const std::string& toml_content);
+
+    /**
+     * @brief Take a snapshot of the current version, without any lock
+     *
+     * @return The snapshot, empty if nothing has been loaded yet
+     */
+    TomlSnapshot GetSnapshot() const;
+
+    /**
+     * @brief The current version
+     *
+     * @return The version, 0 if nothing has been loaded yet
+     */
+    [[nodiscard]] uint64_t GetVersion() const;
+
+    /**
+     * @brief The file given to LoadFile()
+     *
+     * @return The path, empty if the configuration has not been loaded from a file
+     */
+    [[nodiscard]] std::string GetFilePath() const;
+
+    /**
+     * @brief Get the error message when a load or a reload fails
+     * @return error message
+     */
+    [[nodiscard]] std::string GetLastErrorMsg() const;
+
+  private:
+    /**
+     * @brief Publish the content as the new current version
+     */
+    bool Publish(const std::string& toml_content);
+
+    /**
+     * @brief Release the versions which are neither current nor held by a snapshot
+     */
+    void Reclaim();
+
+  private:
+    std::unique_ptr<internal::TomlSnapshotSlot[]> slots_; ///< The versions, current or still held
+    std::atomic<uint64_t> current_{0};                     ///< The current version << 8 | its slot, 0 if none
+    mutable std::mutex mutex_;                             ///< Serializes the loads and reloads only
+    uint64_t version_ = 0;                                 ///< The last version published
+    std::string toml_file_path_;                           ///< The file to reload, empty if none
+    std::string err_msg_;                                  ///< Error message of the last load or reload
+};
+
+} // namespace config_t
+} // namespace ssgx
+
+#endif // SAFEHERON_SGX_TRUSTED_CONFIG_RELOADABLE_H
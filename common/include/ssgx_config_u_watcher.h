@@ -0,0 +1,99 @@
+#ifndef SAFEHERON_SGX_UNTRUSTED_CONFIG_WATCHER_H
+#define SAFEHERON_SGX_UNTRUSTED_CONFIG_WATCHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sgx_error.h>
+#include <sgx_urts.h>
+
+namespace ssgx {
+/**
+ * @namespace ssgx::config_u
+ * @brief Host side of the configurations of ssgx::config_t.
+ */
+namespace config_u {
+
+/** @brief Typedef for the configuration reload callback, i.e. the ECALL ssgx_ecall_config_reload */
+using ConfigReloadCallback = sgx_status_t (*)(sgx_enclave_id_t eid, int* retval, const char* toml_file_path);
+
+/**
+ * @brief Watches a TOML file, and makes the enclave reload it when it changes
+ * @details A thread watches the directory of the file with inotify, so that the file is seen whether it is written in
+ * place or replaced by a rename, as editors and configuration management tools do. Once no change has been seen for
+ * debounce_ms milliseconds, it calls ssgx_ecall_config_reload() for the path, which reloads every
+ * ssgx::config_t::ReloadableTomlConfig loaded from it.
+ *
+ * @par Example
+ * @code
+ *      ssgx::config_u::TomlFileWatcher watcher;
+ *      if (!watcher.Start(eid, ssgx_ecall_config_reload, "/root/config.toml")) return -1;
+ * @endcode
+ */
+class TomlFileWatcher {
+  public:
+    TomlFileWatcher() = default;
+
+    /**
+     * @brief Stop watching
+     */
+    ~TomlFileWatcher();
+
+    TomlFileWatcher(const TomlFileWatcher&) = delete;
+    TomlFileWatcher& operator=(const TomlFileWatcher&) = delete;
+
+    /**
+     * @brief Start watching a file
+     * @param[in] eid The enclave which loaded the file
+     * @param[in] reload_cb The ECALL ssgx_ecall_config_reload, as generated for the enclave
+     * @param[in] toml_file_path The path of the file, as given to ReloadableTomlConfig::LoadFile()
+     * @param[in] debounce_ms How long the file must stay unchanged before it is reloaded
+     * @return Return true if successful; otherwise, return false, e.g. if the directory of the file can not be watched
+     * or the watcher is already started
+     */
+    bool Start(sgx_enclave_id_t eid, ConfigReloadCallback reload_cb, const std::string& toml_file_path,
+               int debounce_ms = 200);
+
+    /**
+     * @brief Stop watching, and wait for any reload in progress
+     */
+    void Stop();
+
+    /**
+     * @brief The number of reloads which succeeded
+     */
+    uint64_t GetReloadCount() const {
+        return reload_count_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The number of reloads which failed, either the ECALL or the reload in the enclave
+     */
+    uint64_t GetFailureCount() const {
+        return failure_count_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    void Run();
+    void Reload();
+
+    std::mutex mutex_; // serializes Start() and Stop()
+    sgx_enclave_id_t eid_ = 0;
+    ConfigReloadCallback reload_cb_ = nullptr;
+    std::string toml_file_path_;
+    std::string file_name_; // the name of the file in its directory
+    int debounce_ms_ = 0;
+    int inotify_fd_ = -1;
+    int stop_fd_ = -1; // an eventfd which wakes the thread up to stop
+    std::thread thread_;
+    std::atomic<uint64_t> reload_count_{0};
+    std::atomic<uint64_t> failure_count_{0};
+};
+
+} // namespace config_u
+} // namespace ssgx
+
+#endif // SAFEHERON_SGX_UNTRUSTED_CONFIG_WATCHER_H
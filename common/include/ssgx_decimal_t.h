@@ -1,7 +1,9 @@
 #ifndef SAFEHERON_SGX_TRUSTED_DECIMAL_H
 #define SAFEHERON_SGX_TRUSTED_DECIMAL_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 struct mpd_context_t;
 struct mpd_t;
@@ -32,6 +34,13 @@ namespace ssgx {
  */
 namespace decimal_t {
 
+namespace internal {
+struct FixedDecimal;
+class MpdOperand;
+} // namespace internal
+
+class BigDecimal;
+
 /**
  * @brief Rounding type for precision control
  *
@@ -99,6 +108,8 @@ class Precision {
 
   public:
     friend class BigDecimal;
+    friend class DecimalAccumulator;
+    friend std::vector<BigDecimal> ScaleAll(const std::vector<BigDecimal>& values, const Precision& prec);
 
   private:
     [[nodiscard]] mpd_context_t* Get() const;
@@ -115,7 +126,11 @@ class Precision {
  * automatically, the default round type is ROUND_HALF_UP. Using class Precision can customize precision and rounding
  * type for calculation result.
  *
- *        2. According
+ *        2. Values whose coefficient has at most 38 digits are held inline, as a 128-bit scaled integer: copies,
+ * Add, Sub, Multiply, comparisons, SetScale, Neg and ToStr then run without mpdecimal nor any allocation. Other values,
+ * and results which do not fit, are held by mpdecimal; both representations give the same results.
+ *
+ *        3. According
  * https://github.com/frohoff/jdk8u-dev-jdk/blob/da0da73ab82ed714dc5be94acd2f0d00fbdfe2e9/src/share/classes/java/math/BigDecimal.java#L637
  *           the max exponent supported is 9999999999 (10 nines). it means the value range of Bigdecimal is
  * [-9x10^999999999, 9x10^999999999]. But the actual result depends on the specific hardware performance, an exception
@@ -158,17 +173,14 @@ class BigDecimal {
 
     /**
      * @brief The move constructor
-     *        Construct a BigDecimal object and move the value from num The num object's member pointer ptr_data_ will
-     * be set as null
-     * @param[in, out] num The object which value will be copied to this new instance, and its member pointer ptr_data_
-     * will be set as null
+     *        Construct a BigDecimal object and move the value from num, which is left holding 0
+     * @param[in, out] num The object which value will be moved to this new instance
      */
     BigDecimal(BigDecimal&& num) noexcept;
 
     /**
      * @brief The move and assignment operator
-     * @param[in,out] num The object which value will be copied to this new instance, and its member pointer ptr_data_
-     * will be set as null
+     * @param[in,out] num The object which value will be moved to this instance, and which is left holding 0
      * @return A new BigDecimal object moved from num.
      */
     BigDecimal& operator=(BigDecimal&& num) noexcept;
@@ -454,14 +466,267 @@ class BigDecimal {
      */
     [[nodiscard]] std::string ToStr(int scale, RoundType round_type) const;
 
+    /**
+     * @brief Conversion to the binary encoding
+     * @details The encoding keeps the sign, the exponent and the coefficient, as the string of ToStr() does, in a
+     * fixed layout:
+     *          - 1 byte: bit 7 is the sign, bits 0-6 are n, the size of the coefficient (at most 42 bytes)
+     *          - 1 to 10 bytes: the exponent, as a zigzag LEB128 varint
+     *          - n bytes: the coefficient, an unsigned big-endian integer
+     *
+     *        1234.56 takes 5 bytes, and a value of 38 digits with an exponent from -64 to 63 takes 18 bytes.
+     * @return The encoded value
+     *
+     * @par Examples
+     * @code
+     *      BigDecimal a("1234.56");
+     *      std::vector<uint8_t> bytes = a.ToBytes();                  // {0x03, 0x03, 0x01, 0xE2, 0x40}
+     *      BigDecimal b = BigDecimal::FromBytes(bytes.data(), bytes.size());
+     * @endcode
+     */
+    [[nodiscard]] std::vector<uint8_t> ToBytes() const;
+
+    /**
+     * @brief Append the binary encoding to bytes, see ToBytes()
+     * @param[in,out] bytes The buffer to append to, e.g. a snapshot of many values
+     */
+    void AppendBytes(std::vector<uint8_t>& bytes) const;
+
+    /**
+     * @brief Conversion from the binary encoding, see ToBytes()
+     * @param[in] data The encoded value
+     * @param[in] size The size of data
+     * @param[out] consumed If not null, set to the size of the encoded value, which is read from the front of data;
+     * otherwise, data must hold exactly one encoded value
+     * @return The decoded value
+     * @note An exception will occur if data is not a valid encoding, or if the value is out of the range of
+     * BigDecimal, as for the strings of BigDecimal(const char*)
+     */
+    [[nodiscard]] static BigDecimal FromBytes(const uint8_t* data, size_t size, size_t* consumed = nullptr);
+
+    /**
+     * @brief Conversion from an integer
+     * @param[in] value The integer
+     * @return The value, with an exponent of 0
+     */
+    [[nodiscard]] static BigDecimal FromInt64(int64_t value);
+
+    /**
+     * @brief Conversion to an integer
+     * @return The value, which must be an integer, e.g. 12 or 12.00
+     * @note An exception will occur if the value has a fractional part, use SetScale(0, round_type) to round it
+     * first, or if it is out of the range of int64_t
+     */
+    [[nodiscard]] int64_t ToInt64() const;
+
   private:
+    friend class internal::MpdOperand;
+    friend class DecimalAccumulator;
+    friend std::vector<BigDecimal> ScaleAll(const std::vector<BigDecimal>& values, const Precision& prec);
+
     int Compare(const BigDecimal& num) const;
     static void SetDefaultContext(mpd_context_t* ptr_ctx);
 
+    /**
+     * @brief Get the value if it is held inline
+     * @return false if the value is held by mpdecimal
+     */
+    bool GetFixed(internal::FixedDecimal& value) const;
+
+    /**
+     * @brief A BigDecimal holding the value inline
+     */
+    static BigDecimal FromFixed(const internal::FixedDecimal& value);
+
+    /**
+     * @brief A BigDecimal taking the ownership of ptr, which holds the value inline instead if it fits
+     */
+    static BigDecimal FromMpd(mpd_t* ptr);
+
+    /**
+     * @brief Copy the value into a new mpdecimal object
+     */
+    mpd_t* NewMpd() const;
+
   private:
-    mpd_t* ptr_data_;
+    mpd_t* ptr_data_;    ///< The value, or nullptr if it is held inline by the members below
+    uint64_t coeff_lo_;  ///< Low 64 bits of the inline coefficient, below 10^38
+    uint64_t coeff_hi_;  ///< High 64 bits of the inline coefficient
+    int32_t exponent_;   ///< The inline value is (-1)^negative_ * coefficient * 10^exponent_
+    bool negative_;      ///< Sign of the inline value, which can be a negative zero as in mpdecimal
 };
 
+/**
+ * @brief Exact accumulator of sums and sums of products of BigDecimal values
+ * @details Terms are added without any rounding: in 128 bits while the sum fits, then by mpdecimal at a working
+ * precision of SSGX_DECIMAL_ACCUMULATOR_PREC digits. The sum is rounded, and the conditions raised are checked, only
+ * once in Result(). A Result() is the same as the one of a chain of Add(), as long as no intermediate sum of the chain
+ * would have been rounded.
+ *
+ *        Enclaves can not start threads: to spread a large input across the ECALL threads of the host, each thread
+ * fills its own accumulator with a slice of the input, then Merge() combines them. An accumulator must not be used by
+ * several threads at once.
+ *
+ * @par Examples
+ * @code
+ *      DecimalAccumulator fees;
+ *      for (size_t i = 0; i < amounts.size(); ++i) {
+ *          fees.AddProduct(amounts[i], rates[i]);
+ *      }
+ *      BigDecimal total = fees.Result(Precision(RoundType::RoundHalfEven, 2));
+ * @endcode
+ */
+class DecimalAccumulator {
+  public:
+    /**
+     * @brief Construct an accumulator holding 0
+     */
+    DecimalAccumulator();
+
+    /**
+     * @brief Destruction
+     */
+    ~DecimalAccumulator();
+
+    DecimalAccumulator(const DecimalAccumulator&) = delete;
+    DecimalAccumulator& operator=(const DecimalAccumulator&) = delete;
+
+    /**
+     * @brief Add a value to the sum
+     * @param[in] num The value to add
+     * @note An exception is thrown only if the memory for the sum can not be allocated, other errors are reported by
+     * Result()
+     */
+    void Add(const BigDecimal& num);
+
+    /**
+     * @brief Add the product x * y to the sum
+     * @param[in] x The first factor
+     * @param[in] y The second factor
+     * @note An exception is thrown only if the memory for the sum can not be allocated, other errors are reported by
+     * Result()
+     */
+    void AddProduct(const BigDecimal& x, const BigDecimal& y);
+
+    /**
+     * @brief Add the sum of another accumulator to this one
+     * @param[in] other The accumulator to add, which is not modified
+     */
+    void Merge(const DecimalAccumulator& other);
+
+    /**
+     * @brief The sum in default precision
+     * @return The sum, rounded to 99 digits
+     * @note An exception will occur if the sum is inexact, overflows or is invalid
+     */
+    [[nodiscard]] BigDecimal Result() const;
+
+    /**
+     * @brief The sum in customized precision
+     * @param[in] prec Precision control
+     * @return The sum, rounded to prec
+     * @note An exception will occur if the sum overflows or is invalid
+     */
+    [[nodiscard]] BigDecimal Result(const Precision& prec) const;
+
+  private:
+    friend BigDecimal WeightedAverage(const std::vector<BigDecimal>& values, const std::vector<BigDecimal>& weights);
+    friend BigDecimal WeightedAverage(const std::vector<BigDecimal>& values, const std::vector<BigDecimal>& weights,
+                                      const Precision& prec);
+
+    /**
+     * @brief dividend / divisor, where both sums are exact and the quotient is rounded once
+     * @param[in] prec Precision control, or nullptr for the default precision
+     */
+    static BigDecimal Quotient(const DecimalAccumulator& dividend, const DecimalAccumulator& divisor,
+                               const Precision* prec);
+
+    /**
+     * @brief The sum at the working precision, without final rounding
+     * @param[in, out] status The conditions raised, which are added to the ones of the accumulation
+     * @return A new mpdecimal object, which the caller deletes
+     */
+    mpd_t* NewTotal(uint32_t* status) const;
+
+    /**
+     * @brief The mpdecimal part of the sum, allocated holding 0 at its first use
+     */
+    mpd_t* MpdSum();
+
+  private:
+    BigDecimal fixed_sum_; ///< The part of the sum held inline
+    mpd_t* ptr_sum_;       ///< The rest of the sum, or nullptr while the whole sum is held inline
+    uint32_t status_;      ///< The mpdecimal conditions raised by the accumulation
+};
+
+/**
+ * @brief Sum of values in default precision
+ * @param[in] values The values to add
+ * @return The sum, rounded once to 99 digits
+ * @note The values are accumulated exactly by a DecimalAccumulator, see DecimalAccumulator::Result()
+ */
+[[nodiscard]] BigDecimal Sum(const std::vector<BigDecimal>& values);
+
+/**
+ * @brief Sum of values in customized precision
+ * @param[in] values The values to add
+ * @param[in] prec Precision control
+ * @return The sum, rounded once to prec
+ */
+[[nodiscard]] BigDecimal Sum(const std::vector<BigDecimal>& values, const Precision& prec);
+
+/**
+ * @brief Sum of x[i] * y[i] in default precision
+ * @param[in] x The first factors
+ * @param[in] y The second factors, as many as x
+ * @return The sum of the products, rounded once to 99 digits
+ * @note An exception will occur if x and y are not of the same size
+ */
+[[nodiscard]] BigDecimal DotProduct(const std::vector<BigDecimal>& x, const std::vector<BigDecimal>& y);
+
+/**
+ * @brief Sum of x[i] * y[i] in customized precision
+ * @param[in] x The first factors
+ * @param[in] y The second factors, as many as x
+ * @param[in] prec Precision control
+ * @return The sum of the products, rounded once to prec
+ * @note An exception will occur if x and y are not of the same size
+ */
+[[nodiscard]] BigDecimal DotProduct(const std::vector<BigDecimal>& x, const std::vector<BigDecimal>& y,
+                                    const Precision& prec);
+
+/**
+ * @brief Average of values weighted by weights in default precision
+ * @param[in] values The values
+ * @param[in] weights The weights of the values, as many as values
+ * @return Sum(values[i] * weights[i]) / Sum(weights), where both sums are exact and the quotient is rounded once to
+ * 99 digits
+ * @note An exception will occur if values and weights are not of the same size, or if the sum of the weights is 0
+ */
+[[nodiscard]] BigDecimal WeightedAverage(const std::vector<BigDecimal>& values,
+                                         const std::vector<BigDecimal>& weights);
+
+/**
+ * @brief Average of values weighted by weights in customized precision
+ * @param[in] values The values
+ * @param[in] weights The weights of the values, as many as values
+ * @param[in] prec Precision control
+ * @return Sum(values[i] * weights[i]) / Sum(weights), where both sums are exact and the quotient is rounded to prec
+ * @note An exception will occur if values and weights are not of the same size, or if the sum of the weights is 0
+ */
+[[nodiscard]] BigDecimal WeightedAverage(const std::vector<BigDecimal>& values, const std::vector<BigDecimal>& weights,
+                                         const Precision& prec);
+
+/**
+ * @brief Round each value to the scale and rounding type of prec, as BigDecimal::SetScale() does
+ * @param[in] values The values to round
+ * @param[in] prec Precision control
+ * @return The rounded values, in the order of values
+ * @note The values share one context, and the conditions raised are checked once: an exception will occur if any
+ * value can not be rounded
+ */
+[[nodiscard]] std::vector<BigDecimal> ScaleAll(const std::vector<BigDecimal>& values, const Precision& prec);
+
 } // namespace decimal_t
 } // namespace ssgx
 
@@ -1,7 +1,10 @@
 
 #ifndef SAFEHERON_SGX_TRUSTED_FILESTREAM_H
 #define SAFEHERON_SGX_TRUSTED_FILESTREAM_H
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "sgx_key.h"
 #include "sgx_tprotected_fs.h"
@@ -556,17 +559,44 @@ class FileSystemException : public std::exception {
 };
 
 /**
- * @brief Read a plaintext file (file size <= 100 KB)
+ * @brief Read a plaintext file.
+ *
+ * ReadAllBytes() and ReadAllText() load a whole file of at most 100 KB in one call. For bigger files, Open() the
+ * reader as a stream and Read() or ReadAt() it into caller buffers; there is no size limit and the file is never
+ * staged as a whole. Stream data crosses the enclave boundary in 1 MB chunks through one untrusted buffer, and
+ * the last chunk is kept so that small sequential reads don't each leave the enclave.
+ *
+ * @par Examples
+ * @code
+ *     PlainFileReader reader(path);
+ *     reader.Open();
+ *     std::vector<uint8_t> buf(64 * 1024);
+ *     size_t n = 0;
+ *     while ((n = reader.Read(buf.data(), buf.size())) > 0) {
+ *         // consume buf[0, n)
+ *     }
+ *     reader.Close();
+ * @endcode
  */
 class PlainFileReader {
   public:
+    PlainFileReader(const PlainFileReader&) = delete;
+    PlainFileReader& operator=(const PlainFileReader&) = delete;
+
     /**
      * @brief Construct a PlainFileReader and initialized it
      * @param[in] filepath File path
      */
-    explicit PlainFileReader(std::string filepath) : file_path_(std::move(filepath)) {
+    explicit PlainFileReader(std::string filepath)
+        : file_path_(std::move(filepath)), handle_(0), file_size_(0), position_(0), buffer_(nullptr),
+          window_offset_(0), window_size_(0) {
     }
 
+    /**
+     * @brief Close the stream if it is still open, errors are ignored.
+     */
+    ~PlainFileReader();
+
     /**
      * @brief Read a plaintext binary file, the max file size is 100KB.
      * @return Return the file content, in bytes.
@@ -581,22 +611,87 @@ class PlainFileReader {
      */
     std::string ReadAllText() const;
 
+    /**
+     * @brief Open the file as a stream, with a shared lock held until Close().
+     * @throws FileSystemException If the stream is already open or the file cannot be opened.
+     */
+    void Open();
+
+    /**
+     * @brief Read from the current position and advance it.
+     * @param[out] buffer Buffer in the enclave to receive the data.
+     * @param[in] size Maximum number of bytes to read, there is no upper limit.
+     * @return Number of bytes actually read, less than size only at the end of file (0 if EOF is reached).
+     * @throws FileSystemException If the stream is not open or a read error occurs.
+     */
+    size_t Read(void* buffer, size_t size);
+
+    /**
+     * @brief Read at an absolute offset, the current position is not changed.
+     * @param[in] offset Offset from the beginning of the file.
+     * @param[out] buffer Buffer in the enclave to receive the data.
+     * @param[in] size Maximum number of bytes to read, there is no upper limit.
+     * @return Number of bytes actually read, less than size only at the end of file.
+     * @throws FileSystemException If the stream is not open or a read error occurs.
+     */
+    size_t ReadAt(uint64_t offset, void* buffer, size_t size);
+
+    /**
+     * @brief Returns the current position of Read().
+     * @return Current position.
+     * @throws FileSystemException If the stream is not open.
+     */
+    uint64_t Tell() const;
+
+    /**
+     * @brief Returns the file size when the stream was opened.
+     * @return File size, in bytes.
+     * @throws FileSystemException If the stream is not open.
+     */
+    uint64_t Size() const;
+
+    /**
+     * @brief Close the stream, do nothing if it is not open.
+     * @throws FileSystemException If closing fails.
+     */
+    void Close();
+
   private:
     std::string file_path_;
+    uint64_t handle_;
+    uint64_t file_size_;
+    uint64_t position_;
+    uint8_t* buffer_;
+    uint64_t window_offset_;
+    size_t window_size_;
 };
 
 /**
- * @brief Write a plaintext file (file size <= 100 KB)
+ * @brief Write a plaintext file.
+ *
+ * WriteAllBytes() and WriteAllText() write a whole file of at most 100 KB in one call. For bigger files, Open() the
+ * writer as a stream and Write() it piece by piece; there is no size limit. Writes are gathered in a 1 MB untrusted
+ * buffer and leave the enclave only when it is full, on Flush() or on Close().
  */
 class PlainFileWriter {
   public:
+    PlainFileWriter(const PlainFileWriter&) = delete;
+    PlainFileWriter& operator=(const PlainFileWriter&) = delete;
+
     /**
      * @brief Construct a PlainFileWriter and initialized it
      * @param[in] filepath File path
      */
-    explicit PlainFileWriter(std::string filepath) : file_path_(std::move(filepath)) {
+    explicit PlainFileWriter(std::string filepath)
+        : file_path_(std::move(filepath)), handle_(0), buffer_(nullptr), buffered_size_(0) {
     }
 
+    /**
+     * @brief Close the stream if it is still open, errors are ignored.
+     * @note Call Close() explicitly to find out whether the buffered data has been written.
+     */
+    ~PlainFileWriter();
+
     /**
      * @brief Write data to a binary file in plaintext
      * @param[in] data data will be written to file, in bytes, the max size is 100KB.
@@ -611,8 +706,155 @@ class PlainFileWriter {
      */
     void WriteAllText(const std::string& str);
 
+    /**
+     * @brief Open the file as a stream, with an exclusive lock held until Close().
+     * @param[in] file_mode CreateNew fails if the file exists, OpenOrCreate truncates it, Append writes at its end.
+     * @throws FileSystemException If the stream is already open or the file cannot be opened.
+     */
+    void Open(FileMode file_mode = FileMode::OpenOrCreate);
+
+    /**
+     * @brief Append data to the stream.
+     * @param[in] data Data in the enclave to be written.
+     * @param[in] size Size of the data in bytes, there is no upper limit.
+     * @throws FileSystemException If the stream is not open or writing fails.
+     */
+    void Write(const void* data, size_t size);
+
+    /**
+     * @brief Write the buffered data and flush the file to disk.
+     * @throws FileSystemException If the stream is not open or flushing fails.
+     */
+    void Flush();
+
+    /**
+     * @brief Write the buffered data and close the stream, do nothing if it is not open.
+     * @throws FileSystemException If writing or closing fails.
+     */
+    void Close();
+
   private:
+    void WriteBuffer();
+
     std::string file_path_;
+    uint64_t handle_;
+    uint8_t* buffer_;
+    size_t buffered_size_;
+};
+
+/**
+ * @brief A read-only plaintext file mapped into untrusted memory by the host.
+ *
+ * Unlike PlainFileReader, nothing is copied when the file is opened. Each Read() copies just the requested range into
+ * the enclave with plain memory reads, so a big lookup table costs EPC and host I/O only for the pages actually
+ * touched. The host holds a shared lock on the file until Close().
+ *
+ * @note The mapped bytes are untrusted and may change between two reads. Only trust the copy written to the
+ * caller's buffer. To authenticate a range, use ReadVerified(), which hashes that copy rather than the mapping.
+ * @note Writers which ignore the lock must not truncate the file while it is mapped.
+ *
+ * @par Examples
+ * @code
+ *     MappedPlainFile table(path);
+ *     Entry entry;
+ *     table.Read(index * sizeof(Entry), &entry, sizeof(Entry));
+ * @endcode
+ */
+class MappedPlainFile {
+  public:
+    MappedPlainFile(const MappedPlainFile&) = delete;
+    MappedPlainFile& operator=(const MappedPlainFile&) = delete;
+
+    /**
+     * @brief Map a file read-only.
+     * @param[in] filepath File path
+     * @throws FileSystemException If the file cannot be mapped.
+     */
+    explicit MappedPlainFile(const std::string& filepath);
+
+    /**
+     * @brief Unmap the file if it is still mapped, errors are ignored.
+     */
+    ~MappedPlainFile();
+
+    /**
+     * @brief Returns the file size when it was mapped.
+     * @return File size, in bytes.
+     * @throws FileSystemException If the file is not mapped.
+     */
+    uint64_t Size() const;
+
+    /**
+     * @brief Copy a range of the file into the enclave.
+     * @param[in] offset Offset from the beginning of the file.
+     * @param[out] buffer Buffer in the enclave to receive the data.
+     * @param[in] size Number of bytes to copy, offset + size must not exceed Size().
+     * @throws FileSystemException If the file is not mapped or the range is out of bounds.
+     */
+    void Read(uint64_t offset, void* buffer, size_t size) const;
+
+    /**
+     * @brief Copy a range of the file into the enclave.
+     * @param[in] offset Offset from the beginning of the file.
+     * @param[in] size Number of bytes to copy, offset + size must not exceed Size().
+     * @return The copied range, in bytes.
+     * @throws FileSystemException If the file is not mapped or the range is out of bounds.
+     */
+    std::vector<uint8_t> Read(uint64_t offset, size_t size) const;
+
+    /**
+     * @brief Copy a range of the file into the enclave and check its SHA256 digest.
+     * @param[in] offset Offset from the beginning of the file.
+     * @param[out] buffer Buffer in the enclave to receive the data.
+     * @param[in] size Number of bytes to copy, offset + size must not exceed Size().
+     * @param[in] expected_sha256 Expected SHA256 digest of the range (32 bytes).
+     * @throws FileSystemException If the file is not mapped, the range is out of bounds or the digest doesn't match.
+     * The buffer is wiped if the digest doesn't match.
+     */
+    void ReadVerified(uint64_t offset, void* buffer, size_t size, const std::vector<uint8_t>& expected_sha256) const;
+
+    /**
+     * @brief Unmap the file, do nothing if it is not mapped.
+     * @throws FileSystemException If unmapping fails.
+     */
+    void Close();
+
+  private:
+    uint64_t handle_;
+    const uint8_t* data_;
+    uint64_t size_;
+};
+
+/**
+ * @brief Tuning options for opening a protected file.
+ */
+struct ProtectedFileOptions {
+    /// Size of a protected file node, the unit of the node cache.
+    static constexpr uint64_t NODE_SIZE = 4096;
+
+    /**
+     * Bytes of decrypted nodes the protected file system keeps in its cache, e.g. 1024 * NODE_SIZE.
+     * 0 keeps the SDK default (48 nodes); other values are rounded up to whole nodes and to at least the default.
+     * Honored only if the SGX SDK provides sgx_fopen_ex(), otherwise the SDK default applies.
+     */
+    uint64_t cache_size = 0;
+
+    /**
+     * Bytes ProtectedFileReader fetches at once for sequential reads and serves smaller Read() calls from,
+     * 0 disables read-ahead. Ignored by ProtectedFileWriter.
+     */
+    size_t read_ahead = 0;
+};
+
+/**
+ * @brief Read counters of a ProtectedFileReader.
+ */
+struct ProtectedFileStats {
+    uint64_t reads = 0;         ///< Read() calls
+    uint64_t hits = 0;          ///< Read() calls served entirely by the read-ahead buffer
+    uint64_t misses = 0;        ///< Read() calls which had to fetch from the protected file system
+    uint64_t fetches = 0;       ///< sgx_fread() calls, each one decrypts or looks up the nodes it spans
+    uint64_t bytes_fetched = 0; ///< Bytes returned by sgx_fread()
 };
 
 /**
@@ -622,6 +864,12 @@ class ProtectedFileReader {
   private:
     SGX_FILE* file_;
     const char* file_name_;
+    mutable std::vector<uint8_t> ahead_buf_;
+    mutable size_t ahead_pos_;
+    mutable size_t ahead_len_;
+    mutable ProtectedFileStats stats_;
+
+    size_t Fetch(void* buffer, size_t size) const;
 
   public:
     ProtectedFileReader(const ProtectedFileReader&) = delete;
@@ -630,9 +878,10 @@ class ProtectedFileReader {
     /**
      * @brief Opens a file for reading.
      * @param file_name The name of the file to open (must be a valid, non-null C-string).
+     * @param options Node cache size and read-ahead, the defaults keep the SDK behavior.
      * @throws FileSystemException If the file cannot be opened.
      */
-    explicit ProtectedFileReader(const char* file_name);
+    explicit ProtectedFileReader(const char* file_name, const ProtectedFileOptions& options = ProtectedFileOptions());
     ~ProtectedFileReader();
 
     /**
@@ -647,6 +896,12 @@ class ProtectedFileReader {
      */
     size_t Read(void* buffer, size_t size) const;
 
+    /**
+     * @brief Returns the read counters since the file was opened.
+     * @return Read counters.
+     */
+    ProtectedFileStats Stats() const;
+
     /**
      * @brief Returns the current file position.
      * @return Current file position.
@@ -687,9 +942,12 @@ class ProtectedFileWriter {
      * @param file_name The name of the file to create or overwrite (must be a valid, non-null C-string).
      * @param file_mode One of FileMode to identify the writing operation mode.
      * @param key_policy The key policy for sealing operations (default: SGX_KEYPOLICY_MRENCLAVE).
+     * @param options Node cache size, the default keeps the SDK behavior.
      * @throws FileSystemException If the file cannot be opened.
      */
-    explicit ProtectedFileWriter(const char* file_name, FileMode file_mode = FileMode::CreateNew, uint16_t key_policy = SGX_KEYPOLICY_MRENCLAVE);
+    explicit ProtectedFileWriter(const char* file_name, FileMode file_mode = FileMode::CreateNew,
+                                 uint16_t key_policy = SGX_KEYPOLICY_MRENCLAVE,
+                                 const ProtectedFileOptions& options = ProtectedFileOptions());
 
     ~ProtectedFileWriter();
 
@@ -717,6 +975,169 @@ class ProtectedFileWriter {
     void Close();
 };
 
+/**
+ * @brief A writer of a chunked sealed file, whose chunks can be encrypted in parallel by several enclave threads.
+ *
+ * The data is cut into chunks of ChunkSize() bytes, only the last one may be shorter. Each chunk is encrypted on its
+ * own with AES-GCM, using a key derived from a seal key, and written at offset index * ChunkSize(). The chunk tags
+ * form an index which, with the data size, is authenticated by a trailer at the end of the file; a
+ * ChunkedFileReader can therefore decrypt any chunk in O(1) and detects reordered, replaced or truncated chunks. The
+ * seal key request is saved to a metadata file next to the data, as for ProtectedFileWriter.
+ *
+ * WriteChunk() may be called concurrently, in any order, from several threads (e.g. one ECALL per worker thread).
+ * Each index is written exactly once, then Close() writes the index and the trailer. A file not closed is not
+ * readable.
+ *
+ * @par Examples
+ * @code
+ *     ChunkedFileWriter writer(path, FileMode::OpenOrCreate);
+ *     // in each worker thread, for its share of the chunks:
+ *     writer.WriteChunk(i, data + i * writer.ChunkSize(), std::min(writer.ChunkSize(), size - i * writer.ChunkSize()));
+ *     // once all the workers are done:
+ *     writer.Close();
+ * @endcode
+ */
+class ChunkedFileWriter {
+  public:
+    ChunkedFileWriter(const ChunkedFileWriter&) = delete;
+    ChunkedFileWriter& operator=(const ChunkedFileWriter&) = delete;
+
+    /**
+     * @brief Create a chunked file.
+     * @param file_name The name of the file to create or overwrite (must be a valid, non-null C-string).
+     * @param file_mode CreateNew or OpenOrCreate. Append is not supported, chunks are never encrypted twice.
+     * @param key_policy The key policy for sealing operations (default: SGX_KEYPOLICY_MRENCLAVE).
+     * @param chunk_size Chunk size in bytes, from 4 KB to 16 MB (default: 256 KB).
+     * @throws FileSystemException If a parameter is invalid or the file cannot be created.
+     */
+    explicit ChunkedFileWriter(const char* file_name, FileMode file_mode = FileMode::CreateNew,
+                               uint16_t key_policy = SGX_KEYPOLICY_MRENCLAVE, size_t chunk_size = 256 * 1024);
+
+    /**
+     * @brief Release the file if it is still open, errors are ignored. The file is left unreadable.
+     */
+    ~ChunkedFileWriter();
+
+    /**
+     * @brief Returns the chunk size.
+     * @return Chunk size, in bytes.
+     */
+    size_t ChunkSize() const;
+
+    /**
+     * @brief Encrypt and write one chunk, thread safe.
+     * @param index Chunk index, the chunk is written at offset index * ChunkSize().
+     * @param data Chunk data.
+     * @param size Chunk size, ChunkSize() except for the last chunk which may be shorter (must be > 0).
+     * @throws FileSystemException If the file is not open, the index has been written or the write fails.
+     */
+    void WriteChunk(uint64_t index, const void* data, size_t size);
+
+    /**
+     * @brief Write the index and the trailer, then close the file. The file and its metadata file are flushed to disk.
+     * @throws FileSystemException If a chunk is missing, a chunk other than the last is short, or writing fails.
+     */
+    void Close();
+
+  private:
+    uint8_t* AcquireBuffer();
+    void ReleaseBuffer(uint8_t* buffer);
+    void Release();
+
+    std::string file_name_;
+    uint64_t handle_;
+    size_t chunk_size_;
+    uint8_t key_[16];
+    std::mutex mutex_;
+    std::vector<uint32_t> chunk_sizes_;
+    std::vector<uint8_t> tags_;
+    std::vector<uint8_t*> buffers_;
+    bool failed_;
+};
+
+/**
+ * @brief A reader of a file written by ChunkedFileWriter, with random access and thread safe reads.
+ *
+ * The trailer and the chunk index are authenticated when the file is opened. Every read then decrypts just the chunks
+ * it touches, each one checked against its tag and position, so several threads can read different chunks in
+ * parallel.
+ */
+class ChunkedFileReader {
+  public:
+    ChunkedFileReader(const ChunkedFileReader&) = delete;
+    ChunkedFileReader& operator=(const ChunkedFileReader&) = delete;
+
+    /**
+     * @brief Open a chunked file and authenticate its index.
+     * @param file_name The name of the file to open (must be a valid, non-null C-string).
+     * @throws FileSystemException If the file cannot be opened, or its metadata, index or trailer is invalid.
+     */
+    explicit ChunkedFileReader(const char* file_name);
+
+    /**
+     * @brief Close the file if it is still open, errors are ignored.
+     */
+    ~ChunkedFileReader();
+
+    /**
+     * @brief Returns the data size.
+     * @return Data size, in bytes.
+     */
+    uint64_t Size() const;
+
+    /**
+     * @brief Returns the chunk size.
+     * @return Chunk size, in bytes.
+     */
+    size_t ChunkSize() const;
+
+    /**
+     * @brief Returns the number of chunks.
+     * @return Chunk count.
+     */
+    uint64_t ChunkCount() const;
+
+    /**
+     * @brief Decrypt one chunk, thread safe.
+     * @param index Chunk index, less than ChunkCount().
+     * @param buffer Buffer to receive the chunk.
+     * @param size Buffer size, at least the size of the chunk (ChunkSize() is always enough).
+     * @return The chunk size.
+     * @throws FileSystemException If the file is not open, a parameter is invalid or the chunk fails to authenticate.
+     */
+    size_t ReadChunk(uint64_t index, void* buffer, size_t size);
+
+    /**
+     * @brief Read at an absolute offset, decrypting the chunks it spans, thread safe.
+     * @param offset Offset from the beginning of the data.
+     * @param buffer Buffer to receive the data.
+     * @param size Maximum number of bytes to read.
+     * @return Number of bytes actually read, less than size only at the end of data.
+     * @throws FileSystemException If the file is not open or a chunk fails to authenticate.
+     */
+    size_t Read(uint64_t offset, void* buffer, size_t size);
+
+    /**
+     * @brief Close the file, do nothing if it is not open.
+     * @throws FileSystemException If closing fails.
+     */
+    void Close();
+
+  private:
+    uint8_t* AcquireBuffer();
+    void ReleaseBuffer(uint8_t* buffer);
+    void Release();
+
+    uint64_t handle_;
+    size_t chunk_size_;
+    uint64_t data_size_;
+    uint64_t chunk_count_;
+    uint8_t key_[16];
+    std::vector<uint8_t> tags_;
+    std::mutex mutex_;
+    std::vector<uint8_t*> buffers_;
+};
+
 }; // namespace filesystem_t
 }; // namespace ssgx
 
@@ -0,0 +1,212 @@
+#ifndef SAFEHERON_SGX_TRUSTED_FILESYSTEM_KV_STORE_H
+#define SAFEHERON_SGX_TRUSTED_FILESYSTEM_KV_STORE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ssgx_filesystem_t.h"
+
+namespace ssgx {
+namespace filesystem_t {
+
+namespace detail {
+struct KvSegment;
+} // namespace detail
+
+/**
+ * @brief Options of a KvStore
+ */
+struct KvStoreOptions {
+    /**
+     * @brief Key policy of the WAL records and segments, SGX_KEYPOLICY_MRENCLAVE or SGX_KEYPOLICY_MRSIGNER
+     */
+    uint16_t key_policy = SGX_KEYPOLICY_MRENCLAVE;
+
+    /**
+     * @brief The memtable is written to a new segment once its keys and values take this many bytes
+     */
+    size_t memtable_size = 4 * 1024 * 1024;
+
+    /**
+     * @brief NeedsCompaction() returns true from this many segments on
+     */
+    size_t compaction_trigger = 4;
+
+    /**
+     * @brief Flush the WAL to disk on every Put() and Delete(); if false, a crash may lose the latest updates
+     */
+    bool sync = true;
+
+    /**
+     * @brief Bits of bloom filter per key in a segment, 10 gives about 1% false positives; 0 disables the filter
+     */
+    size_t bloom_bits_per_key = 10;
+};
+
+/**
+ * @brief An embedded, crash safe key-value store whose files are sealed to the enclave.
+ *
+ * Updates go to an in-enclave memtable, and are logged to a write-ahead log (WAL) first: each record is sealed by
+ * SealHandler with the log id and sequence number as its MAC text, so records can be neither modified nor reordered.
+ * A full memtable is written to an immutable sorted segment, which is a ChunkedFileWriter file holding the entries,
+ * a sparse index and a bloom filter. Get() reads one block of at most one segment in the common case, and Scan()
+ * merges the memtable with all segments.
+ *
+ * The live segments and WAL are listed in a manifest, written alternately to two chunked files with a generation
+ * number: a crash while writing one leaves the other, so the store always reopens to the last committed state and
+ * replays the WAL on top of it. A commit removes the files it replaces only once the manifest, its metadata and the
+ * directory are flushed to disk. The key of every file comes from the enclave seal key, under the key policy of
+ * KvStoreOptions.
+ *
+ * Compact() merges all segments into one and drops deleted keys. Enclaves cannot start threads, so the application
+ * runs it from an ECALL on a thread of its own; Get(), Scan(), Put() and Delete() go on meanwhile.
+ *
+ * @note Like other sealed files, the store cannot detect a rollback of its whole directory to an older copy.
+ *
+ * Usage:
+ * @code
+ *      KvStore store(dir);
+ *      store.Put("wallet/1", metadata);
+ *      std::optional<std::string> value = store.Get("wallet/1");
+ *      for (const auto& kv : store.Scan("wallet/", "wallet0")) { ... }
+ *
+ *      // In an ECALL made by a background thread of the host
+ *      if (store.NeedsCompaction()) store.Compact();
+ * @endcode
+ *
+ * All methods are thread safe.
+ */
+class KvStore {
+  public:
+    KvStore(const KvStore&) = delete;
+    KvStore& operator=(const KvStore&) = delete;
+
+    /**
+     * @brief Open the store in directory dir, or create it if dir has none
+     * @param[in] dir Directory of the store, which is created if it doesn't exist. It is locked until Close().
+     * @param[in] options Options, see KvStoreOptions
+     * @throws FileSystemException If the directory is in use, its files fail to authenticate, or it has segments or
+     * WALs but no manifest
+     */
+    explicit KvStore(const std::string& dir, const KvStoreOptions& options = KvStoreOptions());
+
+    /**
+     * @brief Close the store if it is still open, errors are ignored.
+     */
+    ~KvStore();
+
+    /**
+     * @brief Set the value of key
+     * @param[in] key Key, at most 64 KB
+     * @param[in] value Value, at most 16 MB
+     * @throws FileSystemException If the store is closed, or the update cannot be logged
+     */
+    void Put(const std::string& key, const std::string& value);
+
+    /**
+     * @brief Delete key, do nothing if it doesn't exist
+     * @param[in] key Key, at most 64 KB
+     * @throws FileSystemException If the store is closed, or the update cannot be logged
+     */
+    void Delete(const std::string& key);
+
+    /**
+     * @brief Get the value of key
+     * @param[in] key Key
+     * @return The value, or std::nullopt if key doesn't exist
+     * @throws FileSystemException If the store is closed, or a segment fails to authenticate
+     */
+    std::optional<std::string> Get(const std::string& key) const;
+
+    /**
+     * @brief Get the keys in [begin, end) with their values, in ascending order
+     * @param[in] begin First key of the range
+     * @param[in] end Key after the range, an empty end means no upper bound
+     * @param[in] limit Max number of keys to return
+     * @return Pairs of key and value
+     * @throws FileSystemException If the store is closed, or a segment fails to authenticate
+     */
+    std::vector<std::pair<std::string, std::string>> Scan(const std::string& begin, const std::string& end,
+                                                           size_t limit = SIZE_MAX) const;
+
+    /**
+     * @brief Write the memtable to a new segment, and start a new WAL
+     * @throws FileSystemException If the store is closed or writing fails, the store is unchanged then
+     */
+    void Flush();
+
+    /**
+     * @brief Whether there are at least KvStoreOptions::compaction_trigger segments
+     */
+    bool NeedsCompaction() const;
+
+    /**
+     * @brief Merge all segments into one, dropping overwritten values and deleted keys
+     * @throws FileSystemException If the store is closed or writing fails, the store is unchanged then
+     */
+    void Compact();
+
+    /**
+     * @brief Returns the number of segments
+     */
+    size_t SegmentCount() const;
+
+    /**
+     * @brief Close the store, do nothing if it is not open. Updates stay in the WAL until the next open.
+     * @throws FileSystemException If closing the WAL fails
+     */
+    void Close();
+
+  private:
+    using MemTable = std::map<std::string, std::optional<std::string>>;
+
+    void Write(const std::string& key, const std::optional<std::string>& value);
+    void AppendWal(const std::string& key, const std::optional<std::string>& value);
+    void ReplayWal(uint64_t wal_id);
+    void FlushLocked();
+    void LoadManifest();
+    bool CommitManifest(const std::vector<std::shared_ptr<detail::KvSegment>>& segments, uint64_t wal_id,
+                        const std::vector<uint64_t>& obsolete_ids, bool& in_doubt);
+    void RemoveUnreferenced(uint64_t first_id, const std::vector<uint64_t>& obsolete_ids);
+    uint64_t AllocateFileId();
+    std::shared_ptr<detail::KvSegment> WriteSegment(
+        uint64_t id, const std::vector<std::shared_ptr<detail::KvSegment>>& sources, const MemTable* memtable,
+        bool drop_deleted) const;
+    std::string FilePath(uint64_t id, const char* extension) const;
+    void RemoveSegmentFile(uint64_t id) const;
+
+    std::string dir_;
+    KvStoreOptions options_;
+    std::unique_ptr<PlainFileWriter> lock_;
+
+    // Serializes Put(), Delete(), Flush() and manifest commits; guards the WAL and the manifest generation
+    mutable std::mutex write_mutex_;
+    std::unique_ptr<PlainFileWriter> wal_;
+    uint64_t wal_id_;
+    uint64_t wal_seq_;
+    uint64_t generation_;
+    std::vector<uint64_t> deferred_ids_; // Obsolete files kept until a commit is known to be on disk
+
+    // One compaction at a time
+    std::mutex compact_mutex_;
+
+    // Guards the state read by Get() and Scan()
+    mutable std::mutex mutex_;
+    MemTable memtable_;
+    size_t memtable_bytes_;
+    std::vector<std::shared_ptr<detail::KvSegment>> segments_; // Oldest first
+    uint64_t next_file_id_;
+    std::set<uint64_t> pending_ids_; // Files being written, not in the manifest yet
+};
+
+} // namespace filesystem_t
+} // namespace ssgx
+
+#endif // SAFEHERON_SGX_TRUSTED_FILESYSTEM_KV_STORE_H
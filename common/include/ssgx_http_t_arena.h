@@ -0,0 +1,149 @@
+#ifndef SSGXLIB_SSGX_HTTP_T_ARENA_H
+#define SSGXLIB_SSGX_HTTP_T_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace ssgx {
+namespace http_t {
+
+/**
+ * @brief Bump allocator for the objects of the request being handled, released all at once when it completes.
+ *
+ * Each enclave thread (TCS) has its own arena, so allocating from it takes no lock, whereas the enclave heap is
+ * shared by all threads. Blocks are kept from one request to the next, up to RETAINED_SIZE bytes.
+ *
+ * The server opens a RequestArena::Scope around every request and builds its Request and Response on the arena.
+ * Objects which use the arena must not outlive the scope; copies of Request, Response, TypeHeaders and TypeParams are
+ * made on the heap, and so are the objects they are move-assigned to, and the Request and Response they are move
+ * constructed into, so they can be kept. A TypeHeaders or TypeParams move constructed from one on the arena keeps it.
+ */
+class RequestArena {
+  public:
+    static constexpr size_t BLOCK_SIZE = 16 * 1024;
+    static constexpr size_t RETAINED_SIZE = 64 * 1024;
+
+    RequestArena() = default;
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    /**
+     * @brief Take size bytes from the arena.
+     * @return nullptr if a new block is needed and can not be allocated.
+     */
+    void* Allocate(size_t size, size_t alignment);
+
+    /**
+     * @brief Gives access to the arena of the calling thread, and releases everything allocated from it in the
+     * meantime when the scope ends. Scopes may be nested.
+     */
+    class Scope {
+      public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @return The arena of the thread, or nullptr if it could not be allocated, in which case the heap is used.
+         */
+        RequestArena* Arena() const {
+            return arena_;
+        }
+
+      private:
+        RequestArena* arena_;
+        size_t block_ = 0;
+        size_t used_ = 0;
+    };
+
+  private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size = 0;
+    };
+
+    void Rewind(size_t block, size_t used);
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0; // block being carved
+    size_t used_ = 0;    // bytes taken from blocks_[current_]
+};
+
+/**
+ * @brief Standard allocator over a RequestArena. A default constructed allocator uses the heap.
+ *
+ * Memory taken from an arena is not released by deallocate() but when the scope of the request ends.
+ *
+ * A container keeps its allocator when another one is assigned or moved into it, so a container which outlives the
+ * scope never picks up the arena: its elements are moved one by one into its own memory instead. Containers on
+ * different arenas must not be swapped.
+ */
+template <typename T>
+class ArenaAllocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(RequestArena* arena) noexcept : arena_(arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.Arena()) {
+    }
+
+    T* allocate(size_t n) {
+        if (!arena_) {
+            return std::allocator<T>().allocate(n);
+        }
+        if (n > SIZE_MAX / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        void* ptr = arena_->Allocate(n * sizeof(T), alignof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (!arena_) {
+            std::allocator<T>().deallocate(ptr, n);
+        }
+    }
+
+    // Copies of a container may outlive the request, so they are made on the heap
+    ArenaAllocator select_on_container_copy_construction() const noexcept {
+        return ArenaAllocator();
+    }
+
+    RequestArena* Arena() const noexcept {
+        return arena_;
+    }
+
+  private:
+    RequestArena* arena_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.Arena() == b.Arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.Arena() != b.Arena();
+}
+
+} // namespace http_t
+} // namespace ssgx
+
+#endif // SSGXLIB_SSGX_HTTP_T_ARENA_H
@@ -1,8 +1,11 @@
 #ifndef SAFEHERON_SGX_TRUSTED_HTTP_CLIENT_H
 #define SAFEHERON_SGX_TRUSTED_HTTP_CLIENT_H
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "ssgx_http_t_structs.h"
 
@@ -35,6 +38,53 @@ enum class ErrorCode {
     Unknown = 9999, /**< Unknown error occurred. */
 };
 
+/**
+ * @brief Settings of the keep-alive connection pool shared by all Client instances in the enclave.
+ *
+ * After a response which lets the connection stay open, the connection (including its TLS session) is kept and reused
+ * by the next request to the same scheme, host, port and CA chain, which saves the TCP connect and the TLS handshake.
+ */
+struct ConnectionPoolOptions {
+    bool enabled = true;          /**< Reuse connections. When false, every request opens and closes its connection. */
+    size_t max_idle_per_host = 4; /**< Idle connections kept per scheme, host, port and CA chain. */
+    int idle_timeout_ms = 30000;  /**< Idle connections older than this are closed instead of being reused. */
+};
+
+/**
+ * @brief Settings of the TLS session cache shared by all Client instances in the enclave.
+ *
+ * When a new HTTPS connection has to be made, the session of the last handshake with the same host and port is offered
+ * to the server. If the server accepts it, the handshake is abbreviated: no certificate chain verification and no new
+ * key exchange. Sessions are only offered to clients which trust the same CA chain as the one which created them.
+ */
+struct TlsSessionCacheOptions {
+    bool enabled = true;     /**< Offer cached sessions. When false, every new connection does a full handshake. */
+    size_t max_entries = 64; /**< Number of servers whose session is kept. */
+    int lifetime_sec = 3600; /**< Sessions older than this are not offered any more. */
+};
+
+/**
+ * @brief Counters of the TLS session cache.
+ */
+struct TlsSessionCacheStats {
+    uint64_t hits;   /**< New connections whose handshake resumed a cached session. */
+    uint64_t misses; /**< New connections which found no usable cached session, or whose offered session the server
+                          declined. */
+    size_t entries;  /**< Sessions currently cached. */
+};
+
+/**
+ * @brief One request of a batch sent by Client::SendAll().
+ */
+struct RequestSpec {
+    std::string method = "GET"; /**< "GET" or "POST". */
+    std::string path;           /**< Request path. */
+    TypeHeaders headers;        /**< HTTP headers. */
+    TypeParams params;          /**< URL parameters, GET only. */
+    std::string body;           /**< Request body, POST only. */
+    std::string content_type;   /**< Body MIME type, POST only. */
+};
+
 /**
  * @brief Represents detailed error information, typically from client operations.
  */
@@ -70,6 +120,9 @@ class Result {
     Result() = default;
     Result(std::unique_ptr<Response>&& res, const Error& err) : res_(std::move(res)), err_(err) {
     }
+    Result(std::unique_ptr<Response>&& res, const Error& err, bool tls_session_resumed)
+        : res_(std::move(res)), err_(err), tls_session_resumed_(tls_session_resumed) {
+    }
     // Response
     explicit operator bool() const {
         return res_ != nullptr;
@@ -104,9 +157,18 @@ class Result {
         return err_;
     }
 
+    /**
+     * @brief Whether the HTTPS connection which carried the request was set up by resuming a cached TLS session,
+     * see TlsSessionCacheOptions. Always false for HTTP.
+     */
+    [[nodiscard]] bool tls_session_resumed() const {
+        return tls_session_resumed_;
+    }
+
   private:
     std::unique_ptr<Response> res_;
     Error err_ = Error(ErrorCode::Unknown, "Invalid", "Unknown");
+    bool tls_session_resumed_ = false;
 };
 
 /**
@@ -272,6 +334,61 @@ class Client {
     Result Post(const std::string& path, const TypeHeaders& headers, const std::string& body,
                 const std::string& content_type, int time_out_sec = SSGX_HTTP_CLIENT_TIMEOUT);
 
+    /**
+     * @brief Sends several requests to this client's server at the same time.
+     *
+     * All requests are in flight together, each on its own connection, and are driven by the calling thread: the
+     * batch takes about as long as its slowest request and occupies a single enclave thread.
+     *
+     * @param requests Requests to send.
+     * @param time_out_sec Timeout duration (in seconds), default is
+     * SSGX_HTTP_CLIENT_TIMEOUT. Requests still pending after this long without any progress of the batch fail.
+     * @return One result per request, in the same order.
+     */
+    std::vector<Result> SendAll(const std::vector<RequestSpec>& requests, int time_out_sec = SSGX_HTTP_CLIENT_TIMEOUT);
+
+    /**
+     * @brief Sends requests to several servers at the same time.
+     *
+     * Same as the member SendAll(), with each request sent by the client it is paired with.
+     *
+     * @param requests Requests to send, with the client (server, port and CA chain) of each one.
+     * @param time_out_sec Timeout duration (in seconds), default is
+     * SSGX_HTTP_CLIENT_TIMEOUT.
+     * @return One result per request, in the same order.
+     */
+    static std::vector<Result> SendAll(const std::vector<std::pair<const Client*, RequestSpec>>& requests,
+                                       int time_out_sec = SSGX_HTTP_CLIENT_TIMEOUT);
+
+    /**
+     * @brief Configure the connection pool shared by all clients.
+     *
+     * Disabling the pool also closes the connections which are currently idle.
+     *
+     * @param options New pool settings.
+     */
+    static void SetConnectionPoolOptions(const ConnectionPoolOptions& options);
+
+    /**
+     * @brief Close all idle connections of the shared connection pool.
+     */
+    static void ClearConnectionPool();
+
+    /**
+     * @brief Configure the TLS session cache shared by all clients.
+     *
+     * Disabling the cache also drops the sessions which are currently cached.
+     *
+     * @param options New cache settings.
+     */
+    static void SetTlsSessionCacheOptions(const TlsSessionCacheOptions& options);
+
+    /**
+     * @brief Get the counters of the TLS session cache.
+     * @return Hits, misses and number of cached sessions.
+     */
+    static TlsSessionCacheStats GetTlsSessionCacheStats();
+
   private:
     [[nodiscard]] Result SendRequest(const std::string& method, const std::string& path, const TypeHeaders& headers,
                                      const TypeParams& params, const std::string& body, const std::string& content_type,
@@ -3,6 +3,7 @@
 
 #include <functional>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -83,26 +84,49 @@ class FilterChain {
      */
     Response Execute(Request& request, const std::function<void(Request&, Response&)>& handler) {
         Response response;
+        Execute(request, handler, response);
+        return response;
+    }
 
+    /**
+     * @brief Execute the filter chain for a request, on a response prepared by the caller.
+     *
+     * Same as the other overload, for a response which already carries state, such as the sink of a streamed
+     * response (see Response::BeginStream()).
+     *
+     * An exception of the handler becomes a 500 response, unless the response is already streaming: then it is
+     * rethrown, so that the caller aborts the response rather than end a truncated body as if it were complete.
+     *
+     * @param request The HTTP request object to process.
+     * @param handler The handler function to process the request.
+     * @param response The response to fill.
+     */
+    void Execute(Request& request, const std::function<void(Request&, Response&)>& handler, Response& response) {
         for (auto& filter : filters_) {
             if (!filter->Before(request, response)) {
-                return response;
+                return;
             }
         }
 
+        // Once a response streams, its status code is sent and the error can not be reported any more, the
+        // exception goes on to the caller which aborts the response instead of completing it
         try {
             handler(request, response);
         } catch (const std::exception& ex) {
+            if (response.IsStreaming()) {
+                throw;
+            }
             response.SetResp("Internal Server Error: " + std::string(ex.what()), "text/plain", HttpStatusCode::InternalServerError500);
         } catch (...) {
+            if (response.IsStreaming()) {
+                throw std::runtime_error("Unknown exception in a streamed response");
+            }
             response.SetResp("Internal Server Error: Unknown exception", "text/plain", HttpStatusCode::InternalServerError500);
         }
 
         for (auto& filter : filters_) {
             filter->After(request, response);
         }
-
-        return response;
     }
 
   private:
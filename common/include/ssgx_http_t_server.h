@@ -1,9 +1,9 @@
 #ifndef SSGXLIB_SSGX_HTTP_T_SERVER_H
 #define SSGXLIB_SSGX_HTTP_T_SERVER_H
 
-#include <mutex>
+#include <functional>
+#include <memory>
 #include <string>
-#include <unordered_map>
 
 #include "ssgx_http_t_filter.h"
 #include "ssgx_http_t_structs.h"
@@ -15,6 +15,10 @@ namespace ssgx {
  * (TEE).
  */
 namespace http_t {
+namespace internal {
+class Router;
+}
+
 /**
  * @brief HTTP service class for managing request listening and routing.
  *
@@ -30,7 +34,7 @@ class Server {
      * Initializes the HTTP service without setting up a listener. The server can be configured further using setter
      * functions like SetTimeOut() and set_max_connections().
      */
-    Server() = default;
+    Server();
 
     /**
      * @brief Destructor.
@@ -138,8 +142,17 @@ class Server {
      * This method registers a handler function that will be invoked whenever a GET request is made to the specified
      * path.
      *
+     * The path may contain parameters and a trailing wildcard, e.g. "/orders/{id}" or "/files/*name". The values
+     * matched by them are available with Request::PathParams(). Literal segments take precedence over parameters, and
+     * parameters over wildcards. A wildcard which is not the last segment makes the path invalid.
+     *
+     * Handlers are registered before Start(), which builds the route table.
+     *
      * @param path The path for which the handler should be registered.
      * @param handler The function to handle GET requests at the specified path.
+     * @throws std::invalid_argument if the path is invalid, or conflicts with the parameter or wildcard names of a path
+     * registered before, e.g. "/orders/{id}" and "/orders/{name}".
+     * @throws std::logic_error if the server is running.
      */
     void Get(const std::string& path,
              const std::function<void(ssgx::http_t::Request&, ssgx::http_t::Response&)>& handler);
@@ -148,24 +161,40 @@ class Server {
      * @brief Register a handler for POST requests.
      *
      * This method registers a handler function that will be invoked whenever a POST request is made to the specified
-     * path.
+     * path. The path may contain parameters and a trailing wildcard, see Get().
      *
      * @param path The path for which the handler should be registered.
      * @param handler The function to handle POST requests at the specified path.
+     * @throws std::invalid_argument if the path is invalid, see Get().
+     * @throws std::logic_error if the server is running.
      */
     void Post(const std::string& path,
               const std::function<void(ssgx::http_t::Request&, ssgx::http_t::Response&)>& handler);
 
+    /**
+     * @brief Register a handler for POST requests whose body is read piece by piece.
+     *
+     * Large request bodies are left on the host and pulled by the handler through the reader, so the enclave never has
+     * to hold the whole body. Small bodies are delivered with the request and read from memory by the same reader.
+     * Request::Body() is empty for these handlers.
+     *
+     * @param path The path for which the handler should be registered.
+     * @param handler The function to handle POST requests at the specified path.
+     * @throws std::invalid_argument if the path is invalid, see Get().
+     * @throws std::logic_error if the server is running.
+     */
+    void PostStream(
+        const std::string& path,
+        const std::function<void(ssgx::http_t::Request&, ssgx::http_t::BodyReader&, ssgx::http_t::Response&)>& handler);
+
   private:
     void RegisterHandler(const std::string& method, const std::string& path,
-                         const std::function<void(ssgx::http_t::Request&, ssgx::http_t::Response&)>& handler);
+                         const std::function<void(ssgx::http_t::Request&, ssgx::http_t::Response&)>& handler,
+                         bool is_stream = false);
 
     void Process(const std::string& method, const std::string& path, ssgx::http_t::Request& req,
                  ssgx::http_t::Response& resp);
 
-    std::function<void(ssgx::http_t::Request&, ssgx::http_t::Response&)> GetHandler(const std::string& method,
-                                                                                    const std::string& method_path);
-
     friend void ServerProcessBridge(Server* srv, const std::string& method, const std::string& path,
                                     ssgx::http_t::Request& req, ssgx::http_t::Response& resp);
 
@@ -177,11 +206,8 @@ class Server {
     uint64_t max_queued_ = 64;
     bool is_stopped_ = true;
 
-    // key = "{method}_{path}"
-    // map<key, handler>
-    std::mutex key_handler_map_mutex_;
-    std::unordered_map<std::string, std::function<void(ssgx::http_t::Request&, ssgx::http_t::Response&)>>
-        key_handler_map_;
+    // Routes are looked up without locking, see internal::Router
+    std::unique_ptr<internal::Router> router_;
 
     FilterChain filter_chain_;
 };
@@ -1,9 +1,13 @@
 #ifndef SAFEHERON_SGX_TRUSTED_HTTP_STRUCT_H
 #define SAFEHERON_SGX_TRUSTED_HTTP_STRUCT_H
 #include <any>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <unordered_map>
+
+#include "ssgx_http_t_arena.h"
+
 namespace ssgx {
 namespace http_t {
 // Enum for HTTP Status Codes, used to represent various response states
@@ -100,14 +104,62 @@ struct ci {
     }
 };
 
-using TypeHeaders = std::map<std::string, std::string, ci>;
-using TypeParams = std::map<std::string, std::string>;
+/**
+ * @brief Headers and parameters of a request or a response.
+ *
+ * @note Source-breaking change: they used to be plain std::map with the default allocator. Since they carry an
+ * ArenaAllocator, code which binds them to a std::map<std::string, std::string, ci> or a
+ * std::map<std::string, std::string> must use TypeHeaders and TypeParams, or copy them. A default constructed map
+ * still uses the heap.
+ *
+ * A map move constructed from one on an arena keeps the arena, as std::map does; to keep one beyond the request, copy
+ * it, move assign it, or move construct it with a heap allocator: TypeHeaders kept(std::move(h), {}).
+ */
+using TypeHeaders = std::map<std::string, std::string, ci, ArenaAllocator<std::pair<const std::string, std::string>>>;
+using TypeParams =
+    std::map<std::string, std::string, std::less<std::string>, ArenaAllocator<std::pair<const std::string, std::string>>>;
+
+/**
+ * @brief Source of a request body which is read piece by piece, see Server::PostStream().
+ */
+class BodyReader {
+  public:
+    virtual ~BodyReader() = default;
+
+    /**
+     * @brief Read the next part of the body.
+     *
+     * @param buf Buffer receiving the data.
+     * @param size Size of buf.
+     * @return Number of bytes written to buf, 0 once the whole body has been read.
+     * @throws std::runtime_error if the body can not be received from the host, e.g. the client went away.
+     */
+    virtual size_t Read(uint8_t* buf, size_t size) = 0;
+};
 
 /**
  * @brief HTTP request class to represent an incoming HTTP request
  */
 class Request {
   public:
+    Request() = default;
+
+    /**
+     * @brief Create a request whose headers, parameters and attributes are allocated from an arena.
+     *
+     * @param arena The arena, or nullptr for the heap. It must outlive the request.
+     */
+    explicit Request(RequestArena* arena);
+
+    /**
+     * @brief Move a request, its headers, parameters and attributes to the heap if they are on an arena, so that the
+     * new request can outlive the scope of the arena. Copies and move assignments are made on the heap likewise.
+     */
+    Request(Request&& other);
+    Request(const Request& other) = default;
+    Request& operator=(Request&& other) = default;
+    Request& operator=(const Request& other) = default;
+
     /**
      * @brief Set the HTTP method (GET, POST, etc.) from a char buffer.
      *
@@ -297,6 +349,30 @@ class Request {
      */
     std::string GetParamValue(const std::string& key, const char* def = "") const;
 
+    /**
+     * @brief Set a parameter matched in the path, e.g. "id" for a handler registered on "/orders/{id}".
+     *
+     * @param key The name of the parameter in the route.
+     * @param val The matched segment.
+     */
+    void SetPathParam(const std::string& key, const std::string& val);
+
+    /**
+     * @brief Get the parameters matched in the path by the route of the handler.
+     *
+     * @return A const reference to the path parameters of the request.
+     */
+    const TypeParams& PathParams() const;
+
+    /**
+     * @brief Get the value of a parameter matched in the path (with a default value).
+     *
+     * @param key The name of the parameter in the route.
+     * @param def The default value to return if the route has no such parameter.
+     * @return The value of the parameter, or the default value if not found.
+     */
+    std::string GetPathParamValue(const std::string& key, const char* def = "") const;
+
     /**
      * @brief Set the body of the request from a character buffer.
      *
@@ -325,6 +401,23 @@ class Request {
      */
     const std::string& Body() const;
 
+    /**
+     * @brief Set the reader of a body which has not been copied into Body().
+     *
+     * @param reader The reader, owned by the caller, or nullptr.
+     */
+    void SetBodyStream(BodyReader* reader);
+
+    /**
+     * @brief Get the reader of the body.
+     *
+     * Only handlers registered with Server::PostStream() see a reader, for the other handlers the whole body is in
+     * Body().
+     *
+     * @return The reader, or nullptr if the body is in Body().
+     */
+    BodyReader* BodyStream() const;
+
     /**
      * @brief Parse the request from a JSON string.
      *
@@ -403,9 +496,13 @@ class Request {
     std::string method_;
     std::string path_; //"/api/v1/xxx"
     TypeParams params_;
+    TypeParams path_params_;
     TypeHeaders headers_;
     std::string body_;
-    std::unordered_map<std::string, std::any> data_;
+    BodyReader* body_stream_ = nullptr;
+    std::unordered_map<std::string, std::any, std::hash<std::string>, std::equal_to<std::string>,
+                       ArenaAllocator<std::pair<const std::string, std::any>>>
+        data_;
 
     template <typename T>
     T& GetInternal(const std::string& key) {
@@ -417,17 +514,58 @@ class Request {
     }
 };
 
+class Response;
+
+/**
+ * @brief Destination of a response which is sent piece by piece, see Response::BeginStream().
+ */
+class ResponseSink {
+  public:
+    virtual ~ResponseSink() = default;
+
+    /**
+     * @brief Send the status code and the headers of the response.
+     * @throws std::runtime_error if they can not be handed to the host.
+     */
+    virtual void Begin(const Response& response) = 0;
+
+    /**
+     * @brief Send the next part of the body.
+     * @throws std::runtime_error if the data can not be handed to the host, e.g. the client went away.
+     */
+    virtual void Write(const char* data, size_t size) = 0;
+};
+
 /**
  * @brief HTTP response class to represent an outgoing HTTP response
  */
 class Response {
   public:
+    Response() = default;
+
+    /**
+     * @brief Create a response whose headers are allocated from an arena.
+     *
+     * @param arena The arena, or nullptr for the heap. It must outlive the response.
+     */
+    explicit Response(RequestArena* arena);
+
+    /**
+     * @brief Move a response, its headers to the heap if they are on an arena, so that the new response can outlive
+     * the scope of the arena. Copies and move assignments are made on the heap likewise.
+     */
+    Response(Response&& other);
+    Response(const Response& other) = default;
+    Response& operator=(Response&& other) = default;
+    Response& operator=(const Response& other) = default;
+
     /**
      * @brief Set the HTTP status code for the response.
      *
      * This method sets the HTTP status code (e.g., 200 OK, 404 Not Found) for the response.
      *
      * @param status The HTTP status code to set.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetStatusCode(HttpStatusCode status);
 
@@ -446,6 +584,7 @@ class Response {
      * This method sets the headers for the HTTP response.
      *
      * @param headers The headers to set as a map.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetHeaders(const TypeHeaders& headers);
 
@@ -465,6 +604,7 @@ class Response {
      *
      * @param key The key (header name) to set.
      * @param val The value for the header.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetHeader(const std::string& key, const std::string& val);
 
@@ -475,6 +615,7 @@ class Response {
      *
      * @param key The key (header name) to set.
      * @param val The integer value for the header.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetHeader(const std::string& key, int64_t val);
 
@@ -518,6 +659,7 @@ class Response {
      *
      * @param buf The character buffer containing the body.
      * @param buf_len The length of the buffer.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetBody(const char* buf, size_t buf_len);
 
@@ -527,6 +669,7 @@ class Response {
      * This method sets the body of the response using a string.
      *
      * @param body The body of the response as a string.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetBody(const std::string& body);
 
@@ -568,6 +711,7 @@ class Response {
      * @param n The length of the body string.
      * @param content_type The content type (e.g., "application/json").
      * @param status The HTTP status code for the response.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetResp(const char* s, size_t n, const std::string& content_type, HttpStatusCode status);
 
@@ -579,6 +723,7 @@ class Response {
      * @param s The response body as a string.
      * @param content_type The content type (e.g., "application/json").
      * @param status The HTTP status code for the response.
+     * @throws std::runtime_error if the response is streaming, see BeginStream().
      */
     void SetResp(const std::string& s, const std::string& content_type, HttpStatusCode status);
 
@@ -620,10 +765,76 @@ class Response {
      */
     void SetResp204NoContent();
 
+    /**
+     * @brief Start sending the response before it is complete.
+     *
+     * The status code and the headers set so far are sent at once, and the body follows with Write(), using chunked
+     * transfer encoding. Status code, headers and Body() can not be changed any more: the methods which set them,
+     * SetResp() and the like included, throw std::runtime_error. The response is complete when the handler returns,
+     * the host sends the last (empty) chunk then. If the handler throws instead, the host closes the connection
+     * without the last chunk, so that the client does not take the truncated body for a complete one.
+     *
+     * When the response has no sink (e.g. for requests received through ssgx_ecall_http_on_message()), the data
+     * passed to Write() is collected in Body() and sent when the handler returns.
+     *
+     * @throws std::runtime_error if the response is already streaming or the host can not start it.
+     */
+    void BeginStream();
+
+    /**
+     * @brief Send the next part of a body started with BeginStream().
+     *
+     * @param data The data to send.
+     * @param size The length of data.
+     * @throws std::runtime_error if BeginStream() was not called, End() was called, or the host can not send it.
+     */
+    void Write(const char* data, size_t size);
+
+    /**
+     * @brief Send the next part of a body started with BeginStream().
+     *
+     * @param data The data to send.
+     */
+    void Write(const std::string& data);
+
+    /**
+     * @brief Send a server-sent event ("text/event-stream") on a body started with BeginStream().
+     *
+     * @param data The event data, a line break in it (CRLF, LF or CR) starts a new "data:" line.
+     * @param event The event type, none if empty.
+     * @throws std::invalid_argument if the event type contains a line break.
+     */
+    void WriteEvent(const std::string& data, const std::string& event = "");
+
+    /**
+     * @brief Mark a body started with BeginStream() as complete, later writes fail. The stream itself is finished
+     * when the handler returns, after the After() methods of the filters.
+     */
+    void End();
+
+    /**
+     * @brief Check whether BeginStream() has been called.
+     *
+     * @return True if the response is (or has been) streamed.
+     */
+    bool IsStreaming() const;
+
+    /**
+     * @brief Set where a streamed response is sent. This is done by the server before the handler is called.
+     *
+     * @param sink The sink, owned by the caller, or nullptr.
+     */
+    void SetStreamSink(ResponseSink* sink);
+
   private:
+    void CheckNotStreaming() const;
+
     HttpStatusCode status_code_ = HttpStatusCode::InternalServerError500;
     TypeHeaders headers_;
     std::string body_;
+    ResponseSink* stream_sink_ = nullptr;
+    bool streaming_ = false;
+    bool stream_ended_ = false;
 };
 
 } // namespace http_t
@@ -24,6 +24,11 @@ using HttpOnMessageCallback = sgx_status_t (*)(sgx_enclave_id_t eid, int* retval
                                                char** resp_status_headers_json, uint8_t** resp_body,
                                                size_t* resp_body_size);
 
+/** @brief Typedef for HTTP message callback which carries the request and response in binary frames */
+using HttpOnBinaryMessageCallback = sgx_status_t (*)(sgx_enclave_id_t eid, int* retval, const char* server_id,
+                                                     const uint8_t* req_frame, size_t req_frame_size,
+                                                     uint8_t** resp_frame, size_t* resp_frame_size);
+
 /** @brief Typedef for Enclave ID registration callback */
 using RegisterEidCallback = sgx_status_t (*)(sgx_enclave_id_t eid, sgx_enclave_id_t enclave_eid);
 
@@ -55,6 +60,28 @@ class HttpCallbackManager {
         return status == SGX_SUCCESS;
     }
 
+    /**
+     * @brief Http module callback function registration, with the binary framing callback.
+     *
+     * When a binary callback is registered, requests are forwarded into the enclave through it, which avoids encoding
+     * params, headers and the response status as JSON on both sides of the enclave boundary.
+     *
+     * @param[in] eid enclave id
+     * @param[in] register_cb The function name of the eid registration callback function
+     * @param[in] http_cb The function name of http message callback function
+     * @param[in] http_binary_cb The function name of http binary message callback function
+     *            (ssgx_ecall_http_on_binary_message)
+     * @return Return true if successful; otherwise, return false
+     */
+    bool RegisterCallbacks(sgx_enclave_id_t eid, RegisterEidCallback register_cb, HttpOnMessageCallback http_cb,
+                           HttpOnBinaryMessageCallback http_binary_cb) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        http_callback_map_[eid] = http_cb;
+        http_binary_callback_map_[eid] = http_binary_cb;
+        sgx_status_t status = register_cb(eid, eid);
+        return status == SGX_SUCCESS;
+    }
+
     /**
      * @brief Check if the enclave has registered a callback function
      * @param[in] eid enclave id
@@ -79,6 +106,20 @@ class HttpCallbackManager {
         return nullptr;
     }
 
+    /**
+     * @brief Get the http binary message callback function of the corresponding enclave
+     * @param[in] eid enclave id
+     * @return Return the callback function if it registered; otherwise, return nullptr
+     */
+    HttpOnBinaryMessageCallback GetHttpBinaryCallback(sgx_enclave_id_t eid) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = http_binary_callback_map_.find(eid);
+        if (it != http_binary_callback_map_.end()) {
+            return it->second;
+        }
+        return nullptr;
+    }
+
   public:
     HttpCallbackManager(const HttpCallbackManager&) = delete;
     HttpCallbackManager& operator=(const HttpCallbackManager&) = delete;
@@ -92,13 +133,13 @@ class HttpCallbackManager {
 
     mutable std::mutex mutex_;
     std::unordered_map<sgx_enclave_id_t, HttpOnMessageCallback> http_callback_map_;
+    std::unordered_map<sgx_enclave_id_t, HttpOnBinaryMessageCallback> http_binary_callback_map_;
 };
 
 class SignalFlag {
 public:
-    static void SetStopFlag() {
-        stop_flag_.store(true, std::memory_order_relaxed);
-    }
+    // Also raises the stop flag of the control page, see ssgx::utils_u::ControlPage
+    static void SetStopFlag();
 
     static bool GetStopFlag() {
         return stop_flag_.load(std::memory_order_relaxed);
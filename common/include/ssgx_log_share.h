@@ -16,6 +16,24 @@ enum class LogLevel {
 
 namespace internal {
 
+/**
+ * Type tags of the arguments packed in a structured log record (see SSGX_LOGF). Each argument is its tag byte followed
+ * by its value in host byte order: 8 bytes for the integers and doubles, 1 byte for a char, and a 4 byte length
+ * followed by the bytes for a string.
+ */
+enum class LogArgType : uint8_t {
+    INT = 1,
+    UINT = 2,
+    DOUBLE = 3,
+    CHAR = 4,
+    STRING = 5,
+};
+
+/**
+ * Maximum size of the packed arguments of a log record. Longer strings are truncated.
+ */
+constexpr size_t LOG_RECORD_MAX_ARGS_SIZE = 896;
+
 class LogFinisher;
 
 class LogMessage {
@@ -10,18 +10,55 @@
 #include <string>
 
 #include "ssgx_log_t_logger.h"
+#include "ssgx_log_t_record.h"
 
 // Internal macro
 #define __SSGX__FILENAME__ (strrchr(__FILE__, '/') ? (strrchr(__FILE__, '/') + 1) : __FILE__)
 
+/**
+ * Messages below this level are compiled out of the enclave: 0 (TRACE) keeps all of them, 2 (INFO) strips TRACE and
+ * DEBUG. Defaults to INFO in release builds (NDEBUG) and to TRACE otherwise.
+ */
+#ifndef SSGX_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SSGX_LOG_MIN_LEVEL 2
+#else
+#define SSGX_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// Internal macro
+#define __SSGX_LOG_ENABLED__(LEVEL)                                                                                    \
+    (static_cast<int>(ssgx::log_t::LogLevel::LEVEL) >= SSGX_LOG_MIN_LEVEL &&                                           \
+     ssgx::log_t::internal::IsLevelEnabled(ssgx::log_t::LogLevel::LEVEL))
+
 #undef SSGX_LOG
 #undef SSGX_LOG_IF
+//  Nothing streamed into a disabled message is evaluated: the level is checked first against SSGX_LOG_MIN_LEVEL, then
+//  against the level of the host logger.
 //  @exception RuntimeError Throw exception if logger has not been initialized.
 #define SSGX_LOG(LEVEL)                                                                                                \
-    ssgx::log_t::internal::LogFinisher() =                                                                             \
-        ssgx::log_t::internal::LogMessage(ssgx::log_t::LogLevel::LEVEL, __SSGX__FILENAME__, __LINE__, __FUNCTION__)
+    !__SSGX_LOG_ENABLED__(LEVEL)                                                                                       \
+        ? (void)0                                                                                                      \
+        : ssgx::log_t::internal::LogFinisher() = ssgx::log_t::internal::LogMessage(                                    \
+              ssgx::log_t::LogLevel::LEVEL, __SSGX__FILENAME__, __LINE__, __FUNCTION__)
 #define SSGX_LOG_IF(LEVEL, CONDITION) !(CONDITION) ? (void)0 : SSGX_LOG(LEVEL)
 
+#undef SSGX_LOGF
+//  Structured log: FORMAT is a string literal in which each "{}" is replaced by the next argument. Integers, floating
+//  point numbers, chars and strings are supported. The enclave only sends the id of the call site and the packed
+//  arguments, the host formats the message, or writes the record as is (see SSGXLogger::SetRecordLog() on the host).
+//  Example: SSGX_LOGF(INFO, "Order {} filled at {}", order_id, price);
+//  @exception RuntimeError Throw exception if logger has not been initialized.
+#define SSGX_LOGF(LEVEL, FORMAT, ...)                                                                                  \
+    do {                                                                                                               \
+        if (__SSGX_LOG_ENABLED__(LEVEL)) {                                                                             \
+            static ssgx::log_t::internal::LogSite __ssgx_log_site__(ssgx::log_t::LogLevel::LEVEL, __FILE__, __LINE__,  \
+                                                                    __FUNCTION__, FORMAT);                             \
+            ssgx::log_t::internal::WriteLogRecord(__ssgx_log_site__, ##__VA_ARGS__);                                   \
+        }                                                                                                              \
+    } while (0)
+
 #ifndef SSGX_FUNC_BEGIN
 #define SSGX_FUNC_BEGIN (SSGX_LOG(INFO) << "Function Begin!");
 #endif
@@ -1,6 +1,8 @@
 #ifndef SAFEHERON_SGX_LIBRARY_LOG_T_LOG_MESSAGE_H
 #define SAFEHERON_SGX_LIBRARY_LOG_T_LOG_MESSAGE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <string>
 
@@ -14,6 +16,19 @@ namespace log_t {
 
 #include "ssgx_log_share.h"
 
+namespace internal {
+
+/**
+ * @brief Whether the host logger writes messages of this level, as published by SSGXLogger::Init() and
+ * SSGXLogger::SetLogLevel() on the host. Reads enclave-visible memory only, no OCALL.
+ *
+ * Messages are enabled while the host has not published a level, so that logging before the host logger is
+ * initialized still fails the usual way.
+ */
+bool IsLevelEnabled(LogLevel level);
+
+} // namespace internal
+
 } // namespace log_t
 } // namespace ssgx
 
@@ -50,6 +50,14 @@ class SSGXLogger {
      */
     void SetTraceId(const std::string& trace_id);
 
+    /**
+     * @brief Waits until the host has written all log messages of the enclave.
+     *
+     * Log messages are queued in a ring buffer shared with the host, and written by a host thread. FATAL messages are
+     * flushed right away; call this to flush the others, e.g. before the enclave is destroyed.
+     */
+    void Flush();
+
     // Delete copy constructor and assignment operator
     SSGXLogger(const SSGXLogger&) = delete;
     SSGXLogger& operator=(const SSGXLogger&) = delete;
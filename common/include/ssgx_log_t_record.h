@@ -0,0 +1,127 @@
+#ifndef SAFEHERON_SGX_LIBRARY_LOG_T_RECORD_H
+#define SAFEHERON_SGX_LIBRARY_LOG_T_RECORD_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "ssgx_log_t_log_message.h"
+
+namespace ssgx {
+namespace log_t {
+namespace internal {
+
+/**
+ * @brief Static description of a structured log statement, one per SSGX_LOGF() call site.
+ *
+ * The strings stay in the enclave binary: the site is registered with the host the first time it logs, and its
+ * records only carry the id the host assigned to it, along with the packed arguments.
+ */
+struct LogSite {
+    constexpr LogSite(LogLevel level, const char* file, int line, const char* func, const char* format)
+        : level(level), file(file), line(line), func(func), format(format), id(0) {
+    }
+
+    const LogLevel level;
+    const char* const file;
+    const int line;
+    const char* const func;
+    const char* const format;
+    std::atomic<uint32_t> id; // 0 until the site is registered with the host
+};
+
+/**
+ * @brief Arguments of a log record, packed as described at LogArgType.
+ */
+class LogRecordArgs {
+  public:
+    LogRecordArgs() : size_(0) {
+    }
+
+    void Put(LogArgType type, const void* value, size_t size) {
+        if (size_ + 1 + size > LOG_RECORD_MAX_ARGS_SIZE)
+            return;
+        data_[size_++] = static_cast<uint8_t>(type);
+        memcpy(data_ + size_, value, size);
+        size_ += size;
+    }
+
+    void PutString(const char* value, size_t size) {
+        if (size_ + 1 + sizeof(uint32_t) > LOG_RECORD_MAX_ARGS_SIZE)
+            return;
+        if (size > LOG_RECORD_MAX_ARGS_SIZE - size_ - 1 - sizeof(uint32_t))
+            size = LOG_RECORD_MAX_ARGS_SIZE - size_ - 1 - sizeof(uint32_t);
+        auto length = static_cast<uint32_t>(size);
+        data_[size_++] = static_cast<uint8_t>(LogArgType::STRING);
+        memcpy(data_ + size_, &length, sizeof(length));
+        size_ += sizeof(length);
+        memcpy(data_ + size_, value, size);
+        size_ += size;
+    }
+
+    const uint8_t* Data() const {
+        return data_;
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+  private:
+    uint8_t data_[LOG_RECORD_MAX_ARGS_SIZE];
+    size_t size_;
+};
+
+inline void PackLogArg(LogRecordArgs& args, char value) {
+    args.Put(LogArgType::CHAR, &value, sizeof(value));
+}
+
+inline void PackLogArg(LogRecordArgs& args, const char* value) {
+    args.PutString(value, strlen(value));
+}
+
+inline void PackLogArg(LogRecordArgs& args, const std::string& value) {
+    args.PutString(value.data(), value.size());
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type PackLogArg(LogRecordArgs& args,
+                                                                                                 T value) {
+    auto v = static_cast<int64_t>(value);
+    args.Put(LogArgType::INT, &v, sizeof(v));
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type PackLogArg(LogRecordArgs& args,
+                                                                                                  T value) {
+    auto v = static_cast<uint64_t>(value);
+    args.Put(LogArgType::UINT, &v, sizeof(v));
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type PackLogArg(LogRecordArgs& args, T value) {
+    auto v = static_cast<double>(value);
+    args.Put(LogArgType::DOUBLE, &v, sizeof(v));
+}
+
+/**
+ * @brief Hand a record to the host, registering its site first if needed.
+ * @exception RuntimeError Throw exception if logger has not been initialized.
+ */
+void SubmitLogRecord(LogSite& site, const LogRecordArgs& args);
+
+template <typename... Args>
+void WriteLogRecord(LogSite& site, const Args&... values) {
+    LogRecordArgs args;
+    int unused[] = {0, (PackLogArg(args, values), 0)...};
+    (void)unused;
+    SubmitLogRecord(site, args);
+}
+
+} // namespace internal
+} // namespace log_t
+} // namespace ssgx
+
+#endif // SAFEHERON_SGX_LIBRARY_LOG_T_RECORD_H
@@ -1,6 +1,8 @@
 #ifndef SAFEHERON_SGX_LIBRARY_LOG_U_LOG_MESSAGE_H
 #define SAFEHERON_SGX_LIBRARY_LOG_U_LOG_MESSAGE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <string>
 
@@ -1,6 +1,9 @@
 #ifndef SAFEHERON_SGX_LIBRARY_LOG_U_H
 #define SAFEHERON_SGX_LIBRARY_LOG_U_H
 
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
 #include <string>
 
 #include "ssgx_log_u_log_message.h"
@@ -8,6 +11,27 @@
 namespace ssgx {
 namespace log_u {
 
+/**
+ * @brief What an asynchronous logger does with a message when its queue is full.
+ */
+enum class LogOverflowPolicy {
+    BLOCK = 0,           ///< Wait until the writer thread makes room. No message is lost.
+    DROP = 1,            ///< Discard the message, only counted by SSGXLogger::GetDroppedCount().
+    DROP_AND_REPORT = 2, ///< Discard the message, and log how many were discarded once the queue has room again.
+};
+
+/**
+ * @brief Settings of an asynchronous logger, see SSGXLogger::Init().
+ */
+struct AsyncLogOptions {
+    /// Maximum number of messages waiting to be written.
+    size_t queue_size = 8192;
+    /// What to do with a message when the queue is full.
+    LogOverflowPolicy overflow_policy = LogOverflowPolicy::BLOCK;
+    /// Sync the log file to disk at most this often, in milliseconds. 0 leaves it to the system.
+    uint32_t fsync_interval_ms = 0;
+};
+
 /**
  * @class SSGXLogger
  * @brief Singleton class for managing logging within the SGX library.
@@ -48,6 +72,24 @@ class SSGXLogger {
     void Init(const std::string& logger_name, const std::string& log_file,
               LogLevel log_level = ssgx::log_u::LogLevel::INFO, bool append_console = false);
 
+    /**
+     * @brief Initializes an asynchronous logger.
+     *
+     * Same as the other Init(), except that messages are queued and written by a background thread, so that the
+     * threads logging, OCALL threads of enclaves in particular, never wait for the disk. The writer thread writes the
+     * messages in batches, and syncs the log file to disk every options.fsync_interval_ms milliseconds, as long as
+     * some messages are not synced yet.
+     * Flush() waits until the queue is empty.
+     *
+     * @param logger_name Name of the logger (e.g., "AppLogger").
+     * @param log_file Path to the log file.
+     * @param log_level Logging level to filter log messages.
+     * @param append_console Whether to output log messages to the console.
+     * @param options Queue size, overflow policy and sync interval.
+     */
+    void Init(const std::string& logger_name, const std::string& log_file, LogLevel log_level, bool append_console,
+              const AsyncLogOptions& options);
+
     /**
      * @brief Retrieves the singleton instance of SSGXLogger.
      *
@@ -74,6 +116,17 @@ class SSGXLogger {
      */
     void SetTraceId(const std::string& trace_id);
 
+    /**
+     * @brief Changes the log level of an initialized logger.
+     *
+     * The new level is also published to the enclaves, which stop formatting the messages below it. It may be changed
+     * at any time, e.g. from a signal handler thread, to turn debug logs on without restarting the service. Does
+     * nothing if the logger has not been initialized.
+     *
+     * @param log_level Logging level to filter log messages.
+     */
+    void SetLogLevel(LogLevel log_level);
+
     bool IsInitialized();
 
     /**
@@ -93,6 +146,41 @@ class SSGXLogger {
      */
     int WriteLog(ssgx::log_u::LogLevel log_level, const char* msg);
 
+    /**
+     * @brief Write the messages which enclaves have queued in their log rings and are not written yet.
+     *
+     * Enclave messages are written asynchronously by a background thread. Call this e.g. after destroying an
+     * enclave, to make sure its last messages are in the log before going on.
+     */
+    void Flush();
+
+    /**
+     * @brief Writes the structured log records of enclaves (SSGX_LOGF) as is to a binary file.
+     *
+     * The records are no longer formatted into the log, which saves the formatting and keeps the file several times
+     * smaller; DecodeRecordLog() turns it into text later. The file is truncated. Formatted messages (SSGX_LOG) are not
+     * affected.
+     *
+     * @param record_file Path to the record log, or an empty string to format the records into the log again.
+     * @return 0 on success, -1 if the file can not be opened.
+     */
+    int SetRecordLog(const std::string& record_file);
+
+    /**
+     * @brief Decodes a record log written after SetRecordLog(), one line per record.
+     *
+     * @param record_file Path to the record log.
+     * @param out Stream receiving the decoded records.
+     * @return 0 on success, -1 if the file can not be opened or is not a record log, -2 if it is truncated or
+     * corrupted; the records before the damaged one have been written to out.
+     */
+    static int DecodeRecordLog(const std::string& record_file, std::ostream& out);
+
+    /**
+     * @brief Number of messages an asynchronous logger has discarded because its queue was full.
+     */
+    uint64_t GetDroppedCount();
+
     // Delete copy constructor and assignment operator
     SSGXLogger(const SSGXLogger&) = delete;
     SSGXLogger& operator=(const SSGXLogger&) = delete;
@@ -116,6 +204,12 @@ class SSGXLogger {
      */
     int MapLogLevel(LogLevel log_level) const;
 
+    /**
+     * @brief Common part of both Init(), async_options is null for a synchronous logger.
+     */
+    void InitLogger(const std::string& logger_name, const std::string& log_file, LogLevel log_level,
+                    bool append_console, const AsyncLogOptions* async_options);
+
     std::string logger_name_; ///< Name of the logger.
     bool initialized_;
 };
@@ -11,6 +11,7 @@
 #include "ssgx_utils_t_time.h"
 #include "ssgx_utils_t_uuid.h"
 #include "ssgx_utils_t_enclave_info.h"
+#include "ssgx_utils_t_control_page.h"
 
 namespace ssgx {
 
@@ -124,6 +125,24 @@ std::string FormatStr(const char* fmt, ...);
  */
 void* MallocOutside(size_t size);
 
+/**
+ * @brief Allocates size bytes of zeroed storage outside the enclave, from a pooled untrusted arena when possible.
+ *
+ * Blocks up to 64 KB are carved from an arena that the host maps once, so neither this call nor FreeOutside() leaves
+ * the enclave. Larger requests, or requests made while the arena is full, fall back to MallocOutside().
+ *
+ * @param[in] size    number of bytes to allocate
+ * @return
+ * - On success, returns the pointer to the beginning of newly allocated memory outside the enclave, which must be
+ * deallocated with FreeOutside().
+ * - If size is zero or on failure, returns a null pointer.
+ * @exception std::runtime_error Throw the exception if the allocated memory is not outside the Enclave.
+ *
+ * @note A pooled block can only be released by FreeOutside() inside the enclave, never by the host with free(). Use
+ * MallocOutside(), MemdupOutside() or StrndupOutside() for buffers whose ownership is handed to the host.
+ */
+void* MallocOutsidePooled(size_t size);
+
 /**
  * @brief Allocates memory outside the enclave for an array of num objects of size and initializes all bytes in the
  * allocated storage to zero.
@@ -268,6 +287,30 @@ void* MemcpyToOutside(void* dest_outside_enclave, const void* src, std::size_t c
  */
 void* MemdupOutside(const void* buf_ptr, std::size_t buf_size);
 
+/**
+ * @brief Usage counters of the untrusted arena behind MallocOutsidePooled().
+ */
+struct OutsidePoolStats {
+    size_t arena_size;        ///< Bytes mapped by the host for the arena, 0 if the arena is not mapped.
+    size_t pages_total;       ///< Number of 64 KB pages in the arena.
+    size_t pages_in_use;      ///< Pages already bound to a size class.
+    size_t bytes_in_use;      ///< Bytes held by live pooled blocks (rounded up to their size class).
+    uint64_t pooled_allocs;   ///< Allocations served from the arena, without an OCALL.
+    uint64_t pooled_frees;    ///< Frees returned to the arena, without an OCALL.
+    uint64_t fallback_allocs; ///< MallocOutsidePooled() calls that went through ssgx_ocall_malloc.
+};
+
+/**
+ * @brief Get a snapshot of the untrusted arena counters.
+ *
+ * Small allocations made by MallocOutsidePooled() are carved from an arena that the host maps once, so they neither
+ * leave the enclave on allocation nor on FreeOutside(). Requests above 64 KB, or made while the arena is full, fall
+ * back to an OCALL.
+ *
+ * @return counters at the time of the call.
+ */
+OutsidePoolStats GetOutsidePoolStats();
+
 /**
  * @brief Sleep for a specified number of seconds using OCall.
  * @param seconds The number of seconds to sleep.
@@ -0,0 +1,56 @@
+#ifndef SSGXLIB_SSGX_UTILS_CONTROLPAGE_H_
+#define SSGXLIB_SSGX_UTILS_CONTROLPAGE_H_
+
+#include <cstdint>
+
+namespace ssgx {
+namespace utils_t {
+
+/**
+ * @brief Signals published by the host in a shared page of untrusted memory, read without leaving the enclave.
+ *
+ * The page is mapped with one OCALL on first use; every later read is an atomic load, so these functions are cheap
+ * enough for tight polling loops. The values come from the host and are no more trustworthy than the result of an
+ * OCALL: they are only validated (range checks, monotonic clock).
+ *
+ * If the host does not provide the page, each function falls back to a safe default, given below.
+ */
+class ControlPage {
+  public:
+    ControlPage() = delete;
+
+    /**
+     * @brief Check whether the page is mapped.
+     * @return false if the host refused to map it, in which case the fallbacks are used.
+     */
+    static bool IsAvailable();
+
+    /**
+     * @brief Check whether the host asked the enclave servers to stop.
+     * @return The stop flag, or false if the page is not available.
+     */
+    static bool StopRequested();
+
+    /**
+     * @brief Get the minimum level written by the host logger.
+     * @return A LogLevel value, or -1 if the host logger is not initialized or the page is not available.
+     */
+    static int32_t LogLevel();
+
+    /**
+     * @brief Get a clock refreshed by the host every few milliseconds (10 by default).
+     *
+     * The clock never goes backwards: an earlier value written by the host is ignored.
+     *
+     * @exception runtime_error Throw the exception if the page is not available and PreciseTime::NowInMilliseconds()
+     * fails.
+     *
+     * @return Milliseconds since the UNIX epoch, or PreciseTime::NowInMilliseconds() if the page is not available.
+     */
+    static int64_t CoarseNowInMilliseconds();
+};
+
+} // namespace utils_t
+} // namespace ssgx
+
+#endif // SSGXLIB_SSGX_UTILS_CONTROLPAGE_H_
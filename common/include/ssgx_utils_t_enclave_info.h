@@ -1,7 +1,7 @@
 #ifndef SSGXLIB_SSGX_UTILS_ENCLAVEINFO_H_
 #define SSGXLIB_SSGX_UTILS_ENCLAVEINFO_H_
 
-#include <mutex>
+#include <atomic>
 
 #include "sgx_eid.h"
 
@@ -38,8 +38,8 @@ class EnclaveInfo {
     EnclaveInfo(const EnclaveInfo&) = delete;
     EnclaveInfo& operator=(const EnclaveInfo&) = delete;
 
-    sgx_enclave_id_t enclave_eid_ = 0;
-    std::mutex mutex_;
+    // Written once by ssgx_ecall_register_enclave_eid(), read without a lock
+    std::atomic<sgx_enclave_id_t> enclave_eid_{0};
 };
 
 } // namespace utils_t
@@ -0,0 +1,61 @@
+#ifndef SAFEHERON_SGX_UNTRUSTED_UTILS_H
+#define SAFEHERON_SGX_UNTRUSTED_UTILS_H
+
+#include <cstdint>
+
+namespace ssgx {
+/**
+ * @namespace ssgx::utils_u
+ * @brief Host side of the utilities of ssgx::utils_t.
+ */
+namespace utils_u {
+
+/**
+ * @brief Host side of the control page, a page of untrusted memory which enclaves read without an OCALL.
+ *
+ * The page is created by the first enclave which asks for it, and lives as long as the process. At that point a host
+ * thread starts refreshing the coarse clock of the page every SSGX_CONTROL_PAGE_TICK_MS milliseconds, until Shutdown()
+ * is called or the process exits.
+ *
+ * The setters below may be called at any time, also before any enclave has mapped the page: the values are then
+ * visible from the first read of the enclave.
+ */
+class ControlPage {
+  public:
+    ControlPage() = delete;
+
+    /**
+     * @brief Set the stop flag read by ssgx::utils_t::ControlPage::StopRequested().
+     */
+    static void SetStopFlag(bool stop);
+
+    /**
+     * @brief Publish the minimum level of the host logger.
+     * @param level A ssgx::log_u::LogLevel value, or -1 if the logger is not initialized.
+     */
+    static void SetLogLevel(int32_t level);
+
+    /**
+     * @brief Refresh the coarse clock right away, without waiting for the next tick.
+     */
+    static void UpdateCoarseClock();
+
+    /**
+     * @brief Get the page, creating it if needed, and start the coarse clock thread if it is not running.
+     * @return The page, or nullptr if it can not be mapped.
+     */
+    static uint8_t* Map();
+
+    /**
+     * @brief Stop the coarse clock thread and wait for it to exit.
+     *
+     * Call it once the enclaves are destroyed, e.g. before the process returns from main(). The page stays mapped
+     * with its last values, an enclave created later starts the thread again.
+     */
+    static void Shutdown();
+};
+
+} // namespace utils_u
+} // namespace ssgx
+
+#endif // SAFEHERON_SGX_UNTRUSTED_UTILS_H
@@ -45,7 +45,7 @@ int SGX_CDECL main(int argc, char* argv[]) {
     }
     printf("Enclave (eid = %ld) is created!\n\n", test_enclave_id);
 
-    ok = ssgx::http_u::HttpCallbackManager::GetInstance().RegisterCallbacks(test_enclave_id, ssgx_ecall_register_enclave_eid, ssgx_ecall_http_on_message);
+    ok = ssgx::http_u::HttpCallbackManager::GetInstance().RegisterCallbacks(test_enclave_id, ssgx_ecall_register_enclave_eid, ssgx_ecall_http_on_message, ssgx_ecall_http_on_binary_message);
     if(!ok){
         printf("\nFailed to register callback function for HTTP module.\n");
         goto _exit;
@@ -0,0 +1,301 @@
+#include "ssgx_config_t_reloadable.h"
+
+#include <cstring>
+#include <set>
+#include <utility>
+
+#include "ssgx_utils_t.h"
+
+#include "TomlDocument.h"
+
+static_assert(SSGX_CONFIG_SNAPSHOT_SLOTS >= 2 && SSGX_CONFIG_SNAPSHOT_SLOTS <= 256,
+              "SSGX_CONFIG_SNAPSHOT_SLOTS must be from 2 to 256");
+
+namespace ssgx {
+namespace config_t {
+namespace internal {
+
+/**
+ * @brief A version of a ReloadableTomlConfig.
+ *
+ * A reader registers in readers, then checks that version is still the one it read from current_: a reload which
+ * retires the slot clears version before it checks readers, so that either the reader sees the slot retired and
+ * retries, or the reload sees the reader and keeps the document. Both sides use sequentially consistent operations.
+ */
+struct TomlSnapshotSlot {
+    std::atomic<uint32_t> readers{0}; // snapshots held, and readers about to take one
+    std::atomic<uint64_t> version{0}; // 0 once the slot is retired, or before it is used
+    // written by the loads only, while no reader can take the slot
+    std::unique_ptr<const TomlDocument> document;
+    std::vector<uint8_t> digest;
+    uint64_t document_version = 0; // the version of the document, which stays once the slot is retired
+};
+
+// The configurations which the host can reload, by ssgx_ecall_config_reload()
+static std::mutex g_reloadable_mutex;
+static std::set<ReloadableTomlConfig*> g_reloadable_configs;
+
+} // namespace internal
+
+using internal::TomlDocument;
+using internal::TomlNode;
+using internal::TomlSnapshotSlot;
+
+#define SNAPSHOT_SLOT_BITS 8
+#define SNAPSHOT_SLOT_MASK ((1ULL << SNAPSHOT_SLOT_BITS) - 1)
+
+TomlSnapshot::~TomlSnapshot() {
+    Release();
+}
+
+TomlSnapshot::TomlSnapshot(TomlSnapshot&& other) noexcept : slot_(other.slot_), err_msg_(std::move(other.err_msg_)) {
+    other.slot_ = nullptr;
+}
+
+TomlSnapshot& TomlSnapshot::operator=(TomlSnapshot&& other) noexcept {
+    if (this != &other) {
+        Release();
+        slot_ = other.slot_;
+        err_msg_ = std::move(other.err_msg_);
+        other.slot_ = nullptr;
+    }
+    return *this;
+}
+
+void TomlSnapshot::Release() {
+    if (slot_) {
+        slot_->readers.fetch_sub(1);
+        slot_ = nullptr;
+    }
+}
+
+uint64_t TomlSnapshot::GetVersion() const {
+    return slot_ ? slot_->document_version : 0;
+}
+
+std::vector<uint8_t> TomlSnapshot::GetFileDigest() const {
+    return slot_ ? slot_->digest : std::vector<uint8_t>();
+}
+
+std::optional<int64_t> TomlSnapshot::GetInteger(const std::vector<TomlKey>& path) {
+    if (!slot_) {
+        err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
+        return std::nullopt;
+    }
+    const TomlNode* node = slot_->document->FindValue(path, TomlNode::Type::Integer, err_msg_);
+    if (!node) {
+        return std::nullopt;
+    }
+    return node->integer;
+}
+
+std::optional<std::string> TomlSnapshot::GetString(const std::vector<TomlKey>& path) {
+    if (!slot_) {
+        err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
+        return std::nullopt;
+    }
+    const TomlNode* node = slot_->document->FindValue(path, TomlNode::Type::String, err_msg_);
+    if (!node) {
+        return std::nullopt;
+    }
+    return node->string;
+}
+
+std::optional<std::vector<int64_t>> TomlSnapshot::GetIntegerArray(const std::vector<TomlKey>& path) {
+    if (!slot_) {
+        err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
+        return std::nullopt;
+    }
+    const TomlNode* node = slot_->document->FindArray(path, TomlNode::Type::Integer, err_msg_);
+    if (!node) {
+        return std::nullopt;
+    }
+    std::vector<int64_t> values;
+    values.reserve(node->items.size());
+    for (const TomlNode* item : node->items) {
+        values.push_back(item->integer);
+    }
+    return values;
+}
+
+std::optional<std::vector<std::string>> TomlSnapshot::GetStringArray(const std::vector<TomlKey>& path) {
+    if (!slot_) {
+        err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
+        return std::nullopt;
+    }
+    const TomlNode* node = slot_->document->FindArray(path, TomlNode::Type::String, err_msg_);
+    if (!node) {
+        return std::nullopt;
+    }
+    std::vector<std::string> values;
+    values.reserve(node->items.size());
+    for (const TomlNode* item : node->items) {
+        values.push_back(item->string);
+    }
+    return values;
+}
+
+ReloadableTomlConfig::ReloadableTomlConfig() : slots_(new TomlSnapshotSlot[SSGX_CONFIG_SNAPSHOT_SLOTS]) {
+}
+
+ReloadableTomlConfig::~ReloadableTomlConfig() {
+    std::lock_guard<std::mutex> lock(internal::g_reloadable_mutex);
+    internal::g_reloadable_configs.erase(this);
+}
+
+bool ReloadableTomlConfig::LoadFile(const char* toml_file_path) {
+    if (!toml_file_path || strnlen(toml_file_path, 1) == 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        err_msg_ = ssgx::utils_t::FormatStr("The input toml file path is empty");
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string content;
+        if (!internal::ReadTomlFile(toml_file_path, content, err_msg_) || !Publish(content)) {
+            return false;
+        }
+        toml_file_path_ = toml_file_path;
+    }
+    std::lock_guard<std::mutex> lock(internal::g_reloadable_mutex);
+    internal::g_reloadable_configs.insert(this);
+    return true;
+}
+
+bool ReloadableTomlConfig::Reload() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (toml_file_path_.empty()) {
+        err_msg_ = ssgx::utils_t::FormatStr("The configuration has not been loaded from a file");
+        return false;
+    }
+    std::string content;
+    if (!internal::ReadTomlFile(toml_file_path_.c_str(), content, err_msg_)) {
+        return false;
+    }
+    return Publish(content);
+}
+
+bool ReloadableTomlConfig::LoadString(const std::string& toml_content) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Publish(toml_content);
+}
+
+bool ReloadableTomlConfig::Publish(const std::string& toml_content) {
+    std::string error;
+    std::unique_ptr<TomlDocument> document = TomlDocument::Parse(toml_content, error);
+    if (!document) {
+        err_msg_ = ssgx::utils_t::FormatStr("Failed to parse the toml content: %s", error.c_str());
+        return false;
+    }
+    std::vector<uint8_t> digest;
+    if (!internal::DigestTomlContent(toml_content, digest, err_msg_)) {
+        return false;
+    }
+
+    Reclaim();
+
+    // A free slot is neither current nor holding a document still in use
+    uint64_t current = current_.load();
+    TomlSnapshotSlot* free_slot = nullptr;
+    uint64_t free_index = 0;
+    for (uint64_t i = 0; i < SSGX_CONFIG_SNAPSHOT_SLOTS; ++i) {
+        if (!slots_[i].document && (current == 0 || (current & SNAPSHOT_SLOT_MASK) != i)) {
+            free_slot = &slots_[i];
+            free_index = i;
+            break;
+        }
+    }
+    if (!free_slot) {
+        err_msg_ = ssgx::utils_t::FormatStr("All %d versions of the configuration are still in use",
+                                            SSGX_CONFIG_SNAPSHOT_SLOTS);
+        return false;
+    }
+
+    free_slot->document = std::move(document);
+    free_slot->digest = std::move(digest);
+    free_slot->document_version = ++version_;
+    free_slot->version.store(version_);
+    current_.store((version_ << SNAPSHOT_SLOT_BITS) | free_index);
+
+    // Retire the previous version, new readers take the new one
+    if (current != 0) {
+        slots_[current & SNAPSHOT_SLOT_MASK].version.store(0);
+    }
+    Reclaim();
+    return true;
+}
+
+void ReloadableTomlConfig::Reclaim() {
+    uint64_t current = current_.load();
+    for (uint64_t i = 0; i < SSGX_CONFIG_SNAPSHOT_SLOTS; ++i) {
+        TomlSnapshotSlot& slot = slots_[i];
+        if (current != 0 && (current & SNAPSHOT_SLOT_MASK) == i) {
+            continue;
+        }
+        if (slot.document && slot.version.load() == 0 && slot.readers.load() == 0) {
+            slot.document.reset();
+            slot.digest.clear();
+        }
+    }
+}
+
+TomlSnapshot ReloadableTomlConfig::GetSnapshot() const {
+    for (;;) {
+        uint64_t current = current_.load();
+        if (current == 0) {
+            return TomlSnapshot();
+        }
+        TomlSnapshotSlot& slot = slots_[current & SNAPSHOT_SLOT_MASK];
+        slot.readers.fetch_add(1);
+        if (slot.version.load() == (current >> SNAPSHOT_SLOT_BITS)) {
+            return TomlSnapshot(&slot);
+        }
+        // A reload retired this version meanwhile, take the new one
+        slot.readers.fetch_sub(1);
+    }
+}
+
+uint64_t ReloadableTomlConfig::GetVersion() const {
+    return current_.load(std::memory_order_acquire) >> SNAPSHOT_SLOT_BITS;
+}
+
+std::string ReloadableTomlConfig::GetFilePath() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return toml_file_path_;
+}
+
+std::string ReloadableTomlConfig::GetLastErrorMsg() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return err_msg_;
+}
+
+} // namespace config_t
+} // namespace ssgx
+
+/**
+ * Reload the configurations loaded from a file, see ReloadableTomlConfig.
+ *
+ * @return The number of configurations reloaded, or -1 if one of them failed to reload.
+ */
+extern "C" int ssgx_ecall_config_reload(const char* toml_file_path) {
+    using ssgx::config_t::internal::g_reloadable_configs;
+    using ssgx::config_t::internal::g_reloadable_mutex;
+
+    if (!toml_file_path) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(g_reloadable_mutex);
+    int reloaded = 0;
+    bool failed = false;
+    for (ssgx::config_t::ReloadableTomlConfig* config : g_reloadable_configs) {
+        if (config->GetFilePath() != toml_file_path) {
+            continue;
+        }
+        if (config->Reload()) {
+            ++reloaded;
+        } else {
+            failed = true;
+        }
+    }
+    return failed ? -1 : reloaded;
+}
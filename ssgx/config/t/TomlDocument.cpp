@@ -0,0 +1,746 @@
+#include "TomlDocument.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+// Values nested deeper and keys made of more parts than this are rejected, the enclave stack is small
+#define TOML_MAX_DEPTH 64
+
+namespace ssgx {
+namespace config_t {
+namespace internal {
+
+static void AppendPathKey(std::string& path_key, const std::string& key) {
+    auto size = static_cast<uint32_t>(key.size());
+    path_key.push_back('s');
+    path_key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    path_key.append(key);
+}
+
+static void AppendPathKey(std::string& path_key, size_t index) {
+    auto value = static_cast<uint64_t>(index);
+    path_key.push_back('i');
+    path_key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// The path as a JSON array, for error messages
+static std::string PathToString(const std::vector<TomlKey>& path) {
+    std::string str = "[";
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        if (it != path.rbegin())
+            str.append(", ");
+        if (it->type_ == TomlKey::KeyType::Integer) {
+            str.append(std::to_string(it->index_key_));
+        } else {
+            str.append("\"").append(it->str_key_).append("\"");
+        }
+    }
+    str.append("]");
+    return str;
+}
+
+static const char* TypeName(TomlNode::Type type) {
+    switch (type) {
+    case TomlNode::Type::Integer:
+        return "an integer";
+    case TomlNode::Type::String:
+        return "a string";
+    case TomlNode::Type::Array:
+        return "an array";
+    case TomlNode::Type::Table:
+        return "a table";
+    default:
+        return "a value of an unsupported type";
+    }
+}
+
+/**
+ * @brief Recursive descent parser of TOML v1.0.0 documents.
+ */
+class TomlParser {
+  public:
+    TomlParser(const std::string& content, TomlDocument& doc, std::string& error)
+        : s_(content), pos_(0), doc_(doc), error_(error) {
+    }
+
+    bool ParseDocument();
+
+  private:
+    TomlNode* NewNode(TomlNode::Type type) {
+        doc_.nodes_.emplace_back();
+        doc_.nodes_.back().type = type;
+        return &doc_.nodes_.back();
+    }
+
+    bool Fail(const char* reason) {
+        auto end = s_.begin() + static_cast<std::ptrdiff_t>(std::min(pos_, s_.size()));
+        error_ = "line " + std::to_string(1 + std::count(s_.begin(), end, '\n')) + ": " + reason;
+        return false;
+    }
+
+    bool Eof() const {
+        return pos_ >= s_.size();
+    }
+
+    char Peek(size_t offset = 0) const {
+        return pos_ + offset < s_.size() ? s_[pos_ + offset] : '\0';
+    }
+
+    bool IsNewline() const {
+        return Peek() == '\n' || (Peek() == '\r' && Peek(1) == '\n');
+    }
+
+    void SkipNewline() {
+        pos_ += Peek() == '\r' ? 2 : 1;
+    }
+
+    void SkipWhitespace() {
+        while (Peek() == ' ' || Peek() == '\t')
+            ++pos_;
+    }
+
+    void SkipComment() {
+        if (Peek() == '#') {
+            while (!Eof() && !IsNewline())
+                ++pos_;
+        }
+    }
+
+    // Whitespace, newlines and comments, as allowed inside arrays
+    void SkipBlank() {
+        for (;;) {
+            SkipWhitespace();
+            SkipComment();
+            if (!IsNewline())
+                return;
+            SkipNewline();
+        }
+    }
+
+    bool ExpectLineEnd() {
+        SkipWhitespace();
+        SkipComment();
+        if (Eof())
+            return true;
+        if (!IsNewline())
+            return Fail("Expected the end of the line");
+        SkipNewline();
+        return true;
+    }
+
+    bool ParseKey(std::vector<std::string>& keys);
+    bool ParseSimpleKey(std::string& key);
+    bool ParseValue(TomlNode*& value, int depth);
+    bool ParseBasicString(std::string& out, bool multiline);
+    bool ParseLiteralString(std::string& out, bool multiline);
+    bool ParseEscape(std::string& out);
+    bool ParseArray(TomlNode*& value, int depth);
+    bool ParseInlineTable(TomlNode*& value, int depth);
+    bool ParseScalar(TomlNode*& value);
+
+    bool OpenTable(const std::vector<std::string>& keys, TomlNode*& table);
+    bool OpenTableArray(const std::vector<std::string>& keys, TomlNode*& table);
+    bool Descend(TomlNode*& node, const std::string& key, bool dotted_key);
+    bool Assign(TomlNode* table, const std::vector<std::string>& keys, TomlNode* value);
+
+    const std::string& s_;
+    size_t pos_;
+    TomlDocument& doc_;
+    std::string& error_;
+};
+
+bool TomlParser::ParseDocument() {
+    TomlNode* root = NewNode(TomlNode::Type::Table);
+    TomlNode* current = root;
+    std::vector<std::string> keys;
+
+    // A UTF-8 byte order mark is allowed at the start of the file
+    if (s_.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        pos_ = 3;
+
+    while (!Eof()) {
+        SkipWhitespace();
+        SkipComment();
+        if (Eof())
+            break;
+        if (IsNewline()) {
+            SkipNewline();
+            continue;
+        }
+
+        keys.clear();
+        if (Peek() == '[' && Peek(1) == '[') {
+            pos_ += 2;
+            if (!ParseKey(keys))
+                return false;
+            if (Peek() != ']' || Peek(1) != ']')
+                return Fail("Expected ']]' at the end of the array of tables header");
+            pos_ += 2;
+            if (!OpenTableArray(keys, current))
+                return false;
+        } else if (Peek() == '[') {
+            ++pos_;
+            if (!ParseKey(keys))
+                return false;
+            if (Peek() != ']')
+                return Fail("Expected ']' at the end of the table header");
+            ++pos_;
+            if (!OpenTable(keys, current))
+                return false;
+        } else {
+            TomlNode* value = nullptr;
+            if (!ParseKey(keys))
+                return false;
+            if (Peek() != '=')
+                return Fail("Expected '=' after the key");
+            ++pos_;
+            SkipWhitespace();
+            if (!ParseValue(value, 0) || !Assign(current, keys, value))
+                return false;
+        }
+        if (!ExpectLineEnd())
+            return false;
+    }
+    return true;
+}
+
+bool TomlParser::ParseKey(std::vector<std::string>& keys) {
+    for (;;) {
+        std::string key;
+        SkipWhitespace();
+        if (!ParseSimpleKey(key))
+            return false;
+        keys.push_back(std::move(key));
+        if (keys.size() > TOML_MAX_DEPTH)
+            return Fail("The key has too many parts");
+        SkipWhitespace();
+        if (Peek() != '.')
+            return true;
+        ++pos_;
+    }
+}
+
+bool TomlParser::ParseSimpleKey(std::string& key) {
+    if (Peek() == '"')
+        return ParseBasicString(key, false);
+    if (Peek() == '\'')
+        return ParseLiteralString(key, false);
+
+    size_t start = pos_;
+    while (!Eof() && (isalnum(static_cast<unsigned char>(Peek())) || Peek() == '_' || Peek() == '-'))
+        ++pos_;
+    if (pos_ == start)
+        return Fail("Expected a key");
+    key.assign(s_, start, pos_ - start);
+    return true;
+}
+
+bool TomlParser::ParseValue(TomlNode*& value, int depth) {
+    if (depth > TOML_MAX_DEPTH)
+        return Fail("Values are nested too deeply");
+
+    char c = Peek();
+    if (c == '"' || c == '\'') {
+        bool multiline = Peek(1) == c && Peek(2) == c;
+        value = NewNode(TomlNode::Type::String);
+        return c == '"' ? ParseBasicString(value->string, multiline) : ParseLiteralString(value->string, multiline);
+    }
+    if (c == '[')
+        return ParseArray(value, depth);
+    if (c == '{')
+        return ParseInlineTable(value, depth);
+    return ParseScalar(value);
+}
+
+bool TomlParser::ParseEscape(std::string& out) {
+    char c = Peek();
+    ++pos_;
+    switch (c) {
+    case 'b':
+        out.push_back('\b');
+        return true;
+    case 't':
+        out.push_back('\t');
+        return true;
+    case 'n':
+        out.push_back('\n');
+        return true;
+    case 'f':
+        out.push_back('\f');
+        return true;
+    case 'r':
+        out.push_back('\r');
+        return true;
+    case '"':
+        out.push_back('"');
+        return true;
+    case '\\':
+        out.push_back('\\');
+        return true;
+    case 'u':
+    case 'U': {
+        size_t digits = c == 'u' ? 4 : 8;
+        uint32_t code = 0;
+        for (size_t i = 0; i < digits; ++i) {
+            char h = Peek();
+            if (!isxdigit(static_cast<unsigned char>(h)))
+                return Fail("Invalid unicode escape");
+            code = code * 16 + static_cast<uint32_t>(isdigit(static_cast<unsigned char>(h)) ? h - '0'
+                                                                                              : (h | 0x20) - 'a' + 10);
+            ++pos_;
+        }
+        if (code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF))
+            return Fail("Invalid unicode scalar value");
+        // UTF-8 encoding
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        return true;
+    }
+    default:
+        return Fail("Invalid escape sequence");
+    }
+}
+
+bool TomlParser::ParseBasicString(std::string& out, bool multiline) {
+    pos_ += multiline ? 3 : 1;
+    // A newline right after the opening delimiter is trimmed
+    if (multiline && IsNewline())
+        SkipNewline();
+
+    for (;;) {
+        if (Eof())
+            return Fail("Unterminated string");
+        char c = Peek();
+        if (c == '"') {
+            if (!multiline) {
+                ++pos_;
+                return true;
+            }
+            if (Peek(1) == '"' && Peek(2) == '"') {
+                // Up to two quotes right before the closing delimiter belong to the string
+                size_t quotes = 3;
+                while (quotes < 5 && Peek(quotes) == '"')
+                    ++quotes;
+                out.append(quotes - 3, '"');
+                pos_ += quotes;
+                return true;
+            }
+            out.push_back(c);
+            ++pos_;
+        } else if (c == '\\') {
+            ++pos_;
+            if (multiline) {
+                // A line ending backslash trims the whitespace and newlines which follow it
+                size_t p = pos_;
+                while (p < s_.size() && (s_[p] == ' ' || s_[p] == '\t'))
+                    ++p;
+                if (p < s_.size() && (s_[p] == '\n' || (s_[p] == '\r' && p + 1 < s_.size() && s_[p + 1] == '\n'))) {
+                    pos_ = p;
+                    while (Peek() == ' ' || Peek() == '\t' || IsNewline()) {
+                        if (IsNewline())
+                            SkipNewline();
+                        else
+                            ++pos_;
+                    }
+                    continue;
+                }
+            }
+            if (!ParseEscape(out))
+                return false;
+        } else if (IsNewline()) {
+            if (!multiline)
+                return Fail("Unterminated string");
+            out.push_back('\n');
+            SkipNewline();
+        } else if ((static_cast<unsigned char>(c) < 0x20 && c != '\t') || c == 0x7F) {
+            return Fail("Control characters must be escaped");
+        } else {
+            out.push_back(c);
+            ++pos_;
+        }
+    }
+}
+
+bool TomlParser::ParseLiteralString(std::string& out, bool multiline) {
+    pos_ += multiline ? 3 : 1;
+    if (multiline && IsNewline())
+        SkipNewline();
+
+    for (;;) {
+        if (Eof())
+            return Fail("Unterminated string");
+        char c = Peek();
+        if (c == '\'') {
+            if (!multiline) {
+                ++pos_;
+                return true;
+            }
+            if (Peek(1) == '\'' && Peek(2) == '\'') {
+                size_t quotes = 3;
+                while (quotes < 5 && Peek(quotes) == '\'')
+                    ++quotes;
+                out.append(quotes - 3, '\'');
+                pos_ += quotes;
+                return true;
+            }
+            out.push_back(c);
+            ++pos_;
+        } else if (IsNewline()) {
+            if (!multiline)
+                return Fail("Unterminated string");
+            out.push_back('\n');
+            SkipNewline();
+        } else if ((static_cast<unsigned char>(c) < 0x20 && c != '\t') || c == 0x7F) {
+            return Fail("Control characters are not allowed in literal strings");
+        } else {
+            out.push_back(c);
+            ++pos_;
+        }
+    }
+}
+
+bool TomlParser::ParseArray(TomlNode*& value, int depth) {
+    ++pos_;
+    value = NewNode(TomlNode::Type::Array);
+    value->is_frozen = true;
+    for (;;) {
+        SkipBlank();
+        if (Peek() == ']') {
+            ++pos_;
+            return true;
+        }
+        TomlNode* item = nullptr;
+        if (!ParseValue(item, depth + 1))
+            return false;
+        value->items.push_back(item);
+        SkipBlank();
+        if (Peek() == ',') {
+            ++pos_;
+        } else if (Peek() != ']') {
+            return Fail("Expected ',' or ']' in the array");
+        }
+    }
+}
+
+static void Freeze(TomlNode* node) {
+    node->is_frozen = true;
+    for (auto& member : node->members)
+        Freeze(member.second);
+}
+
+bool TomlParser::ParseInlineTable(TomlNode*& value, int depth) {
+    ++pos_;
+    value = NewNode(TomlNode::Type::Table);
+    value->is_defined = true;
+    SkipWhitespace();
+    if (Peek() == '}') {
+        ++pos_;
+        Freeze(value);
+        return true;
+    }
+    for (;;) {
+        std::vector<std::string> keys;
+        TomlNode* member = nullptr;
+        if (!ParseKey(keys))
+            return false;
+        if (Peek() != '=')
+            return Fail("Expected '=' after the key");
+        ++pos_;
+        SkipWhitespace();
+        if (!ParseValue(member, depth + 1) || !Assign(value, keys, member))
+            return false;
+        SkipWhitespace();
+        if (Peek() == ',') {
+            ++pos_;
+        } else if (Peek() == '}') {
+            ++pos_;
+            Freeze(value);
+            return true;
+        } else {
+            return Fail("Expected ',' or '}' in the inline table");
+        }
+    }
+}
+
+// Parse an integer as TOML defines them; false if the token is not an integer
+static bool ParseInteger(const std::string& token, int64_t& value, bool& overflow) {
+    overflow = false;
+    size_t i = 0;
+    bool negative = false;
+    uint64_t base = 10;
+    if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'o' || token[1] == 'b')) {
+        base = token[1] == 'x' ? 16 : (token[1] == 'o' ? 8 : 2);
+        i = 2;
+    } else {
+        if (token[0] == '+' || token[0] == '-') {
+            negative = token[0] == '-';
+            i = 1;
+        }
+        // No leading zero in decimal integers
+        if (token.size() > i + 1 && token[i] == '0')
+            return false;
+    }
+    if (i >= token.size())
+        return false;
+
+    uint64_t limit = negative ? static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1
+                              : static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    uint64_t magnitude = 0;
+    bool previous_digit = false;
+    for (; i < token.size(); ++i) {
+        char c = token[i];
+        if (c == '_') {
+            // Underscores are only allowed between digits
+            if (!previous_digit || i + 1 >= token.size())
+                return false;
+            previous_digit = false;
+            continue;
+        }
+        uint64_t digit;
+        if (c >= '0' && c <= '9')
+            digit = static_cast<uint64_t>(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            digit = static_cast<uint64_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            digit = static_cast<uint64_t>(c - 'A' + 10);
+        else
+            return false;
+        if (digit >= base)
+            return false;
+        if (magnitude > (limit - digit) / base)
+            overflow = true;
+        else
+            magnitude = magnitude * base + digit;
+        previous_digit = true;
+    }
+    if (!previous_digit)
+        return false;
+    value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+bool TomlParser::ParseScalar(TomlNode*& value) {
+    size_t start = pos_;
+    while (!Eof() && !strchr(" \t\r\n,]}#", Peek()))
+        ++pos_;
+    // A date and a time may be separated by a space
+    if (pos_ - start == 10 && s_[start + 4] == '-' && Peek() == ' ' && isdigit(static_cast<unsigned char>(Peek(1)))) {
+        ++pos_;
+        while (!Eof() && !strchr(" \t\r\n,]}#", Peek()))
+            ++pos_;
+    }
+    std::string token(s_, start, pos_ - start);
+    if (token.empty())
+        return Fail("Expected a value");
+
+    int64_t integer = 0;
+    bool overflow = false;
+    if (ParseInteger(token, integer, overflow)) {
+        if (overflow)
+            return Fail("The integer does not fit in 64 bits");
+        value = NewNode(TomlNode::Type::Integer);
+        value->integer = integer;
+        return true;
+    }
+
+    // Booleans, floating-point numbers and dates are kept as values of another type
+    bool other = token == "true" || token == "false";
+    if (!other) {
+        size_t i = token[0] == '+' || token[0] == '-' ? 1 : 0;
+        other = token.compare(i, std::string::npos, "inf") == 0 || token.compare(i, std::string::npos, "nan") == 0 ||
+                (i < token.size() && isdigit(static_cast<unsigned char>(token[i])) &&
+                 token.find_first_not_of("0123456789_.eE+-:TZtz ", i) == std::string::npos);
+    }
+    if (!other)
+        return Fail("Invalid value");
+    value = NewNode(TomlNode::Type::Other);
+    return true;
+}
+
+bool TomlParser::Descend(TomlNode*& node, const std::string& key, bool dotted_key) {
+    auto it = node->members.find(key);
+    if (it == node->members.end()) {
+        TomlNode* child = NewNode(TomlNode::Type::Table);
+        child->is_defined = dotted_key;
+        node->members.emplace(key, child);
+        node = child;
+        return true;
+    }
+    TomlNode* child = it->second;
+    if (child->type == TomlNode::Type::Table) {
+        if (child->is_frozen)
+            return Fail("Inline tables can not be extended");
+        node = child;
+        return true;
+    }
+    if (!dotted_key && child->type == TomlNode::Type::Array && child->is_table_array) {
+        node = child->items.back();
+        return true;
+    }
+    return Fail("The key is already defined as a value");
+}
+
+bool TomlParser::OpenTable(const std::vector<std::string>& keys, TomlNode*& table) {
+    TomlNode* node = &doc_.nodes_.front();
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        if (!Descend(node, keys[i], false))
+            return false;
+    }
+    auto it = node->members.find(keys.back());
+    if (it != node->members.end()) {
+        TomlNode* existing = it->second;
+        if (existing->type != TomlNode::Type::Table || existing->is_frozen || existing->is_defined)
+            return Fail("The table is already defined");
+        existing->is_defined = true;
+        table = existing;
+        return true;
+    }
+    table = NewNode(TomlNode::Type::Table);
+    table->is_defined = true;
+    node->members.emplace(keys.back(), table);
+    return true;
+}
+
+bool TomlParser::OpenTableArray(const std::vector<std::string>& keys, TomlNode*& table) {
+    TomlNode* node = &doc_.nodes_.front();
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        if (!Descend(node, keys[i], false))
+            return false;
+    }
+    TomlNode* array = nullptr;
+    auto it = node->members.find(keys.back());
+    if (it == node->members.end()) {
+        array = NewNode(TomlNode::Type::Array);
+        array->is_table_array = true;
+        node->members.emplace(keys.back(), array);
+    } else {
+        array = it->second;
+        if (array->type != TomlNode::Type::Array || !array->is_table_array)
+            return Fail("The key is already defined as a value");
+    }
+    table = NewNode(TomlNode::Type::Table);
+    table->is_defined = true;
+    array->items.push_back(table);
+    return true;
+}
+
+bool TomlParser::Assign(TomlNode* table, const std::vector<std::string>& keys, TomlNode* value) {
+    TomlNode* node = table;
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        if (!Descend(node, keys[i], true))
+            return false;
+    }
+    if (!node->members.emplace(keys.back(), value).second)
+        return Fail("The key is already defined");
+    return true;
+}
+
+std::unique_ptr<TomlDocument> TomlDocument::Parse(const std::string& content, std::string& error) {
+    std::unique_ptr<TomlDocument> doc(new TomlDocument());
+    TomlParser parser(content, *doc, error);
+    if (!parser.ParseDocument())
+        return nullptr;
+
+    doc->Index();
+    return doc;
+}
+
+void TomlDocument::Index() {
+    // Iterative, the tables of a document may be nested deeper than the enclave stack allows to recurse
+    std::vector<std::pair<const TomlNode*, std::string>> pending;
+    pending.emplace_back(&nodes_.front(), std::string());
+    while (!pending.empty()) {
+        const TomlNode* node = pending.back().first;
+        std::string path_key = std::move(pending.back().second);
+        pending.pop_back();
+
+        size_t size = path_key.size();
+        if (node->type == TomlNode::Type::Table) {
+            for (const auto& member : node->members) {
+                AppendPathKey(path_key, member.first);
+                index_.emplace(path_key, member.second);
+                pending.emplace_back(member.second, path_key);
+                path_key.resize(size);
+            }
+        } else if (node->type == TomlNode::Type::Array) {
+            for (size_t i = 0; i < node->items.size(); ++i) {
+                AppendPathKey(path_key, i);
+                index_.emplace(path_key, node->items[i]);
+                pending.emplace_back(node->items[i], path_key);
+                path_key.resize(size);
+            }
+        }
+    }
+}
+
+const TomlNode* TomlDocument::Find(const std::vector<TomlKey>& path) const {
+    if (path.empty())
+        return nullptr;
+
+    std::string path_key;
+    path_key.reserve(path.size() * 16);
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        if (it->type_ == TomlKey::KeyType::Integer) {
+            if (it->index_key_ < 0)
+                return nullptr;
+            AppendPathKey(path_key, static_cast<size_t>(it->index_key_));
+        } else {
+            AppendPathKey(path_key, it->str_key_);
+        }
+    }
+    auto found = index_.find(path_key);
+    return found == index_.end() ? nullptr : found->second;
+}
+
+const TomlNode* TomlDocument::FindValue(const std::vector<TomlKey>& path, TomlNode::Type type,
+                                        std::string& err_msg) const {
+    if (path.empty()) {
+        err_msg = "The input toml file path is empty";
+        return nullptr;
+    }
+    const TomlNode* node = Find(path);
+    if (!node) {
+        err_msg = "No value is found at " + PathToString(path);
+        return nullptr;
+    }
+    if (node->type != type) {
+        err_msg = std::string("The value at ") + PathToString(path) + " is not " + TypeName(type);
+        return nullptr;
+    }
+    return node;
+}
+
+const TomlNode* TomlDocument::FindArray(const std::vector<TomlKey>& path, TomlNode::Type item_type,
+                                        std::string& err_msg) const {
+    const TomlNode* node = FindValue(path, TomlNode::Type::Array, err_msg);
+    if (!node) {
+        return nullptr;
+    }
+    if (!std::all_of(node->items.begin(), node->items.end(),
+                     [item_type](const TomlNode* item) { return item->type == item_type; })) {
+        err_msg = std::string("The values of the array at ") + PathToString(path) + " are not all " +
+                  TypeName(item_type);
+        return nullptr;
+    }
+    return node;
+}
+
+} // namespace internal
+} // namespace config_t
+} // namespace ssgx
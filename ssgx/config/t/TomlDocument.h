@@ -0,0 +1,107 @@
+#ifndef SSGXLIB_CONFIG_T_TOMLDOCUMENT_H
+#define SSGXLIB_CONFIG_T_TOMLDOCUMENT_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ssgx_config_t.h"
+
+namespace ssgx {
+namespace config_t {
+namespace internal {
+
+/**
+ * @brief A value of a TOML document parsed inside the enclave.
+ *
+ * Floating-point numbers, booleans and dates are parsed but not kept: they are of type Other, like TomlConfig does
+ * not read them.
+ */
+struct TomlNode {
+    enum class Type { Integer, String, Array, Table, Other };
+
+    Type type = Type::Other;
+    int64_t integer = 0;
+    std::string string;
+    std::vector<TomlNode*> items;             // Array
+    std::map<std::string, TomlNode*> members; // Table
+
+    // Only used while parsing
+    bool is_defined = false;     // a table defined by a [header] or a dotted key, not only as the parent of one
+    bool is_frozen = false;      // an inline table or an array value, which can not be extended afterwards
+    bool is_table_array = false; // an array of tables defined by [[headers]]
+};
+
+/**
+ * @brief An immutable TOML document, parsed inside the enclave from the content of a TOML v1.0.0 file.
+ *
+ * Every value of the document can be looked up by its full path with a single hash table lookup: the paths are
+ * indexed once the document is parsed.
+ */
+class TomlDocument {
+  public:
+    /**
+     * @brief Parse a TOML document.
+     * @param[in] content The content of the TOML file
+     * @param[out] error The reason, with its line number, if the content can not be parsed
+     * @return The document, or nullptr if the content can not be parsed
+     */
+    static std::unique_ptr<TomlDocument> Parse(const std::string& content, std::string& error);
+
+    /**
+     * @brief Find a value by its path, in the reverse order, as built by MakeArgs().
+     * @return The value, or nullptr if there is none at this path
+     */
+    const TomlNode* Find(const std::vector<TomlKey>& path) const;
+
+    /**
+     * @brief Find a value of a type by its path, as the getters of TomlConfig do.
+     * @param[out] err_msg The reason if there is no value of this type at this path
+     * @return The value, or nullptr
+     */
+    const TomlNode* FindValue(const std::vector<TomlKey>& path, TomlNode::Type type, std::string& err_msg) const;
+
+    /**
+     * @brief Find an array whose values are all of a type (an empty array is), by its path.
+     * @param[out] err_msg The reason if there is no such array at this path
+     * @return The array, or nullptr
+     */
+    const TomlNode* FindArray(const std::vector<TomlKey>& path, TomlNode::Type item_type, std::string& err_msg) const;
+
+    TomlDocument(const TomlDocument&) = delete;
+    TomlDocument& operator=(const TomlDocument&) = delete;
+
+  private:
+    friend class TomlParser;
+
+    TomlDocument() = default;
+
+    void Index();
+
+    std::deque<TomlNode> nodes_; // all values of the document, nodes_[0] is the root table
+    std::unordered_map<std::string, const TomlNode*> index_; // values by path key, see Find()
+};
+
+/**
+ * @brief Read a TOML file of up to 128KB into the enclave, with a single OCALL.
+ * @param[out] content The content of the file
+ * @param[out] err_msg The reason if the file can not be read
+ */
+bool ReadTomlFile(const char* toml_file_path, std::string& content, std::string& err_msg);
+
+/**
+ * @brief Compute the SHA-256 digest of the content of a TOML file.
+ * @param[out] digest The 32 bytes digest
+ * @param[out] err_msg The reason if the digest can not be computed
+ */
+bool DigestTomlContent(const std::string& content, std::vector<uint8_t>& digest, std::string& err_msg);
+
+} // namespace internal
+} // namespace config_t
+} // namespace ssgx
+
+#endif // SSGXLIB_CONFIG_T_TOMLDOCUMENT_H
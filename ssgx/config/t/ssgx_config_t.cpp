@@ -1,16 +1,25 @@
 #include "ssgx_config_t.h"
 
+#include <algorithm>
 #include <string>
 
 #include "nlohmann/json.hpp"
 
 #include "sgx_lfence.h"
+#include "sgx_tcrypto.h"
 #include "sgx_trts.h"
 
 #include "ssgx_config_t_t.h"
 #include "ssgx_utils_t.h"
 
+#include "TomlDocument.h"
+
 using JSON = nlohmann::json;
+using ssgx::config_t::internal::TomlDocument;
+using ssgx::config_t::internal::TomlNode;
+
+// The largest TOML file read into the enclave, as limited on the host
+#define LIMITED_TOML_CONTENT_SIZE (128 * 1024)
 
 namespace ssgx {
 namespace config_t {
@@ -30,11 +39,78 @@ static std::string GetPathStr(const std::vector<TomlKey>& path) {
     return paths_json.dump();
 }
 
+namespace internal {
+
+bool ReadTomlFile(const char* toml_file_path, std::string& content, std::string& err_msg) {
+    int ret = 0;
+    char* ptr_content = nullptr;
+    int32_t content_size = 0;
+
+    content.clear();
+
+    // read the whole file with a single OCALL
+    sgx_status_t status = ssgx_ocall_toml_read_file(&ret, toml_file_path, &ptr_content, &content_size);
+    if (status != SGX_SUCCESS) {
+        err_msg = ssgx::utils_t::FormatStr("Enclave ssgx_ocall_toml_read_file function call failed, sgx status: 0x%x",
+                                           status);
+        return false;
+    }
+    if (ret < 0) {
+        err_msg =
+            ssgx::utils_t::FormatStr("Enclave ssgx_ocall_toml_read_file function call failed, error code: %d", ret);
+        return false;
+    }
+    // The file is empty
+    if (!ptr_content || content_size <= 0) {
+        return true;
+    }
+
+    if (sgx_is_outside_enclave(ptr_content, content_size) == 0) {
+        // Don't call FreeOutside() in this case.
+        err_msg = ssgx::utils_t::FormatStr("The memory block pointed to by the pointer passed from the untrusted "
+                                           "execution environment contains trusted memory");
+        return false;
+    }
+    if (content_size > LIMITED_TOML_CONTENT_SIZE) {
+        ssgx::utils_t::FreeOutside(ptr_content, content_size);
+        err_msg = ssgx::utils_t::FormatStr("The size of the toml file is too large: %d", content_size);
+        return false;
+    }
+    sgx_lfence();
+
+    content.assign(ptr_content, content_size);
+    ssgx::utils_t::FreeOutside(ptr_content, content_size);
+    return true;
+}
+
+bool DigestTomlContent(const std::string& content, std::vector<uint8_t>& digest, std::string& err_msg) {
+    digest.resize(sizeof(sgx_sha256_hash_t));
+    sgx_status_t status = sgx_sha256_msg(reinterpret_cast<const uint8_t*>(content.data()),
+                                         static_cast<uint32_t>(content.size()),
+                                         reinterpret_cast<sgx_sha256_hash_t*>(digest.data()));
+    if (status != SGX_SUCCESS) {
+        digest.clear();
+        err_msg =
+            ssgx::utils_t::FormatStr("Failed to compute the digest of the toml content, sgx status: 0x%x", status);
+        return false;
+    }
+    return true;
+}
+
+} // namespace internal
+
 TomlConfig::~TomlConfig() {
-    ssgx_ocall_toml_free(ref_untrusted_toml_obj_);
+    FreeUntrustedObject();
 }
 
-bool TomlConfig::LoadFile(const char* toml_file_path) {
+void TomlConfig::FreeUntrustedObject() {
+    if (ref_untrusted_toml_obj_ != 0) {
+        ssgx_ocall_toml_free(ref_untrusted_toml_obj_);
+        ref_untrusted_toml_obj_ = 0;
+    }
+}
+
+bool TomlConfig::LoadFile(const char* toml_file_path, LoadMode mode) {
     int ret = 0;
     sgx_status_t status = SGX_ERROR_UNEXPECTED;
     uint64_t toml_ctx = 0;
@@ -44,6 +120,14 @@ bool TomlConfig::LoadFile(const char* toml_file_path) {
         return false;
     }
 
+    if (mode == LoadMode::Enclave) {
+        std::string content;
+        if (!internal::ReadTomlFile(toml_file_path, content, err_msg_)) {
+            return false;
+        }
+        return LoadDocument(content);
+    }
+
     status = ssgx_ocall_toml_create_from_file(&ret, toml_file_path, &toml_ctx);
     if (status != SGX_SUCCESS) {
         err_msg_ = ssgx::utils_t::FormatStr(
@@ -55,8 +139,38 @@ bool TomlConfig::LoadFile(const char* toml_file_path) {
             "Enclave ssgx_ocall_toml_create_from_file function call failed, error code: %d", ret);
         return false;
     }
+    FreeUntrustedObject();
     ref_untrusted_toml_obj_ = toml_ctx;
+    document_.reset();
+    digest_.clear();
+
+    return true;
+}
+
+bool TomlConfig::LoadString(const std::string& toml_content) {
+    if (toml_content.size() > LIMITED_TOML_CONTENT_SIZE) {
+        err_msg_ = ssgx::utils_t::FormatStr("The size of the toml content is too large: %zu", toml_content.size());
+        return false;
+    }
+    return LoadDocument(toml_content);
+}
 
+bool TomlConfig::LoadDocument(const std::string& toml_content) {
+    std::string error;
+    std::shared_ptr<const TomlDocument> document = TomlDocument::Parse(toml_content, error);
+    if (!document) {
+        err_msg_ = ssgx::utils_t::FormatStr("Failed to parse the toml content: %s", error.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> digest;
+    if (!internal::DigestTomlContent(toml_content, digest, err_msg_)) {
+        return false;
+    }
+
+    FreeUntrustedObject();
+    document_ = std::move(document);
+    digest_ = std::move(digest);
     return true;
 }
 
@@ -66,6 +180,14 @@ std::optional<int64_t> TomlConfig::GetInteger(const std::vector<TomlKey>& path)
     std::string paths_str;
     sgx_status_t status = SGX_ERROR_UNEXPECTED;
 
+    if (document_) {
+        const TomlNode* node = document_->FindValue(path, TomlNode::Type::Integer, err_msg_);
+        if (!node) {
+            return std::nullopt;
+        }
+        return node->integer;
+    }
+
     if (ref_untrusted_toml_obj_ == 0) {
         err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
         return std::nullopt;
@@ -100,6 +222,15 @@ std::optional<std::string> TomlConfig::GetString(const std::vector<TomlKey>& pat
     std::string paths_str;
     std::string value;
     sgx_status_t status = SGX_ERROR_UNEXPECTED;
+
+    if (document_) {
+        const TomlNode* node = document_->FindValue(path, TomlNode::Type::String, err_msg_);
+        if (!node) {
+            return std::nullopt;
+        }
+        return node->string;
+    }
+
     if (ref_untrusted_toml_obj_ == 0) {
         err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
         return std::nullopt;
@@ -158,6 +289,18 @@ std::optional<std::string> TomlConfig::GetString(const std::vector<TomlKey>& pat
 std::optional<std::vector<int64_t>> TomlConfig::GetIntegerArray(const std::vector<TomlKey>& path) {
     std::vector<int64_t> values;
 
+    if (document_) {
+        const TomlNode* node = document_->FindArray(path, TomlNode::Type::Integer, err_msg_);
+        if (!node) {
+            return std::nullopt;
+        }
+        values.reserve(node->items.size());
+        for (const TomlNode* item : node->items) {
+            values.push_back(item->integer);
+        }
+        return values;
+    }
+
     if (ref_untrusted_toml_obj_ == 0) {
         err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
         return std::nullopt;
@@ -207,6 +350,18 @@ std::optional<std::vector<int64_t>> TomlConfig::GetIntegerArray(const std::vecto
 std::optional<std::vector<std::string>> TomlConfig::GetStringArray(const std::vector<TomlKey>& path) {
     std::vector<std::string> values;
 
+    if (document_) {
+        const TomlNode* node = document_->FindArray(path, TomlNode::Type::String, err_msg_);
+        if (!node) {
+            return std::nullopt;
+        }
+        values.reserve(node->items.size());
+        for (const TomlNode* item : node->items) {
+            values.push_back(item->string);
+        }
+        return values;
+    }
+
     if (ref_untrusted_toml_obj_ == 0) {
         err_msg_ = ssgx::utils_t::FormatStr("The TOML object has not been initialized");
         return std::nullopt;
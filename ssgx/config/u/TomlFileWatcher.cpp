@@ -0,0 +1,123 @@
+#include "ssgx_config_u_watcher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace ssgx {
+namespace config_u {
+
+TomlFileWatcher::~TomlFileWatcher() {
+    Stop();
+}
+
+bool TomlFileWatcher::Start(sgx_enclave_id_t eid, ConfigReloadCallback reload_cb, const std::string& toml_file_path,
+                            int debounce_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable() || !reload_cb || toml_file_path.empty() || debounce_ms < 0) {
+        return false;
+    }
+
+    // Watch the directory: a file replaced by a rename is another inode, which a watch on the file would miss
+    std::string dir = ".";
+    std::string file_name = toml_file_path;
+    size_t pos = toml_file_path.rfind('/');
+    if (pos != std::string::npos) {
+        dir = pos == 0 ? "/" : toml_file_path.substr(0, pos);
+        file_name = toml_file_path.substr(pos + 1);
+    }
+    if (file_name.empty()) {
+        return false;
+    }
+
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        return false;
+    }
+    if (inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(inotify_fd);
+        return false;
+    }
+    int stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd < 0) {
+        close(inotify_fd);
+        return false;
+    }
+
+    eid_ = eid;
+    reload_cb_ = reload_cb;
+    toml_file_path_ = toml_file_path;
+    file_name_ = file_name;
+    debounce_ms_ = debounce_ms;
+    inotify_fd_ = inotify_fd;
+    stop_fd_ = stop_fd;
+    thread_ = std::thread(&TomlFileWatcher::Run, this);
+    return true;
+}
+
+void TomlFileWatcher::Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t written = write(stop_fd_, &one, sizeof(one));
+    (void)written;
+    thread_.join();
+    close(inotify_fd_);
+    close(stop_fd_);
+    inotify_fd_ = -1;
+    stop_fd_ = -1;
+}
+
+void TomlFileWatcher::Run() {
+    alignas(struct inotify_event) char buf[4096];
+    bool pending = false; // the file changed, and has not been reloaded since
+
+    for (;;) {
+        struct pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+        int ret = poll(fds, 2, pending ? debounce_ms_ : -1);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+        if (ret == 0) {
+            // no change for debounce_ms_
+            pending = false;
+            Reload();
+            continue;
+        }
+
+        ssize_t len;
+        while ((len = read(inotify_fd_, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + len;) {
+                auto* event = reinterpret_cast<struct inotify_event*>(p);
+                if (event->len > 0 && file_name_ == event->name) {
+                    pending = true;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+}
+
+void TomlFileWatcher::Reload() {
+    int ret = 0;
+    sgx_status_t status = reload_cb_(eid_, &ret, toml_file_path_.c_str());
+    if (status != SGX_SUCCESS || ret < 0) {
+        failure_count_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        reload_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace config_u
+} // namespace ssgx
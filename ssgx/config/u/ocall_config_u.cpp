@@ -67,6 +67,61 @@ extern "C" int32_t ssgx_ocall_toml_create_from_file(const char* toml_file_path,
     return 0;
 }
 
+/* Read a TOML file, to parse it in enclave
+ *
+ * Parameters:
+ *      toml_file_path[in, string] - path of TOML file
+ *      ptr_ptr_content[out] - content of the file, in untrusted memory allocated with malloc()
+ *      content_len[out] - size of the content
+ * Return:
+ *      0 - Success
+ *      <0 -  Failed
+ */
+extern "C" int32_t ssgx_ocall_toml_read_file(const char* toml_file_path, char** ptr_ptr_content, int32_t* content_len) {
+    if (!toml_file_path || strnlen(toml_file_path, 1) == 0) {
+        return -1;
+    }
+    if (!ptr_ptr_content || !content_len) {
+        return -2;
+    }
+    *ptr_ptr_content = nullptr;
+    *content_len = 0;
+
+    struct stat s_buf{};
+    if (stat(toml_file_path, &s_buf) != 0) {
+        return -3;
+    }
+    if (!S_ISREG(s_buf.st_mode)) {
+        return -4;
+    }
+    size_t toml_file_size = s_buf.st_size;
+    if (toml_file_size > LIMITED_TOML_FILE_SIZE) {
+        return -5;
+    }
+    if (toml_file_size == 0) {
+        return 0;
+    }
+
+    FILE* fp = fopen(toml_file_path, "rb");
+    if (!fp) {
+        return -6;
+    }
+    auto ptr_content = static_cast<char*>(malloc(toml_file_size));
+    if (!ptr_content) {
+        fclose(fp);
+        return -7;
+    }
+    size_t read_size = fread(ptr_content, 1, toml_file_size, fp);
+    fclose(fp);
+    if (read_size != toml_file_size) {
+        free(ptr_content);
+        return -8;
+    }
+    *ptr_ptr_content = ptr_content;
+    *content_len = static_cast<int32_t>(toml_file_size);
+    return 0;
+}
+
 /* Find node and get the int value
  *
  * Parameters:
@@ -1,6 +1,7 @@
 #include "ssgx_decimal_t.h"
 
 #include <assert.h>
+#include <climits>
 #include <cstring>
 #include <stdexcept>
 
@@ -16,6 +17,17 @@
 #define SSGX_MAX_EXP 9999999999L
 #define SSGX_MIN_EXP -9999999999L
 
+// Values of at most 38 digits, which fit 128 bits, with an exponent which fits 32 bits are held inline
+#define FIXED_MAX_DIGITS 38
+#define FIXED_MAX_EXP 999999999L
+
+// The binary encoding of BigDecimal::ToBytes(): a coefficient of 99 digits fits 42 bytes
+#define BYTES_SIGN_BIT 0x80
+#define BYTES_MAX_COEFF 42
+
+// The precision of the sums of DecimalAccumulator, which are exact unless they spread over more digits
+#define SSGX_DECIMAL_ACCUMULATOR_PREC 1000
+
 namespace ssgx {
 namespace decimal_t {
 
@@ -123,6 +135,487 @@ static bool CheckContextStatus(const mpd_context_t* ctx, bool ignore_rounding, s
     return error.empty();
 }
 
+namespace internal {
+
+// 128-bit arithmetic is limited to addition, subtraction, multiplication, shifts and comparisons, which the compiler
+// inlines: a 128-bit division would need __udivti3 from libgcc, which enclaves do not link.
+typedef unsigned __int128 uint128_t;
+
+/**
+ * @brief A decimal value held inline: (-1)^negative * coeff * 10^exp, with coeff < 10^FIXED_MAX_DIGITS and
+ * |exp| <= FIXED_MAX_EXP. As in mpdecimal, the exponent is kept as is (1.20 is 120 * 10^-2) and zero is signed.
+ */
+struct FixedDecimal {
+    uint128_t coeff;
+    int64_t exp;
+    bool negative;
+};
+
+/**
+ * @brief Powers of ten from 10^0 to 10^FIXED_MAX_DIGITS
+ */
+static const uint128_t* Pow10Table() {
+    static const uint128_t* table = [] {
+        static uint128_t pow10[FIXED_MAX_DIGITS + 1];
+        pow10[0] = 1;
+        for (int i = 1; i <= FIXED_MAX_DIGITS; ++i) {
+            pow10[i] = pow10[i - 1] * 10;
+        }
+        return pow10;
+    }();
+    return table;
+}
+
+static const uint32_t POW10_U32[10] = {1,      10,      100,      1000,      10000,
+                                       100000, 1000000, 10000000, 100000000, 1000000000};
+
+static bool IsFixedExp(int64_t exp) {
+    return exp >= -FIXED_MAX_EXP && exp <= FIXED_MAX_EXP;
+}
+
+/**
+ * @brief The number of digits of x, 1 for 0
+ */
+static int CountDigits(uint128_t x) {
+    const uint128_t* pow10 = Pow10Table();
+    int digits = 1;
+    while (digits <= FIXED_MAX_DIGITS && x >= pow10[digits]) {
+        ++digits;
+    }
+    return digits;
+}
+
+/**
+ * @brief x / d, and x % d in rem, for a divisor below 2^32
+ */
+static uint128_t DivSmall(uint128_t x, uint32_t d, uint32_t& rem) {
+    uint64_t hi = static_cast<uint64_t>(x >> 64);
+    uint64_t lo = static_cast<uint64_t>(x);
+    uint64_t q_hi = hi / d;
+    uint64_t r = hi % d;
+    uint64_t cur = (r << 32) | (lo >> 32);
+    uint64_t q_mid = cur / d;
+    r = cur % d;
+    cur = (r << 32) | (lo & 0xFFFFFFFFULL);
+    uint64_t q_lo = cur / d;
+    rem = static_cast<uint32_t>(cur % d);
+    return (static_cast<uint128_t>(q_hi) << 64) | (static_cast<uint128_t>(q_mid) << 32) | q_lo;
+}
+
+/**
+ * @brief x * 10^n into result
+ * @return false if the result does not fit the inline coefficient
+ */
+static bool ScaleUp(uint128_t x, int64_t n, uint128_t& result) {
+    if (x == 0) {
+        result = 0;
+        return true;
+    }
+    if (n > FIXED_MAX_DIGITS || x >= Pow10Table()[FIXED_MAX_DIGITS - n]) {
+        return false;
+    }
+    result = x * Pow10Table()[n];
+    return true;
+}
+
+/**
+ * @brief Whether to increment the coefficient kept after digits have been dropped, as mpdecimal rounds
+ * @param[in] round A mpdecimal rounding mode
+ * @param[in] negative The sign of the value
+ * @param[in] kept The coefficient kept
+ * @param[in] digit The first digit dropped
+ * @param[in] sticky Whether any other digit dropped is not 0
+ */
+static bool RoundIncrement(int round, bool negative, uint128_t kept, uint32_t digit, bool sticky) {
+    bool inexact = digit != 0 || sticky;
+    uint32_t last = 0;
+    switch (round) {
+    case MPD_ROUND_UP:
+        return inexact;
+    case MPD_ROUND_CEILING:
+        return inexact && !negative;
+    case MPD_ROUND_FLOOR:
+        return inexact && negative;
+    case MPD_ROUND_HALF_UP:
+        return digit >= 5;
+    case MPD_ROUND_HALF_DOWN:
+        return digit > 5 || (digit == 5 && sticky);
+    case MPD_ROUND_HALF_EVEN:
+        return digit > 5 || (digit == 5 && (sticky || (kept & 1) != 0));
+    case MPD_ROUND_05UP:
+        DivSmall(kept, 10, last);
+        return inexact && (last == 0 || last == 5);
+    default:
+        // MPD_ROUND_DOWN, MPD_ROUND_TRUNC
+        return false;
+    }
+}
+
+/**
+ * @brief Rescale x to the exponent exp, as mpd_quantize() does
+ * @return false if the result does not fit the inline representation
+ */
+static bool FixedQuantize(const FixedDecimal& x, int64_t exp, int round, FixedDecimal& result) {
+    if (!IsFixedExp(exp)) {
+        return false;
+    }
+    result.negative = x.negative;
+    result.exp = exp;
+    if (exp <= x.exp) {
+        return ScaleUp(x.coeff, x.exp - exp, result.coeff);
+    }
+
+    // Drop the last n digits, the first of them being kept apart for rounding
+    int64_t n = exp - x.exp;
+    uint128_t kept = x.coeff;
+    uint32_t rem = 0;
+    uint32_t digit = 0;
+    bool sticky = false;
+    if (n > FIXED_MAX_DIGITS + 1) {
+        sticky = kept != 0;
+        kept = 0;
+    } else {
+        for (int64_t left = n - 1; left > 0 && kept != 0;) {
+            int chunk = left > 9 ? 9 : static_cast<int>(left);
+            kept = DivSmall(kept, POW10_U32[chunk], rem);
+            sticky = sticky || rem != 0;
+            left -= chunk;
+        }
+        kept = DivSmall(kept, 10, digit);
+    }
+    if (RoundIncrement(round, x.negative, kept, digit, sticky)) {
+        ++kept;
+    }
+    result.coeff = kept;
+    return true;
+}
+
+/**
+ * @brief x + y, exact as mpd_add() is when the result has less than SSGX_MAX_PREC digits
+ * @param[in] round The rounding mode of the context, which decides the sign of a zero sum of opposite signs
+ * @return false if the result does not fit the inline representation
+ */
+static bool FixedAdd(const FixedDecimal& x, const FixedDecimal& y, int round, FixedDecimal& result) {
+    int64_t exp = x.exp < y.exp ? x.exp : y.exp;
+    uint128_t cx = 0;
+    uint128_t cy = 0;
+    if (!ScaleUp(x.coeff, x.exp - exp, cx) || !ScaleUp(y.coeff, y.exp - exp, cy)) {
+        return false;
+    }
+
+    result.exp = exp;
+    if (x.negative == y.negative) {
+        // both below 10^38, no wrap around
+        result.coeff = cx + cy;
+        result.negative = x.negative;
+        return result.coeff < Pow10Table()[FIXED_MAX_DIGITS];
+    }
+    if (cx > cy) {
+        result.coeff = cx - cy;
+        result.negative = x.negative;
+    } else if (cy > cx) {
+        result.coeff = cy - cx;
+        result.negative = y.negative;
+    } else {
+        // An exact zero sum of operands of opposite signs is negative only when rounding toward -infinity
+        result.coeff = 0;
+        result.negative = round == MPD_ROUND_FLOOR;
+    }
+    return true;
+}
+
+/**
+ * @brief x * y, exact as mpd_mul() is when the result has less than SSGX_MAX_PREC digits
+ * @return false if the result does not fit the inline representation
+ */
+static bool FixedMultiply(const FixedDecimal& x, const FixedDecimal& y, FixedDecimal& result) {
+    result.exp = x.exp + y.exp;
+    result.negative = x.negative != y.negative;
+    if (!IsFixedExp(result.exp)) {
+        return false;
+    }
+    if (x.coeff == 0 || y.coeff == 0) {
+        result.coeff = 0;
+        return true;
+    }
+
+    // One factor must fit 64 bits, as the product of two larger ones exceeds 10^38
+    uint128_t big = x.coeff;
+    uint128_t small = y.coeff;
+    if ((small >> 64) != 0) {
+        big = y.coeff;
+        small = x.coeff;
+    }
+    if ((small >> 64) != 0) {
+        return false;
+    }
+    uint128_t lo = static_cast<uint128_t>(static_cast<uint64_t>(big)) * static_cast<uint64_t>(small);
+    uint128_t hi = static_cast<uint128_t>(static_cast<uint64_t>(big >> 64)) * static_cast<uint64_t>(small);
+    if ((hi >> 64) != 0) {
+        return false;
+    }
+    uint128_t product = lo + (hi << 64);
+    if (product < lo) {
+        return false;
+    }
+    result.coeff = product;
+    return product < Pow10Table()[FIXED_MAX_DIGITS];
+}
+
+/**
+ * @brief Compare the values of x and y, as mpd_cmp() does
+ * @return -1, 0 or 1
+ */
+static int FixedCompare(const FixedDecimal& x, const FixedDecimal& y) {
+    int sign_x = x.coeff == 0 ? 0 : (x.negative ? -1 : 1);
+    int sign_y = y.coeff == 0 ? 0 : (y.negative ? -1 : 1);
+    if (sign_x != sign_y || sign_x == 0) {
+        return sign_x < sign_y ? -1 : (sign_x > sign_y ? 1 : 0);
+    }
+
+    // Same sign: compare the magnitudes, first by their adjusted exponent
+    int cmp = 0;
+    int64_t adjusted_x = x.exp + CountDigits(x.coeff) - 1;
+    int64_t adjusted_y = y.exp + CountDigits(y.coeff) - 1;
+    if (adjusted_x != adjusted_y) {
+        cmp = adjusted_x < adjusted_y ? -1 : 1;
+    } else {
+        // The operand with the larger exponent has fewer digits, aligning it can not overflow
+        uint128_t cx = x.coeff;
+        uint128_t cy = y.coeff;
+        if (x.exp > y.exp) {
+            ScaleUp(x.coeff, x.exp - y.exp, cx);
+        } else if (y.exp > x.exp) {
+            ScaleUp(y.coeff, y.exp - x.exp, cy);
+        }
+        cmp = cx < cy ? -1 : (cx > cy ? 1 : 0);
+    }
+    return sign_x < 0 ? -cmp : cmp;
+}
+
+/**
+ * @brief Parse a plain decimal string: [sign] digits [. digits] [(e|E) [sign] digits]
+ * @return false if str is not such a string, or if its value does not fit the inline representation; mpdecimal then
+ * parses it, and reports the errors.
+ */
+static bool FixedParse(const char* str, FixedDecimal& result) {
+    const char* p = str;
+    result.negative = false;
+    if (*p == '+' || *p == '-') {
+        result.negative = *p == '-';
+        ++p;
+    }
+
+    uint128_t coeff = 0;
+    int digits = 0;        // significant digits
+    int64_t frac = 0;      // digits after the decimal point
+    bool any_digit = false;
+    bool point = false;
+    for (;; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            any_digit = true;
+            if (point) {
+                ++frac;
+            }
+            if (digits == 0 && *p == '0') {
+                continue;
+            }
+            if (++digits > FIXED_MAX_DIGITS) {
+                return false;
+            }
+            coeff = coeff * 10 + static_cast<uint32_t>(*p - '0');
+        } else if (*p == '.' && !point) {
+            point = true;
+        } else {
+            break;
+        }
+    }
+    if (!any_digit) {
+        return false;
+    }
+
+    int64_t exp = 0;
+    if (*p == 'e' || *p == 'E') {
+        ++p;
+        bool exp_negative = false;
+        if (*p == '+' || *p == '-') {
+            exp_negative = *p == '-';
+            ++p;
+        }
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        for (; *p >= '0' && *p <= '9'; ++p) {
+            exp = exp * 10 + (*p - '0');
+            if (exp > FIXED_MAX_EXP * 10) {
+                return false;
+            }
+        }
+        if (exp_negative) {
+            exp = -exp;
+        }
+    }
+    if (*p != '\0') {
+        return false;
+    }
+
+    result.coeff = coeff;
+    result.exp = exp - frac;
+    return IsFixedExp(result.exp);
+}
+
+/**
+ * @brief Convert to a string in scientific notation, as mpd_to_sci() does with uppercase
+ */
+static std::string FixedToStr(const FixedDecimal& x) {
+    // Digits of the coefficient, in chunks of 9
+    char buf[FIXED_MAX_DIGITS + 9];
+    char* end = buf + sizeof(buf);
+    char* begin = end;
+    uint128_t coeff = x.coeff;
+    do {
+        uint32_t chunk = 0;
+        coeff = DivSmall(coeff, POW10_U32[9], chunk);
+        for (int i = 0; i < 9 && (coeff != 0 || chunk != 0 || i == 0); ++i) {
+            *--begin = static_cast<char>('0' + chunk % 10);
+            chunk /= 10;
+        }
+    } while (coeff != 0);
+    auto len = static_cast<int64_t>(end - begin);
+
+    std::string str;
+    str.reserve(len + 32);
+    if (x.negative) {
+        str.push_back('-');
+    }
+    int64_t adjusted = x.exp + len - 1;
+    if (x.exp <= 0 && adjusted >= -6) {
+        // Plain notation
+        if (x.exp == 0) {
+            str.append(begin, end);
+        } else if (len > -x.exp) {
+            str.append(begin, end + x.exp);
+            str.push_back('.');
+            str.append(end + x.exp, end);
+        } else {
+            str.append("0.");
+            str.append(static_cast<size_t>(-x.exp - len), '0');
+            str.append(begin, end);
+        }
+    } else {
+        // Scientific notation
+        str.push_back(*begin);
+        if (len > 1) {
+            str.push_back('.');
+            str.append(begin + 1, end);
+        }
+        str.push_back('E');
+        if (adjusted >= 0) {
+            str.push_back('+');
+        }
+        str.append(std::to_string(adjusted));
+    }
+    return str;
+}
+
+/**
+ * @brief Append x to bytes, as a zigzag LEB128 varint
+ */
+static void AppendVarint(int64_t x, std::vector<uint8_t>& bytes) {
+    uint64_t v = (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+    while (v >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(v));
+}
+
+/**
+ * @brief Read a zigzag LEB128 varint from data at pos, and advance pos past it
+ * @return false if the varint is truncated, or longer than 10 bytes
+ */
+static bool ReadVarint(const uint8_t* data, size_t size, size_t& pos, int64_t& x) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= size) {
+            return false;
+        }
+        uint8_t byte = data[pos++];
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            x = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief An operand for mpdecimal: the mpd_t of a BigDecimal, or a temporary copy of its inline value
+ */
+class MpdOperand {
+  public:
+    explicit MpdOperand(const BigDecimal& num)
+        : owned_(num.ptr_data_ ? nullptr : num.NewMpd()), ptr_(num.ptr_data_ ? num.ptr_data_ : owned_) {
+    }
+    ~MpdOperand() {
+        if (owned_) {
+            mpd_del(owned_);
+        }
+    }
+    MpdOperand(const MpdOperand&) = delete;
+    MpdOperand& operator=(const MpdOperand&) = delete;
+
+    const mpd_t* Get() const {
+        return ptr_;
+    }
+
+  private:
+    mpd_t* owned_;
+    const mpd_t* ptr_;
+};
+
+/**
+ * @brief A result of mpdecimal, released unless it is handed over with Release()
+ */
+class MpdResult {
+  public:
+    explicit MpdResult(mpd_context_t* ctx) : ptr_(mpd_new(ctx)) {
+        if (!ptr_) {
+            throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                      "A malloc error! Failed to call mpd_new().");
+        }
+    }
+    // Take the ownership of ptr
+    explicit MpdResult(mpd_t* ptr) : ptr_(ptr) {
+    }
+    ~MpdResult() {
+        if (ptr_) {
+            mpd_del(ptr_);
+        }
+    }
+    MpdResult(const MpdResult&) = delete;
+    MpdResult& operator=(const MpdResult&) = delete;
+
+    mpd_t* Get() const {
+        return ptr_;
+    }
+    mpd_t* Release() {
+        mpd_t* ptr = ptr_;
+        ptr_ = nullptr;
+        return ptr;
+    }
+
+  private:
+    mpd_t* ptr_;
+};
+
+} // namespace internal
+
+using internal::FixedDecimal;
+using internal::MpdOperand;
+using internal::MpdResult;
+
 Precision::Precision(RoundType round_type, int scale) : ptr_ctx_(nullptr), scale_(0) {
     std::string error_msg;
 
@@ -164,12 +657,14 @@ mpd_context_t* Precision::Get() const {
     return ptr_ctx_;
 }
 
-BigDecimal::BigDecimal() : BigDecimal("0") {
+BigDecimal::BigDecimal() : ptr_data_(nullptr), coeff_lo_(0), coeff_hi_(0), exponent_(0), negative_(false) {
 }
 
-BigDecimal::BigDecimal(const char* str) {
+BigDecimal::BigDecimal(const char* str) : BigDecimal() {
     mpd_context_t ctx;
+    mpd_t* ptr = nullptr;
     std::string error_msg;
+    FixedDecimal value;
 
     // Validate str, it must not be empty,
     // and its max length must be less than SSGX_MAX_PREC + 10.
@@ -179,81 +674,70 @@ BigDecimal::BigDecimal(const char* str) {
             "Invalid parameter! str must not be empty, or its length exceeds the max.");
     }
 
+    // Plain numbers which fit are held inline, mpdecimal parses the others and reports the errors
+    if (internal::FixedParse(str, value)) {
+        *this = FromFixed(value);
+        return;
+    }
+
     SetDefaultContext(&ctx);
-    if (!(ptr_data_ = mpd_new(&ctx))) {
+    if (!(ptr = mpd_new(&ctx))) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2,
                                                   "A malloc error! Failed to call mpd_new().");
     }
 
-    mpd_set_string(ptr_data_, str, &ctx);
+    mpd_set_string(ptr, str, &ctx);
 
     // Consider the result is invalid if meet one of the following conditions
     // 1. Any exceptions
     // 2. Result is infinite
     // 3. Result is NaN
     if (!CheckContextStatus(&ctx, false, error_msg)) {
-        mpd_del(ptr_data_);
-        ptr_data_ = nullptr;
+        mpd_del(ptr);
+        ptr = nullptr;
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -3, error_msg.c_str());
     }
-    if (mpd_isinfinite(ptr_data_) || mpd_isnan(ptr_data_)) {
-        mpd_del(ptr_data_);
-        ptr_data_ = nullptr;
+    if (mpd_isinfinite(ptr) || mpd_isnan(ptr)) {
+        mpd_del(ptr);
+        ptr = nullptr;
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -4,
                                                   "Paramter str is an invalid number.");
     }
-}
 
-BigDecimal::BigDecimal(const BigDecimal& num) {
-    mpd_context_t ctx;
-    std::string error_msg;
-
-    ASSERT_THROW(num.ptr_data_);
+    *this = FromMpd(ptr);
+}
 
-    SetDefaultContext(&ctx);
-    if (!(ptr_data_ = mpd_new(&ctx))) {
-        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
-                                                  "A malloc error! Failed to call mpd_new().");
-    }
-
-    mpd_copy(ptr_data_, num.ptr_data_, &ctx);
-    if (!CheckContextStatus(&ctx, false, error_msg)) {
-        mpd_del(ptr_data_);
-        ptr_data_ = nullptr;
-        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2, error_msg.c_str());
+BigDecimal::BigDecimal(const BigDecimal& num)
+    : ptr_data_(nullptr), coeff_lo_(num.coeff_lo_), coeff_hi_(num.coeff_hi_), exponent_(num.exponent_),
+      negative_(num.negative_) {
+    if (num.ptr_data_) {
+        ptr_data_ = num.NewMpd();
     }
 }
 
-BigDecimal::BigDecimal(BigDecimal&& num) noexcept {
-    ptr_data_ = num.ptr_data_;
+BigDecimal::BigDecimal(BigDecimal&& num) noexcept
+    : ptr_data_(num.ptr_data_), coeff_lo_(num.coeff_lo_), coeff_hi_(num.coeff_hi_), exponent_(num.exponent_),
+      negative_(num.negative_) {
     num.ptr_data_ = nullptr;
+    num.coeff_lo_ = 0;
+    num.coeff_hi_ = 0;
+    num.exponent_ = 0;
+    num.negative_ = false;
 }
 
 BigDecimal& BigDecimal::operator=(const BigDecimal& num) {
-    mpd_context_t ctx;
-    std::string error_msg;
-
     if (this == &num)
         return *this;
 
-    ASSERT_THROW(num.ptr_data_);
-
-    SetDefaultContext(&ctx);
+    mpd_t* ptr_data = num.ptr_data_ ? num.NewMpd() : nullptr;
     if (ptr_data_) {
-        delete ptr_data_;
-        ptr_data_ = nullptr;
-    }
-    if (!(ptr_data_ = mpd_new(&ctx))) {
-        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
-                                                  "A malloc error! Failed to call mpd_new().");
-    }
-
-    mpd_copy(ptr_data_, num.ptr_data_, &ctx);
-    if (!CheckContextStatus(&ctx, false, error_msg)) {
         mpd_del(ptr_data_);
-        ptr_data_ = nullptr;
-        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2, error_msg.c_str());
     }
+    ptr_data_ = ptr_data;
+    coeff_lo_ = num.coeff_lo_;
+    coeff_hi_ = num.coeff_hi_;
+    exponent_ = num.exponent_;
+    negative_ = num.negative_;
 
     return *this;
 }
@@ -268,7 +752,15 @@ BigDecimal& BigDecimal::operator=(BigDecimal&& num) noexcept {
     }
 
     ptr_data_ = num.ptr_data_;
+    coeff_lo_ = num.coeff_lo_;
+    coeff_hi_ = num.coeff_hi_;
+    exponent_ = num.exponent_;
+    negative_ = num.negative_;
     num.ptr_data_ = nullptr;
+    num.coeff_lo_ = 0;
+    num.coeff_hi_ = 0;
+    num.exponent_ = 0;
+    num.negative_ = false;
 
     return *this;
 }
@@ -281,134 +773,146 @@ BigDecimal::~BigDecimal() {
 }
 
 BigDecimal BigDecimal::Add(const BigDecimal& num) const {
-    BigDecimal result;
     mpd_context_t ctx;
     std::string error_msg;
+    FixedDecimal x, y, z;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y) && internal::FixedAdd(x, y, MPD_ROUND_HALF_UP, z)) {
+        return FromFixed(z);
+    }
 
     SetDefaultContext(&ctx);
-    mpd_add(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_add(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, false, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
-    return result;
+    return FromMpd(result.Release());
 }
 
 BigDecimal BigDecimal::Add(const BigDecimal& num, const Precision& prec) const {
-    BigDecimal result;
     std::string error_msg;
     mpd_context_t ctx = *prec.Get();
+    FixedDecimal x, y, z;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y) && internal::FixedAdd(x, y, ctx.round, z)) {
+        return FromFixed(z).SetScale(prec.scale_, (RoundType)ctx.round);
+    }
 
-    mpd_add(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_add(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, true, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result.SetScale(prec.scale_, (RoundType)ctx.round);
+    return FromMpd(result.Release()).SetScale(prec.scale_, (RoundType)ctx.round);
 }
 
 BigDecimal BigDecimal::Sub(const BigDecimal& num) const {
-    BigDecimal result;
     mpd_context_t ctx;
     std::string error_msg;
+    FixedDecimal x, y, z;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y)) {
+        y.negative = !y.negative;
+        if (internal::FixedAdd(x, y, MPD_ROUND_HALF_UP, z)) {
+            return FromFixed(z);
+        }
+    }
 
     SetDefaultContext(&ctx);
-    mpd_sub(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_sub(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, false, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result;
+    return FromMpd(result.Release());
 }
 
 BigDecimal BigDecimal::Sub(const BigDecimal& num, const Precision& prec) const {
-    BigDecimal result;
     std::string error_msg;
     mpd_context_t ctx = *prec.Get();
+    FixedDecimal x, y, z;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y)) {
+        y.negative = !y.negative;
+        if (internal::FixedAdd(x, y, ctx.round, z)) {
+            return FromFixed(z).SetScale(prec.scale_, (RoundType)ctx.round);
+        }
+    }
 
-    mpd_sub(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_sub(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, true, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result.SetScale(prec.scale_, (RoundType)ctx.round);
+    return FromMpd(result.Release()).SetScale(prec.scale_, (RoundType)ctx.round);
 }
 
 BigDecimal BigDecimal::Multiply(const BigDecimal& num) const {
-    BigDecimal result;
     mpd_context_t ctx;
     std::string error_msg;
+    FixedDecimal x, y, z;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y) && internal::FixedMultiply(x, y, z)) {
+        return FromFixed(z);
+    }
 
     SetDefaultContext(&ctx);
-    mpd_mul(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_mul(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, false, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result;
+    return FromMpd(result.Release());
 }
 
 BigDecimal BigDecimal::Multiply(const BigDecimal& num, const Precision& prec) const {
-    BigDecimal result;
     std::string error_msg;
     mpd_context_t ctx = *prec.Get();
+    FixedDecimal x, y, z;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y) && internal::FixedMultiply(x, y, z)) {
+        return FromFixed(z).SetScale(prec.scale_, (RoundType)ctx.round);
+    }
 
-    mpd_mul(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_mul(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, true, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result.SetScale(prec.scale_, (RoundType)ctx.round);
+    return FromMpd(result.Release()).SetScale(prec.scale_, (RoundType)ctx.round);
 }
 
 BigDecimal BigDecimal::Div(const BigDecimal& num) const {
-    BigDecimal result;
     mpd_context_t ctx;
     std::string error_msg;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
-
     SetDefaultContext(&ctx);
-    mpd_div(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_div(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, false, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result;
+    return FromMpd(result.Release());
 }
 
 BigDecimal BigDecimal::Div(const BigDecimal& num, const Precision& prec) const {
-    BigDecimal result;
     std::string error_msg;
     mpd_context_t ctx = *prec.Get();
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
-
-    mpd_div(result.ptr_data_, ptr_data_, num.ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_div(result.Get(), MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
     if (!CheckContextStatus(&ctx, true, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result.SetScale(prec.scale_, (RoundType)ctx.round);
+    return FromMpd(result.Release()).SetScale(prec.scale_, (RoundType)ctx.round);
 }
 
 bool BigDecimal::operator==(const BigDecimal& num) const {
@@ -428,27 +932,30 @@ bool BigDecimal::operator<(const BigDecimal& num) const {
 }
 
 bool BigDecimal::operator>=(const BigDecimal& num) const {
-    return Compare(num) == 1 || Compare(num) == 0;
+    return Compare(num) >= 0;
 }
 
 bool BigDecimal::operator<=(const BigDecimal& num) const {
-    return Compare(num) == -1 || Compare(num) == 0;
+    return Compare(num) <= 0;
 }
 
 BigDecimal BigDecimal::SetScale(int scale, RoundType round_type) const {
-    BigDecimal result;
     mpd_t* scale_num = nullptr;
     std::string scale_str = "1e";
     mpd_context_t ctx;
     std::string error_msg;
-
-    ASSERT_THROW(ptr_data_);
+    FixedDecimal x, z;
 
     if (scale >= SSGX_MAX_PREC) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
                                                   "Invalid parameter! scale must less than 99.");
     }
 
+    int round = MapRoundType(round_type);
+    if (round >= 0 && GetFixed(x) && internal::FixedQuantize(x, -static_cast<int64_t>(scale), round, z)) {
+        return FromFixed(z);
+    }
+
     SetDefaultContext(&ctx);
     if (!(scale_num = mpd_new(&ctx))) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2,
@@ -463,11 +970,14 @@ BigDecimal BigDecimal::SetScale(int scale, RoundType round_type) const {
     }
 
     SetDefaultContext(&ctx);
-    if (!mpd_qsetround(&ctx, MapRoundType(round_type))) {
+    if (!mpd_qsetround(&ctx, round)) {
+        mpd_del(scale_num);
+        scale_num = nullptr;
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -4,
                                                   "Parameter round_type is invalid.");
     }
-    mpd_quantize(result.ptr_data_, ptr_data_, scale_num, &ctx);
+    MpdResult result(&ctx);
+    mpd_quantize(result.Get(), MpdOperand(*this).Get(), scale_num, &ctx);
     if (!CheckContextStatus(&ctx, true, error_msg)) {
         mpd_del(scale_num);
         scale_num = nullptr;
@@ -477,24 +987,31 @@ BigDecimal BigDecimal::SetScale(int scale, RoundType round_type) const {
     mpd_del(scale_num);
     scale_num = nullptr;
 
-    return result;
+    return FromMpd(result.Release());
 }
 
 BigDecimal BigDecimal::Neg() const {
-    BigDecimal result;
     BigDecimal zero;
     mpd_context_t ctx;
     std::string error_msg;
-
-    ASSERT_THROW(ptr_data_);
+    FixedDecimal x, y, z;
+
+    // 0 - (*this), as mpdecimal computes it
+    if (zero.GetFixed(x) && GetFixed(y)) {
+        y.negative = !y.negative;
+        if (internal::FixedAdd(x, y, MPD_ROUND_HALF_UP, z)) {
+            return FromFixed(z);
+        }
+    }
 
     SetDefaultContext(&ctx);
-    mpd_sub(result.ptr_data_, zero.ptr_data_, ptr_data_, &ctx);
+    MpdResult result(&ctx);
+    mpd_sub(result.Get(), MpdOperand(zero).Get(), MpdOperand(*this).Get(), &ctx);
     if (!CheckContextStatus(&ctx, true, error_msg)) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
     }
 
-    return result;
+    return FromMpd(result.Release());
 }
 
 bool BigDecimal::IsValidDecimal(const char* expr) {
@@ -529,8 +1046,11 @@ bool BigDecimal::IsValidDecimal(const char* expr) {
 std::string BigDecimal::ToStr() const {
     std::string result;
     char* sci_str = nullptr;
+    FixedDecimal x;
 
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x)) {
+        return internal::FixedToStr(x);
+    }
 
     if (!(sci_str = mpd_to_sci(ptr_data_, 1))) {
         throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
@@ -547,12 +1067,171 @@ std::string BigDecimal::ToStr(int scale, RoundType round_type) const {
     return SetScale(scale, round_type).ToStr();
 }
 
+std::vector<uint8_t> BigDecimal::ToBytes() const {
+    std::vector<uint8_t> bytes;
+    AppendBytes(bytes);
+    return bytes;
+}
+
+void BigDecimal::AppendBytes(std::vector<uint8_t>& bytes) const {
+    uint8_t coeff[BYTES_MAX_COEFF]; // little-endian
+    size_t n = 0;
+    int64_t exp = 0;
+    bool negative = false;
+    FixedDecimal x;
+
+    if (GetFixed(x)) {
+        for (internal::uint128_t c = x.coeff; c != 0; c >>= 8) {
+            coeff[n++] = static_cast<uint8_t>(c);
+        }
+        exp = x.exp;
+        negative = x.negative;
+    } else {
+        // Export the coefficient as an integer, in words of 16 bits, least significant first
+        uint32_t status = 0;
+        uint16_t* words = nullptr;
+        MpdResult integer(NewMpd());
+        integer.Get()->exp = 0;
+        mpd_set_positive(integer.Get());
+        size_t len = mpd_qexport_u16(&words, 0, 1U << 16, integer.Get(), &status);
+        if (len == SIZE_MAX || len * 2 > BYTES_MAX_COEFF) {
+            mpd_free(words);
+            throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                      "Failed to export the coefficient.");
+        }
+        for (size_t i = 0; i < len; ++i) {
+            coeff[n++] = static_cast<uint8_t>(words[i]);
+            coeff[n++] = static_cast<uint8_t>(words[i] >> 8);
+        }
+        mpd_free(words);
+        while (n > 0 && coeff[n - 1] == 0) {
+            --n;
+        }
+        exp = ptr_data_->exp;
+        negative = mpd_isnegative(ptr_data_);
+    }
+
+    bytes.push_back(static_cast<uint8_t>((negative ? BYTES_SIGN_BIT : 0) | n));
+    internal::AppendVarint(exp, bytes);
+    for (size_t i = n; i > 0; --i) {
+        bytes.push_back(coeff[i - 1]);
+    }
+}
+
+BigDecimal BigDecimal::FromBytes(const uint8_t* data, size_t size, size_t* consumed) {
+    mpd_context_t ctx;
+    std::string error_msg;
+    uint32_t status = 0;
+    int64_t exp = 0;
+    size_t pos = 1;
+    FixedDecimal value;
+
+    if (!data || size == 0) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                  "Invalid parameter! data must not be empty.");
+    }
+
+    bool negative = (data[0] & BYTES_SIGN_BIT) != 0;
+    size_t n = data[0] & ~BYTES_SIGN_BIT;
+    if (n > BYTES_MAX_COEFF || !internal::ReadVarint(data, size, pos, exp) || size - pos < n ||
+        (!consumed && size - pos != n) || exp > SSGX_MAX_EXP + SSGX_MAX_PREC || exp < SSGX_MIN_EXP - SSGX_MAX_PREC) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2,
+                                                  "Invalid parameter! data is not an encoded decimal.");
+    }
+    const uint8_t* coeff = data + pos;
+    if (consumed) {
+        *consumed = pos + n;
+    }
+
+    if (n <= 16 && internal::IsFixedExp(exp)) {
+        internal::uint128_t c = 0;
+        for (size_t i = 0; i < n; ++i) {
+            c = (c << 8) | coeff[i];
+        }
+        if (c < internal::Pow10Table()[FIXED_MAX_DIGITS]) {
+            value.coeff = c;
+            value.exp = exp;
+            value.negative = negative;
+            return FromFixed(value);
+        }
+    }
+
+    // Import the coefficient in words of 16 bits, least significant first, then check the value as the strings are
+    uint16_t words[BYTES_MAX_COEFF / 2] = {0};
+    for (size_t i = 0; i < n; ++i) {
+        words[i / 2] |= static_cast<uint16_t>(coeff[n - 1 - i] << (8 * (i % 2)));
+    }
+    SetDefaultContext(&ctx);
+    MpdResult result(&ctx);
+    mpd_qimport_u16(result.Get(), words, n == 0 ? 1 : (n + 1) / 2, negative ? MPD_NEG : MPD_POS, 1U << 16, &ctx,
+                    &status);
+    result.Get()->exp = exp;
+    mpd_qfinalize(result.Get(), &ctx, &status);
+    ctx.status = status;
+    if (!CheckContextStatus(&ctx, false, error_msg)) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -3, error_msg.c_str());
+    }
+
+    return FromMpd(result.Release());
+}
+
+BigDecimal BigDecimal::FromInt64(int64_t value) {
+    FixedDecimal x;
+
+    x.negative = value < 0;
+    x.coeff = x.negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    x.exp = 0;
+    return FromFixed(x);
+}
+
+int64_t BigDecimal::ToInt64() const {
+    FixedDecimal x;
+
+    if (!GetFixed(x)) {
+        uint32_t status = 0;
+        int64_t value = mpd_qget_i64(ptr_data_, &status);
+        if (status & MPD_Invalid_operation) {
+            throw ssgx::exception_t::LocatedException(
+                __FILE__, __LINE__, __FUNCTION__, -1,
+                "Invalid operation! The value is not an integer, or is out of the range of int64_t.");
+        }
+        return value;
+    }
+
+    internal::uint128_t magnitude = x.coeff;
+    if (x.exp > 0 && !internal::ScaleUp(x.coeff, x.exp, magnitude)) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2,
+                                                  "Invalid operation! The value is out of the range of int64_t.");
+    }
+    if (x.exp < 0) {
+        // The digits dropped must all be 0
+        uint32_t rem = 0;
+        for (int64_t left = -x.exp; left > 0 && magnitude != 0;) {
+            int chunk = left > 9 ? 9 : static_cast<int>(left);
+            magnitude = internal::DivSmall(magnitude, internal::POW10_U32[chunk], rem);
+            if (rem != 0) {
+                throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -3,
+                                                          "Invalid operation! The value is not an integer.");
+            }
+            left -= chunk;
+        }
+    }
+    internal::uint128_t limit = static_cast<uint64_t>(INT64_MAX) + (x.negative ? 1 : 0);
+    if (magnitude > limit) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2,
+                                                  "Invalid operation! The value is out of the range of int64_t.");
+    }
+    return x.negative ? static_cast<int64_t>(0 - static_cast<uint64_t>(magnitude)) : static_cast<int64_t>(magnitude);
+}
+
 int BigDecimal::Compare(const BigDecimal& num) const {
     int ret = 0;
     mpd_context_t ctx;
+    FixedDecimal x, y;
 
-    ASSERT_THROW(num.ptr_data_);
-    ASSERT_THROW(ptr_data_);
+    if (GetFixed(x) && num.GetFixed(y)) {
+        return internal::FixedCompare(x, y);
+    }
 
     SetDefaultContext(&ctx);
 
@@ -563,7 +1242,7 @@ int BigDecimal::Compare(const BigDecimal& num) const {
     // The MPD_Invalid_operation condition is added to status if at least
     // one of the operands is a signaling NaN. In this case, result is set
     // to NaN and INT_MAX is returned.
-    ret = mpd_cmp(ptr_data_, num.ptr_data_, &ctx);
+    ret = mpd_cmp(MpdOperand(*this).Get(), MpdOperand(num).Get(), &ctx);
 
     // Show an exception if is an invalid operation.
     if (ret == INT_MAX) {
@@ -588,5 +1267,357 @@ void BigDecimal::SetDefaultContext(mpd_context_t* ptr_ctx) {
     }
 }
 
+bool BigDecimal::GetFixed(FixedDecimal& value) const {
+    if (ptr_data_) {
+        return false;
+    }
+    value.coeff = (static_cast<internal::uint128_t>(coeff_hi_) << 64) | coeff_lo_;
+    value.exp = exponent_;
+    value.negative = negative_;
+    return true;
+}
+
+BigDecimal BigDecimal::FromFixed(const FixedDecimal& value) {
+    BigDecimal result;
+    result.coeff_lo_ = static_cast<uint64_t>(value.coeff);
+    result.coeff_hi_ = static_cast<uint64_t>(value.coeff >> 64);
+    result.exponent_ = static_cast<int32_t>(value.exp);
+    result.negative_ = value.negative;
+    return result;
+}
+
+BigDecimal BigDecimal::FromMpd(mpd_t* ptr) {
+    FixedDecimal value;
+
+    // Hold finite values which fit inline, reading the coefficient from its words of MPD_RADIX
+    if (mpd_isfinite(ptr) && ptr->digits <= FIXED_MAX_DIGITS && internal::IsFixedExp(ptr->exp)) {
+        value.coeff = 0;
+        for (mpd_ssize_t i = ptr->len - 1; i >= 0; --i) {
+            value.coeff = value.coeff * MPD_RADIX + ptr->data[i];
+        }
+        value.exp = ptr->exp;
+        value.negative = mpd_isnegative(ptr);
+        mpd_del(ptr);
+        return FromFixed(value);
+    }
+
+    BigDecimal result;
+    result.ptr_data_ = ptr;
+    return result;
+}
+
+mpd_t* BigDecimal::NewMpd() const {
+    mpd_context_t ctx;
+    std::string error_msg;
+    mpd_t* ptr = nullptr;
+    FixedDecimal value;
+
+    SetDefaultContext(&ctx);
+    if (!(ptr = mpd_new(&ctx))) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                  "A malloc error! Failed to call mpd_new().");
+    }
+
+    if (GetFixed(value)) {
+        // Import the coefficient in words of 16 bits, least significant first, as FromBytes() does: this needs no
+        // 128-bit division. The exponent and the sign, that of zero included, are set as they are.
+        uint16_t words[sizeof(value.coeff) / 2];
+        size_t word_count = 1;
+        for (size_t i = 0; i < sizeof(value.coeff) / 2; ++i) {
+            words[i] = static_cast<uint16_t>(value.coeff >> (16 * i));
+            if (words[i] != 0) {
+                word_count = i + 1;
+            }
+        }
+        uint32_t status = 0;
+        uint8_t sign = value.negative ? MPD_NEG : MPD_POS;
+        mpd_qimport_u16(ptr, words, word_count, sign, 1U << 16, &ctx, &status);
+        mpd_set_sign(ptr, sign);
+        ptr->exp = value.exp;
+        mpd_qfinalize(ptr, &ctx, &status);
+        ctx.status |= status;
+    } else {
+        mpd_copy(ptr, ptr_data_, &ctx);
+    }
+    if (!CheckContextStatus(&ctx, false, error_msg)) {
+        mpd_del(ptr);
+        ptr = nullptr;
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -2, error_msg.c_str());
+    }
+    return ptr;
+}
+
+/**
+ * @brief Set the context in which DecimalAccumulator adds, which rounds only the sums of more than
+ * SSGX_DECIMAL_ACCUMULATOR_PREC digits
+ */
+static void SetAccumulatorContext(mpd_context_t* ptr_ctx) {
+    mpd_maxcontext(ptr_ctx);
+    ptr_ctx->prec = SSGX_DECIMAL_ACCUMULATOR_PREC;
+    ptr_ctx->emax = SSGX_MAX_EXP;
+    ptr_ctx->emin = SSGX_MIN_EXP;
+    ptr_ctx->round = MPD_ROUND_HALF_UP;
+}
+
+DecimalAccumulator::DecimalAccumulator() : ptr_sum_(nullptr), status_(0) {
+}
+
+DecimalAccumulator::~DecimalAccumulator() {
+    if (ptr_sum_) {
+        mpd_del(ptr_sum_);
+        ptr_sum_ = nullptr;
+    }
+}
+
+void DecimalAccumulator::Add(const BigDecimal& num) {
+    mpd_context_t ctx;
+    FixedDecimal x, y, z;
+
+    if (fixed_sum_.GetFixed(x) && num.GetFixed(y) && internal::FixedAdd(x, y, MPD_ROUND_HALF_UP, z)) {
+        fixed_sum_ = BigDecimal::FromFixed(z);
+        return;
+    }
+
+    SetAccumulatorContext(&ctx);
+    mpd_t* sum = MpdSum();
+    mpd_qadd(sum, sum, MpdOperand(num).Get(), &ctx, &status_);
+}
+
+void DecimalAccumulator::AddProduct(const BigDecimal& x, const BigDecimal& y) {
+    mpd_context_t ctx;
+    FixedDecimal fx, fy, product, sum, z;
+
+    if (x.GetFixed(fx) && y.GetFixed(fy) && internal::FixedMultiply(fx, fy, product) && fixed_sum_.GetFixed(sum) &&
+        internal::FixedAdd(sum, product, MPD_ROUND_HALF_UP, z)) {
+        fixed_sum_ = BigDecimal::FromFixed(z);
+        return;
+    }
+
+    SetAccumulatorContext(&ctx);
+    mpd_t* total = MpdSum();
+    mpd_qfma(total, MpdOperand(x).Get(), MpdOperand(y).Get(), total, &ctx, &status_);
+}
+
+void DecimalAccumulator::Merge(const DecimalAccumulator& other) {
+    mpd_context_t ctx;
+
+    if (this == &other) {
+        // Add the whole sum to the mpdecimal part, which doubles it
+        MpdResult total(NewTotal(&status_));
+        SetAccumulatorContext(&ctx);
+        mpd_t* sum = MpdSum();
+        mpd_qadd(sum, sum, total.Get(), &ctx, &status_);
+        return;
+    }
+
+    Add(other.fixed_sum_);
+    if (other.ptr_sum_) {
+        SetAccumulatorContext(&ctx);
+        mpd_t* sum = MpdSum();
+        mpd_qadd(sum, sum, other.ptr_sum_, &ctx, &status_);
+    }
+    status_ |= other.status_;
+}
+
+BigDecimal DecimalAccumulator::Result() const {
+    mpd_context_t ctx;
+    std::string error_msg;
+    uint32_t status = 0;
+
+    if (!ptr_sum_ && status_ == 0) {
+        return fixed_sum_;
+    }
+
+    MpdResult result(NewTotal(&status));
+    BigDecimal::SetDefaultContext(&ctx);
+    mpd_qfinalize(result.Get(), &ctx, &status);
+    ctx.status = status;
+    if (!CheckContextStatus(&ctx, false, error_msg)) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
+    }
+
+    return BigDecimal::FromMpd(result.Release());
+}
+
+BigDecimal DecimalAccumulator::Result(const Precision& prec) const {
+    std::string error_msg;
+    mpd_context_t ctx = *prec.Get();
+    uint32_t status = 0;
+
+    if (!ptr_sum_ && status_ == 0) {
+        return fixed_sum_.SetScale(prec.scale_, (RoundType)ctx.round);
+    }
+
+    MpdResult result(NewTotal(&status));
+    mpd_qfinalize(result.Get(), &ctx, &status);
+    ctx.status = status;
+    if (!CheckContextStatus(&ctx, true, error_msg)) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
+    }
+
+    return BigDecimal::FromMpd(result.Release()).SetScale(prec.scale_, (RoundType)ctx.round);
+}
+
+BigDecimal DecimalAccumulator::Quotient(const DecimalAccumulator& dividend, const DecimalAccumulator& divisor,
+                                        const Precision* prec) {
+    mpd_context_t ctx;
+    std::string error_msg;
+    uint32_t status = 0;
+
+    if (prec) {
+        ctx = *prec->Get();
+    } else {
+        BigDecimal::SetDefaultContext(&ctx);
+    }
+    MpdResult x(dividend.NewTotal(&status));
+    MpdResult y(divisor.NewTotal(&status));
+    MpdResult result(&ctx);
+    mpd_qdiv(result.Get(), x.Get(), y.Get(), &ctx, &status);
+    ctx.status = status;
+    if (!CheckContextStatus(&ctx, prec != nullptr, error_msg)) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
+    }
+
+    if (prec) {
+        return BigDecimal::FromMpd(result.Release()).SetScale(prec->scale_, (RoundType)ctx.round);
+    }
+    return BigDecimal::FromMpd(result.Release());
+}
+
+mpd_t* DecimalAccumulator::NewTotal(uint32_t* status) const {
+    mpd_context_t ctx;
+
+    SetAccumulatorContext(&ctx);
+    MpdResult total(&ctx);
+    *status |= status_;
+    if (ptr_sum_) {
+        mpd_qadd(total.Get(), ptr_sum_, MpdOperand(fixed_sum_).Get(), &ctx, status);
+    } else {
+        mpd_qcopy(total.Get(), MpdOperand(fixed_sum_).Get(), status);
+    }
+    return total.Release();
+}
+
+mpd_t* DecimalAccumulator::MpdSum() {
+    mpd_context_t ctx;
+
+    if (!ptr_sum_) {
+        SetAccumulatorContext(&ctx);
+        MpdResult sum(&ctx);
+        mpd_qset_ssize(sum.Get(), 0, &ctx, &status_);
+        ptr_sum_ = sum.Release();
+    }
+    return ptr_sum_;
+}
+
+BigDecimal Sum(const std::vector<BigDecimal>& values) {
+    DecimalAccumulator sum;
+    for (const BigDecimal& value : values) {
+        sum.Add(value);
+    }
+    return sum.Result();
+}
+
+BigDecimal Sum(const std::vector<BigDecimal>& values, const Precision& prec) {
+    DecimalAccumulator sum;
+    for (const BigDecimal& value : values) {
+        sum.Add(value);
+    }
+    return sum.Result(prec);
+}
+
+BigDecimal DotProduct(const std::vector<BigDecimal>& x, const std::vector<BigDecimal>& y) {
+    if (x.size() != y.size()) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                  "Invalid parameter! x and y must be of the same size.");
+    }
+
+    DecimalAccumulator sum;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sum.AddProduct(x[i], y[i]);
+    }
+    return sum.Result();
+}
+
+BigDecimal DotProduct(const std::vector<BigDecimal>& x, const std::vector<BigDecimal>& y, const Precision& prec) {
+    if (x.size() != y.size()) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                  "Invalid parameter! x and y must be of the same size.");
+    }
+
+    DecimalAccumulator sum;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sum.AddProduct(x[i], y[i]);
+    }
+    return sum.Result(prec);
+}
+
+BigDecimal WeightedAverage(const std::vector<BigDecimal>& values, const std::vector<BigDecimal>& weights) {
+    DecimalAccumulator numerator;
+    DecimalAccumulator denominator;
+
+    if (values.size() != weights.size()) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                  "Invalid parameter! values and weights must be of the same size.");
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        numerator.AddProduct(values[i], weights[i]);
+        denominator.Add(weights[i]);
+    }
+    return DecimalAccumulator::Quotient(numerator, denominator, nullptr);
+}
+
+BigDecimal WeightedAverage(const std::vector<BigDecimal>& values, const std::vector<BigDecimal>& weights,
+                           const Precision& prec) {
+    DecimalAccumulator numerator;
+    DecimalAccumulator denominator;
+
+    if (values.size() != weights.size()) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1,
+                                                  "Invalid parameter! values and weights must be of the same size.");
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        numerator.AddProduct(values[i], weights[i]);
+        denominator.Add(weights[i]);
+    }
+    return DecimalAccumulator::Quotient(numerator, denominator, &prec);
+}
+
+std::vector<BigDecimal> ScaleAll(const std::vector<BigDecimal>& values, const Precision& prec) {
+    std::vector<BigDecimal> results;
+    std::string scale_str = "1e";
+    mpd_context_t ctx;
+    std::string error_msg;
+    uint32_t status = 0;
+    FixedDecimal x, z;
+
+    // The context and the quantum are shared by all the values held by mpdecimal
+    BigDecimal::SetDefaultContext(&ctx);
+    ctx.round = prec.Get()->round;
+    MpdResult scale_num(&ctx);
+    scale_str += std::to_string(-prec.scale_);
+    mpd_qset_string(scale_num.Get(), scale_str.c_str(), &ctx, &status);
+
+    results.reserve(values.size());
+    for (const BigDecimal& value : values) {
+        if (value.GetFixed(x) && internal::FixedQuantize(x, -static_cast<int64_t>(prec.scale_), ctx.round, z)) {
+            results.push_back(BigDecimal::FromFixed(z));
+            continue;
+        }
+        MpdResult result(&ctx);
+        mpd_qquantize(result.Get(), MpdOperand(value).Get(), scale_num.Get(), &ctx, &status);
+        results.push_back(BigDecimal::FromMpd(result.Release()));
+    }
+
+    ctx.status = status;
+    if (!CheckContextStatus(&ctx, true, error_msg)) {
+        throw ssgx::exception_t::LocatedException(__FILE__, __LINE__, __FUNCTION__, -1, error_msg.c_str());
+    }
+
+    return results;
+}
+
 } // namespace decimal_t
-} // namespace ssgx
\ No newline at end of file
+} // namespace ssgx
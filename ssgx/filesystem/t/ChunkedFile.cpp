@@ -0,0 +1,612 @@
+#include <algorithm>
+#include <cstring>
+
+#include "sgx_lfence.h"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include "sgx_utils.h"
+
+#include "ssgx_filesystem_t.h"
+#include "ssgx_filesystem_t_t.h"
+#include "ssgx_utils_t.h"
+
+#include "../../common/internal_check.h"
+#include "FileMetaData.h"
+#include "filesystem_constant.h"
+
+namespace ssgx {
+namespace filesystem_t {
+namespace detail {
+
+static constexpr size_t CHUNK_TAG_SIZE = sizeof(sgx_aes_gcm_128bit_tag_t);
+static constexpr size_t CHUNK_IV_SIZE = 12;
+static constexpr size_t CHUNK_AAD_SIZE = 16;
+
+// The index and trailer MACs use IVs no chunk index can reach
+static constexpr uint64_t INDEX_IV_INDEX = UINT64_MAX - 1;
+static constexpr uint64_t TRAILER_IV_INDEX = UINT64_MAX;
+
+// Offsets of the trailer fields
+static constexpr size_t TRAILER_VERSION_OFFSET = 8;
+static constexpr size_t TRAILER_CHUNK_SIZE_OFFSET = 12;
+static constexpr size_t TRAILER_DATA_SIZE_OFFSET = 16;
+static constexpr size_t TRAILER_CHUNK_COUNT_OFFSET = 24;
+static constexpr size_t TRAILER_INDEX_MAC_OFFSET = 32;
+static constexpr size_t TRAILER_MAC_OFFSET = 48;
+
+static void PutUint32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+static void PutUint64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+static uint32_t GetUint32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint64_t GetUint64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// IV of a chunk: chunk index (8 bytes, little endian) | 0 (4 bytes)
+static void ChunkIv(uint64_t index, uint8_t iv[CHUNK_IV_SIZE]) {
+    PutUint64(iv, index);
+    PutUint32(iv + 8, 0);
+}
+
+// AAD of a chunk: file tag (8 bytes) | chunk index (8 bytes, little endian)
+static void ChunkAad(uint64_t index, uint8_t aad[CHUNK_AAD_SIZE]) {
+    memcpy(aad, FS_CHUNKED_FILE_TAG, sizeof(FS_CHUNKED_FILE_TAG));
+    PutUint64(aad + 8, index);
+}
+
+// Get the seal key of key_request and derive the file key from it
+static void DeriveFileKey(const sgx_key_request_t& key_request, uint8_t key[16]) {
+    sgx_key_128bit_t seal_key = {0};
+    sgx_status_t status = sgx_get_key(&key_request, &seal_key);
+    if (status != SGX_SUCCESS) {
+        throw FileSystemException("Failed to get seal key");
+    }
+
+    sgx_cmac_128bit_tag_t file_key = {0};
+    status = sgx_rijndael128_cmac_msg(&seal_key, reinterpret_cast<const uint8_t*>(FS_CHUNKED_FILE_KEY_LABEL),
+                                      static_cast<uint32_t>(strlen(FS_CHUNKED_FILE_KEY_LABEL)), &file_key);
+    memset_s(seal_key, sizeof(sgx_key_128bit_t), 0, sizeof(sgx_key_128bit_t));
+    if (status != SGX_SUCCESS) {
+        throw FileSystemException("Failed to derive the file key");
+    }
+    memcpy(key, file_key, sizeof(file_key));
+    memset_s(file_key, sizeof(file_key), 0, sizeof(file_key));
+}
+
+static void CheckOcall(const char* function, sgx_status_t sgx_status, int ret) {
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Failed to call function %s(), sgx status: 0x%x", function, sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function %s() return errors, error code: %d", function, ret));
+    }
+}
+
+// Read exactly size bytes at offset into an untrusted buffer
+static void ReadExact(uint64_t handle, uint64_t offset, uint8_t* buffer, size_t size) {
+    int ret = 0;
+    size_t read_size = 0;
+    CheckOcall("ssgx_ocall_plain_file_read",
+               ssgx_ocall_plain_file_read(&ret, handle, offset, buffer, size, &read_size), ret);
+    if (read_size != size) {
+        throw FileSystemException("Invalid chunked file, unexpected end of file");
+    }
+    sgx_lfence();
+}
+
+// Write size bytes at offset from an untrusted buffer
+static void WriteExact(uint64_t handle, uint64_t offset, const uint8_t* buffer, size_t size) {
+    int ret = 0;
+    CheckOcall("ssgx_ocall_plain_file_write_at", ssgx_ocall_plain_file_write_at(&ret, handle, offset, buffer, size),
+               ret);
+}
+
+static uint8_t* MallocOutsideOrThrow(size_t size) {
+    auto* buffer = static_cast<uint8_t*>(utils_t::MallocOutsidePooled(size));
+    if (!buffer) {
+        throw FileSystemException("Failed to allocate a buffer outside the enclave");
+    }
+    return buffer;
+}
+
+} // namespace detail
+
+ChunkedFileWriter::ChunkedFileWriter(const char* file_name, FileMode file_mode, uint16_t key_policy,
+                                     size_t chunk_size)
+    : handle_(0), chunk_size_(chunk_size), key_{0}, failed_(false) {
+    int ret = 0;
+    uint64_t file_size = 0;
+
+    if (!file_name) {
+        throw FileSystemException("File name cannot be null");
+    }
+    if (!is_valid_key_policy(key_policy)) {
+        throw FileSystemException("Invalid parameter, key_policy is invalid");
+    }
+    if (chunk_size < FS_CHUNKED_FILE_MIN_CHUNK_SIZE || chunk_size > FS_CHUNKED_FILE_MAX_CHUNK_SIZE) {
+        throw FileSystemException("Invalid parameter, chunk_size must be from 4 KB to 16 MB");
+    }
+    // Appending would encrypt chunks twice with the same key and IV
+    if (file_mode != FileMode::CreateNew && file_mode != FileMode::OpenOrCreate) {
+        throw FileSystemException("Invalid file mode, a chunked file can only be created");
+    }
+    file_name_ = file_name;
+
+    Path metadata_file{file_name};
+    metadata_file += FS_METADATA_FILE_EXT;
+    if (file_mode == FileMode::CreateNew && (Exists(Path(file_name)) || Exists(metadata_file))) {
+        throw FileSystemException("The file already exists");
+    }
+
+    // Each file gets its own key, from a random key_id
+    const sgx_report_t* report = sgx_self_report();
+    if (!report) {
+        throw FileSystemException("Failed to get self Enclave Report");
+    }
+    sgx_key_id_t key_id = {0};
+    if (sgx_read_rand(key_id.id, sizeof(key_id)) != SGX_SUCCESS) {
+        throw FileSystemException("Failed to read random number generator");
+    }
+    FileMetaData metadata(0, key_policy, key_id, report->body.isv_svn, report->body.cpu_svn);
+    detail::DeriveFileKey(metadata.GetKeyRequest(), key_);
+
+    try {
+        detail::CheckOcall(
+            "ssgx_ocall_plain_file_open",
+            ssgx_ocall_plain_file_open(&ret, file_name, static_cast<int>(file_mode), &handle_, &file_size), ret);
+    } catch (...) {
+        Release();
+        throw;
+    }
+
+    if (!metadata.ToFile(metadata_file.String())) {
+        Release();
+        Remove(Path(file_name));
+        throw FileSystemException("Failed to create metadata file");
+    }
+}
+
+ChunkedFileWriter::~ChunkedFileWriter() {
+    Release();
+}
+
+size_t ChunkedFileWriter::ChunkSize() const {
+    return chunk_size_;
+}
+
+uint8_t* ChunkedFileWriter::AcquireBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!buffers_.empty()) {
+            uint8_t* buffer = buffers_.back();
+            buffers_.pop_back();
+            return buffer;
+        }
+    }
+    return detail::MallocOutsideOrThrow(chunk_size_);
+}
+
+void ChunkedFileWriter::ReleaseBuffer(uint8_t* buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(buffer);
+}
+
+void ChunkedFileWriter::Release() {
+    for (uint8_t* buffer : buffers_) {
+        utils_t::FreeOutside(buffer, chunk_size_);
+    }
+    buffers_.clear();
+    if (handle_ != 0) {
+        int ret = 0;
+        ssgx_ocall_plain_file_close(&ret, handle_);
+        handle_ = 0;
+    }
+    memset_s(key_, sizeof(key_), 0, sizeof(key_));
+}
+
+void ChunkedFileWriter::WriteChunk(uint64_t index, const void* data, size_t size) {
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    if (!data || size == 0 || size > chunk_size_) {
+        throw FileSystemException("Invalid write parameters");
+    }
+    if (index >= FS_CHUNKED_FILE_MAX_CHUNKS) {
+        throw FileSystemException("Invalid parameter, chunk index is too large");
+    }
+
+    // Claim the index, so that no two calls encrypt it
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index < chunk_sizes_.size() && chunk_sizes_[index] != 0) {
+            throw FileSystemException(
+                ssgx::utils_t::FormatStr("Chunk %llu has been written", static_cast<unsigned long long>(index)));
+        }
+        if (index >= chunk_sizes_.size()) {
+            chunk_sizes_.resize(index + 1, 0);
+            tags_.resize((index + 1) * detail::CHUNK_TAG_SIZE, 0);
+        }
+        chunk_sizes_[index] = static_cast<uint32_t>(size);
+    }
+
+    // Encrypt straight into the untrusted buffer, the ciphertext may be seen by the host
+    uint8_t iv[detail::CHUNK_IV_SIZE] = {0};
+    uint8_t aad[detail::CHUNK_AAD_SIZE] = {0};
+    sgx_aes_gcm_128bit_tag_t tag = {0};
+    detail::ChunkIv(index, iv);
+    detail::ChunkAad(index, aad);
+
+    uint8_t* buffer = AcquireBuffer();
+    try {
+        const sgx_status_t status = sgx_rijndael128GCM_encrypt(
+            reinterpret_cast<const sgx_aes_gcm_128bit_key_t*>(key_), static_cast<const uint8_t*>(data),
+            static_cast<uint32_t>(size), buffer, iv, sizeof(iv), aad, sizeof(aad), &tag);
+        if (status != SGX_SUCCESS) {
+            throw FileSystemException(ssgx::utils_t::FormatStr("Failed to encrypt the chunk, sgx status: 0x%x", status));
+        }
+        detail::WriteExact(handle_, index * chunk_size_, buffer, size);
+    } catch (...) {
+        ReleaseBuffer(buffer);
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ = true;
+        throw;
+    }
+    ReleaseBuffer(buffer);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    memcpy(tags_.data() + index * detail::CHUNK_TAG_SIZE, tag, sizeof(tag));
+}
+
+void ChunkedFileWriter::Close() {
+    int ret = 0;
+
+    if (handle_ == 0) {
+        return;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_) {
+            throw FileSystemException("A chunk failed to be written, the file is incomplete");
+        }
+
+        // Every chunk must be there, and only the last one may be short
+        const uint64_t chunk_count = chunk_sizes_.size();
+        uint64_t data_size = 0;
+        for (uint64_t i = 0; i < chunk_count; i++) {
+            if (chunk_sizes_[i] == 0) {
+                throw FileSystemException(
+                    ssgx::utils_t::FormatStr("Chunk %llu is missing", static_cast<unsigned long long>(i)));
+            }
+            if (i + 1 < chunk_count && chunk_sizes_[i] != chunk_size_) {
+                throw FileSystemException(ssgx::utils_t::FormatStr("Chunk %llu is shorter than the chunk size",
+                                                                   static_cast<unsigned long long>(i)));
+            }
+            data_size += chunk_sizes_[i];
+        }
+
+        // index | trailer
+        std::vector<uint8_t> tail(tags_);
+        const size_t trailer_offset = tail.size();
+        tail.resize(trailer_offset + FS_CHUNKED_FILE_TRAILER_SIZE, 0);
+        uint8_t* trailer = tail.data() + trailer_offset;
+        memcpy(trailer, FS_CHUNKED_FILE_TAG, sizeof(FS_CHUNKED_FILE_TAG));
+        detail::PutUint32(trailer + detail::TRAILER_VERSION_OFFSET, FS_CHUNKED_FILE_VERSION);
+        detail::PutUint32(trailer + detail::TRAILER_CHUNK_SIZE_OFFSET, static_cast<uint32_t>(chunk_size_));
+        detail::PutUint64(trailer + detail::TRAILER_DATA_SIZE_OFFSET, data_size);
+        detail::PutUint64(trailer + detail::TRAILER_CHUNK_COUNT_OFFSET, chunk_count);
+
+        // The index MAC covers the trailer fields and the index, the trailer MAC covers the trailer fields and the
+        // index MAC, so a reader authenticates the small trailer before it allocates anything for the index
+        std::vector<uint8_t> signed_index(trailer, trailer + detail::TRAILER_INDEX_MAC_OFFSET);
+        signed_index.insert(signed_index.end(), tags_.begin(), tags_.end());
+        uint8_t iv[detail::CHUNK_IV_SIZE] = {0};
+        detail::ChunkIv(detail::INDEX_IV_INDEX, iv);
+        sgx_status_t status = sgx_rijndael128GCM_encrypt(
+            reinterpret_cast<const sgx_aes_gcm_128bit_key_t*>(key_), nullptr, 0, nullptr, iv, sizeof(iv),
+            signed_index.data(), static_cast<uint32_t>(signed_index.size()),
+            reinterpret_cast<sgx_aes_gcm_128bit_tag_t*>(trailer + detail::TRAILER_INDEX_MAC_OFFSET));
+        if (status != SGX_SUCCESS) {
+            throw FileSystemException(ssgx::utils_t::FormatStr("Failed to sign the index, sgx status: 0x%x", status));
+        }
+
+        detail::ChunkIv(detail::TRAILER_IV_INDEX, iv);
+        status = sgx_rijndael128GCM_encrypt(
+            reinterpret_cast<const sgx_aes_gcm_128bit_key_t*>(key_), nullptr, 0, nullptr, iv, sizeof(iv), trailer,
+            static_cast<uint32_t>(detail::TRAILER_MAC_OFFSET),
+            reinterpret_cast<sgx_aes_gcm_128bit_tag_t*>(trailer + detail::TRAILER_MAC_OFFSET));
+        if (status != SGX_SUCCESS) {
+            throw FileSystemException(ssgx::utils_t::FormatStr("Failed to sign the trailer, sgx status: 0x%x", status));
+        }
+
+        // Chunks take exactly data_size bytes, the tail follows them
+        uint8_t* buffer = nullptr;
+        if (buffers_.empty()) {
+            buffers_.push_back(detail::MallocOutsideOrThrow(chunk_size_));
+        }
+        buffer = buffers_.back();
+        for (size_t offset = 0; offset < tail.size(); offset += chunk_size_) {
+            const size_t size = std::min(chunk_size_, tail.size() - offset);
+            memcpy(buffer, tail.data() + offset, size);
+            detail::WriteExact(handle_, data_size + offset, buffer, size);
+        }
+
+        detail::CheckOcall("ssgx_ocall_plain_file_flush", ssgx_ocall_plain_file_flush(&ret, handle_), ret);
+        const uint64_t handle = handle_;
+        handle_ = 0;
+        detail::CheckOcall("ssgx_ocall_plain_file_close", ssgx_ocall_plain_file_close(&ret, handle), ret);
+
+        // The file can't be opened without its metadata, which was written by the constructor
+        Path metadata_file{file_name_.c_str()};
+        metadata_file += FS_METADATA_FILE_EXT;
+        detail::CheckOcall("ssgx_ocall_sync_path", ssgx_ocall_sync_path(&ret, metadata_file.String().c_str()), ret);
+    } catch (...) {
+        Release();
+        throw;
+    }
+    Release();
+}
+
+ChunkedFileReader::ChunkedFileReader(const char* file_name)
+    : handle_(0), chunk_size_(0), data_size_(0), chunk_count_(0), key_{0} {
+    int ret = 0;
+    uint64_t file_size = 0;
+
+    if (!file_name) {
+        throw FileSystemException("File name cannot be null");
+    }
+
+    Path metadata_file{file_name};
+    metadata_file += FS_METADATA_FILE_EXT;
+    std::optional<FileMetaData> metadata = FileMetaData::FromFile(metadata_file.String());
+    if (!metadata.has_value()) {
+        throw FileSystemException("Failed to read the metadata file");
+    }
+    if (metadata.value().GetLegacyMode() != 0) {
+        throw FileSystemException("Invalid metadata file, it doesn't belong to a chunked file");
+    }
+    detail::DeriveFileKey(metadata.value().GetKeyRequest(), key_);
+
+    try {
+        detail::CheckOcall("ssgx_ocall_plain_file_open",
+                           ssgx_ocall_plain_file_open(&ret, file_name, 0, &handle_, &file_size), ret);
+
+        if (file_size < FS_CHUNKED_FILE_TRAILER_SIZE) {
+            throw FileSystemException("Invalid chunked file, it is too short");
+        }
+
+        // The trailer is read before the chunk size is known, through a small buffer of its own
+        uint8_t trailer[FS_CHUNKED_FILE_TRAILER_SIZE] = {0};
+        uint8_t* buffer = detail::MallocOutsideOrThrow(sizeof(trailer));
+        try {
+            detail::ReadExact(handle_, file_size - sizeof(trailer), buffer, sizeof(trailer));
+            memcpy(trailer, buffer, sizeof(trailer));
+        } catch (...) {
+            utils_t::FreeOutside(buffer, sizeof(trailer));
+            throw;
+        }
+        utils_t::FreeOutside(buffer, sizeof(trailer));
+
+        // Authenticate the trailer before trusting its fields, the index buffer is sized by them
+        uint8_t iv[detail::CHUNK_IV_SIZE] = {0};
+        detail::ChunkIv(detail::TRAILER_IV_INDEX, iv);
+        sgx_status_t status = sgx_rijndael128GCM_decrypt(
+            reinterpret_cast<const sgx_aes_gcm_128bit_key_t*>(key_), nullptr, 0, nullptr, iv, sizeof(iv), trailer,
+            static_cast<uint32_t>(detail::TRAILER_MAC_OFFSET),
+            reinterpret_cast<const sgx_aes_gcm_128bit_tag_t*>(trailer + detail::TRAILER_MAC_OFFSET));
+        if (status != SGX_SUCCESS) {
+            throw FileSystemException("Invalid chunked file, the trailer fails to authenticate");
+        }
+
+        const uint32_t version = detail::GetUint32(trailer + detail::TRAILER_VERSION_OFFSET);
+        const uint32_t chunk_size = detail::GetUint32(trailer + detail::TRAILER_CHUNK_SIZE_OFFSET);
+        const uint64_t data_size = detail::GetUint64(trailer + detail::TRAILER_DATA_SIZE_OFFSET);
+        const uint64_t chunk_count = detail::GetUint64(trailer + detail::TRAILER_CHUNK_COUNT_OFFSET);
+        if (memcmp(trailer, FS_CHUNKED_FILE_TAG, sizeof(FS_CHUNKED_FILE_TAG)) != 0 ||
+            version != FS_CHUNKED_FILE_VERSION) {
+            throw FileSystemException("Invalid chunked file, unknown trailer");
+        }
+        if (chunk_size < FS_CHUNKED_FILE_MIN_CHUNK_SIZE || chunk_size > FS_CHUNKED_FILE_MAX_CHUNK_SIZE ||
+            chunk_count > FS_CHUNKED_FILE_MAX_CHUNKS || (data_size + chunk_size - 1) / chunk_size != chunk_count ||
+            file_size != data_size + chunk_count * detail::CHUNK_TAG_SIZE + FS_CHUNKED_FILE_TRAILER_SIZE) {
+            throw FileSystemException("Invalid chunked file, inconsistent trailer");
+        }
+        sgx_lfence();
+        chunk_size_ = chunk_size;
+        data_size_ = data_size;
+        chunk_count_ = chunk_count;
+
+        // trailer fields | index
+        const size_t index_size = chunk_count * detail::CHUNK_TAG_SIZE;
+        std::vector<uint8_t> tail(detail::TRAILER_INDEX_MAC_OFFSET + index_size);
+        memcpy(tail.data(), trailer, detail::TRAILER_INDEX_MAC_OFFSET);
+        if (index_size > 0) {
+            buffer = AcquireBuffer();
+            try {
+                for (size_t offset = 0; offset < index_size; offset += chunk_size_) {
+                    const size_t size = std::min(chunk_size_, index_size - offset);
+                    detail::ReadExact(handle_, data_size + offset, buffer, size);
+                    memcpy(tail.data() + detail::TRAILER_INDEX_MAC_OFFSET + offset, buffer, size);
+                }
+            } catch (...) {
+                ReleaseBuffer(buffer);
+                throw;
+            }
+            ReleaseBuffer(buffer);
+        }
+
+        detail::ChunkIv(detail::INDEX_IV_INDEX, iv);
+        status = sgx_rijndael128GCM_decrypt(
+            reinterpret_cast<const sgx_aes_gcm_128bit_key_t*>(key_), nullptr, 0, nullptr, iv, sizeof(iv), tail.data(),
+            static_cast<uint32_t>(tail.size()),
+            reinterpret_cast<const sgx_aes_gcm_128bit_tag_t*>(trailer + detail::TRAILER_INDEX_MAC_OFFSET));
+        if (status != SGX_SUCCESS) {
+            throw FileSystemException("Invalid chunked file, the index fails to authenticate");
+        }
+
+        tail.erase(tail.begin(), tail.begin() + detail::TRAILER_INDEX_MAC_OFFSET);
+        tags_.swap(tail);
+    } catch (...) {
+        Release();
+        throw;
+    }
+}
+
+ChunkedFileReader::~ChunkedFileReader() {
+    Release();
+}
+
+uint64_t ChunkedFileReader::Size() const {
+    return data_size_;
+}
+
+size_t ChunkedFileReader::ChunkSize() const {
+    return chunk_size_;
+}
+
+uint64_t ChunkedFileReader::ChunkCount() const {
+    return chunk_count_;
+}
+
+uint8_t* ChunkedFileReader::AcquireBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!buffers_.empty()) {
+            uint8_t* buffer = buffers_.back();
+            buffers_.pop_back();
+            return buffer;
+        }
+    }
+    return detail::MallocOutsideOrThrow(chunk_size_);
+}
+
+void ChunkedFileReader::ReleaseBuffer(uint8_t* buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(buffer);
+}
+
+void ChunkedFileReader::Release() {
+    for (uint8_t* buffer : buffers_) {
+        utils_t::FreeOutside(buffer, chunk_size_);
+    }
+    buffers_.clear();
+    if (handle_ != 0) {
+        int ret = 0;
+        ssgx_ocall_plain_file_close(&ret, handle_);
+        handle_ = 0;
+    }
+    memset_s(key_, sizeof(key_), 0, sizeof(key_));
+}
+
+size_t ChunkedFileReader::ReadChunk(uint64_t index, void* buffer, size_t size) {
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    if (index >= chunk_count_) {
+        throw FileSystemException("Invalid parameter, chunk index is out of range");
+    }
+    const size_t chunk_size = (index + 1 < chunk_count_) ? chunk_size_ : data_size_ - index * chunk_size_;
+    if (!buffer || size < chunk_size) {
+        throw FileSystemException("Invalid parameter, the buffer is smaller than the chunk");
+    }
+
+    // Decrypt a copy in the enclave, the host may change its buffer at any time
+    std::vector<uint8_t> ciphertext(chunk_size);
+    uint8_t* outside = AcquireBuffer();
+    try {
+        detail::ReadExact(handle_, index * chunk_size_, outside, chunk_size);
+        memcpy(ciphertext.data(), outside, chunk_size);
+    } catch (...) {
+        ReleaseBuffer(outside);
+        throw;
+    }
+    ReleaseBuffer(outside);
+
+    uint8_t iv[detail::CHUNK_IV_SIZE] = {0};
+    uint8_t aad[detail::CHUNK_AAD_SIZE] = {0};
+    detail::ChunkIv(index, iv);
+    detail::ChunkAad(index, aad);
+    const sgx_status_t status = sgx_rijndael128GCM_decrypt(
+        reinterpret_cast<const sgx_aes_gcm_128bit_key_t*>(key_), ciphertext.data(), static_cast<uint32_t>(chunk_size),
+        static_cast<uint8_t*>(buffer), iv, sizeof(iv), aad, sizeof(aad),
+        reinterpret_cast<const sgx_aes_gcm_128bit_tag_t*>(tags_.data() + index * detail::CHUNK_TAG_SIZE));
+    if (status != SGX_SUCCESS) {
+        memset(buffer, 0, chunk_size);
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Chunk %llu fails to authenticate", static_cast<unsigned long long>(index)));
+    }
+    return chunk_size;
+}
+
+size_t ChunkedFileReader::Read(uint64_t offset, void* buffer, size_t size) {
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    if (!buffer && size > 0) {
+        throw FileSystemException("Invalid read parameters");
+    }
+    if (offset >= data_size_) {
+        return 0;
+    }
+    size = static_cast<size_t>(std::min<uint64_t>(size, data_size_ - offset));
+
+    // Whole chunks are decrypted in place, partial ones through a chunk buffer
+    auto* out = static_cast<uint8_t*>(buffer);
+    std::vector<uint8_t> chunk;
+    size_t total_read = 0;
+    while (total_read < size) {
+        const uint64_t pos = offset + total_read;
+        const uint64_t index = pos / chunk_size_;
+        const size_t in_chunk = static_cast<size_t>(pos % chunk_size_);
+        const size_t chunk_size = (index + 1 < chunk_count_) ? chunk_size_ : data_size_ - index * chunk_size_;
+        const size_t count = std::min(size - total_read, chunk_size - in_chunk);
+        if (in_chunk == 0 && count == chunk_size) {
+            ReadChunk(index, out + total_read, count);
+        } else {
+            chunk.resize(chunk_size_);
+            ReadChunk(index, chunk.data(), chunk.size());
+            memcpy(out + total_read, chunk.data() + in_chunk, count);
+        }
+        total_read += count;
+    }
+    return total_read;
+}
+
+void ChunkedFileReader::Close() {
+    int ret = 0;
+
+    if (handle_ == 0) {
+        return;
+    }
+
+    const uint64_t handle = handle_;
+    handle_ = 0;
+    const sgx_status_t sgx_status = ssgx_ocall_plain_file_close(&ret, handle);
+    Release();
+    detail::CheckOcall("ssgx_ocall_plain_file_close", sgx_status, ret);
+}
+
+} // namespace filesystem_t
+} // namespace ssgx
@@ -0,0 +1,1146 @@
+#include <algorithm>
+#include <cstring>
+
+#include "sgx_tseal.h"
+
+#include "ssgx_filesystem_t.h"
+#include "ssgx_filesystem_t_kv_store.h"
+#include "ssgx_filesystem_t_t.h"
+#include "ssgx_utils_t.h"
+
+#include "../../common/internal_check.h"
+#include "filesystem_constant.h"
+
+namespace ssgx {
+namespace filesystem_t {
+namespace detail {
+
+using KvMemTable = std::map<std::string, std::optional<std::string>>;
+
+// Entry: key size(4) | value size(4), with KV_TOMBSTONE set if the key is deleted | key | value
+static constexpr size_t KV_ENTRY_HEADER_SIZE = 8;
+static constexpr uint32_t KV_TOMBSTONE = 0x80000000U;
+
+// Segment footer: tag(8) | version(4) | bloom probes(4) | segment id(8) | entry count(8) | index offset(8) |
+// bloom offset(8)
+static constexpr size_t KV_SEGMENT_FOOTER_SIZE = 48;
+
+// Manifest: tag(8) | version(4) | reserved(4) | generation(8) | next file id(8) | WAL id(8) | segment count(4) |
+// obsolete count(4) | segment ids(8 each) | obsolete ids(8 each)
+static constexpr size_t KV_MANIFEST_HEADER_SIZE = 48;
+
+// WAL record: sealed size(4) | sealed data, whose MAC text is tag(8) | WAL id(8) | sequence number(8)
+static constexpr size_t KV_WAL_MAC_TEXT_SIZE = 24;
+static constexpr uint8_t KV_WAL_PUT = 1;
+static constexpr uint8_t KV_WAL_DELETE = 2;
+static constexpr size_t KV_WAL_MAX_RECORD_SIZE = FS_KV_STORE_MAX_KEY_SIZE + FS_KV_STORE_MAX_VALUE_SIZE + 1024;
+
+static void AppendUint32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static void AppendUint64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static void AppendBytes(std::vector<uint8_t>& out, const std::string& s) {
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+static uint32_t GetUint32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint64_t GetUint64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// FNV-1a, with the MurmurHash3 finalizer so that both halves mix all bits
+static uint64_t KvHash(const std::string& key) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Bloom filter probes by double hashing
+static void BloomAdd(std::vector<uint8_t>& bloom, uint32_t probes, uint64_t hash) {
+    const uint64_t bits = bloom.size() * 8;
+    const uint64_t delta = (hash >> 32) | 1;
+    uint64_t h = hash;
+    for (uint32_t i = 0; i < probes; i++, h += delta) {
+        bloom[(h % bits) / 8] |= static_cast<uint8_t>(1 << (h % 8));
+    }
+}
+
+static bool BloomMayContain(const std::vector<uint8_t>& bloom, uint32_t probes, uint64_t hash) {
+    if (bloom.empty()) {
+        return true;
+    }
+    const uint64_t bits = bloom.size() * 8;
+    const uint64_t delta = (hash >> 32) | 1;
+    uint64_t h = hash;
+    for (uint32_t i = 0; i < probes; i++, h += delta) {
+        if ((bloom[(h % bits) / 8] & (1 << (h % 8))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ApplyToMemTable(KvMemTable& memtable, size_t& memtable_bytes, const std::string& key,
+                            const std::optional<std::string>& value) {
+    auto it = memtable.find(key);
+    if (it != memtable.end()) {
+        memtable_bytes -= it->second.has_value() ? it->second->size() : 0;
+        it->second = value;
+    } else {
+        memtable.emplace(key, value);
+        memtable_bytes += key.size() + KV_ENTRY_HEADER_SIZE;
+    }
+    memtable_bytes += value.has_value() ? value->size() : 0;
+}
+
+// Whether dir holds a file whose name ends with extension
+static bool HasFileWithExtension(const std::string& dir, const char* extension) {
+    int ret = 0;
+    uint32_t found = 0;
+    const sgx_status_t status = ssgx_ocall_directory_has_extension(&ret, dir.c_str(), extension, &found);
+    if (status != SGX_SUCCESS || ret < 0) {
+        throw FileSystemException(ssgx::utils_t::FormatStr("Failed to list the files of %s", dir.c_str()));
+    }
+    return found != 0;
+}
+
+// Flush the entries of dir to disk, so that the files created in it survive a power loss
+static bool SyncDirectory(const std::string& dir) {
+    int ret = 0;
+    const sgx_status_t status = ssgx_ocall_sync_path(&ret, dir.c_str());
+    return status == SGX_SUCCESS && ret >= 0;
+}
+
+/**
+ * An open segment: its entries are read from the chunked file, its sparse index and bloom filter are kept in the
+ * enclave.
+ */
+struct KvSegment {
+    uint64_t id = 0;
+    std::unique_ptr<ChunkedFileReader> file;
+    uint64_t entry_count = 0;
+    uint64_t data_size = 0; // Entries take [0, data_size)
+    std::vector<std::string> index_keys;
+    std::vector<uint64_t> index_offsets;
+    std::vector<uint8_t> bloom;
+    uint32_t bloom_probes = 0;
+
+    static std::shared_ptr<KvSegment> Open(const std::string& path, uint64_t id);
+
+    // Offset of the block where key would be
+    uint64_t BlockOffset(const std::string& key) const {
+        auto it = std::upper_bound(index_keys.begin(), index_keys.end(), key);
+        return it == index_keys.begin() ? 0 : index_offsets[it - index_keys.begin() - 1];
+    }
+
+    bool Find(const std::string& key, std::optional<std::string>& value) const;
+};
+
+// Reads the entries of a segment in [offset, end) in order
+class KvSegmentCursor {
+  public:
+    KvSegmentCursor(const KvSegment* segment, uint64_t offset, uint64_t end)
+        : segment_(segment), offset_(offset), end_(end), pos_(0) {
+    }
+
+    bool Next(std::string& key, std::optional<std::string>& value) {
+        if (pos_ == buffer_.size() && offset_ == end_) {
+            return false;
+        }
+        Fill(KV_ENTRY_HEADER_SIZE);
+        const uint32_t key_size = GetUint32(buffer_.data() + pos_);
+        const uint32_t value_field = GetUint32(buffer_.data() + pos_ + 4);
+        const uint32_t value_size = value_field & ~KV_TOMBSTONE;
+        if (key_size > FS_KV_STORE_MAX_KEY_SIZE || value_size > FS_KV_STORE_MAX_VALUE_SIZE) {
+            throw FileSystemException("Invalid segment, the entry is too large");
+        }
+        pos_ += KV_ENTRY_HEADER_SIZE;
+
+        Fill(key_size + value_size);
+        const char* p = reinterpret_cast<const char*>(buffer_.data() + pos_);
+        key.assign(p, key_size);
+        if (value_field & KV_TOMBSTONE) {
+            value.reset();
+        } else {
+            value.emplace(p + key_size, value_size);
+        }
+        pos_ += key_size + value_size;
+        return true;
+    }
+
+  private:
+    // Make sure size bytes are buffered from pos_
+    void Fill(size_t size) {
+        const size_t buffered = buffer_.size() - pos_;
+        if (buffered >= size) {
+            return;
+        }
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(pos_));
+        pos_ = 0;
+
+        const uint64_t read_size = std::min<uint64_t>(std::max(size - buffered, FS_KV_STORE_READ_SIZE), end_ - offset_);
+        if (buffered + read_size < size) {
+            throw FileSystemException("Invalid segment, an entry is truncated");
+        }
+        buffer_.resize(buffered + read_size);
+        if (segment_->file->Read(offset_, buffer_.data() + buffered, read_size) != read_size) {
+            throw FileSystemException("Invalid segment, unexpected end of data");
+        }
+        offset_ += read_size;
+    }
+
+    const KvSegment* segment_;
+    uint64_t offset_; // Next offset to read
+    uint64_t end_;
+    std::vector<uint8_t> buffer_;
+    size_t pos_;
+};
+
+std::shared_ptr<KvSegment> KvSegment::Open(const std::string& path, uint64_t id) {
+    auto segment = std::make_shared<KvSegment>();
+    segment->id = id;
+    segment->file = std::make_unique<ChunkedFileReader>(path.c_str());
+
+    const uint64_t size = segment->file->Size();
+    if (size < KV_SEGMENT_FOOTER_SIZE) {
+        throw FileSystemException("Invalid segment, it is too short");
+    }
+    uint8_t footer[KV_SEGMENT_FOOTER_SIZE] = {0};
+    if (segment->file->Read(size - sizeof(footer), footer, sizeof(footer)) != sizeof(footer)) {
+        throw FileSystemException("Invalid segment, unexpected end of data");
+    }
+    if (memcmp(footer, FS_KV_STORE_SEGMENT_TAG, sizeof(FS_KV_STORE_SEGMENT_TAG)) != 0 ||
+        GetUint32(footer + 8) != FS_KV_STORE_VERSION) {
+        throw FileSystemException("Invalid segment, unknown footer");
+    }
+    // The id is checked, so the host cannot swap two segments
+    if (GetUint64(footer + 16) != id) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Invalid segment, it is not segment %llu", static_cast<unsigned long long>(id)));
+    }
+    segment->bloom_probes = GetUint32(footer + 12);
+    segment->entry_count = GetUint64(footer + 24);
+    const uint64_t index_offset = GetUint64(footer + 32);
+    const uint64_t bloom_offset = GetUint64(footer + 40);
+    if (index_offset > bloom_offset || bloom_offset > size - sizeof(footer)) {
+        throw FileSystemException("Invalid segment, inconsistent footer");
+    }
+    segment->data_size = index_offset;
+
+    // index count(4) | key size(4) | key | offset(8) ... | bloom filter
+    std::vector<uint8_t> tail(size - sizeof(footer) - index_offset);
+    if (segment->file->Read(index_offset, tail.data(), tail.size()) != tail.size()) {
+        throw FileSystemException("Invalid segment, unexpected end of data");
+    }
+    const size_t index_size = bloom_offset - index_offset;
+    if (index_size < 4) {
+        throw FileSystemException("Invalid segment, inconsistent index");
+    }
+    const uint32_t count = GetUint32(tail.data());
+    size_t pos = 4;
+    for (uint32_t i = 0; i < count; i++) {
+        if (index_size - pos < 4) {
+            throw FileSystemException("Invalid segment, inconsistent index");
+        }
+        const uint32_t key_size = GetUint32(tail.data() + pos);
+        pos += 4;
+        if (index_size - pos < static_cast<uint64_t>(key_size) + 8) {
+            throw FileSystemException("Invalid segment, inconsistent index");
+        }
+        segment->index_keys.emplace_back(reinterpret_cast<const char*>(tail.data() + pos), key_size);
+        pos += key_size;
+        const uint64_t offset = GetUint64(tail.data() + pos);
+        pos += 8;
+        if (offset >= index_offset || (!segment->index_offsets.empty() && offset <= segment->index_offsets.back())) {
+            throw FileSystemException("Invalid segment, inconsistent index");
+        }
+        segment->index_offsets.push_back(offset);
+    }
+    if (pos != index_size) {
+        throw FileSystemException("Invalid segment, inconsistent index");
+    }
+    segment->bloom.assign(tail.begin() + static_cast<std::ptrdiff_t>(index_size), tail.end());
+    return segment;
+}
+
+bool KvSegment::Find(const std::string& key, std::optional<std::string>& value) const {
+    if (!BloomMayContain(bloom, bloom_probes, KvHash(key))) {
+        return false;
+    }
+    auto it = std::upper_bound(index_keys.begin(), index_keys.end(), key);
+    if (it == index_keys.begin()) {
+        return false;
+    }
+
+    // Only the block of key is read
+    const size_t block = it - index_keys.begin() - 1;
+    const uint64_t end = block + 1 < index_offsets.size() ? index_offsets[block + 1] : data_size;
+    KvSegmentCursor cursor(this, index_offsets[block], end);
+    std::string entry_key;
+    while (cursor.Next(entry_key, value)) {
+        if (entry_key == key) {
+            return true;
+        }
+        if (entry_key > key) {
+            break;
+        }
+    }
+    value.reset();
+    return false;
+}
+
+// Merges a memtable and segments from `begin` on, the newest value of a key wins
+class KvMergeIterator {
+  public:
+    KvMergeIterator(const std::vector<std::shared_ptr<KvSegment>>& segments, const std::string& begin,
+                    KvMemTable::const_iterator memtable_begin, KvMemTable::const_iterator memtable_end)
+        : memtable_it_(memtable_begin), memtable_end_(memtable_end) {
+        // Source 0 is the memtable, then segments from the newest one
+        for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+            cursors_.emplace_back(it->get(), (*it)->BlockOffset(begin), (*it)->data_size);
+        }
+        heads_.resize(cursors_.size() + 1);
+        for (size_t i = 0; i < heads_.size(); i++) {
+            Advance(i);
+            while (heads_[i].valid && heads_[i].key < begin) {
+                Advance(i);
+            }
+        }
+    }
+
+    bool Next(std::string& key, std::optional<std::string>& value) {
+        size_t winner = heads_.size();
+        for (size_t i = 0; i < heads_.size(); i++) {
+            if (heads_[i].valid && (winner == heads_.size() || heads_[i].key < heads_[winner].key)) {
+                winner = i;
+            }
+        }
+        if (winner == heads_.size()) {
+            return false;
+        }
+
+        key = heads_[winner].key;
+        value = std::move(heads_[winner].value);
+        for (size_t i = 0; i < heads_.size(); i++) {
+            if (heads_[i].valid && heads_[i].key == key) {
+                Advance(i);
+            }
+        }
+        return true;
+    }
+
+  private:
+    struct Head {
+        bool valid = false;
+        std::string key;
+        std::optional<std::string> value;
+    };
+
+    void Advance(size_t source) {
+        Head& head = heads_[source];
+        if (source > 0) {
+            head.valid = cursors_[source - 1].Next(head.key, head.value);
+        } else if (memtable_it_ != memtable_end_) {
+            head.valid = true;
+            head.key = memtable_it_->first;
+            head.value = memtable_it_->second;
+            ++memtable_it_;
+        } else {
+            head.valid = false;
+        }
+    }
+
+    KvMemTable::const_iterator memtable_it_;
+    KvMemTable::const_iterator memtable_end_;
+    std::vector<KvSegmentCursor> cursors_;
+    std::vector<Head> heads_;
+};
+
+// Writes the plaintext of a segment chunk by chunk
+class KvSegmentBuilder {
+  public:
+    KvSegmentBuilder(const std::string& path, uint16_t key_policy)
+        : writer_(path.c_str(), FileMode::CreateNew, key_policy, FS_KV_STORE_CHUNK_SIZE), chunk_index_(0), offset_(0) {
+        chunk_.reserve(FS_KV_STORE_CHUNK_SIZE);
+    }
+
+    uint64_t Offset() const {
+        return offset_;
+    }
+
+    void Append(const uint8_t* data, size_t size) {
+        offset_ += size;
+        while (size > 0) {
+            const size_t n = std::min(size, FS_KV_STORE_CHUNK_SIZE - chunk_.size());
+            chunk_.insert(chunk_.end(), data, data + n);
+            data += n;
+            size -= n;
+            if (chunk_.size() == FS_KV_STORE_CHUNK_SIZE) {
+                writer_.WriteChunk(chunk_index_++, chunk_.data(), chunk_.size());
+                chunk_.clear();
+            }
+        }
+    }
+
+    void Append(const std::vector<uint8_t>& data) {
+        Append(data.data(), data.size());
+    }
+
+    void Append(const std::string& data) {
+        Append(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    void Finish() {
+        if (!chunk_.empty()) {
+            writer_.WriteChunk(chunk_index_++, chunk_.data(), chunk_.size());
+            chunk_.clear();
+        }
+        writer_.Close();
+    }
+
+  private:
+    ChunkedFileWriter writer_;
+    std::vector<uint8_t> chunk_;
+    uint64_t chunk_index_;
+    uint64_t offset_;
+};
+
+} // namespace detail
+
+KvStore::KvStore(const std::string& dir, const KvStoreOptions& options)
+    : dir_(dir), options_(options), wal_id_(0), wal_seq_(0), generation_(0), memtable_bytes_(0), next_file_id_(1) {
+    if (dir.empty()) {
+        throw FileSystemException("The input directory is empty");
+    }
+    if (!is_valid_key_policy(options.key_policy)) {
+        throw FileSystemException("Invalid parameter, key_policy is invalid");
+    }
+    if (options.memtable_size == 0 || options.compaction_trigger < 2 || options.bloom_bits_per_key > 64) {
+        throw FileSystemException("Invalid parameter, options are out of range");
+    }
+
+    Path dir_path(dir.c_str());
+    if (!Exists(dir_path)) {
+        CreateDirectory(dir_path);
+    }
+
+    // An exclusive lock on LOCK keeps other stores out of dir
+    Path lock_file(dir.c_str());
+    lock_file /= Path("LOCK");
+    auto lock = std::make_unique<PlainFileWriter>(lock_file.String());
+    lock->Open(FileMode::OpenOrCreate);
+
+    try {
+        std::lock_guard<std::mutex> write_lock(write_mutex_);
+        LoadManifest();
+        // Replayed updates go to a segment, new ones to a new WAL
+        FlushLocked();
+    } catch (...) {
+        wal_.reset();
+        segments_.clear();
+        memtable_.clear();
+        throw;
+    }
+    lock_ = std::move(lock);
+}
+
+KvStore::~KvStore() {
+    try {
+        Close();
+    } catch (...) {
+    }
+}
+
+std::string KvStore::FilePath(uint64_t id, const char* extension) const {
+    Path path(dir_.c_str());
+    path /= Path(ssgx::utils_t::FormatStr("%06llu%s", static_cast<unsigned long long>(id), extension).c_str());
+    return path.String();
+}
+
+void KvStore::RemoveSegmentFile(uint64_t id) const {
+    Path segment_file(FilePath(id, ".seg").c_str());
+    Path metadata_file(segment_file);
+    metadata_file += FS_METADATA_FILE_EXT;
+    Remove(segment_file);
+    Remove(metadata_file);
+}
+
+uint64_t KvStore::AllocateFileId() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = next_file_id_++;
+    pending_ids_.insert(id);
+    return id;
+}
+
+void KvStore::LoadManifest() {
+    bool found = false;
+    uint64_t next_file_id = 1;
+    std::vector<uint64_t> segment_ids;
+    std::vector<uint64_t> obsolete_ids;
+
+    // Take the newest of the two manifests which authenticate, a crash may have left the other one torn
+    for (int slot = 0; slot < 2; slot++) {
+        const std::string path = FilePath(slot, ".manifest");
+        if (!Exists(Path(path.c_str()))) {
+            continue;
+        }
+        std::vector<uint8_t> data;
+        try {
+            ChunkedFileReader reader(path.c_str());
+            if (reader.Size() < detail::KV_MANIFEST_HEADER_SIZE || reader.Size() > FS_KV_STORE_MAX_MANIFEST_SIZE) {
+                continue;
+            }
+            data.resize(reader.Size());
+            if (reader.Read(0, data.data(), data.size()) != data.size()) {
+                continue;
+            }
+        } catch (const FileSystemException&) {
+            continue;
+        }
+
+        const uint8_t* p = data.data();
+        const uint64_t generation = detail::GetUint64(p + 16);
+        const uint32_t segment_count = detail::GetUint32(p + 40);
+        const uint32_t obsolete_count = detail::GetUint32(p + 44);
+        if (memcmp(p, FS_KV_STORE_MANIFEST_TAG, sizeof(FS_KV_STORE_MANIFEST_TAG)) != 0 ||
+            detail::GetUint32(p + 8) != FS_KV_STORE_VERSION || generation % 2 != static_cast<uint64_t>(slot) ||
+            data.size() !=
+                detail::KV_MANIFEST_HEADER_SIZE + (static_cast<uint64_t>(segment_count) + obsolete_count) * 8) {
+            throw FileSystemException("Invalid manifest, inconsistent header");
+        }
+        if (found && generation <= generation_) {
+            continue;
+        }
+
+        found = true;
+        generation_ = generation;
+        next_file_id = detail::GetUint64(p + 24);
+        wal_id_ = detail::GetUint64(p + 32);
+        segment_ids.clear();
+        obsolete_ids.clear();
+        p += detail::KV_MANIFEST_HEADER_SIZE;
+        for (uint32_t i = 0; i < segment_count; i++, p += 8) {
+            segment_ids.push_back(detail::GetUint64(p));
+        }
+        for (uint32_t i = 0; i < obsolete_count; i++, p += 8) {
+            obsolete_ids.push_back(detail::GetUint64(p));
+        }
+    }
+
+    if (!found) {
+        // The first commit goes to slot 1, slot 0 exists only after it has succeeded
+        if (Exists(Path(FilePath(0, ".manifest").c_str()))) {
+            throw FileSystemException("Invalid store, no manifest can be authenticated");
+        }
+        // A first open which crashed before its commit leaves an empty WAL 1 at most. Other segments or WALs mean
+        // that the manifests are lost, and starting afresh would hide their data, then remove it.
+        Path first_wal(FilePath(1, ".wal").c_str());
+        if (Exists(first_wal) && FileSize(first_wal) == 0) {
+            Remove(first_wal);
+        }
+        if (detail::HasFileWithExtension(dir_, ".seg") || detail::HasFileWithExtension(dir_, ".wal")) {
+            throw FileSystemException("Invalid store, it has segments or WALs but no manifest");
+        }
+    }
+
+    for (uint64_t id : segment_ids) {
+        segments_.push_back(detail::KvSegment::Open(FilePath(id, ".seg"), id));
+    }
+    RemoveUnreferenced(next_file_id, obsolete_ids);
+    if (wal_id_ != 0) {
+        ReplayWal(wal_id_);
+    }
+}
+
+void KvStore::RemoveUnreferenced(uint64_t first_id, const std::vector<uint64_t>& obsolete_ids) {
+    std::set<uint64_t> referenced{wal_id_};
+    for (const auto& segment : segments_) {
+        referenced.insert(segment->id);
+    }
+
+    // Files the last commit replaced
+    for (uint64_t id : obsolete_ids) {
+        if (referenced.count(id) == 0) {
+            RemoveSegmentFile(id);
+            Remove(Path(FilePath(id, ".wal").c_str()));
+        }
+    }
+
+    // Files created after the last commit, which never made it to a manifest
+    const uint64_t last_referenced = *referenced.rbegin();
+    uint64_t id = first_id;
+    for (uint64_t missing = 0; missing < FS_KV_STORE_ORPHAN_PROBE || id <= last_referenced; id++) {
+        if (referenced.count(id) != 0) {
+            missing = 0;
+            continue;
+        }
+        Path segment_file(FilePath(id, ".seg").c_str());
+        Path metadata_file(segment_file);
+        metadata_file += FS_METADATA_FILE_EXT;
+        const bool found_segment = Remove(segment_file);
+        const bool found_metadata = Remove(metadata_file);
+        const bool found_wal = Remove(Path(FilePath(id, ".wal").c_str()));
+        missing = (found_segment || found_metadata || found_wal) ? 0 : missing + 1;
+    }
+    next_file_id_ = id;
+}
+
+bool KvStore::CommitManifest(const std::vector<std::shared_ptr<detail::KvSegment>>& segments, uint64_t wal_id,
+                             const std::vector<uint64_t>& obsolete_ids, bool& in_doubt) {
+    // Files being written by others must stay above next file id, so that a crash leaves them to be removed
+    uint64_t next_file_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_file_id = pending_ids_.empty() ? next_file_id_ : std::min(*pending_ids_.begin(), next_file_id_);
+    }
+
+    const uint64_t generation = generation_ + 1;
+    std::vector<uint8_t> data(FS_KV_STORE_MANIFEST_TAG, FS_KV_STORE_MANIFEST_TAG + sizeof(FS_KV_STORE_MANIFEST_TAG));
+    detail::AppendUint32(data, FS_KV_STORE_VERSION);
+    detail::AppendUint32(data, 0);
+    detail::AppendUint64(data, generation);
+    detail::AppendUint64(data, next_file_id);
+    detail::AppendUint64(data, wal_id);
+    detail::AppendUint32(data, static_cast<uint32_t>(segments.size()));
+    detail::AppendUint32(data, static_cast<uint32_t>(obsolete_ids.size() + deferred_ids_.size()));
+    for (const auto& segment : segments) {
+        detail::AppendUint64(data, segment->id);
+    }
+    for (uint64_t id : obsolete_ids) {
+        detail::AppendUint64(data, id);
+    }
+    for (uint64_t id : deferred_ids_) {
+        detail::AppendUint64(data, id);
+    }
+    if (data.size() > FS_KV_STORE_MAX_MANIFEST_SIZE) {
+        throw FileSystemException("Too many segments, the manifest is too large");
+    }
+
+    // Write the slot of the older manifest, the current one stays valid until Close() has flushed this one. From
+    // here on, a failure may leave this one valid on disk as well.
+    in_doubt = true;
+    ChunkedFileWriter writer(FilePath(generation % 2, ".manifest").c_str(), FileMode::OpenOrCreate,
+                             options_.key_policy, FS_CHUNKED_FILE_MIN_CHUNK_SIZE);
+    for (size_t offset = 0, index = 0; offset < data.size(); offset += FS_CHUNKED_FILE_MIN_CHUNK_SIZE, index++) {
+        writer.WriteChunk(index, data.data() + offset, std::min(FS_CHUNKED_FILE_MIN_CHUNK_SIZE, data.size() - offset));
+    }
+    writer.Close();
+    generation_ = generation;
+    in_doubt = false;
+
+    // Close() has flushed the manifest and the segments are flushed likewise, but their directory entries may still
+    // be in memory only. Until they are on disk, a power loss may bring back the previous manifest, so the files it
+    // needs are kept until a later commit is durable.
+    if (!detail::SyncDirectory(dir_)) {
+        deferred_ids_.insert(deferred_ids_.end(), obsolete_ids.begin(), obsolete_ids.end());
+        return false;
+    }
+    std::vector<uint64_t> deferred_ids;
+    deferred_ids.swap(deferred_ids_);
+    try {
+        for (uint64_t id : deferred_ids) {
+            RemoveSegmentFile(id);
+            Remove(Path(FilePath(id, ".wal").c_str()));
+        }
+    } catch (const FileSystemException&) {
+        // They are listed as obsolete in the manifest, the next open removes them
+    }
+    return true;
+}
+
+std::shared_ptr<detail::KvSegment> KvStore::WriteSegment(
+    uint64_t id, const std::vector<std::shared_ptr<detail::KvSegment>>& sources, const MemTable* memtable,
+    bool drop_deleted) const {
+    const std::string path = FilePath(id, ".seg");
+    {
+        detail::KvSegmentBuilder builder(path, options_.key_policy);
+        const MemTable empty;
+        detail::KvMergeIterator it(sources, std::string(), memtable ? memtable->begin() : empty.begin(),
+                                   memtable ? memtable->end() : empty.end());
+
+        std::vector<uint8_t> index;
+        uint32_t index_count = 0;
+        uint64_t block_offset = 0;
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> header;
+        std::string key;
+        std::optional<std::string> value;
+        while (it.Next(key, value)) {
+            if (drop_deleted && !value.has_value()) {
+                continue;
+            }
+            // A sparse index entry per block
+            if (index_count == 0 || builder.Offset() - block_offset >= FS_KV_STORE_BLOCK_SIZE) {
+                block_offset = builder.Offset();
+                detail::AppendUint32(index, static_cast<uint32_t>(key.size()));
+                detail::AppendBytes(index, key);
+                detail::AppendUint64(index, block_offset);
+                index_count++;
+            }
+            header.clear();
+            detail::AppendUint32(header, static_cast<uint32_t>(key.size()));
+            detail::AppendUint32(header,
+                                 value.has_value() ? static_cast<uint32_t>(value->size()) : detail::KV_TOMBSTONE);
+            builder.Append(header);
+            builder.Append(key);
+            if (value.has_value()) {
+                builder.Append(value.value());
+            }
+            hashes.push_back(detail::KvHash(key));
+        }
+
+        // index | bloom filter | footer
+        const uint64_t index_offset = builder.Offset();
+        header.clear();
+        detail::AppendUint32(header, index_count);
+        builder.Append(header);
+        builder.Append(index);
+
+        const uint64_t bloom_offset = builder.Offset();
+        uint32_t probes = 0;
+        if (options_.bloom_bits_per_key > 0 && !hashes.empty()) {
+            // k = ln2 * bits per key is the optimum
+            probes = static_cast<uint32_t>(
+                std::min<size_t>(std::max<size_t>(options_.bloom_bits_per_key * 69 / 100, 1), 30));
+            std::vector<uint8_t> bloom((std::max<size_t>(hashes.size() * options_.bloom_bits_per_key, 64) + 7) / 8, 0);
+            for (uint64_t hash : hashes) {
+                detail::BloomAdd(bloom, probes, hash);
+            }
+            builder.Append(bloom);
+        }
+
+        std::vector<uint8_t> footer(FS_KV_STORE_SEGMENT_TAG, FS_KV_STORE_SEGMENT_TAG + sizeof(FS_KV_STORE_SEGMENT_TAG));
+        detail::AppendUint32(footer, FS_KV_STORE_VERSION);
+        detail::AppendUint32(footer, probes);
+        detail::AppendUint64(footer, id);
+        detail::AppendUint64(footer, hashes.size());
+        detail::AppendUint64(footer, index_offset);
+        detail::AppendUint64(footer, bloom_offset);
+        builder.Append(footer);
+        builder.Finish();
+    }
+    return detail::KvSegment::Open(path, id);
+}
+
+void KvStore::AppendWal(const std::string& key, const std::optional<std::string>& value) {
+    // op(1) | key size(4) | key [| value size(4) | value]
+    std::vector<uint8_t> record;
+    record.reserve(1 + 8 + key.size() + (value.has_value() ? value->size() : 0));
+    record.push_back(value.has_value() ? detail::KV_WAL_PUT : detail::KV_WAL_DELETE);
+    detail::AppendUint32(record, static_cast<uint32_t>(key.size()));
+    detail::AppendBytes(record, key);
+    if (value.has_value()) {
+        detail::AppendUint32(record, static_cast<uint32_t>(value->size()));
+        detail::AppendBytes(record, value.value());
+    }
+
+    std::vector<uint8_t> mac_text(FS_KV_STORE_WAL_TAG, FS_KV_STORE_WAL_TAG + sizeof(FS_KV_STORE_WAL_TAG));
+    detail::AppendUint64(mac_text, wal_id_);
+    detail::AppendUint64(mac_text, wal_seq_);
+
+    utils_t::SealHandler seal_handler(options_.key_policy);
+    seal_handler.SetAdditionalMacText(mac_text.data(), static_cast<uint32_t>(mac_text.size()));
+    std::optional<std::vector<uint8_t>> sealed = seal_handler.SealData(record);
+    memset_s(record.data(), record.size(), 0, record.size());
+    if (!sealed.has_value()) {
+        throw FileSystemException("Failed to seal the WAL record: " + seal_handler.GetLastError());
+    }
+
+    std::vector<uint8_t> size;
+    detail::AppendUint32(size, static_cast<uint32_t>(sealed->size()));
+    wal_->Write(size.data(), size.size());
+    wal_->Write(sealed->data(), sealed->size());
+    if (options_.sync) {
+        wal_->Flush();
+    }
+    wal_seq_++;
+}
+
+void KvStore::ReplayWal(uint64_t wal_id) {
+    // The WAL is created before the manifest which lists it
+    const std::string path = FilePath(wal_id, ".wal");
+    if (!Exists(Path(path.c_str()))) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Invalid store, WAL %llu is missing", static_cast<unsigned long long>(wal_id)));
+    }
+
+    PlainFileReader reader(path);
+    reader.Open();
+    utils_t::SealHandler seal_handler;
+    std::vector<uint8_t> expected_mac_text(FS_KV_STORE_WAL_TAG, FS_KV_STORE_WAL_TAG + sizeof(FS_KV_STORE_WAL_TAG));
+    expected_mac_text.reserve(detail::KV_WAL_MAC_TEXT_SIZE);
+    detail::AppendUint64(expected_mac_text, wal_id);
+    for (uint64_t seq = 0;; seq++) {
+        // A crash may leave the last record torn, replay stops there
+        uint8_t size_field[4] = {0};
+        if (reader.Read(size_field, sizeof(size_field)) != sizeof(size_field)) {
+            break;
+        }
+        const uint32_t size = detail::GetUint32(size_field);
+        if (size < sizeof(sgx_sealed_data_t) || size > detail::KV_WAL_MAX_RECORD_SIZE) {
+            break;
+        }
+        std::vector<uint8_t> sealed(size);
+        if (reader.Read(sealed.data(), sealed.size()) != sealed.size()) {
+            break;
+        }
+        const auto* sealed_data = reinterpret_cast<const sgx_sealed_data_t*>(sealed.data());
+        if (sgx_calc_sealed_data_size(sgx_get_add_mac_txt_len(sealed_data), sgx_get_encrypt_txt_len(sealed_data)) !=
+            size) {
+            break;
+        }
+        std::optional<utils_t::UnsealedData> unsealed = seal_handler.UnsealData(sealed);
+        if (!unsealed.has_value()) {
+            break;
+        }
+
+        // A record which authenticates but is out of place has been moved by the host
+        expected_mac_text.resize(sizeof(FS_KV_STORE_WAL_TAG) + 8);
+        detail::AppendUint64(expected_mac_text, seq);
+        if (unsealed->additional_mac_text != expected_mac_text) {
+            throw FileSystemException(ssgx::utils_t::FormatStr("Invalid WAL, record %llu is out of order",
+                                                               static_cast<unsigned long long>(seq)));
+        }
+
+        const std::vector<uint8_t>& record = unsealed->decrypted_text;
+        const uint8_t* p = record.data();
+        const size_t record_size = record.size();
+        if (record_size < 5) {
+            throw FileSystemException("Invalid WAL record");
+        }
+        const uint32_t key_size = detail::GetUint32(p + 1);
+        if (record_size - 5 < key_size) {
+            throw FileSystemException("Invalid WAL record");
+        }
+        std::string key(reinterpret_cast<const char*>(p + 5), key_size);
+        std::optional<std::string> value;
+        size_t pos = 5 + key_size;
+        if (p[0] == detail::KV_WAL_PUT) {
+            if (record_size - pos < 4 || record_size - pos - 4 != detail::GetUint32(p + pos)) {
+                throw FileSystemException("Invalid WAL record");
+            }
+            value.emplace(reinterpret_cast<const char*>(p + pos + 4), record_size - pos - 4);
+        } else if (p[0] != detail::KV_WAL_DELETE || pos != record_size) {
+            throw FileSystemException("Invalid WAL record");
+        }
+        detail::ApplyToMemTable(memtable_, memtable_bytes_, key, value);
+        memset_s(unsealed->decrypted_text.data(), record_size, 0, record_size);
+    }
+    reader.Close();
+}
+
+void KvStore::FlushLocked() {
+    uint64_t segment_id = 0;
+    if (!memtable_.empty()) {
+        segment_id = AllocateFileId();
+    }
+    const uint64_t wal_id = AllocateFileId();
+
+    std::shared_ptr<detail::KvSegment> segment;
+    std::unique_ptr<PlainFileWriter> wal;
+    std::vector<std::shared_ptr<detail::KvSegment>> segments;
+    bool durable = false;
+    bool in_doubt = false;
+    try {
+        // Other writers wait on write_mutex_, so the memtable doesn't change while it is written
+        if (segment_id != 0) {
+            segment = WriteSegment(segment_id, {}, &memtable_, false);
+        }
+        wal = std::make_unique<PlainFileWriter>(FilePath(wal_id, ".wal"));
+        wal->Open(FileMode::CreateNew);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            segments = segments_;
+            pending_ids_.erase(segment_id);
+            pending_ids_.erase(wal_id);
+        }
+        if (segment) {
+            segments.push_back(segment);
+        }
+        std::vector<uint64_t> obsolete_ids;
+        if (wal_id_ != 0) {
+            obsolete_ids.push_back(wal_id_);
+        }
+        durable = CommitManifest(segments, wal_id, obsolete_ids, in_doubt);
+    } catch (...) {
+        wal.reset();
+        segment.reset();
+        if (in_doubt) {
+            // The new manifest may be the one on disk, which needs the new files and no longer the current WAL:
+            // the files go once a later commit is durable, and nothing more is written until the store is opened
+            // again and knows which manifest it has
+            deferred_ids_.push_back(wal_id);
+            if (segment_id != 0) {
+                deferred_ids_.push_back(segment_id);
+            }
+            wal_.reset();
+        } else {
+            Remove(Path(FilePath(wal_id, ".wal").c_str()));
+            if (segment_id != 0) {
+                RemoveSegmentFile(segment_id);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ids_.erase(segment_id);
+        pending_ids_.erase(wal_id);
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        segments_.swap(segments);
+        memtable_.clear();
+        memtable_bytes_ = 0;
+    }
+
+    // The old WAL is in the segment now, it goes once the manifest is durable
+    const uint64_t old_wal_id = wal_id_;
+    wal_.swap(wal);
+    wal_id_ = wal_id;
+    wal_seq_ = 0;
+    try {
+        if (wal) {
+            wal->Close();
+        }
+        if (durable && old_wal_id != 0) {
+            Remove(Path(FilePath(old_wal_id, ".wal").c_str()));
+        }
+    } catch (const FileSystemException&) {
+        // It is listed as obsolete in the manifest, the next open removes it
+    }
+}
+
+void KvStore::Write(const std::string& key, const std::optional<std::string>& value) {
+    if (key.size() > FS_KV_STORE_MAX_KEY_SIZE) {
+        throw FileSystemException("Invalid parameter, the key is too large");
+    }
+    if (value.has_value() && value->size() > FS_KV_STORE_MAX_VALUE_SIZE) {
+        throw FileSystemException("Invalid parameter, the value is too large");
+    }
+
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    if (!wal_) {
+        throw FileSystemException("The store is closed, or its WAL has failed");
+    }
+    try {
+        AppendWal(key, value);
+    } catch (...) {
+        // The WAL may end with part of a record now, nothing must follow it
+        wal_.reset();
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        detail::ApplyToMemTable(memtable_, memtable_bytes_, key, value);
+    }
+    if (memtable_bytes_ >= options_.memtable_size) {
+        try {
+            FlushLocked();
+        } catch (const FileSystemException&) {
+            // The update is in the WAL already, the next write tries again
+        }
+    }
+}
+
+void KvStore::Put(const std::string& key, const std::string& value) {
+    Write(key, value);
+}
+
+void KvStore::Delete(const std::string& key) {
+    Write(key, std::nullopt);
+}
+
+std::optional<std::string> KvStore::Get(const std::string& key) const {
+    std::vector<std::shared_ptr<detail::KvSegment>> segments;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!lock_) {
+            throw FileSystemException("The store is closed");
+        }
+        auto it = memtable_.find(key);
+        if (it != memtable_.end()) {
+            return it->second;
+        }
+        segments = segments_;
+    }
+
+    // Segments stay readable while they are held, even if a compaction has removed them
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        std::optional<std::string> value;
+        if ((*it)->Find(key, value)) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<std::string, std::string>> KvStore::Scan(const std::string& begin, const std::string& end,
+                                                               size_t limit) const {
+    std::vector<std::pair<std::string, std::string>> result;
+    MemTable memtable;
+    std::vector<std::shared_ptr<detail::KvSegment>> segments;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!lock_) {
+            throw FileSystemException("The store is closed");
+        }
+        if (limit == 0 || (!end.empty() && end <= begin)) {
+            return result;
+        }
+        memtable.insert(memtable_.lower_bound(begin), end.empty() ? memtable_.end() : memtable_.lower_bound(end));
+        segments = segments_;
+    }
+
+    detail::KvMergeIterator it(segments, begin, memtable.begin(), memtable.end());
+    std::string key;
+    std::optional<std::string> value;
+    while (result.size() < limit && it.Next(key, value)) {
+        if (!end.empty() && key >= end) {
+            break;
+        }
+        if (value.has_value()) {
+            result.emplace_back(key, std::move(value.value()));
+        }
+    }
+    return result;
+}
+
+void KvStore::Flush() {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    if (!wal_) {
+        throw FileSystemException("The store is closed, or its WAL has failed");
+    }
+    if (!memtable_.empty()) {
+        FlushLocked();
+    }
+}
+
+bool KvStore::NeedsCompaction() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lock_ && segments_.size() >= options_.compaction_trigger;
+}
+
+size_t KvStore::SegmentCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+}
+
+void KvStore::Compact() {
+    std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+    std::vector<std::shared_ptr<detail::KvSegment>> inputs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!lock_) {
+            throw FileSystemException("The store is closed");
+        }
+        inputs = segments_;
+    }
+    if (inputs.empty()) {
+        return;
+    }
+
+    // The inputs are all segments, older than anything written meanwhile: deleted keys can be dropped
+    const uint64_t id = AllocateFileId();
+    std::vector<uint64_t> obsolete_ids;
+    bool durable = false;
+    bool in_doubt = false;
+    try {
+        std::shared_ptr<detail::KvSegment> output = WriteSegment(id, inputs, nullptr, true);
+
+        std::lock_guard<std::mutex> write_lock(write_mutex_);
+        if (!wal_) {
+            throw FileSystemException("The store is closed, or its WAL has failed");
+        }
+        // Flushes only append, so the inputs are still the oldest segments
+        std::vector<std::shared_ptr<detail::KvSegment>> segments{output};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            segments.insert(segments.end(), segments_.begin() + static_cast<std::ptrdiff_t>(inputs.size()),
+                            segments_.end());
+            pending_ids_.erase(id);
+        }
+        for (const auto& input : inputs) {
+            obsolete_ids.push_back(input->id);
+        }
+        durable = CommitManifest(segments, wal_id_, obsolete_ids, in_doubt);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        segments_.swap(segments);
+    } catch (...) {
+        if (in_doubt) {
+            // The new manifest may be the one on disk, the output goes once a later commit is durable. Both
+            // manifests hold the same data, so the store carries on with the inputs.
+            std::lock_guard<std::mutex> write_lock(write_mutex_);
+            deferred_ids_.push_back(id);
+        } else {
+            RemoveSegmentFile(id);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ids_.erase(id);
+        throw;
+    }
+
+    // Otherwise the next durable commit removes them
+    if (!durable) {
+        return;
+    }
+    try {
+        for (uint64_t obsolete_id : obsolete_ids) {
+            RemoveSegmentFile(obsolete_id);
+        }
+    } catch (const FileSystemException&) {
+        // They are listed as obsolete in the manifest, the next open removes them
+    }
+}
+
+void KvStore::Close() {
+    std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::unique_ptr<PlainFileWriter> wal = std::move(wal_);
+    std::unique_ptr<PlainFileWriter> lock;
+    {
+        std::lock_guard<std::mutex> state_lock(mutex_);
+        lock = std::move(lock_);
+        segments_.clear();
+        memtable_.clear();
+        memtable_bytes_ = 0;
+    }
+    if (wal) {
+        wal->Close();
+    }
+    if (lock) {
+        lock->Close();
+    }
+}
+
+} // namespace filesystem_t
+} // namespace ssgx
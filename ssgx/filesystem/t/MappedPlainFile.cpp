@@ -0,0 +1,133 @@
+#include <cstring>
+
+#include "sgx_lfence.h"
+#include "sgx_trts.h"
+
+#include "ssgx_filesystem_t.h"
+#include "ssgx_filesystem_t_t.h"
+#include "ssgx_utils_t.h"
+
+#include "crypto-suites/crypto-hash/sha256.h"
+
+namespace ssgx {
+namespace filesystem_t {
+
+static constexpr size_t SHA256_DIGEST_SIZE = 32;
+
+MappedPlainFile::MappedPlainFile(const std::string& filepath) : handle_(0), data_(nullptr), size_(0) {
+    int ret = 0;
+    uint64_t handle = 0;
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (filepath.empty()) {
+        throw FileSystemException("Invalid parameter, filepath is empty");
+    }
+
+    sgx_status = ssgx_ocall_map_plain_file(&ret, filepath.c_str(), &handle, &data, &size);
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_map_plain_file(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_map_plain_file() return errors, error code: %d", ret));
+    }
+
+    // The whole region must lie outside of the enclave, so that any range checked against size_ does too
+    if (size > 0 && (!data || size > SIZE_MAX || sgx_is_outside_enclave(data, static_cast<size_t>(size)) == 0)) {
+        ssgx_ocall_unmap_plain_file(&ret, handle);
+        throw FileSystemException("Invalid external input detected, with traces of enclave memory found");
+    }
+    sgx_lfence();
+
+    handle_ = handle;
+    data_ = data;
+    size_ = size;
+}
+
+MappedPlainFile::~MappedPlainFile() {
+    if (handle_ != 0) {
+        int ret = 0;
+        ssgx_ocall_unmap_plain_file(&ret, handle_);
+    }
+}
+
+uint64_t MappedPlainFile::Size() const {
+    if (handle_ == 0) {
+        throw FileSystemException("File not mapped");
+    }
+    return size_;
+}
+
+void MappedPlainFile::Read(uint64_t offset, void* buffer, size_t size) const {
+    if (handle_ == 0) {
+        throw FileSystemException("File not mapped");
+    }
+    if (!buffer && size > 0) {
+        throw FileSystemException("Invalid read parameters");
+    }
+    if (offset > size_ || size > size_ - offset) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Invalid parameter, range [%llu, +%zu) exceeds the file size %llu", static_cast<unsigned long long>(offset),
+            size, static_cast<unsigned long long>(size_)));
+    }
+    sgx_lfence();
+
+    if (size > 0) {
+        memcpy(buffer, data_ + offset, size);
+    }
+}
+
+std::vector<uint8_t> MappedPlainFile::Read(uint64_t offset, size_t size) const {
+    std::vector<uint8_t> result(size);
+    Read(offset, result.data(), size);
+    return result;
+}
+
+void MappedPlainFile::ReadVerified(uint64_t offset, void* buffer, size_t size,
+                                   const std::vector<uint8_t>& expected_sha256) const {
+    if (expected_sha256.size() != SHA256_DIGEST_SIZE) {
+        throw FileSystemException("Invalid parameter, expected_sha256 must be 32 bytes");
+    }
+
+    Read(offset, buffer, size);
+
+    // Hash the copy in the enclave, the mapping itself may change at any time
+    uint8_t md[SHA256_DIGEST_SIZE] = {0};
+    safeheron::hash::CSHA256 sha256;
+    sha256.Write(static_cast<const uint8_t*>(buffer), size);
+    sha256.Finalize(md);
+    if (memcmp(md, expected_sha256.data(), sizeof(md)) != 0) {
+        if (size > 0) {
+            memset(buffer, 0, size);
+        }
+        throw FileSystemException("The SHA256 digest of the range doesn't match");
+    }
+}
+
+void MappedPlainFile::Close() {
+    int ret = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ == 0) {
+        return;
+    }
+
+    sgx_status = ssgx_ocall_unmap_plain_file(&ret, handle_);
+    handle_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_unmap_plain_file(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_unmap_plain_file() return errors, error code: %d", ret));
+    }
+}
+
+} // namespace filesystem_t
+} // namespace ssgx
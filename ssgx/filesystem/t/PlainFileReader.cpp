@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "sgx_lfence.h"
 #include "sgx_tprotected_fs.h"
 #include "sgx_trts.h"
@@ -81,5 +84,147 @@ std::string PlainFileReader::ReadAllText() const {
     return result;
 }
 
+PlainFileReader::~PlainFileReader() {
+    if (handle_ != 0) {
+        int ret = 0;
+        ssgx_ocall_plain_file_close(&ret, handle_);
+        utils_t::FreeOutside(buffer_, FS_PLAIN_STREAM_CHUNK_SIZE);
+    }
+}
+
+void PlainFileReader::Open() {
+    int ret = 0;
+    uint64_t handle = 0;
+    uint64_t file_size = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ != 0) {
+        throw FileSystemException("The file is already open");
+    }
+    if (file_path_.empty()) {
+        throw FileSystemException("Invalid parameter, filepath is empty");
+    }
+
+    sgx_status = ssgx_ocall_plain_file_open(&ret, file_path_.c_str(), 0, &handle, &file_size);
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_plain_file_open(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_open() return errors, error code: %d", ret));
+    }
+
+    // One staging buffer for the lifetime of the stream
+    auto* buffer = static_cast<uint8_t*>(utils_t::MallocOutsidePooled(FS_PLAIN_STREAM_CHUNK_SIZE));
+    if (!buffer) {
+        ssgx_ocall_plain_file_close(&ret, handle);
+        throw FileSystemException("Failed to allocate the stream buffer outside the enclave");
+    }
+
+    handle_ = handle;
+    file_size_ = file_size;
+    position_ = 0;
+    buffer_ = buffer;
+    window_offset_ = 0;
+    window_size_ = 0;
+}
+
+size_t PlainFileReader::Read(void* buffer, size_t size) {
+    const size_t read_size = ReadAt(position_, buffer, size);
+    position_ += read_size;
+    return read_size;
+}
+
+size_t PlainFileReader::ReadAt(uint64_t offset, void* buffer, size_t size) {
+    int ret = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    if (!buffer && size > 0) {
+        throw FileSystemException("Invalid read parameters");
+    }
+
+    auto* out = static_cast<uint8_t*>(buffer);
+    size_t total_read = 0;
+    while (total_read < size) {
+        const uint64_t pos = offset + total_read;
+
+        // Serve what the last chunk already holds
+        if (pos >= window_offset_ && pos - window_offset_ < window_size_) {
+            const size_t available = window_size_ - static_cast<size_t>(pos - window_offset_);
+            const size_t count = std::min(size - total_read, available);
+            memcpy(out + total_read, buffer_ + (pos - window_offset_), count);
+            total_read += count;
+            continue;
+        }
+
+        // Fetch the next chunk
+        size_t read_size = 0;
+        window_size_ = 0;
+        sgx_status = ssgx_ocall_plain_file_read(&ret, handle_, pos, buffer_, FS_PLAIN_STREAM_CHUNK_SIZE, &read_size);
+        if (sgx_status != SGX_SUCCESS) {
+            throw FileSystemException(ssgx::utils_t::FormatStr(
+                "Failed to call function ssgx_ocall_plain_file_read(), sgx status: 0x%x", sgx_status));
+        }
+        if (ret < 0) {
+            throw FileSystemException(
+                ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_read() return errors, error code: %d", ret));
+        }
+        if (read_size > FS_PLAIN_STREAM_CHUNK_SIZE) {
+            throw FileSystemException("Invalid external input detected, read size exceeds the buffer size");
+        }
+        sgx_lfence();
+
+        // End of file
+        if (read_size == 0) {
+            break;
+        }
+        window_offset_ = pos;
+        window_size_ = read_size;
+    }
+
+    return total_read;
+}
+
+uint64_t PlainFileReader::Tell() const {
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    return position_;
+}
+
+uint64_t PlainFileReader::Size() const {
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    return file_size_;
+}
+
+void PlainFileReader::Close() {
+    int ret = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ == 0) {
+        return;
+    }
+
+    sgx_status = ssgx_ocall_plain_file_close(&ret, handle_);
+    utils_t::FreeOutside(buffer_, FS_PLAIN_STREAM_CHUNK_SIZE);
+    handle_ = 0;
+    buffer_ = nullptr;
+    window_size_ = 0;
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_plain_file_close(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_close() return errors, error code: %d", ret));
+    }
+}
+
 } // namespace filesystem_t
 } // namespace ssgx
\ No newline at end of file
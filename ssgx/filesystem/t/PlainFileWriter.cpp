@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "sgx_lfence.h"
 #include "sgx_tprotected_fs.h"
 #include "sgx_trts.h"
@@ -46,5 +49,147 @@ void PlainFileWriter::WriteAllText(const std::string& str) {
     WritePlainFile(file_path_, false, reinterpret_cast<const uint8_t*>(str.c_str()), str.length());
 }
 
+PlainFileWriter::~PlainFileWriter() {
+    try {
+        Close();
+    } catch (...) {
+        // A destructor must not throw
+    }
+}
+
+void PlainFileWriter::Open(FileMode file_mode) {
+    int ret = 0;
+    uint64_t handle = 0;
+    uint64_t file_size = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ != 0) {
+        throw FileSystemException("The file is already open");
+    }
+    if (file_path_.empty()) {
+        throw FileSystemException("Invalid parameter, filepath is empty");
+    }
+    if (file_mode != FileMode::CreateNew && file_mode != FileMode::OpenOrCreate && file_mode != FileMode::Append) {
+        throw FileSystemException("Invalid file mode");
+    }
+
+    sgx_status =
+        ssgx_ocall_plain_file_open(&ret, file_path_.c_str(), static_cast<int>(file_mode), &handle, &file_size);
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_plain_file_open(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_open() return errors, error code: %d", ret));
+    }
+
+    // One staging buffer for the lifetime of the stream
+    auto* buffer = static_cast<uint8_t*>(utils_t::MallocOutsidePooled(FS_PLAIN_STREAM_CHUNK_SIZE));
+    if (!buffer) {
+        ssgx_ocall_plain_file_close(&ret, handle);
+        throw FileSystemException("Failed to allocate the stream buffer outside the enclave");
+    }
+
+    handle_ = handle;
+    buffer_ = buffer;
+    buffered_size_ = 0;
+}
+
+void PlainFileWriter::Write(const void* data, size_t size) {
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+    if (!data && size > 0) {
+        throw FileSystemException("Invalid write parameters");
+    }
+
+    const auto* in = static_cast<const uint8_t*>(data);
+    size_t written_size = 0;
+    while (written_size < size) {
+        const size_t count = std::min(size - written_size, FS_PLAIN_STREAM_CHUNK_SIZE - buffered_size_);
+        memcpy(buffer_ + buffered_size_, in + written_size, count);
+        buffered_size_ += count;
+        written_size += count;
+        if (buffered_size_ == FS_PLAIN_STREAM_CHUNK_SIZE) {
+            WriteBuffer();
+        }
+    }
+}
+
+void PlainFileWriter::WriteBuffer() {
+    int ret = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (buffered_size_ == 0) {
+        return;
+    }
+
+    sgx_status = ssgx_ocall_plain_file_write(&ret, handle_, buffer_, buffered_size_);
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_plain_file_write(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_write() return errors, error code: %d", ret));
+    }
+    buffered_size_ = 0;
+}
+
+void PlainFileWriter::Flush() {
+    int ret = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ == 0) {
+        throw FileSystemException("File not open");
+    }
+
+    WriteBuffer();
+    sgx_status = ssgx_ocall_plain_file_flush(&ret, handle_);
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_plain_file_flush(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_flush() return errors, error code: %d", ret));
+    }
+}
+
+void PlainFileWriter::Close() {
+    int ret = 0;
+    sgx_status_t sgx_status = SGX_SUCCESS;
+
+    if (handle_ == 0) {
+        return;
+    }
+
+    // Release the stream even if the last chunk cannot be written
+    std::string error;
+    try {
+        WriteBuffer();
+    } catch (const FileSystemException& e) {
+        error = e.what();
+    }
+
+    sgx_status = ssgx_ocall_plain_file_close(&ret, handle_);
+    utils_t::FreeOutside(buffer_, FS_PLAIN_STREAM_CHUNK_SIZE);
+    handle_ = 0;
+    buffer_ = nullptr;
+    buffered_size_ = 0;
+    if (!error.empty()) {
+        throw FileSystemException(error);
+    }
+    if (sgx_status != SGX_SUCCESS) {
+        throw FileSystemException(ssgx::utils_t::FormatStr(
+            "Failed to call function ssgx_ocall_plain_file_close(), sgx status: 0x%x", sgx_status));
+    }
+    if (ret < 0) {
+        throw FileSystemException(
+            ssgx::utils_t::FormatStr("Function ssgx_ocall_plain_file_close() return errors, error code: %d", ret));
+    }
+}
+
 } // namespace filesystem_t
 } // namespace ssgx
\ No newline at end of file
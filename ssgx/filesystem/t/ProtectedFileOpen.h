@@ -0,0 +1,49 @@
+#ifndef SSGXLIB_SSGX_FILESYSTEM_T_PROTECTED_FILE_OPEN_H
+#define SSGXLIB_SSGX_FILESYSTEM_T_PROTECTED_FILE_OPEN_H
+
+#include "sgx_key.h"
+#include "sgx_tprotected_fs.h"
+
+#include "ssgx_filesystem_t.h"
+
+#include "filesystem_constant.h"
+
+namespace ssgx {
+namespace filesystem_t {
+namespace detail {
+
+/**
+ * @brief Open a protected file with the node cache size in options.
+ *
+ * SSGX_FS_HAVE_FOPEN_EX is defined by CMake when the SGX SDK declares sgx_fopen_ex(). Without it, or if
+ * options.cache_size is 0, the file is opened by sgx_fopen()/sgx_fopen_auto_key() with the SDK default cache.
+ *
+ * @param file_name the protected file name
+ * @param mode open mode, as for sgx_fopen()
+ * @param key the file key, or nullptr to derive it as sgx_fopen_auto_key() does
+ * @param options the open options
+ * @return the file handler, nullptr if failed
+ */
+inline SGX_FILE* OpenProtectedFile(const char* file_name, const char* mode, const sgx_key_128bit_t* key,
+                                   const ProtectedFileOptions& options) {
+#ifdef SSGX_FS_HAVE_FOPEN_EX
+    if (options.cache_size > 0) {
+        // The SDK accepts whole nodes only, and no less than its default
+        uint64_t cache_size = (options.cache_size + ProtectedFileOptions::NODE_SIZE - 1) /
+                              ProtectedFileOptions::NODE_SIZE * ProtectedFileOptions::NODE_SIZE;
+        if (cache_size < FS_PROTECTED_DEFAULT_CACHE_SIZE) {
+            cache_size = FS_PROTECTED_DEFAULT_CACHE_SIZE;
+        }
+        return sgx_fopen_ex(file_name, mode, key, cache_size);
+    }
+#else
+    (void)options;
+#endif
+    return key ? sgx_fopen(file_name, mode, key) : sgx_fopen_auto_key(file_name, mode);
+}
+
+} // namespace detail
+} // namespace filesystem_t
+} // namespace ssgx
+
+#endif // SSGXLIB_SSGX_FILESYSTEM_T_PROTECTED_FILE_OPEN_H
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "sgx_lfence.h"
 #include "sgx_tprotected_fs.h"
 #include "sgx_trts.h"
@@ -9,12 +12,14 @@
 
 #include "../../common/internal_check.h"
 #include "FileMetaData.h"
+#include "ProtectedFileOpen.h"
 #include "filesystem_constant.h"
 
 namespace ssgx {
 namespace filesystem_t {
 
-ProtectedFileReader::ProtectedFileReader(const char* file_name) : file_(nullptr), file_name_(file_name) {
+ProtectedFileReader::ProtectedFileReader(const char* file_name, const ProtectedFileOptions& options)
+    : file_(nullptr), file_name_(file_name), ahead_pos_(0), ahead_len_(0) {
     sgx_status_t status = SGX_SUCCESS;
 
     if (!file_name) {
@@ -35,7 +40,7 @@ ProtectedFileReader::ProtectedFileReader(const char* file_name) : file_(nullptr)
     // try to use sgx_fopen_auto_key() to open the protected file, because perhaps it is a legacy file
     // created by other applications.
     if (!meta_data.has_value() || meta_data.value().GetLegacyMode() == 1) {
-        file_ = sgx_fopen_auto_key(file_name, "r");
+        file_ = detail::OpenProtectedFile(file_name, "r", nullptr, options);
         if (!file_) {
             throw FileSystemException("Failed to open the file in auto key mode.");
         }
@@ -52,7 +57,7 @@ ProtectedFileReader::ProtectedFileReader(const char* file_name) : file_(nullptr)
         }
 
         // open file for reading
-        file_ = sgx_fopen(file_name, "r", &seal_key);
+        file_ = detail::OpenProtectedFile(file_name, "r", &seal_key, options);
         if (!file_) {
             memset_s(seal_key, sizeof(sgx_key_128bit_t), 0, sizeof(sgx_key_128bit_t));
             throw FileSystemException("Failed to open the file for reading");
@@ -61,6 +66,8 @@ ProtectedFileReader::ProtectedFileReader(const char* file_name) : file_(nullptr)
         // clear key data
         memset_s(seal_key, sizeof(sgx_key_128bit_t), 0, sizeof(sgx_key_128bit_t));
     }
+
+    ahead_buf_.resize(options.read_ahead);
 }
 
 ProtectedFileReader::~ProtectedFileReader() {
@@ -69,17 +76,50 @@ ProtectedFileReader::~ProtectedFileReader() {
     }
 }
 
-size_t ProtectedFileReader::Read(void* buffer, size_t size) const {
-    if (!file_ || !buffer || size == 0) {
-        throw FileSystemException("Invalid read parameters");
-    }
+size_t ProtectedFileReader::Fetch(void* buffer, size_t size) const {
     size_t bytes_read = sgx_fread(buffer, 1, size, file_);
     if (bytes_read == 0 && sgx_ferror(file_) != 0) {
         throw FileSystemException("Read error");
     }
+    stats_.fetches++;
+    stats_.bytes_fetched += bytes_read;
     return bytes_read;
 }
 
+size_t ProtectedFileReader::Read(void* buffer, size_t size) const {
+    if (!file_ || !buffer || size == 0) {
+        throw FileSystemException("Invalid read parameters");
+    }
+    stats_.reads++;
+
+    // Serve what the read-ahead buffer holds first
+    auto* out = static_cast<uint8_t*>(buffer);
+    size_t total_read = std::min(size, ahead_len_ - ahead_pos_);
+    if (total_read > 0) {
+        memcpy(out, ahead_buf_.data() + ahead_pos_, total_read);
+        ahead_pos_ += total_read;
+    }
+    if (total_read == size) {
+        stats_.hits++;
+        return total_read;
+    }
+    stats_.misses++;
+
+    // The buffer is drained. Read big requests directly, refill it for small ones.
+    const size_t left = size - total_read;
+    if (left >= ahead_buf_.size()) {
+        return total_read + Fetch(out + total_read, left);
+    }
+    ahead_len_ = Fetch(ahead_buf_.data(), ahead_buf_.size());
+    ahead_pos_ = std::min(left, ahead_len_);
+    memcpy(out + total_read, ahead_buf_.data(), ahead_pos_);
+    return total_read + ahead_pos_;
+}
+
+ProtectedFileStats ProtectedFileReader::Stats() const {
+    return stats_;
+}
+
 int64_t ProtectedFileReader::Tell() const {
     if (!file_) {
         throw FileSystemException("File not open");
@@ -88,16 +128,23 @@ int64_t ProtectedFileReader::Tell() const {
     if (pos < 0) {
         throw FileSystemException("Tell error");
     }
-    return pos;
+    // The protected file is ahead by the unread part of the read-ahead buffer
+    return pos - static_cast<int64_t>(ahead_len_ - ahead_pos_);
 }
 
 void ProtectedFileReader::Seek(int64_t offset, int origin) const {
     if (!file_) {
         throw FileSystemException("File not open");
     }
+    // SEEK_CUR is relative to what the caller has read, not to what has been fetched
+    if (origin == SEEK_CUR) {
+        offset -= static_cast<int64_t>(ahead_len_ - ahead_pos_);
+    }
     if (sgx_fseek(file_, offset, origin) != 0) {
         throw FileSystemException("Seek error");
     }
+    ahead_pos_ = 0;
+    ahead_len_ = 0;
 }
 
 void ProtectedFileReader::Close() {
@@ -9,6 +9,7 @@
 
 #include "../../common/internal_check.h"
 #include "FileMetaData.h"
+#include "ProtectedFileOpen.h"
 #include "filesystem_constant.h"
 
 namespace ssgx {
@@ -23,11 +24,13 @@ namespace detail {
  * @param meta_file_name the metadata file name
  * @param key_policy seal key policy, if SGX_KEYPOLICY_MRSIGNER is specified, will call sgx_fopen_auto_key() to
  *      create or open the file.
+ * @param options the node cache size to open the file with
  * @return the file handler
  *
  * @throw throw FileSystemException if failed
  */
-static SGX_FILE* OpenFileForWrite(const char* file_name, const char* meta_file_name, uint16_t key_policy) {
+static SGX_FILE* OpenFileForWrite(const char* file_name, const char* meta_file_name, uint16_t key_policy,
+                                  const ProtectedFileOptions& options) {
     // Get enclave self report
     const sgx_report_t* report = sgx_self_report();
     if (!report) {
@@ -46,7 +49,7 @@ static SGX_FILE* OpenFileForWrite(const char* file_name, const char* meta_file_n
 
         // Call sgx_fopen_auto_key() to create or open the file.
         // In this API, a key will be derived with SGX_KEYPOLICY_MRSIGNER
-        file = sgx_fopen_auto_key(file_name, "w");
+        file = OpenProtectedFile(file_name, "w", nullptr, options);
     }
     else {
         // Use a random number for key_id
@@ -66,7 +69,7 @@ static SGX_FILE* OpenFileForWrite(const char* file_name, const char* meta_file_n
         }
 
         // Call sgx_fopen() to create or open the file
-        file = sgx_fopen(file_name, "w", &seal_key);
+        file = OpenProtectedFile(file_name, "w", &seal_key, options);
 
         // Reset seal_key with 0
         memset_s(seal_key, sizeof(sgx_key_128bit_t), 0, sizeof(sgx_key_128bit_t));
@@ -93,11 +96,13 @@ static SGX_FILE* OpenFileForWrite(const char* file_name, const char* meta_file_n
  * @param meta_file_name the metadata file name
  * @param key_policy seal key policy, if SGX_KEYPOLICY_MRSIGNER is specified, will call sgx_fopen_auto_key() to
  *      create or open the file.
+ * @param options the node cache size to open the file with
  * @return the file handler
  *
  * @throw throw FileSystemException if failed
  */
-static SGX_FILE* OpenFileForAppend(const char* file_name, const char* meta_file_name, uint16_t key_policy) {
+static SGX_FILE* OpenFileForAppend(const char* file_name, const char* meta_file_name, uint16_t key_policy,
+                                   const ProtectedFileOptions& options) {
     // Get enclave self report
     const sgx_report_t* report = sgx_self_report();
     if (!report) {
@@ -139,7 +144,7 @@ static SGX_FILE* OpenFileForAppend(const char* file_name, const char* meta_file_
 
         // Call sgx_fopen_auto_key() to create or open the file.
         // In this API, a key will be derived with SGX_KEYPOLICY_MRSIGNER
-        file = sgx_fopen_auto_key(file_name, "a");
+        file = OpenProtectedFile(file_name, "a", nullptr, options);
     }
     else {
         sgx_status_t status = SGX_SUCCESS;
@@ -166,7 +171,7 @@ static SGX_FILE* OpenFileForAppend(const char* file_name, const char* meta_file_
         }
 
         // Call sgx_fopen() to create or open the file
-        file = sgx_fopen(file_name, "a", &seal_key);
+        file = OpenProtectedFile(file_name, "a", &seal_key, options);
 
         // Reset seal_key with 0
         memset_s(seal_key, sizeof(sgx_key_128bit_t), 0, sizeof(sgx_key_128bit_t));
@@ -188,7 +193,8 @@ static SGX_FILE* OpenFileForAppend(const char* file_name, const char* meta_file_
 }
 }
 
-ProtectedFileWriter::ProtectedFileWriter(const char* file_name, FileMode file_mode, uint16_t key_policy)
+ProtectedFileWriter::ProtectedFileWriter(const char* file_name, FileMode file_mode, uint16_t key_policy,
+                                         const ProtectedFileOptions& options)
     : file_(nullptr), file_name_(file_name) {
     sgx_status_t status = SGX_SUCCESS;
 
@@ -211,13 +217,13 @@ ProtectedFileWriter::ProtectedFileWriter(const char* file_name, FileMode file_mo
         if (Exists(Path(file_name)) || Exists(metadata_file)) {
             throw FileSystemException("The file already exists");
         }
-        file_ = detail::OpenFileForWrite(file_name, metadata_file.c_str(), key_policy);
+        file_ = detail::OpenFileForWrite(file_name, metadata_file.c_str(), key_policy, options);
     }
     else if (file_mode == FileMode::OpenOrCreate) {
-        file_ = detail::OpenFileForWrite(file_name, metadata_file.c_str(), key_policy);
+        file_ = detail::OpenFileForWrite(file_name, metadata_file.c_str(), key_policy, options);
     }
     else if (file_mode == FileMode::Append) {
-        file_ = detail::OpenFileForAppend(file_name, metadata_file.c_str(), key_policy);
+        file_ = detail::OpenFileForAppend(file_name, metadata_file.c_str(), key_policy, options);
     }
     else {
         throw FileSystemException("Invalid file mode");
@@ -15,6 +15,52 @@ static constexpr uint8_t FS_METADATA_VERSION = 0x01;
 // Max file size is 100 KB
 static constexpr std::size_t FS_MAX_FILE_SIZE = 100 * 1024;
 
+// Node cache size of a protected file when none is given, 48 nodes as in the SGX SDK
+static constexpr uint64_t FS_PROTECTED_DEFAULT_CACHE_SIZE = 48 * 4096;
+
+// Untrusted buffer size of a plain file stream, data crosses the enclave boundary in chunks of this size
+static constexpr std::size_t FS_PLAIN_STREAM_CHUNK_SIZE = 1024 * 1024;
+
+// Chunked file trailer tag and version
+static constexpr uint8_t FS_CHUNKED_FILE_TAG[8] = {'S', 'S', 'G', 'X', 'C', 'H', 'K', 'F'};
+static constexpr uint32_t FS_CHUNKED_FILE_VERSION = 0x01;
+
+// Chunked file trailer: tag(8) | version(4) | chunk size(4) | data size(8) | chunk count(8) | index MAC(16) | MAC(16)
+static constexpr std::size_t FS_CHUNKED_FILE_TRAILER_SIZE = 64;
+
+// Chunk size range of a chunked file
+static constexpr std::size_t FS_CHUNKED_FILE_MIN_CHUNK_SIZE = 4 * 1024;
+static constexpr std::size_t FS_CHUNKED_FILE_MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+// Max chunk count of a chunked file, which bounds the index kept in the enclave (16 bytes per chunk)
+static constexpr uint64_t FS_CHUNKED_FILE_MAX_CHUNKS = 1ULL << 24;
+
+// The label to derive a chunked file key from its seal key
+static constexpr const char* FS_CHUNKED_FILE_KEY_LABEL = "Safeheron ssgx chunked file key";
+
+// KvStore file tags and version
+static constexpr uint8_t FS_KV_STORE_MANIFEST_TAG[8] = {'S', 'S', 'G', 'X', 'K', 'V', 'M', 'F'};
+static constexpr uint8_t FS_KV_STORE_SEGMENT_TAG[8] = {'S', 'S', 'G', 'X', 'K', 'V', 'S', 'G'};
+static constexpr uint8_t FS_KV_STORE_WAL_TAG[8] = {'S', 'S', 'G', 'X', 'K', 'V', 'W', 'L'};
+static constexpr uint32_t FS_KV_STORE_VERSION = 0x01;
+
+// KvStore key and value size limits
+static constexpr std::size_t FS_KV_STORE_MAX_KEY_SIZE = 64 * 1024;
+static constexpr std::size_t FS_KV_STORE_MAX_VALUE_SIZE = 16 * 1024 * 1024;
+
+// Chunk size of a KvStore segment, and the span of a sparse index entry: a point lookup decrypts a chunk or two
+static constexpr std::size_t FS_KV_STORE_CHUNK_SIZE = 16 * 1024;
+static constexpr std::size_t FS_KV_STORE_BLOCK_SIZE = 4 * 1024;
+
+// Size of the sequential reads of a KvStore segment by a scan or a compaction
+static constexpr std::size_t FS_KV_STORE_READ_SIZE = 64 * 1024;
+
+// Max size of a KvStore manifest
+static constexpr std::size_t FS_KV_STORE_MAX_MANIFEST_SIZE = 1024 * 1024;
+
+// Number of missing file ids after which KvStore stops looking for files left by a crash
+static constexpr uint64_t FS_KV_STORE_ORPHAN_PROBE = 8;
+
 // Tha additional MAC data for seal/unseal
 static constexpr const char* FS_SEAL_ADD_MAC_DATA = "Safeheron ssgx filesystem sealed data";
 
@@ -29,5 +29,26 @@ bool is_directory_empty(const char* path, uint32_t* is_empty) {
     return true;
 }
 
+bool directory_has_extension(const char* path, const char* extension, uint32_t* found) {
+    DIR* dp = nullptr;
+    dp = opendir(path);
+    if (!dp) {
+        return false;
+    }
+
+    const size_t extension_len = strlen(extension);
+    dirent* fp_dir;
+    *found = 0;
+    while ((fp_dir = readdir(dp)) != nullptr) {
+        const size_t name_len = strlen(fp_dir->d_name);
+        if (name_len > extension_len && strcmp(fp_dir->d_name + name_len - extension_len, extension) == 0) {
+            *found = 1;
+            break;
+        }
+    }
+    closedir(dp);
+    return true;
+}
+
 } // namespace filesystem_u
 } // namespace ssgx
\ No newline at end of file
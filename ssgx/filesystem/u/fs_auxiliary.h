@@ -8,6 +8,8 @@ namespace filesystem_u {
 
 bool is_directory_empty(const char* path, uint32_t* is_empty);
 
+bool directory_has_extension(const char* path, const char* extension, uint32_t* found);
+
 }
 } // namespace ssgx
 
@@ -1,3 +1,5 @@
+#include <map>
+#include <mutex>
 #include <string>
 
 #include "ssgx_filesystem_t_enum.h"
@@ -9,6 +11,8 @@
 #include <cstdio>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/file.h>
 #include <unistd.h>
@@ -17,6 +21,7 @@
 #endif
 
 using Stat = struct stat;
+using ssgx::filesystem_t::FileMode;
 using ssgx::filesystem_t::FileType;
 using ssgx::filesystem_t::Perms;
 
@@ -26,6 +31,28 @@ using ssgx::filesystem_t::Perms;
 // Max file size is 100 KB
 #define SSGX_FS_MAX_FILE_SIZE (100 * 1024)
 
+// Handles given to the enclave for opened streams and mappings
+static std::mutex g_handle_mutex;
+static uint64_t g_next_handle = 1;
+
+// Opened plain file streams
+static std::map<uint64_t, int> g_streams;
+
+// Read-only file mappings
+struct FileMapping {
+    int fd;
+    void* data;
+    size_t size;
+};
+static std::map<uint64_t, FileMapping> g_mappings;
+
+// Get the file descriptor of an opened stream, return -1 if the handle is unknown
+static int GetStreamFd(uint64_t handle) {
+    std::lock_guard<std::mutex> lock(g_handle_mutex);
+    auto it = g_streams.find(handle);
+    return (it == g_streams.end()) ? -1 : it->second;
+}
+
 extern "C" int ssgx_ocall_get_file_status(const char* path, uint32_t* file_type, uint32_t* file_permission) {
     int ret = 0;
     Stat s_buf = {0};
@@ -158,6 +185,17 @@ extern "C" int ssgx_ocall_is_directory_or_regular_file_empty(const char* path, u
     return 0;
 }
 
+/*
+ *  does the directory hold a file whose name ends with extension
+ */
+extern "C" int ssgx_ocall_directory_has_extension(const char* path, const char* extension, uint32_t* found) {
+    if (!path || strnlen(path, 1) == 0 || !extension || strnlen(extension, 1) == 0 || !found) {
+        return -1;
+    }
+
+    return ssgx::filesystem_u::directory_has_extension(path, extension, found) ? 0 : -2;
+}
+
 /*
  *  create a directory
  */
@@ -347,3 +385,285 @@ extern "C" int ssgx_ocall_write_file(const char* path, int is_binary, const uint
 
     return 0;
 }
+
+/*
+ *  open a normal file as a stream
+ */
+extern "C" int ssgx_ocall_plain_file_open(const char* path, int mode, uint64_t* handle, uint64_t* file_size) {
+    if (!path || strnlen(path, 1) == 0 || !handle || !file_size) {
+        return -1;
+    }
+    *handle = 0;
+    *file_size = 0;
+
+    // Don't truncate before the lock is held, OpenOrCreate truncates after flock() below
+    int flags = 0;
+    if (mode == 0) {
+        flags = O_RDONLY;
+    } else if (mode == static_cast<int>(FileMode::CreateNew)) {
+        flags = O_WRONLY | O_CREAT | O_EXCL;
+    } else if (mode == static_cast<int>(FileMode::OpenOrCreate)) {
+        flags = O_WRONLY | O_CREAT;
+    } else if (mode == static_cast<int>(FileMode::Append)) {
+        flags = O_WRONLY | O_CREAT | O_APPEND;
+    } else {
+        return -2;
+    }
+
+    const int fd = open(path, flags | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return -3;
+    }
+
+    // readers share the file, a writer holds it exclusively until the stream is closed
+    if (flock(fd, ((mode == 0) ? LOCK_SH : LOCK_EX) | LOCK_NB) == -1) {
+        close(fd);
+        return -4;
+    }
+
+    if (mode == static_cast<int>(FileMode::OpenOrCreate) && ftruncate(fd, 0) != 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -5;
+    }
+
+    Stat s_buf;
+    if (fstat(fd, &s_buf) != 0 || !S_ISREG(s_buf.st_mode)) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -6;
+    }
+
+    std::lock_guard<std::mutex> lock(g_handle_mutex);
+    *handle = g_next_handle++;
+    *file_size = static_cast<uint64_t>(s_buf.st_size);
+    g_streams[*handle] = fd;
+
+    return 0;
+}
+
+/*
+ *  read up to size bytes at offset of an opened stream
+ */
+extern "C" int ssgx_ocall_plain_file_read(uint64_t handle, uint64_t offset, uint8_t* buf, size_t size,
+                                          size_t* read_size) {
+    if (!read_size) {
+        return -1;
+    }
+    *read_size = 0;
+    if (size > 0 && !buf) {
+        return -1;
+    }
+
+    const int fd = GetStreamFd(handle);
+    if (fd == -1) {
+        return -2;
+    }
+
+    // stop at the end of file, pread() returns 0
+    size_t total_read = 0;
+    while (total_read < size) {
+        const ssize_t count = pread(fd, buf + total_read, size - total_read, static_cast<off_t>(offset + total_read));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -3;
+        }
+        if (count == 0) {
+            break;
+        }
+        total_read += static_cast<size_t>(count);
+    }
+
+    *read_size = total_read;
+    return 0;
+}
+
+/*
+ *  append size bytes to an opened stream
+ */
+extern "C" int ssgx_ocall_plain_file_write(uint64_t handle, const uint8_t* buf, size_t size) {
+    if (size > 0 && !buf) {
+        return -1;
+    }
+
+    const int fd = GetStreamFd(handle);
+    if (fd == -1) {
+        return -2;
+    }
+
+    size_t write_size = 0;
+    while (write_size < size) {
+        const ssize_t count = write(fd, buf + write_size, size - write_size);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -3;
+        }
+        write_size += static_cast<size_t>(count);
+    }
+
+    return 0;
+}
+
+/*
+ *  write size bytes at offset of an opened stream
+ */
+extern "C" int ssgx_ocall_plain_file_write_at(uint64_t handle, uint64_t offset, const uint8_t* buf, size_t size) {
+    if (size > 0 && !buf) {
+        return -1;
+    }
+
+    const int fd = GetStreamFd(handle);
+    if (fd == -1) {
+        return -2;
+    }
+
+    size_t write_size = 0;
+    while (write_size < size) {
+        const ssize_t count =
+            pwrite(fd, buf + write_size, size - write_size, static_cast<off_t>(offset + write_size));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -3;
+        }
+        write_size += static_cast<size_t>(count);
+    }
+
+    return 0;
+}
+
+/*
+ *  flush an opened stream to disk
+ */
+extern "C" int ssgx_ocall_plain_file_flush(uint64_t handle) {
+    const int fd = GetStreamFd(handle);
+    if (fd == -1) {
+        return -1;
+    }
+    if (fdatasync(fd) != 0) {
+        return -2;
+    }
+    return 0;
+}
+
+/*
+ *  close an opened stream
+ */
+extern "C" int ssgx_ocall_plain_file_close(uint64_t handle) {
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(g_handle_mutex);
+        auto it = g_streams.find(handle);
+        if (it == g_streams.end()) {
+            return -1;
+        }
+        fd = it->second;
+        g_streams.erase(it);
+    }
+
+    flock(fd, LOCK_UN);
+    if (close(fd) != 0) {
+        return -2;
+    }
+    return 0;
+}
+
+/*
+ *  flush a file or a directory to disk by its path
+ */
+extern "C" int ssgx_ocall_sync_path(const char* path) {
+    if (!path || strnlen(path, 1) == 0) {
+        return -1;
+    }
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    const int ret = (fsync(fd) == 0) ? 0 : -2;
+    close(fd);
+    return ret;
+}
+
+/*
+ *  map a normal file read-only into untrusted memory
+ */
+extern "C" int ssgx_ocall_map_plain_file(const char* path, uint64_t* handle, uint8_t** data, uint64_t* size) {
+    if (!path || strnlen(path, 1) == 0 || !handle || !data || !size) {
+        return -1;
+    }
+    *handle = 0;
+    *data = nullptr;
+    *size = 0;
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -2;
+    }
+
+    // keep a shared lock while mapped, a cooperating writer can't truncate the file under the mapping
+    if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+        close(fd);
+        return -3;
+    }
+
+    Stat s_buf;
+    if (fstat(fd, &s_buf) != 0 || !S_ISREG(s_buf.st_mode)) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -4;
+    }
+
+    // an empty file has nothing to map
+    void* addr = nullptr;
+    const size_t file_size = static_cast<size_t>(s_buf.st_size);
+    if (file_size > 0) {
+        addr = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            flock(fd, LOCK_UN);
+            close(fd);
+            return -5;
+        }
+        // accesses are sparse, don't read ahead pages which won't be touched
+        madvise(addr, file_size, MADV_RANDOM);
+    }
+
+    std::lock_guard<std::mutex> lock(g_handle_mutex);
+    *handle = g_next_handle++;
+    *data = static_cast<uint8_t*>(addr);
+    *size = file_size;
+    g_mappings[*handle] = FileMapping{fd, addr, file_size};
+
+    return 0;
+}
+
+/*
+ *  unmap a file mapped by ssgx_ocall_map_plain_file
+ */
+extern "C" int ssgx_ocall_unmap_plain_file(uint64_t handle) {
+    FileMapping mapping = {-1, nullptr, 0};
+    {
+        std::lock_guard<std::mutex> lock(g_handle_mutex);
+        auto it = g_mappings.find(handle);
+        if (it == g_mappings.end()) {
+            return -1;
+        }
+        mapping = it->second;
+        g_mappings.erase(it);
+    }
+
+    int ret = 0;
+    if (mapping.data && munmap(mapping.data, mapping.size) != 0) {
+        ret = -2;
+    }
+    flock(mapping.fd, LOCK_UN);
+    if (close(mapping.fd) != 0) {
+        ret = -3;
+    }
+    return ret;
+}
@@ -0,0 +1,28 @@
+#ifndef SSGXLIB_HTTP_NETEVENTS_H
+#define SSGXLIB_HTTP_NETEVENTS_H
+
+namespace ssgx {
+namespace internal {
+
+/**
+ * @brief Values exchanged by the non-blocking socket ocalls which let the enclave drive several client
+ * connections from one thread (see ssgx_ocall_http_net_* in ssgx_http_t.edl).
+ */
+
+// Bits of the events and revents arrays of ssgx_ocall_http_net_poll()
+constexpr int HTTP_NET_EVENT_READ = 0x1;  // readable, or a connect()/recv() result is available
+constexpr int HTTP_NET_EVENT_WRITE = 0x2; // writable, or a pending connect() completed
+constexpr int HTTP_NET_EVENT_ERROR = 0x4; // error or hang up, in revents only
+
+// Return values of ssgx_ocall_http_net_send() and ssgx_ocall_http_net_recv() besides a byte count
+constexpr int HTTP_NET_WOULD_BLOCK = -1;
+constexpr int HTTP_NET_FAILED = -2;
+
+// Returned by ssgx_ocall_http_net_connect_finish() when the connection failed and the next address of the host is
+// being tried on the same socket: wait until it is writable again, then call connect_finish once more
+constexpr int HTTP_NET_CONNECT_NEXT = 1;
+
+} // namespace internal
+} // namespace ssgx
+
+#endif // SSGXLIB_HTTP_NETEVENTS_H
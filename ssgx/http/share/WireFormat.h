@@ -0,0 +1,164 @@
+#ifndef SSGXLIB_HTTP_WIREFORMAT_H
+#define SSGXLIB_HTTP_WIREFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace ssgx {
+namespace internal {
+
+/**
+ * @brief Binary framing used by ssgx_ecall_http_on_binary_message().
+ *
+ * All integers are stored in host byte order, because both ends of the ecall run on the same machine.
+ * Every string is encoded as a uint32 length followed by its raw bytes (no terminator).
+ *
+ * Request frame:
+ *      u32 magic | str method | str path | u32 n, n * (str key, str value) params
+ *      | u32 n, n * (str key, str value) headers | str body | u64 body_stream_id | u64 response_stream_id
+ *
+ * A body_stream_id of 0 means that the body field holds the whole request body. Otherwise the body field is empty
+ * and the enclave pulls the body from the host with ssgx_ocall_http_read_request_body(body_stream_id, ...). The host
+ * only streams bodies which are larger than HTTP_WIRE_INLINE_BODY_LIMIT or whose length is not known in advance.
+ *
+ * response_stream_id identifies the host response for ssgx_ocall_http_begin_response_stream() and
+ * ssgx_ocall_http_write_response_stream(). Once a response has been streamed, the response frame returned by the
+ * ecall is ignored.
+ *
+ * Response frame:
+ *      u32 magic | u16 status_code | u32 n, n * (str key, str value) headers | str body
+ */
+constexpr uint32_t HTTP_WIRE_REQUEST_MAGIC = 0x31515253;  // "SRQ1"
+constexpr uint32_t HTTP_WIRE_RESPONSE_MAGIC = 0x31505253; // "SRP1"
+constexpr size_t HTTP_WIRE_INLINE_BODY_LIMIT = 64 * 1024;
+
+/**
+ * @brief Appends fields of a frame into a caller-owned buffer.
+ */
+class WireWriter {
+  public:
+    explicit WireWriter(std::string& out) : out_(out) {
+    }
+
+    void PutU16(uint16_t v) {
+        out_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void PutU32(uint32_t v) {
+        out_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void PutU64(uint64_t v) {
+        out_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    /**
+     * @throws std::length_error if len does not fit in the u32 length field.
+     */
+    void PutBytes(const char* data, size_t len) {
+        CheckLength(len);
+        PutU32(static_cast<uint32_t>(len));
+        if (len > 0) {
+            out_.append(data, len);
+        }
+    }
+
+    void PutStr(const std::string& s) {
+        PutBytes(s.data(), s.size());
+    }
+
+    /**
+     * @brief Size in bytes of a string field with the given payload length.
+     * @throws std::length_error if len does not fit in the u32 length field.
+     */
+    static size_t StrSize(size_t len) {
+        CheckLength(len);
+        return sizeof(uint32_t) + len;
+    }
+
+  private:
+    static void CheckLength(size_t len) {
+        if (len > UINT32_MAX) {
+            throw std::length_error("Wire field larger than 4 GiB");
+        }
+    }
+
+    std::string& out_;
+};
+
+/**
+ * @brief Bounds-checked reader over a frame. Every getter returns false once the frame is exhausted or malformed,
+ * and the reader never touches memory beyond [data, data + size).
+ */
+class WireReader {
+  public:
+    WireReader(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) {
+    }
+
+    bool GetU16(uint16_t& v) {
+        if (!data_ || size_ - pos_ < sizeof(v))
+            return false;
+        memcpy(&v, data_ + pos_, sizeof(v));
+        pos_ += sizeof(v);
+        return true;
+    }
+
+    bool GetU32(uint32_t& v) {
+        if (!data_ || size_ - pos_ < sizeof(v))
+            return false;
+        memcpy(&v, data_ + pos_, sizeof(v));
+        pos_ += sizeof(v);
+        return true;
+    }
+
+    bool GetU64(uint64_t& v) {
+        if (!data_ || size_ - pos_ < sizeof(v))
+            return false;
+        memcpy(&v, data_ + pos_, sizeof(v));
+        pos_ += sizeof(v);
+        return true;
+    }
+
+    /**
+     * @brief Return a view of the next string field without copying it.
+     */
+    bool GetBytes(const char*& ptr, size_t& len) {
+        uint32_t n = 0;
+        if (!GetU32(n))
+            return false;
+        if (size_ - pos_ < n)
+            return false;
+        ptr = reinterpret_cast<const char*>(data_ + pos_);
+        len = n;
+        pos_ += n;
+        return true;
+    }
+
+    bool GetStr(std::string& s) {
+        const char* ptr = nullptr;
+        size_t len = 0;
+        if (!GetBytes(ptr, len))
+            return false;
+        s.assign(ptr, len);
+        return true;
+    }
+
+    /**
+     * @brief Return true if the whole frame has been consumed.
+     */
+    bool AtEnd() const {
+        return pos_ == size_;
+    }
+
+  private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+} // namespace internal
+} // namespace ssgx
+
+#endif // SSGXLIB_HTTP_WIREFORMAT_H
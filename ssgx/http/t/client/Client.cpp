@@ -1,7 +1,10 @@
 #include <memory>
 #include <utility>
 
+#include "mbedtls_client/ConnectionPool.h"
 #include "mbedtls_client/HttpClient.h"
+#include "mbedtls_client/RequestBatch.h"
+#include "mbedtls_client/SessionCache.h"
 
 #include "ssgx_http_t_client.h"
 
@@ -105,6 +108,22 @@ Client::Client(const std::string& host, int port, const std::string& server_ca)
     : host_(host), port_(port), server_ca_(server_ca) {
 }
 
+void Client::SetConnectionPoolOptions(const ConnectionPoolOptions& options) {
+    ConnectionPool::GetInstance().SetOptions(options);
+}
+
+void Client::ClearConnectionPool() {
+    ConnectionPool::GetInstance().Clear();
+}
+
+void Client::SetTlsSessionCacheOptions(const TlsSessionCacheOptions& options) {
+    SessionCache::GetInstance().SetOptions(options);
+}
+
+TlsSessionCacheStats Client::GetTlsSessionCacheStats() {
+    return SessionCache::GetInstance().GetStats();
+}
+
 Result Client::Get(const std::string& path, int time_out_sec) {
     return Get(path, TypeHeaders (), TypeParams(), time_out_sec);
 }
@@ -149,17 +168,9 @@ Result Client::Post(const std::string& path, const TypeHeaders& headers, const s
     return SendRequest("POST", path, headers, TypeParams(), body, content_type, time_out_sec);
 }
 
-Result Client::SendRequest(const std::string& method, const std::string& path, const TypeHeaders& headers,
-                           const TypeParams& params, const std::string& body, const std::string& content_type,
-                           int time_out_sec) const {
-    // Request path must be provided
-    if (path.empty()) {
-        return {nullptr, Error(ErrorCode::InvalidParam, "Path must be provided.", "")};
-    }
-
-    std::list<std::string> headers_list;
-    std::list<std::string> params_list;
-
+// Headers and parameters in the "key: value" and "key=value" forms used by HttpClient
+static void ToLists(const TypeHeaders& headers, const TypeParams& params, const std::string& content_type,
+                    std::list<std::string>& headers_list, std::list<std::string>& params_list) {
     for (const auto& [key, value] : headers) {
         headers_list.push_back(key + ": " + value);
     }
@@ -169,12 +180,9 @@ Result Client::SendRequest(const std::string& method, const std::string& path, c
     if (!content_type.empty()) {
         headers_list.push_back("Content-Type: " + content_type);
     }
+}
 
-    httpparser::Response resp_data;
-    HttpClient client(host_, port_, server_ca_);
-    HttpResult ret = (method == "GET") ? client.Get(path, headers_list, params_list, time_out_sec, resp_data)
-                                       : client.Post(path, headers_list, body, time_out_sec, resp_data);
-
+static Result ToResult(const HttpResult& ret, const httpparser::Response& resp_data) {
     if (ret.Code() != HttpError::OK) {
         return {nullptr, Error(MapErrorCode(ret.Code()), MapErrorMessage(MapErrorCode(ret.Code())), ret.Message())};
     }
@@ -187,7 +195,81 @@ Result Client::SendRequest(const std::string& method, const std::string& path, c
         resp->SetHeader(item.name, item.value);
     }
 
-    return {std::move(resp), Error(ErrorCode::Success, "OK", "Success")};
+    return {std::move(resp), Error(ErrorCode::Success, "OK", "Success"), ret.SessionResumed()};
+}
+
+Result Client::SendRequest(const std::string& method, const std::string& path, const TypeHeaders& headers,
+                           const TypeParams& params, const std::string& body, const std::string& content_type,
+                           int time_out_sec) const {
+    // Request path must be provided
+    if (path.empty()) {
+        return {nullptr, Error(ErrorCode::InvalidParam, "Path must be provided.", "")};
+    }
+
+    std::list<std::string> headers_list;
+    std::list<std::string> params_list;
+    ToLists(headers, params, content_type, headers_list, params_list);
+
+    httpparser::Response resp_data;
+    HttpClient client(host_, port_, server_ca_);
+    HttpResult ret = (method == "GET") ? client.Get(path, headers_list, params_list, time_out_sec, resp_data)
+                                       : client.Post(path, headers_list, body, time_out_sec, resp_data);
+
+    return ToResult(ret, resp_data);
+}
+
+std::vector<Result> Client::SendAll(const std::vector<RequestSpec>& requests, int time_out_sec) {
+    std::vector<std::pair<const Client*, RequestSpec>> targeted;
+    targeted.reserve(requests.size());
+    for (const auto& request : requests) {
+        targeted.emplace_back(this, request);
+    }
+    return SendAll(targeted, time_out_sec);
+}
+
+std::vector<Result> Client::SendAll(const std::vector<std::pair<const Client*, RequestSpec>>& requests,
+                                    int time_out_sec) {
+    std::vector<Result> results(requests.size());
+    std::vector<size_t> batch_index(requests.size(), 0);
+    std::vector<bool> queued(requests.size(), false);
+    RequestBatch batch;
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const Client* client = requests[i].first;
+        const RequestSpec& spec = requests[i].second;
+
+        // Same checks as the single request methods
+        if (!client || spec.path.empty()) {
+            results[i] = {nullptr, Error(ErrorCode::InvalidParam, "Client and path must be provided.", "")};
+            continue;
+        }
+        if (spec.method != "GET" && spec.method != "POST") {
+            results[i] = {nullptr, Error(ErrorCode::InvalidParam, "Method must be GET or POST.", "")};
+            continue;
+        }
+
+        std::list<std::string> headers_list;
+        std::list<std::string> params_list;
+        if (spec.method == "GET") {
+            ToLists(spec.headers, spec.params, "", headers_list, params_list);
+        } else {
+            ToLists(spec.headers, TypeParams(), spec.content_type, headers_list, params_list);
+        }
+
+        HttpClient http_client(client->host_, client->port_, client->server_ca_);
+        batch_index[i] = batch.Add(http_client, spec.method, spec.path, headers_list, params_list,
+                                   (spec.method == "POST") ? spec.body : std::string());
+        queued[i] = true;
+    }
+
+    batch.Run(time_out_sec);
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (queued[i]) {
+            results[i] = ToResult(batch.Result(batch_index[i]), batch.Response(batch_index[i]));
+        }
+    }
+    return results;
 }
 
 } // namespace http_t
@@ -0,0 +1,180 @@
+#include "ConnectionPool.h"
+
+#include <vector>
+
+#include "ssgx_http_t_t.h"
+#include "ssgx_utils_t.h"
+#include "ssgx_utils_t_control_page.h"
+
+#include "../../../share/NetEvents.h"
+#include "TlsConfig.h"
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+// Current time in milliseconds, or -1 if the untrusted clock is not usable. The coarse clock of the control page is
+// read without an OCALL, and is precise enough for timeouts of seconds.
+static int64_t NowInMilliseconds() {
+    try {
+        return ssgx::utils_t::ControlPage::CoarseNowInMilliseconds();
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+// Checks of the pool's own records, made under the lock before an idle connection is handed out again.
+bool ConnectionPool::IsHealthy(const HttpContext& ctx, int64_t now, int idle_timeout_ms) {
+    if (ctx.ssl_fd_.fd < 0) {
+        return false;
+    }
+    if (now < 0 || now < ctx.last_used_ms_ || now - ctx.last_used_ms_ > idle_timeout_ms) {
+        return false;
+    }
+    // Application data left from the last response means the connection is out of step with the server
+    if (ctx.is_https_ && mbedtls_ssl_get_bytes_avail(&ctx.ssl_) != 0) {
+        return false;
+    }
+    return true;
+}
+
+// Probe the socket of an idle connection. Nothing may arrive while it is idle but the server closing it (a close_notify
+// alert and a FIN) or, with TLS 1.3, a session ticket. Takes OCALLs, so it is not called under the lock.
+bool ConnectionPool::IsOpen(HttpContext& ctx) {
+    int fd = ctx.ssl_fd_.fd;
+    int events = ssgx::internal::HTTP_NET_EVENT_READ;
+    int revents = 0;
+    int ret = -1;
+    sgx_status_t status = ssgx_ocall_http_net_poll(&ret, &fd, &events, &revents, 1, 0);
+    if (status != SGX_SUCCESS || ret < 0) {
+        return false;
+    }
+    if (ret == 0 || revents == 0) {
+        return true;
+    }
+    if ((revents & ssgx::internal::HTTP_NET_EVENT_ERROR) || !ctx.is_https_) {
+        return false;
+    }
+
+    // Let mbedtls process the records which arrived, without waiting for more than a millisecond
+    const int time_out = ctx.time_out_;
+    ctx.time_out_ = 1;
+    unsigned char byte = 0;
+    ret = mbedtls_ssl_read(&ctx.ssl_, &byte, 1);
+    ctx.time_out_ = time_out;
+#ifdef MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET
+    if (ret == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET) {
+        return true;
+    }
+#endif
+    // A close_notify, a FIN (0), an error or unexpected data all end the connection
+    return ret == MBEDTLS_ERR_SSL_TIMEOUT || ret == MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+ConnectionPool& ConnectionPool::GetInstance() {
+    static ConnectionPool instance;
+    return instance;
+}
+
+std::unique_ptr<HttpContext> ConnectionPool::Acquire(const std::string& endpoint, const std::string& server_ca) {
+    const std::string ca_digest = TlsConfig::Digest(server_ca);
+    for (;;) {
+        std::unique_ptr<HttpContext> ctx = TakeIdle(endpoint, ca_digest);
+        if (!ctx || IsOpen(*ctx)) {
+            return ctx;
+        }
+        // The server closed it while it was idle: it is closed here, and the next one is tried
+    }
+}
+
+// Take the newest idle connection which passes IsHealthy(), dropping the others on the way.
+std::unique_ptr<HttpContext> ConnectionPool::TakeIdle(const std::string& endpoint, const std::string& ca_digest) {
+    std::vector<std::unique_ptr<HttpContext>> stale;
+    std::unique_ptr<HttpContext> ctx;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!options_.enabled) {
+            return nullptr;
+        }
+        auto endpoint_it = idle_.find(endpoint);
+        if (endpoint_it == idle_.end()) {
+            return nullptr;
+        }
+        auto ca_it = endpoint_it->second.find(ca_digest);
+        if (ca_it == endpoint_it->second.end()) {
+            return nullptr;
+        }
+
+        int64_t now = NowInMilliseconds();
+        IdleList& idle_list = ca_it->second;
+        while (!idle_list.empty() && !ctx) {
+            std::unique_ptr<HttpContext> candidate = std::move(idle_list.front());
+            idle_list.pop_front();
+            if (IsHealthy(*candidate, now, options_.idle_timeout_ms)) {
+                ctx = std::move(candidate);
+            } else {
+                stale.push_back(std::move(candidate));
+            }
+        }
+        if (idle_list.empty()) {
+            endpoint_it->second.erase(ca_it);
+            if (endpoint_it->second.empty()) {
+                idle_.erase(endpoint_it);
+            }
+        }
+    }
+    // Stale connections are closed here, outside the lock, since closing them takes OCALLs.
+    stale.clear();
+    return ctx;
+}
+
+void ConnectionPool::Release(const std::string& endpoint, const std::string& server_ca,
+                             std::unique_ptr<HttpContext> ctx) {
+    if (!ctx) {
+        return;
+    }
+    ctx->last_used_ms_ = NowInMilliseconds();
+    const std::string ca_digest = TlsConfig::Digest(server_ca);
+
+    std::unique_ptr<HttpContext> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!options_.enabled || options_.max_idle_per_host == 0 || ctx->last_used_ms_ < 0) {
+            evicted = std::move(ctx);
+        } else {
+            IdleList& idle_list = idle_[endpoint][ca_digest];
+            idle_list.push_front(std::move(ctx));
+            if (idle_list.size() > options_.max_idle_per_host) {
+                evicted = std::move(idle_list.back());
+                idle_list.pop_back();
+            }
+        }
+    }
+}
+
+void ConnectionPool::SetOptions(const ConnectionPoolOptions& options) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_ = options;
+    }
+    if (!options.enabled) {
+        Clear();
+    }
+}
+
+ConnectionPoolOptions ConnectionPool::GetOptions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return options_;
+}
+
+void ConnectionPool::Clear() {
+    std::map<std::string, std::map<std::string, IdleList>> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle.swap(idle_);
+    }
+}
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
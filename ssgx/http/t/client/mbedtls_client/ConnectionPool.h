@@ -0,0 +1,69 @@
+#ifndef _MBEDTLS_CLIENT_CONNECTION_POOL_H_
+#define _MBEDTLS_CLIENT_CONNECTION_POOL_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "ssgx_http_t_client.h"
+
+#include "HttpClient.h"
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+/**
+ * @brief Idle keep-alive connections shared by every HttpClient in the enclave.
+ *
+ * Connections are grouped by "scheme://host:port". Inside a group each connection remembers the digest of the CA chain
+ * it was verified with, so a connection is never reused by a client which trusts a different set of certificates.
+ * Before an idle connection is handed out, its socket is probed, so that one the server has closed meanwhile is
+ * dropped rather than failing the next request.
+ */
+class ConnectionPool {
+  public:
+    static ConnectionPool& GetInstance();
+
+    /**
+     * @brief Take an idle connection for the given endpoint and CA chain.
+     * @return nullptr if there is no healthy idle connection, the caller should connect a new one.
+     */
+    std::unique_ptr<HttpContext> Acquire(const std::string& endpoint, const std::string& server_ca);
+
+    /**
+     * @brief Give a connection back after a complete keep-alive exchange.
+     *
+     * The connection is closed instead if pooling is disabled or the endpoint already holds max_idle_per_host idle
+     * connections, in which case the oldest one is dropped.
+     */
+    void Release(const std::string& endpoint, const std::string& server_ca, std::unique_ptr<HttpContext> ctx);
+
+    void SetOptions(const ConnectionPoolOptions& options);
+    ConnectionPoolOptions GetOptions();
+
+    /**
+     * @brief Close all idle connections.
+     */
+    void Clear();
+
+  private:
+    ConnectionPool() = default;
+    std::unique_ptr<HttpContext> TakeIdle(const std::string& endpoint, const std::string& ca_digest);
+    static bool IsHealthy(const HttpContext& ctx, int64_t now, int idle_timeout_ms);
+    static bool IsOpen(HttpContext& ctx);
+
+    using IdleList = std::list<std::unique_ptr<HttpContext>>; // newest first
+
+    std::mutex mutex_;
+    ConnectionPoolOptions options_;
+    std::map<std::string, std::map<std::string, IdleList>> idle_; // endpoint -> CA chain digest -> idle connections
+};
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
+
+#endif //_MBEDTLS_CLIENT_CONNECTION_POOL_H_
@@ -5,7 +5,10 @@
 #include "sgx_trts.h"
 
 #include "../httpparser/httpresponseparser.h"
+#include "ConnectionPool.h"
 #include "HttpUrl.h"
+#include "SessionCache.h"
+#include "TlsConfig.h"
 
 #define DATA_BUF_SIZE 4 * 1024
 
@@ -54,19 +57,59 @@ HttpResult HttpClient::ExecuteRequest(const std::string& method, const std::stri
         return {HttpError::InvalidUrl, "Url scheme is not either http nor https: " + url_str};
     }
 
-    // Initialize connection
-    HttpContext ctx;
-    ctx.time_out_ = time_out_sec * 1000;
-    HttpResult ret = InitContext(url, ctx);
+    // Initialize request with headers and body
+    const std::string req_str = InitRequest(method, url, headers, body);
+
+    // Connections are reused per endpoint and per CA chain
+    const std::string endpoint = url.scheme() + "://" + url.hostname() + ":" + url.port();
+    const std::string no_ca;
+    const std::string& pool_ca = (url.scheme() == "https") ? server_ca_ : no_ca;
+    ConnectionPool& pool = ConnectionPool::GetInstance();
+
+    // Try an idle connection first
+    std::unique_ptr<HttpContext> ctx = pool.Acquire(endpoint, pool_ca);
+    if (ctx) {
+        ctx->time_out_ = (time_out_sec > 0) ? time_out_sec * 1000 : 10000;
+
+        HttpResult ret = DoRequest(*ctx, req_str, response);
+        if (ret.Code() == HttpError::OK) {
+            ret.SetSessionResumed(ctx->session_resumed_);
+            if (ctx->reusable_) {
+                pool.Release(endpoint, pool_ca, std::move(ctx));
+            }
+            return ret;
+        }
+
+        // The server may have closed the idle connection in the meantime. Retry on a new connection if the request
+        // can not have been processed: nothing was sent, or the server closed the connection without replying.
+        // Any other failure of a non-idempotent request is reported as is.
+        bool replay = (ret.Code() == HttpError::WriteFaild) ||
+                      (ret.Code() == HttpError::ReadFailed && (method == "GET" || ctx->closed_by_peer_));
+        if (!replay) {
+            return ret;
+        }
+        response = httpparser::Response();
+    }
+
+    // Initialize a new connection
+    ctx = std::make_unique<HttpContext>();
+    ctx->time_out_ = time_out_sec * 1000;
+    HttpResult ret = InitContext(url, *ctx);
+    if (ret.Code() != HttpError::OK) {
+        return ret;
+    }
+    ret = Connect(url, *ctx);
     if (ret.Code() != HttpError::OK) {
         return ret;
     }
-
-    // Initialize request with headers and body
-    const std::string req_str = InitRequest(method, url, headers, body);
 
     // Send the request
-    return DoRequest(url, ctx, req_str, response);
+    ret = DoRequest(*ctx, req_str, response);
+    ret.SetSessionResumed(ctx->session_resumed_);
+    if (ret.Code() == HttpError::OK && ctx->reusable_) {
+        pool.Release(endpoint, pool_ca, std::move(ctx));
+    }
+    return ret;
 }
 
 std::string HttpClient::InitUrl(const std::string& path, const std::list<std::string>& params) {
@@ -156,86 +199,47 @@ std::string HttpClient::InitRequest(const std::string& method, const HttpUrl& ur
 }
 
 HttpResult HttpClient::InitContext(const HttpUrl& url, HttpContext& ctx) {
-    char err_msg[1024] = {0};
-
     mbedtls_net_init_ocall(&ctx.ssl_fd_);
 
-    ctx.is_https_ = (url.scheme() == "https");
-
-    if (ctx.is_https_) {
-        int ret = 0;
-        /*
-         * Generate a random number as a nonce for mbedtls random number generation
-         * The nonce length must be:
-         * 1) at least 24 bytes for a 128-bit strength (maximum achievable strength when using AES-128);
-         * 2) at least 48 bytes for a 256-bit strength (maximum achievable strength when using AES-256).
-         * Refer to:
-         * https://mbed-tls.readthedocs.io/projects/api/en/development/api/file/ctr__drbg_8h/#ctr__drbg_8h_1ad93d675f998550b4478c1fe6f4f34ebc
-         */
-        uint8_t nonce[48] = {0};
-        sgx_status_t status = sgx_read_rand(nonce, sizeof(nonce));
-        if (status != SGX_SUCCESS) {
-            return {HttpError::SetSeedFailed, "sgx_read_rand() failed! Unable to generate nonce."};
-        }
-
-        // Initialize TLS components
-        mbedtls_ssl_init(&ctx.ssl_);
-        mbedtls_ssl_config_init(&ctx.conf_);
-        mbedtls_x509_crt_init(&ctx.ca_cert_);
-        mbedtls_ctr_drbg_init(&ctx.ctr_drbg_);
-        mbedtls_entropy_init(&ctx.entropy_);
-
-        // Turn prediction resistance on
-        mbedtls_ctr_drbg_set_prediction_resistance(&ctx.ctr_drbg_, MBEDTLS_CTR_DRBG_PR_ON);
-
-        // Set DRBG entropy source
-        if ((ret = mbedtls_ctr_drbg_seed(&ctx.ctr_drbg_, mbedtls_entropy_func, &ctx.entropy_, nonce, sizeof(nonce))) !=
-            0) {
-            mbedtls_strerror(ret, err_msg, sizeof(err_msg));
-            return {HttpError::SetSeedFailed, "mbedtls_ctr_drbg_seed() filed! Error: " + std::string(err_msg)};
-        }
+    // Check and set time out
+    if (ctx.time_out_ <= 0) {
+        ctx.time_out_ = 10000;
+    }
 
-        // Parse and set CA certificates
-        // server_ca_ is a base64 string, parameter buflen must be size() + 1
-        if (!server_ca_.empty()) {
-            if ((ret = mbedtls_x509_crt_parse(&ctx.ca_cert_, reinterpret_cast<const uint8_t*>(server_ca_.c_str()),
-                                              server_ca_.size() + 1)) != 0) {
-                mbedtls_strerror(ret, err_msg, sizeof(err_msg));
-                return {HttpError::CACertsWrong, "mbedtls_x509_crt_parse() filed! Error: " + std::string(err_msg)};
-            }
+    if (url.scheme() == "https") {
+        // Seed the DRBG of this thread once, instead of a new DRBG per connection
+        HttpResult ret = TlsConfig::PrepareThreadRandom();
+        if (ret.Code() != HttpError::OK) {
+            return ret;
         }
 
-        // Set SSL default parameters
-        if ((ret = mbedtls_ssl_config_defaults(&ctx.conf_, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
-                                               MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
-            mbedtls_strerror(ret, err_msg, sizeof(err_msg));
-            return {HttpError::SSLConfigFailed, "mbedtls_ssl_config_defaults() filed! Error: " + std::string(err_msg)};
+        // The CA chain is parsed once per bundle and shared by all connections
+        ret = TlsConfig::Get(server_ca_, ctx.tls_config_);
+        if (ret.Code() != HttpError::OK) {
+            return ret;
         }
 
-        // During handshake, verify server's certificate is required!
-        mbedtls_ssl_conf_authmode(&ctx.conf_, MBEDTLS_SSL_VERIFY_REQUIRED);
-
-        // Confiture ca certificates to verify server's certificates
-        mbedtls_ssl_conf_ca_chain(&ctx.conf_, &ctx.ca_cert_, nullptr);
-
-        mbedtls_ssl_conf_rng(&ctx.conf_, mbedtls_ctr_drbg_random, &ctx.ctr_drbg_);
-
-        // Check and set time out
-        if (ctx.time_out_ <= 0) {
-            ctx.time_out_ = 10000;
-        }
-        mbedtls_ssl_conf_read_timeout(&ctx.conf_, ctx.time_out_);
+        // Initialize TLS components
+        mbedtls_ssl_init(&ctx.ssl_);
+        ctx.is_https_ = true;
     }
 
     return {HttpError::OK, "Success"};
 }
 
-HttpResult HttpClient::DoRequest(const HttpUrl& url, HttpContext& ctx, const std::string& request,
-                                 httpparser::Response& response) {
+int HttpClient::BioSend(void* ctx, const unsigned char* buf, size_t len) {
+    return mbedtls_net_send_ocall(&static_cast<HttpContext*>(ctx)->ssl_fd_, buf, len);
+}
+
+// The read timeout is taken from the connection, since the shared TLS configuration has none.
+int HttpClient::BioRecv(void* ctx, unsigned char* buf, size_t len) {
+    auto* http_ctx = static_cast<HttpContext*>(ctx);
+    return mbedtls_net_recv_timeout_ocall(&http_ctx->ssl_fd_, buf, len, http_ctx->time_out_);
+}
+
+HttpResult HttpClient::Connect(const HttpUrl& url, HttpContext& ctx) {
     int ret = 0;
-    size_t req_len = request.size();
     char err_msg[1024] = {0};
-    HttpResult result;
 
     // Connect to the server
     if ((ret = mbedtls_net_connect_ocall(&ctx.ssl_fd_, url.hostname().c_str(), url.port().c_str(),
@@ -246,7 +250,7 @@ HttpResult HttpClient::DoRequest(const HttpUrl& url, HttpContext& ctx, const std
 
     // Do SSL/TLS connect for HTTPS
     if (ctx.is_https_) {
-        if ((ret = mbedtls_ssl_setup(&ctx.ssl_, &ctx.conf_)) != 0) {
+        if ((ret = mbedtls_ssl_setup(&ctx.ssl_, ctx.tls_config_->Conf())) != 0) {
             mbedtls_strerror(ret, err_msg, sizeof(err_msg));
             return {HttpError::SSLSetupFailed, "mbedtls_ssl_setup() filed! Error: " + std::string(err_msg)};
         }
@@ -256,14 +260,19 @@ HttpResult HttpClient::DoRequest(const HttpUrl& url, HttpContext& ctx, const std
             return {HttpError::SSLHostNameWrong, "mbedtls_ssl_set_hostname() filed! Error: " + std::string(err_msg)};
         }
 
-        mbedtls_ssl_set_bio(&ctx.ssl_, &ctx.ssl_fd_, mbedtls_net_send_ocall, mbedtls_net_recv_ocall,
-                            mbedtls_net_recv_timeout_ocall);
+        mbedtls_ssl_set_bio(&ctx.ssl_, &ctx, BioSend, BioRecv, nullptr);
 
-        // Set time out for DTLS handshaking
-        mbedtls_ssl_conf_handshake_timeout(&ctx.conf_, ctx.time_out_, 2 * ctx.time_out_);
+        // Offer the session of the last handshake with this server, so that it can resume it
+        SessionCache& session_cache = SessionCache::GetInstance();
+        const std::string endpoint = url.hostname() + ":" + url.port();
+        bool session_offered = session_cache.Load(endpoint, ctx.tls_config_, &ctx.ssl_);
 
         while ((ret = mbedtls_ssl_handshake(&ctx.ssl_)) != 0) {
             if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+                if (session_offered) {
+                    session_cache.Remove(endpoint);
+                    session_cache.CountOffer(false);
+                }
                 mbedtls_strerror(ret, err_msg, sizeof(err_msg));
                 if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
                     return {HttpError::VerifyCACertsFailed,
@@ -272,8 +281,26 @@ HttpResult HttpClient::DoRequest(const HttpUrl& url, HttpContext& ctx, const std
                 return {HttpError::HandShakeFailed, "mbedtls_ssl_handshake() filed! Error: " + std::string(err_msg)};
             }
         }
+
+        // The server may have declined the session and made a full handshake instead
+        ctx.session_resumed_ = session_offered && mbedtls_ssl_session_reused(&ctx.ssl_) != 0;
+        if (session_offered) {
+            session_cache.CountOffer(ctx.session_resumed_);
+        }
+        session_cache.Store(endpoint, ctx.tls_config_, &ctx.ssl_);
     }
 
+    return {HttpError::OK, "Success"};
+}
+
+HttpResult HttpClient::DoRequest(HttpContext& ctx, const std::string& request, httpparser::Response& response) {
+    int ret = 0;
+    size_t req_len = request.size();
+
+    // Only a connection which delivers a complete keep-alive response can go back to the pool
+    ctx.reusable_ = false;
+    ctx.closed_by_peer_ = false;
+
     // To send the entire request data
     if ((ret = http_write(ctx, request.c_str(), req_len)) <= 0) {
         return {HttpError::WriteFaild, "http_write() filed! ret: " + std::to_string(ret)};
@@ -345,9 +372,13 @@ int HttpClient::http_read(HttpContext& ctx, httpparser::Response& resp) {
                 return -1;
             }
             continue;
+        } else if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+            ctx.closed_by_peer_ = true;
+            return ret;
         } else if (ret < 0) {
             return ret;
         } else if (ret == 0) {
+            ctx.closed_by_peer_ = true;
             break;
         }
 
@@ -361,7 +392,11 @@ int HttpClient::http_read(HttpContext& ctx, httpparser::Response& resp) {
         // unless we waste time to do a read operation again until we get a MBEDTLS_ERR_SSL_TIMEOUT error.
         result = parser.parse(resp, reinterpret_cast<const char*>(read_buf),
                                 reinterpret_cast<const char*>(read_buf + ret));
-        if (HttpResponseParser::ParsingCompleted == result || HttpResponseParser::ParsingError == result) {
+        if (HttpResponseParser::ParsingCompleted == result) {
+            ctx.reusable_ = resp.keepAlive;
+            break;
+        }
+        if (HttpResponseParser::ParsingError == result) {
             break;
         }
     }
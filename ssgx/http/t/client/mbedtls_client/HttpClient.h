@@ -1,12 +1,13 @@
 #ifndef _MBEDTLS_CLIENT_HTTP_CLIENT_H_
 #define _MBEDTLS_CLIENT_HTTP_CLIENT_H_
 
+#include <cstdint>
 #include <list>
+#include <memory>
 #include <string>
 
-#include "mbedtls/ctr_drbg.h"
-#include "mbedtls/entropy.h"
 #include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
 
 #include "../httpparser/response.h"
 #include "HttpUrl.h"
@@ -40,6 +41,7 @@ enum class HttpError {
 class HttpResult {
     HttpError code_;
     std::string msg_;
+    bool session_resumed_ = false;
 
   public:
     HttpResult() : code_(HttpError::OK), msg_("Success") {
@@ -54,12 +56,21 @@ class HttpResult {
     const std::string& Message() const {
         return msg_;
     }
+    // Whether the connection of the request was set up by resuming a cached TLS session
+    bool SessionResumed() const {
+        return session_resumed_;
+    }
+    void SetSessionResumed(bool resumed) {
+        session_resumed_ = resumed;
+    }
 };
 
 /**
  * @brief The context for http client
  *
  */
+class TlsConfig;
+
 class HttpContext {
   public:
     HttpContext() {};
@@ -71,25 +82,24 @@ class HttpContext {
         mbedtls_net_free_ocall(&ssl_fd_);
 
         if (is_https_) {
-            mbedtls_x509_crt_free(&ca_cert_);
             mbedtls_ssl_free(&ssl_);
-            mbedtls_ssl_config_free(&conf_);
-            mbedtls_ctr_drbg_free(&ctr_drbg_);
-            mbedtls_entropy_free(&entropy_);
         }
     }
     // class HttpClient can access private members
     friend class HttpClient;
+    friend class ConnectionPool;
+    friend class RequestBatch;
 
   private:
     bool is_https_ = false;
-    int time_out_ = 10000; // in milliseconds
+    int time_out_ = 10000;        // in milliseconds
+    bool reusable_ = false;       // the last response was read completely and the server keeps the connection open
+    bool closed_by_peer_ = false; // the server closed the connection during the last read
+    bool session_resumed_ = false; // the handshake resumed a cached TLS session
+    int64_t last_used_ms_ = 0;    // when the connection was returned to the pool
+    std::shared_ptr<const TlsConfig> tls_config_; // CA chain and TLS settings, shared with other connections
     mbedtls_net_context ssl_fd_;
-    mbedtls_entropy_context entropy_;
-    mbedtls_ctr_drbg_context ctr_drbg_;
     mbedtls_ssl_context ssl_;
-    mbedtls_ssl_config conf_;
-    mbedtls_x509_crt ca_cert_;
 };
 
 class HttpClient {
@@ -106,6 +116,8 @@ class HttpClient {
                     int time_out_sec, httpparser::Response& response);
 
   private:
+    friend class RequestBatch;
+
     HttpResult ExecuteRequest(const std::string& method, const std::string& path, const std::list<std::string>& headers,
                               const std::list<std::string>& params, const std::string& body, int time_out_sec,
                               httpparser::Response& response);
@@ -113,7 +125,10 @@ class HttpClient {
     std::string InitRequest(const std::string& method, const HttpUrl& url, const std::list<std::string>& headers,
                             const std::string& body = "");
     HttpResult InitContext(const HttpUrl& url, HttpContext& ctx);
-    HttpResult DoRequest(const HttpUrl& url, HttpContext& ctx, const std::string& request, httpparser::Response& response);
+    HttpResult Connect(const HttpUrl& url, HttpContext& ctx);
+    HttpResult DoRequest(HttpContext& ctx, const std::string& request, httpparser::Response& response);
+    static int BioSend(void* ctx, const unsigned char* buf, size_t len);
+    static int BioRecv(void* ctx, unsigned char* buf, size_t len);
     int http_write(HttpContext& ctx, const char* buffer, size_t len);
     int http_read(HttpContext& ctx, httpparser::Response& resp);
 
@@ -0,0 +1,405 @@
+#include "RequestBatch.h"
+
+#include "mbedtls/error.h"
+
+#include "sgx_trts.h"
+
+#include "ssgx_http_t_t.h"
+
+#include "../../../share/NetEvents.h"
+#include "ConnectionPool.h"
+#include "SessionCache.h"
+#include "TlsConfig.h"
+
+#define DATA_BUF_SIZE 4 * 1024
+
+using namespace httpparser;
+using namespace ssgx::internal;
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+// Error reported for a request which could not complete because the batch stopped waiting for it.
+HttpResult RequestBatch::Interrupted(State state, const std::string& reason) {
+    switch (state) {
+    case State::Connecting:
+        return {HttpError::ConnectFailed, "Connect interrupted: " + reason};
+    case State::Handshaking:
+        return {HttpError::HandShakeFailed, "Handshake interrupted: " + reason};
+    case State::Writing:
+        return {HttpError::WriteFaild, "Write interrupted: " + reason};
+    default:
+        return {HttpError::ReadFailed, "Read interrupted: " + reason};
+    }
+}
+
+size_t RequestBatch::Add(const HttpClient& client, const std::string& method, const std::string& path,
+                         const std::list<std::string>& headers, const std::list<std::string>& params,
+                         const std::string& body) {
+    auto item = std::make_unique<Item>(client);
+    item->method = method;
+
+    // Same url checks as HttpClient::ExecuteRequest()
+    const std::string url_str = item->client.InitUrl(path, params);
+    if (!item->url.parse(url_str)) {
+        item->result = {HttpError::InvalidUrl, "Invalid url: " + url_str};
+    } else if (item->url.scheme() != "http" && item->url.scheme() != "https") {
+        item->result = {HttpError::InvalidUrl, "Url scheme is not either http nor https: " + url_str};
+    } else {
+        item->request = item->client.InitRequest(method, item->url, headers, body);
+        item->endpoint = item->url.scheme() + "://" + item->url.hostname() + ":" + item->url.port();
+        if (item->url.scheme() == "https") {
+            item->pool_ca = item->client.server_ca_;
+        }
+        item->state = State::Queued;
+    }
+
+    items_.push_back(std::move(item));
+    return items_.size() - 1;
+}
+
+void RequestBatch::Run(int time_out_sec) {
+    time_out_ms_ = (time_out_sec > 0) ? time_out_sec * 1000 : 10000;
+
+    for (auto& item : items_) {
+        if (item->state == State::Queued) {
+            Start(*item);
+        }
+    }
+
+    // Every request which is not done is waiting for an event on its socket
+    std::vector<Item*> waiting;
+    std::vector<int> fds;
+    std::vector<int> events;
+    std::vector<int> revents;
+    while (true) {
+        waiting.clear();
+        fds.clear();
+        events.clear();
+        for (auto& item : items_) {
+            if (item->state != State::Done) {
+                waiting.push_back(item.get());
+                fds.push_back(item->ctx->ssl_fd_.fd);
+                events.push_back(item->wait_events);
+            }
+        }
+        if (waiting.empty()) {
+            break;
+        }
+
+        int ret = -1;
+        revents.assign(waiting.size(), 0);
+        sgx_status_t status = ssgx_ocall_http_net_poll(&ret, fds.data(), events.data(), revents.data(), fds.size(),
+                                                       time_out_ms_);
+        if (status != SGX_SUCCESS || ret <= 0) {
+            const std::string reason = (status == SGX_SUCCESS && ret == 0)
+                                           ? "timed out"
+                                           : "ssgx_ocall_http_net_poll() failed! ret: " + std::to_string(ret);
+            for (Item* item : waiting) {
+                Finish(*item, Interrupted(item->state, reason));
+            }
+            break;
+        }
+
+        for (size_t i = 0; i < waiting.size(); ++i) {
+            if (revents[i] != 0) {
+                Step(*waiting[i]);
+            }
+        }
+    }
+}
+
+void RequestBatch::Start(Item& item) {
+    // Try an idle connection first
+    item.ctx = ConnectionPool::GetInstance().Acquire(item.endpoint, item.pool_ca);
+    if (!item.ctx) {
+        OpenConnection(item);
+        return;
+    }
+
+    item.reused = true;
+    item.ctx->time_out_ = time_out_ms_;
+    if (item.ctx->is_https_) {
+        mbedtls_ssl_set_bio(&item.ctx->ssl_, item.ctx.get(), BioSendNonBlocking, BioRecvNonBlocking, nullptr);
+    }
+    item.state = State::Writing;
+    Step(item);
+}
+
+void RequestBatch::OpenConnection(Item& item) {
+    item.ctx = std::make_unique<HttpContext>();
+    item.ctx->time_out_ = time_out_ms_;
+    item.reused = false;
+    item.session_offered = false;
+    item.written = 0;
+    item.read_size = 0;
+    item.parser = HttpResponseParser();
+    item.response = httpparser::Response();
+
+    HttpResult ret = item.client.InitContext(item.url, *item.ctx);
+    if (ret.Code() != HttpError::OK) {
+        Finish(item, ret);
+        return;
+    }
+
+    // The connection is only started here, the batch waits for its completion with the other sockets
+    int fd = -1;
+    int connect_ret = -1;
+    sgx_status_t status =
+        ssgx_ocall_http_net_connect_start(&connect_ret, item.url.hostname().c_str(), item.url.port().c_str(), &fd);
+    if (status != SGX_SUCCESS || connect_ret != 0) {
+        Finish(item, {HttpError::ConnectFailed,
+                      "ssgx_ocall_http_net_connect_start() failed! ret: " + std::to_string(connect_ret)});
+        return;
+    }
+    item.ctx->ssl_fd_.fd = fd;
+
+    item.state = State::Connecting;
+    item.wait_events = HTTP_NET_EVENT_WRITE;
+}
+
+void RequestBatch::Step(Item& item) {
+    item.wait_events = 0;
+    while (item.state != State::Done && item.wait_events == 0) {
+        HttpResult ret;
+        switch (item.state) {
+        case State::Connecting:
+            ret = StepConnecting(item);
+            break;
+        case State::Handshaking:
+            ret = StepHandshaking(item);
+            break;
+        case State::Writing:
+            ret = StepWriting(item);
+            break;
+        default:
+            ret = StepReading(item);
+            break;
+        }
+
+        if (ret.Code() != HttpError::OK) {
+            if (CanReplay(item, ret)) {
+                OpenConnection(item);
+            } else {
+                Finish(item, ret);
+            }
+        }
+    }
+}
+
+HttpResult RequestBatch::StepConnecting(Item& item) {
+    HttpContext& ctx = *item.ctx;
+    int ret = -1;
+    char err_msg[1024] = {0};
+
+    sgx_status_t status = ssgx_ocall_http_net_connect_finish(&ret, ctx.ssl_fd_.fd);
+    if (status == SGX_SUCCESS && ret == HTTP_NET_CONNECT_NEXT) {
+        item.wait_events = HTTP_NET_EVENT_WRITE;
+        return {HttpError::OK, "Success"};
+    }
+    if (status != SGX_SUCCESS || ret != 0) {
+        return {HttpError::ConnectFailed, "ssgx_ocall_http_net_connect_finish() failed! ret: " + std::to_string(ret)};
+    }
+
+    if (!ctx.is_https_) {
+        item.state = State::Writing;
+        return {HttpError::OK, "Success"};
+    }
+
+    if ((ret = mbedtls_ssl_setup(&ctx.ssl_, ctx.tls_config_->Conf())) != 0) {
+        mbedtls_strerror(ret, err_msg, sizeof(err_msg));
+        return {HttpError::SSLSetupFailed, "mbedtls_ssl_setup() filed! Error: " + std::string(err_msg)};
+    }
+
+    if ((ret = mbedtls_ssl_set_hostname(&ctx.ssl_, item.url.hostname().c_str())) != 0) {
+        mbedtls_strerror(ret, err_msg, sizeof(err_msg));
+        return {HttpError::SSLHostNameWrong, "mbedtls_ssl_set_hostname() filed! Error: " + std::string(err_msg)};
+    }
+
+    mbedtls_ssl_set_bio(&ctx.ssl_, &ctx, BioSendNonBlocking, BioRecvNonBlocking, nullptr);
+
+    // Offer the session of the last handshake with this server, so that it can resume it
+    item.session_offered =
+        SessionCache::GetInstance().Load(item.url.hostname() + ":" + item.url.port(), ctx.tls_config_, &ctx.ssl_);
+
+    item.state = State::Handshaking;
+    return {HttpError::OK, "Success"};
+}
+
+HttpResult RequestBatch::StepHandshaking(Item& item) {
+    HttpContext& ctx = *item.ctx;
+    SessionCache& session_cache = SessionCache::GetInstance();
+    const std::string session_endpoint = item.url.hostname() + ":" + item.url.port();
+
+    int ret = mbedtls_ssl_handshake(&ctx.ssl_);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
+        item.wait_events = HTTP_NET_EVENT_READ;
+        return {HttpError::OK, "Success"};
+    }
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        item.wait_events = HTTP_NET_EVENT_WRITE;
+        return {HttpError::OK, "Success"};
+    }
+    if (ret != 0) {
+        if (item.session_offered) {
+            session_cache.Remove(session_endpoint);
+            session_cache.CountOffer(false);
+        }
+        char err_msg[1024] = {0};
+        mbedtls_strerror(ret, err_msg, sizeof(err_msg));
+        if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
+            return {HttpError::VerifyCACertsFailed, "mbedtls_ssl_handshake() filed! Error: " + std::string(err_msg)};
+        }
+        return {HttpError::HandShakeFailed, "mbedtls_ssl_handshake() filed! Error: " + std::string(err_msg)};
+    }
+
+    // The server may have declined the session and made a full handshake instead
+    ctx.session_resumed_ = item.session_offered && mbedtls_ssl_session_reused(&ctx.ssl_) != 0;
+    if (item.session_offered) {
+        session_cache.CountOffer(ctx.session_resumed_);
+    }
+    session_cache.Store(session_endpoint, ctx.tls_config_, &ctx.ssl_);
+    item.state = State::Writing;
+    return {HttpError::OK, "Success"};
+}
+
+HttpResult RequestBatch::StepWriting(Item& item) {
+    HttpContext& ctx = *item.ctx;
+
+    // Only a connection which delivers a complete keep-alive response can go back to the pool
+    if (item.written == 0) {
+        ctx.reusable_ = false;
+        ctx.closed_by_peer_ = false;
+    }
+
+    while (item.written < item.request.size()) {
+        const auto* data = reinterpret_cast<const unsigned char*>(item.request.data()) + item.written;
+        size_t len = item.request.size() - item.written;
+        int ret = ctx.is_https_ ? mbedtls_ssl_write(&ctx.ssl_, data, len) : BioSendNonBlocking(&ctx, data, len);
+        if (ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            item.wait_events = HTTP_NET_EVENT_WRITE;
+            return {HttpError::OK, "Success"};
+        }
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
+            item.wait_events = HTTP_NET_EVENT_READ;
+            return {HttpError::OK, "Success"};
+        }
+        if (ret <= 0) {
+            return {HttpError::WriteFaild, "http_write() filed! ret: " + std::to_string(ret)};
+        }
+        item.written += ret;
+    }
+
+    item.state = State::Reading;
+    return {HttpError::OK, "Success"};
+}
+
+HttpResult RequestBatch::StepReading(Item& item) {
+    HttpContext& ctx = *item.ctx;
+    uint8_t read_buf[DATA_BUF_SIZE] = {0};
+
+    // Same end of response rules as HttpClient::http_read()
+    while (true) {
+        int ret = ctx.is_https_ ? mbedtls_ssl_read(&ctx.ssl_, read_buf, DATA_BUF_SIZE)
+                                : BioRecvNonBlocking(&ctx, read_buf, DATA_BUF_SIZE);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
+            item.wait_events = HTTP_NET_EVENT_READ;
+            return {HttpError::OK, "Success"};
+        }
+        if (ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            item.wait_events = HTTP_NET_EVENT_WRITE;
+            return {HttpError::OK, "Success"};
+        }
+        if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+            ctx.closed_by_peer_ = true;
+            return {HttpError::ReadFailed, "http_read() failed! ret: " + std::to_string(ret)};
+        }
+        if (ret < 0) {
+            return {HttpError::ReadFailed, "http_read() failed! ret: " + std::to_string(ret)};
+        }
+        if (ret == 0) {
+            ctx.closed_by_peer_ = true;
+            if (item.read_size == 0) {
+                return {HttpError::ReadFailed, "http_read() failed! ret: 0"};
+            }
+            Finish(item, {HttpError::OK, "Success"});
+            return {HttpError::OK, "Success"};
+        }
+
+        item.read_size += ret;
+        HttpResponseParser::ParseResult result =
+            item.parser.parse(item.response, reinterpret_cast<const char*>(read_buf),
+                              reinterpret_cast<const char*>(read_buf + ret));
+        if (result == HttpResponseParser::ParsingCompleted) {
+            ctx.reusable_ = item.response.keepAlive;
+        }
+        if (result != HttpResponseParser::ParsingIncompleted) {
+            Finish(item, {HttpError::OK, "Success"});
+            return {HttpError::OK, "Success"};
+        }
+    }
+}
+
+void RequestBatch::Finish(Item& item, const HttpResult& result) {
+    item.result = result;
+    item.state = State::Done;
+    item.wait_events = 0;
+    if (!item.ctx) {
+        return;
+    }
+    item.result.SetSessionResumed(item.ctx->session_resumed_);
+
+    // Give the connection its blocking callbacks back before HttpClient uses it again, or closes it
+    if (item.ctx->is_https_) {
+        mbedtls_ssl_set_bio(&item.ctx->ssl_, item.ctx.get(), HttpClient::BioSend, HttpClient::BioRecv, nullptr);
+    }
+    if (result.Code() == HttpError::OK && item.ctx->reusable_) {
+        ConnectionPool::GetInstance().Release(item.endpoint, item.pool_ca, std::move(item.ctx));
+    }
+    item.ctx.reset();
+}
+
+// Same rule as HttpClient::ExecuteRequest(): an idle connection may have been closed by the server in the meantime.
+bool RequestBatch::CanReplay(const Item& item, const HttpResult& result) {
+    if (!item.reused) {
+        return false;
+    }
+    return (result.Code() == HttpError::WriteFaild) ||
+           (result.Code() == HttpError::ReadFailed && (item.method == "GET" || item.ctx->closed_by_peer_));
+}
+
+int RequestBatch::BioSendNonBlocking(void* ctx, const unsigned char* buf, size_t len) {
+    int ret = HTTP_NET_FAILED;
+    sgx_status_t status = ssgx_ocall_http_net_send(&ret, static_cast<HttpContext*>(ctx)->ssl_fd_.fd, buf, len);
+    if (status != SGX_SUCCESS) {
+        return MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    if (ret == HTTP_NET_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    // A byte count can not exceed len, checked since the value comes from outside of the enclave
+    if (ret < 0 || static_cast<size_t>(ret) > len) {
+        return MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    return ret;
+}
+
+int RequestBatch::BioRecvNonBlocking(void* ctx, unsigned char* buf, size_t len) {
+    int ret = HTTP_NET_FAILED;
+    sgx_status_t status = ssgx_ocall_http_net_recv(&ret, static_cast<HttpContext*>(ctx)->ssl_fd_.fd, buf, len);
+    if (status != SGX_SUCCESS) {
+        return MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    if (ret == HTTP_NET_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (ret < 0 || static_cast<size_t>(ret) > len) {
+        return MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return ret;
+}
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
@@ -0,0 +1,100 @@
+#ifndef _MBEDTLS_CLIENT_REQUEST_BATCH_H_
+#define _MBEDTLS_CLIENT_REQUEST_BATCH_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../httpparser/httpresponseparser.h"
+#include "../httpparser/response.h"
+#include "HttpClient.h"
+#include "HttpUrl.h"
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+/**
+ * @brief Several requests kept in flight at the same time by the calling enclave thread.
+ *
+ * Each request gets its own connection, taken from the connection pool or newly opened. The sockets are used in
+ * non-blocking mode and the thread sleeps in a single poll() ocall on all of them until one can make progress, so N
+ * requests take about the time of the slowest one and need only one TCS.
+ *
+ * Connections end up in the same state as the ones of HttpClient: complete keep-alive exchanges are returned to the
+ * pool, and new TLS sessions are stored in the session cache.
+ */
+class RequestBatch {
+  public:
+    RequestBatch() = default;
+    RequestBatch(const RequestBatch&) = delete;
+    RequestBatch& operator=(const RequestBatch&) = delete;
+
+    /**
+     * @brief Queue a request. Same parameters as HttpClient::Get() and HttpClient::Post().
+     * @return Index of the request, for Result() and Response().
+     */
+    size_t Add(const HttpClient& client, const std::string& method, const std::string& path,
+               const std::list<std::string>& headers, const std::list<std::string>& params, const std::string& body);
+
+    /**
+     * @brief Run all queued requests until each one has completed or failed.
+     * @param time_out_sec The batch fails the requests which are still pending when none of them has made any
+     * progress for this long. As with HttpClient, this bounds each wait, not the whole exchange.
+     */
+    void Run(int time_out_sec);
+
+    const HttpResult& Result(size_t index) const {
+        return items_[index]->result;
+    }
+    httpparser::Response& Response(size_t index) {
+        return items_[index]->response;
+    }
+
+  private:
+    enum class State { Queued, Connecting, Handshaking, Writing, Reading, Done };
+
+    struct Item {
+        explicit Item(const HttpClient& http_client) : client(http_client) {
+        }
+        HttpClient client;
+        std::string method;
+        HttpUrl url;
+        std::string endpoint;
+        std::string pool_ca;
+        std::string request;
+        std::unique_ptr<HttpContext> ctx;
+        bool reused = false;          // the connection came from the pool
+        bool session_offered = false; // a cached TLS session was offered during the handshake
+        State state = State::Done;
+        int wait_events = 0; // HTTP_NET_EVENT_* to wait for before the next Step()
+        size_t written = 0;
+        size_t read_size = 0;
+        httpparser::HttpResponseParser parser;
+        httpparser::Response response;
+        HttpResult result;
+    };
+
+    void Start(Item& item);
+    void OpenConnection(Item& item);
+    void Step(Item& item);
+    HttpResult StepConnecting(Item& item);
+    HttpResult StepHandshaking(Item& item);
+    HttpResult StepWriting(Item& item);
+    HttpResult StepReading(Item& item);
+    void Finish(Item& item, const HttpResult& result);
+    static bool CanReplay(const Item& item, const HttpResult& result);
+    static HttpResult Interrupted(State state, const std::string& reason);
+    static int BioSendNonBlocking(void* ctx, const unsigned char* buf, size_t len);
+    static int BioRecvNonBlocking(void* ctx, unsigned char* buf, size_t len);
+
+    int time_out_ms_ = 10000;
+    std::vector<std::unique_ptr<Item>> items_;
+};
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
+
+#endif //_MBEDTLS_CLIENT_REQUEST_BATCH_H_
@@ -0,0 +1,126 @@
+#include "SessionCache.h"
+
+#include "ssgx_utils_t.h"
+#include "ssgx_utils_t_control_page.h"
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+// Current time in milliseconds, or -1 if the untrusted clock is not usable. The coarse clock of the control page is
+// read without an OCALL, and is precise enough for timeouts of seconds.
+static int64_t NowInMilliseconds() {
+    try {
+        return ssgx::utils_t::ControlPage::CoarseNowInMilliseconds();
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+SessionCache& SessionCache::GetInstance() {
+    static SessionCache instance;
+    return instance;
+}
+
+bool SessionCache::Load(const std::string& endpoint, const std::shared_ptr<const TlsConfig>& tls_config,
+                        mbedtls_ssl_context* ssl) {
+    std::unique_ptr<Entry> expired;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!options_.enabled) {
+        return false;
+    }
+
+    int64_t now = NowInMilliseconds();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        Entry& entry = **it;
+        if (entry.endpoint != endpoint) {
+            continue;
+        }
+        if (now < 0 || now >= entry.expire_ms || entry.tls_config.lock() != tls_config) {
+            expired = std::move(*it);
+            entries_.erase(it);
+            break;
+        }
+        if (mbedtls_ssl_set_session(ssl, &entry.session) != 0) {
+            break;
+        }
+        return true;
+    }
+    stats_.misses++;
+    return false;
+}
+
+void SessionCache::Store(const std::string& endpoint, const std::shared_ptr<const TlsConfig>& tls_config,
+                         const mbedtls_ssl_context* ssl) {
+    int64_t now = NowInMilliseconds();
+    if (now < 0) {
+        return;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    if (mbedtls_ssl_get_session(ssl, &entry->session) != 0) {
+        return;
+    }
+    entry->endpoint = endpoint;
+    entry->tls_config = tls_config;
+
+    std::unique_ptr<Entry> replaced;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!options_.enabled || options_.max_entries == 0) {
+        return;
+    }
+    entry->expire_ms = now + static_cast<int64_t>(options_.lifetime_sec) * 1000;
+
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if ((*it)->endpoint == endpoint) {
+            replaced = std::move(*it);
+            entries_.erase(it);
+            break;
+        }
+    }
+    entries_.push_front(std::move(entry));
+    while (entries_.size() > options_.max_entries) {
+        entries_.pop_back();
+    }
+}
+
+void SessionCache::CountOffer(bool resumed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (resumed) {
+        stats_.hits++;
+    } else {
+        stats_.misses++;
+    }
+}
+
+void SessionCache::Remove(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if ((*it)->endpoint == endpoint) {
+            entries_.erase(it);
+            break;
+        }
+    }
+}
+
+void SessionCache::SetOptions(const TlsSessionCacheOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    if (!options_.enabled) {
+        entries_.clear();
+    }
+    while (entries_.size() > options_.max_entries) {
+        entries_.pop_back();
+    }
+}
+
+TlsSessionCacheStats SessionCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TlsSessionCacheStats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
@@ -0,0 +1,85 @@
+#ifndef _MBEDTLS_CLIENT_SESSION_CACHE_H_
+#define _MBEDTLS_CLIENT_SESSION_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "mbedtls/ssl.h"
+
+#include "ssgx_http_t_client.h"
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+class TlsConfig;
+
+/**
+ * @brief TLS sessions of past handshakes, offered again when a new connection to the same server is made.
+ *
+ * A resumed handshake skips the certificate chain verification, so a session is only offered to a connection which
+ * uses the very same TlsConfig (hence the same trusted CA chain) as the handshake which created it.
+ */
+class SessionCache {
+  public:
+    static SessionCache& GetInstance();
+
+    /**
+     * @brief Offer the cached session for endpoint, if any, to an SSL context which has not done its handshake yet.
+     *
+     * A connection with no session to offer counts as a miss. One which is offered a session is counted by
+     * CountOffer() once its handshake is over.
+     *
+     * @return true if a session was set.
+     */
+    bool Load(const std::string& endpoint, const std::shared_ptr<const TlsConfig>& tls_config, mbedtls_ssl_context* ssl);
+
+    /**
+     * @brief Save the session of a completed handshake, replacing the previous one for endpoint.
+     */
+    void Store(const std::string& endpoint, const std::shared_ptr<const TlsConfig>& tls_config,
+               const mbedtls_ssl_context* ssl);
+
+    /**
+     * @brief Count a handshake which offered a cached session: a hit if the server resumed it, a miss otherwise.
+     */
+    void CountOffer(bool resumed);
+
+    /**
+     * @brief Forget the session of endpoint, e.g. after a handshake which offered it failed.
+     */
+    void Remove(const std::string& endpoint);
+
+    void SetOptions(const TlsSessionCacheOptions& options);
+    TlsSessionCacheStats GetStats();
+
+  private:
+    SessionCache() = default;
+
+    struct Entry {
+        Entry() {
+            mbedtls_ssl_session_init(&session);
+        }
+        ~Entry() {
+            mbedtls_ssl_session_free(&session);
+        }
+        std::string endpoint;
+        std::weak_ptr<const TlsConfig> tls_config;
+        int64_t expire_ms = 0;
+        mbedtls_ssl_session session;
+    };
+
+    std::mutex mutex_;
+    TlsSessionCacheOptions options_;
+    TlsSessionCacheStats stats_{};
+    std::list<std::unique_ptr<Entry>> entries_; // newest first
+};
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
+
+#endif //_MBEDTLS_CLIENT_SESSION_CACHE_H_
@@ -0,0 +1,181 @@
+#include "TlsConfig.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <new>
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/error.h"
+
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+
+// Distinct CA bundles kept parsed at the same time
+#define TLS_CONFIG_CACHE_SIZE 16
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+/**
+ * @brief DRBG of one enclave thread.
+ *
+ * It is allocated on the first handshake made by a thread and never released: enclave threads are bound to a fixed
+ * number of TCS and are reused, so there is at most one instance per TCS.
+ */
+struct ThreadRandom {
+    ThreadRandom() {
+        mbedtls_ctr_drbg_init(&ctr_drbg_);
+        mbedtls_entropy_init(&entropy_);
+    }
+
+    mbedtls_entropy_context entropy_;
+    mbedtls_ctr_drbg_context ctr_drbg_;
+    bool seeded_ = false;
+};
+
+static thread_local ThreadRandom* thread_random = nullptr;
+
+static int ThreadRandomFunc(void* /*unused*/, unsigned char* output, size_t output_len) {
+    if (!thread_random || !thread_random->seeded_) {
+        if (TlsConfig::PrepareThreadRandom().Code() != HttpError::OK) {
+            return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+        }
+    }
+    return mbedtls_ctr_drbg_random(&thread_random->ctr_drbg_, output, output_len);
+}
+
+HttpResult TlsConfig::PrepareThreadRandom() {
+    if (thread_random && thread_random->seeded_) {
+        return {HttpError::OK, "Success"};
+    }
+    if (!thread_random) {
+        thread_random = new (std::nothrow) ThreadRandom();
+        if (!thread_random) {
+            return {HttpError::MallocFailed, "Failed to allocate the thread DRBG"};
+        }
+    }
+
+    /*
+     * Generate a random number as a nonce for mbedtls random number generation
+     * The nonce length must be:
+     * 1) at least 24 bytes for a 128-bit strength (maximum achievable strength when using AES-128);
+     * 2) at least 48 bytes for a 256-bit strength (maximum achievable strength when using AES-256).
+     * Refer to:
+     * https://mbed-tls.readthedocs.io/projects/api/en/development/api/file/ctr__drbg_8h/#ctr__drbg_8h_1ad93d675f998550b4478c1fe6f4f34ebc
+     */
+    uint8_t nonce[48] = {0};
+    sgx_status_t status = sgx_read_rand(nonce, sizeof(nonce));
+    if (status != SGX_SUCCESS) {
+        return {HttpError::SetSeedFailed, "sgx_read_rand() failed! Unable to generate nonce."};
+    }
+
+    // The DRBG is reseeded from the entropy source every MBEDTLS_CTR_DRBG_RESEED_INTERVAL requests
+    int ret = mbedtls_ctr_drbg_seed(&thread_random->ctr_drbg_, mbedtls_entropy_func, &thread_random->entropy_, nonce,
+                                    sizeof(nonce));
+    if (ret != 0) {
+        char err_msg[1024] = {0};
+        mbedtls_strerror(ret, err_msg, sizeof(err_msg));
+        return {HttpError::SetSeedFailed, "mbedtls_ctr_drbg_seed() filed! Error: " + std::string(err_msg)};
+    }
+    thread_random->seeded_ = true;
+    return {HttpError::OK, "Success"};
+}
+
+TlsConfig::TlsConfig() {
+    mbedtls_x509_crt_init(&ca_cert_);
+    mbedtls_ssl_config_init(&conf_);
+}
+
+TlsConfig::~TlsConfig() {
+    mbedtls_ssl_config_free(&conf_);
+    mbedtls_x509_crt_free(&ca_cert_);
+}
+
+HttpResult TlsConfig::Init(const std::string& server_ca) {
+    int ret = 0;
+    char err_msg[1024] = {0};
+
+    // Parse and set CA certificates
+    // server_ca is a base64 string, parameter buflen must be size() + 1
+    if (!server_ca.empty()) {
+        if ((ret = mbedtls_x509_crt_parse(&ca_cert_, reinterpret_cast<const uint8_t*>(server_ca.c_str()),
+                                          server_ca.size() + 1)) != 0) {
+            mbedtls_strerror(ret, err_msg, sizeof(err_msg));
+            return {HttpError::CACertsWrong, "mbedtls_x509_crt_parse() filed! Error: " + std::string(err_msg)};
+        }
+    }
+
+    // Set SSL default parameters
+    if ((ret = mbedtls_ssl_config_defaults(&conf_, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                           MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
+        mbedtls_strerror(ret, err_msg, sizeof(err_msg));
+        return {HttpError::SSLConfigFailed, "mbedtls_ssl_config_defaults() filed! Error: " + std::string(err_msg)};
+    }
+
+    // During handshake, verify server's certificate is required!
+    mbedtls_ssl_conf_authmode(&conf_, MBEDTLS_SSL_VERIFY_REQUIRED);
+
+    // Confiture ca certificates to verify server's certificates
+    mbedtls_ssl_conf_ca_chain(&conf_, &ca_cert_, nullptr);
+
+    mbedtls_ssl_conf_rng(&conf_, ThreadRandomFunc, nullptr);
+
+    // No read timeout here: it differs per request, so the connection's own receive callback applies it.
+    return {HttpError::OK, "Success"};
+}
+
+std::string TlsConfig::Digest(const std::string& server_ca) {
+    sgx_sha256_hash_t hash = {0};
+    if (server_ca.size() > UINT32_MAX ||
+        sgx_sha256_msg(reinterpret_cast<const uint8_t*>(server_ca.data()), static_cast<uint32_t>(server_ca.size()),
+                       &hash) != SGX_SUCCESS) {
+        return server_ca;
+    }
+    return std::string(reinterpret_cast<const char*>(hash), sizeof(hash));
+}
+
+HttpResult TlsConfig::Get(const std::string& server_ca, std::shared_ptr<const TlsConfig>& config) {
+    using LruList = std::list<std::pair<std::string, std::shared_ptr<const TlsConfig>>>; // most recently used first
+    static std::mutex mutex;
+    static LruList lru;
+    static std::map<std::string, LruList::iterator> cache; // CA chain digest -> entry of lru
+
+    // Keyed by digest, so that a lookup compares 32 bytes rather than whole CA bundles
+    const std::string digest = Digest(server_ca);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(digest);
+    if (it != cache.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        config = it->second->second;
+        return {HttpError::OK, "Success"};
+    }
+
+    // Built under the lock, so that concurrent first requests parse a bundle only once
+    std::shared_ptr<TlsConfig> new_config(new (std::nothrow) TlsConfig());
+    if (!new_config) {
+        return {HttpError::MallocFailed, "Failed to allocate the TLS configuration"};
+    }
+    HttpResult ret = new_config->Init(server_ca);
+    if (ret.Code() != HttpError::OK) {
+        return ret;
+    }
+
+    // Connections which still use an evicted configuration keep it alive until they are closed
+    if (lru.size() >= TLS_CONFIG_CACHE_SIZE) {
+        cache.erase(lru.back().first);
+        lru.pop_back();
+    }
+    lru.emplace_front(digest, new_config);
+    cache.emplace(digest, lru.begin());
+    config = std::move(new_config);
+    return {HttpError::OK, "Success"};
+}
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
@@ -0,0 +1,70 @@
+#ifndef _MBEDTLS_CLIENT_TLS_CONFIG_H_
+#define _MBEDTLS_CLIENT_TLS_CONFIG_H_
+
+#include <memory>
+#include <string>
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+
+#include "HttpClient.h"
+
+namespace ssgx {
+namespace http_t {
+namespace mbedtls_client {
+
+/**
+ * @brief Client side TLS settings built around one CA chain.
+ *
+ * Parsing a CA bundle (the default one holds more than a hundred root certificates) and setting up an
+ * mbedtls_ssl_config is done once per distinct bundle. The result is immutable and shared by every connection, on
+ * every thread, that verifies servers against the same bundle. The configurations of the 16 most recently used bundles
+ * are kept, looked up by the SHA-256 digest of the bundle; the PEM text itself is not kept.
+ *
+ * Random numbers for the handshakes come from a CTR-DRBG owned by the calling enclave thread, so connections on
+ * different threads never contend on the generator.
+ */
+class TlsConfig {
+  public:
+    ~TlsConfig();
+    TlsConfig(const TlsConfig&) = delete;
+    TlsConfig& operator=(const TlsConfig&) = delete;
+
+    /**
+     * @brief Get the shared configuration for a CA chain, building it on first use.
+     * @param[in] server_ca CA chain in PEM format. An empty string gives a configuration which trusts no server.
+     * @param[out] config The shared configuration.
+     * @return HttpError::CACertsWrong or HttpError::SSLConfigFailed if the configuration can not be built.
+     */
+    static HttpResult Get(const std::string& server_ca, std::shared_ptr<const TlsConfig>& config);
+
+    /**
+     * @brief SHA-256 digest of a CA chain, a short key for the connections verified against it.
+     * @param[in] server_ca CA chain in PEM format.
+     * @return The 32 byte digest, or server_ca itself if it can not be computed.
+     */
+    static std::string Digest(const std::string& server_ca);
+
+    /**
+     * @brief Seed the DRBG of the calling thread if this has not been done yet.
+     * @return HttpError::SetSeedFailed if seeding failed.
+     */
+    static HttpResult PrepareThreadRandom();
+
+    const mbedtls_ssl_config* Conf() const {
+        return &conf_;
+    }
+
+  private:
+    TlsConfig();
+    HttpResult Init(const std::string& server_ca);
+
+    mbedtls_x509_crt ca_cert_;
+    mbedtls_ssl_config conf_;
+};
+
+} // namespace mbedtls_client
+} // namespace http_t
+} // namespace ssgx
+
+#endif //_MBEDTLS_CLIENT_TLS_CONFIG_H_
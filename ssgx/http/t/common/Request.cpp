@@ -9,6 +9,20 @@
 namespace ssgx {
 namespace http_t {
 
+Request::Request(RequestArena* arena)
+    : params_(TypeParams::allocator_type(arena)), path_params_(TypeParams::allocator_type(arena)),
+      headers_(TypeHeaders::allocator_type(arena)), data_(decltype(data_)::allocator_type(arena)) {
+}
+
+// The containers are rebuilt on the heap, moving their nodes only if they are there already
+Request::Request(Request&& other)
+    : method_(std::move(other.method_)), path_(std::move(other.path_)),
+      params_(std::move(other.params_), TypeParams::allocator_type()),
+      path_params_(std::move(other.path_params_), TypeParams::allocator_type()),
+      headers_(std::move(other.headers_), TypeHeaders::allocator_type()), body_(std::move(other.body_)),
+      body_stream_(other.body_stream_), data_(std::move(other.data_), decltype(data_)::allocator_type()) {
+}
+
 void Request::SetMethod(const char* buf, size_t buf_len) {
     if (buf && buf_len > 0) {
         method_.assign(buf, buf_len);
@@ -101,6 +115,22 @@ std::string Request::GetParamValue(const std::string& key, const char* def) cons
     return def;
 }
 
+void Request::SetPathParam(const std::string& key, const std::string& val) {
+    path_params_[key] = val;
+}
+
+const TypeParams& Request::PathParams() const {
+    return path_params_;
+}
+
+std::string Request::GetPathParamValue(const std::string& key, const char* def) const {
+    auto it = path_params_.find(key);
+    if (it != path_params_.end()) {
+        return it->second;
+    }
+    return def;
+}
+
 void Request::SetBody(const char* buf, size_t buf_len) {
     if (buf && buf_len > 0) {
         body_.assign(buf, buf_len);
@@ -117,6 +147,14 @@ const std::string& Request::Body() const {
     return body_;
 }
 
+void Request::SetBodyStream(BodyReader* reader) {
+    body_stream_ = reader;
+}
+
+BodyReader* Request::BodyStream() const {
+    return body_stream_;
+}
+
 bool Request::FromJsonStr(const std::string& json_str) {
     return FromJsonStr(json_str.c_str());
 }
@@ -0,0 +1,78 @@
+#include <algorithm>
+
+#include "ssgx_http_t_arena.h"
+
+namespace ssgx {
+namespace http_t {
+
+// Arena of the thread, allocated by its first request and never released: enclave threads are bound to a fixed number
+// of TCS and are reused, so there is at most one arena per TCS.
+static thread_local RequestArena* thread_arena = nullptr;
+
+void* RequestArena::Allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    // Carve the current block, then the blocks kept from previous requests
+    while (current_ < blocks_.size()) {
+        Block& block = blocks_[current_];
+        auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        uintptr_t start = (base + used_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t offset = start - base;
+        if (offset <= block.size && size <= block.size - offset) {
+            used_ = offset + size;
+            return block.data.get() + offset;
+        }
+        ++current_;
+        used_ = 0;
+    }
+
+    // Large objects get a block of their own
+    Block block;
+    block.size = std::max(BLOCK_SIZE, size + alignment);
+    block.data.reset(new (std::nothrow) unsigned char[block.size]);
+    if (!block.data) {
+        return nullptr;
+    }
+    blocks_.push_back(std::move(block));
+    current_ = blocks_.size() - 1;
+    used_ = 0;
+    return Allocate(size, alignment);
+}
+
+void RequestArena::Rewind(size_t block, size_t used) {
+    current_ = block;
+    used_ = used;
+
+    // Once the outermost scope ends, keep only enough blocks for a typical request
+    if (block == 0 && used == 0) {
+        size_t kept = 0;
+        size_t total = 0;
+        while (kept < blocks_.size() && total + blocks_[kept].size <= RETAINED_SIZE) {
+            total += blocks_[kept].size;
+            ++kept;
+        }
+        blocks_.resize(kept);
+    }
+}
+
+RequestArena::Scope::Scope() {
+    if (!thread_arena) {
+        thread_arena = new (std::nothrow) RequestArena();
+    }
+    arena_ = thread_arena;
+    if (arena_) {
+        block_ = arena_->current_;
+        used_ = arena_->used_;
+    }
+}
+
+RequestArena::Scope::~Scope() {
+    if (arena_) {
+        arena_->Rewind(block_, used_);
+    }
+}
+
+} // namespace http_t
+} // namespace ssgx
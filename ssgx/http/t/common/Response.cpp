@@ -9,7 +9,18 @@
 namespace ssgx {
 namespace http_t {
 
+Response::Response(RequestArena* arena) : headers_(TypeHeaders::allocator_type(arena)) {
+}
+
+// The headers are rebuilt on the heap, moving their nodes only if they are there already
+Response::Response(Response&& other)
+    : status_code_(other.status_code_), headers_(std::move(other.headers_), TypeHeaders::allocator_type()),
+      body_(std::move(other.body_)), stream_sink_(other.stream_sink_), streaming_(other.streaming_),
+      stream_ended_(other.stream_ended_) {
+}
+
 void Response::SetStatusCode(HttpStatusCode status_code) {
+    CheckNotStreaming();
     status_code_ = status_code;
 }
 
@@ -18,6 +29,7 @@ HttpStatusCode Response::StatusCode() const {
 }
 
 void Response::SetHeaders(const TypeHeaders& headers) {
+    CheckNotStreaming();
     headers_ = headers;
 }
 
@@ -26,6 +38,7 @@ const TypeHeaders& Response::Headers() const {
 }
 
 void Response::SetHeader(const std::string& key, const std::string& val) {
+    CheckNotStreaming();
     if (!detail::HasCRLF(key) && !detail::HasCRLF(val)) {
         headers_.emplace(key, val);
     }
@@ -48,6 +61,7 @@ uint64_t Response::GetHeaderValueUint64(const std::string& key, uint64_t def) co
 }
 
 void Response::SetBody(const char* buf, size_t buf_len) {
+    CheckNotStreaming();
     if (buf && buf_len > 0) {
         body_.assign(buf, buf_len);
     } else {
@@ -56,6 +70,7 @@ void Response::SetBody(const char* buf, size_t buf_len) {
 }
 
 void Response::SetBody(const std::string& body) {
+    CheckNotStreaming();
     body_ = body;
 }
 
@@ -100,6 +115,7 @@ bool Response::ToJsonStrWithoutBody(std::string& json_str) const {
 }
 
 void Response::SetResp(const char* s, size_t n, const std::string& content_type, HttpStatusCode status) {
+    CheckNotStreaming();
     if (s && n > 0) {
         body_.assign(s, n);
     } else {
@@ -118,6 +134,7 @@ void Response::SetResp(const std::string& s, const std::string& content_type, Ht
 }
 
 void Response::SetRespRedirect(const std::string& url, HttpStatusCode status_code) {
+    CheckNotStreaming();
     if (url.empty() || detail::HasCRLF(url)) {
         return; // Invalid URL, do nothing
     }
@@ -136,6 +153,7 @@ void Response::SetRespRedirect(const std::string& url, HttpStatusCode status_cod
 }
 
 void Response::SetResp404NotFound() {
+    CheckNotStreaming();
     const std::string body = "<html><body><h1>404 Not Found</h1></body></html>";
     status_code_ = HttpStatusCode::NotFound404; // Set the HTTP status code
 
@@ -146,6 +164,7 @@ void Response::SetResp404NotFound() {
 }
 
 void Response::SetResp500InternalServerError() {
+    CheckNotStreaming();
     const std::string body = "<html><body><h1>500 Internal Server Error</h1></body></html>";
     status_code_ = HttpStatusCode::InternalServerError500; // Correctly set the status code
 
@@ -156,6 +175,7 @@ void Response::SetResp500InternalServerError() {
 }
 
 void Response::SetResp403Forbidden() {
+    CheckNotStreaming();
     const std::string body = "<html><body><h1>403 Forbidden</h1></body></html>";
     status_code_ = HttpStatusCode::Forbidden403; // Correctly set the HTTP status code
 
@@ -166,6 +186,7 @@ void Response::SetResp403Forbidden() {
 }
 
 void Response::SetResp204NoContent() {
+    CheckNotStreaming();
     status_code_ = HttpStatusCode::NoContent204; // Correctly set the HTTP status code
 
     SetHeader("Content-Length", std::to_string(0)); // No extra spaces, convert 0 to a string
@@ -173,5 +194,75 @@ void Response::SetResp204NoContent() {
     body_.clear(); // Ensure the body is empty (204 must not have a response body)
 }
 
+void Response::BeginStream() {
+    if (streaming_) {
+        throw std::runtime_error("The response is already streaming");
+    }
+    if (stream_sink_) {
+        stream_sink_->Begin(*this);
+    }
+    streaming_ = true;
+}
+
+void Response::Write(const char* data, size_t size) {
+    if (!streaming_ || stream_ended_) {
+        throw std::runtime_error("The response is not streaming");
+    }
+    if (!data || size == 0) {
+        return;
+    }
+    if (stream_sink_) {
+        stream_sink_->Write(data, size);
+    } else {
+        body_.append(data, size);
+    }
+}
+
+void Response::Write(const std::string& data) {
+    Write(data.data(), data.size());
+}
+
+void Response::WriteEvent(const std::string& data, const std::string& event) {
+    // A line break in the type would end the field early, and let the rest pass for fields of its own
+    if (event.find_first_of("\r\n") != std::string::npos) {
+        throw std::invalid_argument("Event type contains a line break");
+    }
+    std::string message;
+    if (!event.empty()) {
+        message += "event: " + event + "\n";
+    }
+    // Each line of the data goes into a "data:" line of its own, a line ends with CRLF, LF or CR as in the stream
+    size_t start = 0;
+    while (true) {
+        size_t end = data.find_first_of("\r\n", start);
+        message += "data: " + data.substr(start, end - start) + "\n";
+        if (end == std::string::npos) {
+            break;
+        }
+        start = (data[end] == '\r' && end + 1 < data.size() && data[end + 1] == '\n') ? end + 2 : end + 1;
+    }
+    message += "\n";
+    Write(message);
+}
+
+void Response::End() {
+    stream_ended_ = true;
+}
+
+bool Response::IsStreaming() const {
+    return streaming_;
+}
+
+void Response::SetStreamSink(ResponseSink* sink) {
+    stream_sink_ = sink;
+}
+
+// The status code and the headers are on their way to the client once the response streams
+void Response::CheckNotStreaming() const {
+    if (streaming_) {
+        throw std::runtime_error("The response is streaming, its status code, headers and body can not be changed");
+    }
+}
+
 } // namespace http_t
 } // namespace ssgx
\ No newline at end of file
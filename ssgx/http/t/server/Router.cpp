@@ -0,0 +1,198 @@
+#include "Router.h"
+
+#include <algorithm>
+
+namespace ssgx {
+namespace http_t {
+namespace internal {
+
+// Position of the first segment of a path, after its leading slash
+static size_t FirstSegment(std::string_view path) {
+    return (!path.empty() && path[0] == '/') ? 1 : 0;
+}
+
+// Cut the segment starting at pos; next is the start of the following segment, npos after the last one
+static std::string_view NextSegment(std::string_view path, size_t pos, size_t& next) {
+    size_t slash = path.find('/', pos);
+    if (slash == std::string_view::npos) {
+        next = std::string_view::npos;
+        return path.substr(pos);
+    }
+    next = slash + 1;
+    return path.substr(pos, slash - pos);
+}
+
+bool Router::Add(const std::string& method, const std::string& pattern, const Route& route) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!CanInsert(staging_, pattern)) {
+        return false;
+    }
+    Insert(staging_, method, pattern, route);
+    staging_changed_ = true;
+    return true;
+}
+
+void Router::Publish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!staging_changed_) {
+        return;
+    }
+    // The published table is never modified, so it is a copy of the staging one
+    auto table = std::make_unique<Table>(staging_);
+    current_.store(table.get(), std::memory_order_release);
+    tables_.push_back(std::move(table));
+    staging_changed_ = false;
+}
+
+bool Router::CanInsert(const Table& table, const std::string& pattern) {
+    std::string_view path(pattern);
+    uint32_t node = 0;
+    bool exists = true; // false once the pattern leaves the existing nodes, where there is nothing to conflict with
+    size_t pos = FirstSegment(path);
+    while (pos != std::string_view::npos) {
+        size_t next = 0;
+        std::string_view segment = NextSegment(path, pos, next);
+
+        uint32_t child = 0;
+        if (segment.size() >= 2 && segment.front() == '{' && segment.back() == '}') {
+            // One name per position, e.g. not both "/a/{id}" and "/a/{name}"
+            if (exists && table.nodes[node].param != 0 &&
+                table.nodes[node].param_name != segment.substr(1, segment.size() - 2)) {
+                return false;
+            }
+            child = exists ? table.nodes[node].param : 0;
+        } else if (!segment.empty() && segment.front() == '*') {
+            // A wildcard takes the rest of the path
+            if (next != std::string_view::npos) {
+                return false;
+            }
+            std::string_view name = segment.size() > 1 ? segment.substr(1) : segment;
+            if (exists && table.nodes[node].wildcard != 0 && table.nodes[node].wildcard_name != name) {
+                return false;
+            }
+        } else if (exists) {
+            const auto& literals = table.nodes[node].literals;
+            auto it = std::lower_bound(literals.begin(), literals.end(), segment,
+                                       [](const auto& item, std::string_view seg) { return item.first < seg; });
+            child = (it != literals.end() && it->first == segment) ? it->second : 0;
+        }
+
+        exists = exists && child != 0;
+        node = child;
+        pos = next;
+    }
+    return true;
+}
+
+void Router::Insert(Table& table, const std::string& method, const std::string& pattern, const Route& route) {
+    std::string_view path(pattern);
+    uint32_t node = 0;
+    size_t pos = FirstSegment(path);
+    while (pos != std::string_view::npos) {
+        size_t next = 0;
+        std::string_view segment = NextSegment(path, pos, next);
+
+        uint32_t child = 0;
+        if (segment.size() >= 2 && segment.front() == '{' && segment.back() == '}') {
+            if (table.nodes[node].param == 0) {
+                child = static_cast<uint32_t>(table.nodes.size());
+                table.nodes.emplace_back();
+                table.nodes[node].param = child;
+                table.nodes[node].param_name = std::string(segment.substr(1, segment.size() - 2));
+            }
+            child = table.nodes[node].param;
+        } else if (!segment.empty() && segment.front() == '*') {
+            if (table.nodes[node].wildcard == 0) {
+                child = static_cast<uint32_t>(table.nodes.size());
+                table.nodes.emplace_back();
+                table.nodes[node].wildcard = child;
+                table.nodes[node].wildcard_name = std::string(segment.size() > 1 ? segment.substr(1) : segment);
+            }
+            child = table.nodes[node].wildcard;
+        } else {
+            auto& literals = table.nodes[node].literals;
+            auto it = std::lower_bound(literals.begin(), literals.end(), segment,
+                                       [](const auto& item, std::string_view seg) { return item.first < seg; });
+            if (it != literals.end() && it->first == segment) {
+                child = it->second;
+            } else {
+                child = static_cast<uint32_t>(table.nodes.size());
+                literals.emplace(it, std::string(segment), child);
+                table.nodes.emplace_back();
+            }
+        }
+
+        node = child;
+        pos = next;
+    }
+
+    auto& methods = table.nodes[node].methods;
+    for (auto& item : methods) {
+        if (item.first == method) {
+            item.second = route;
+            return;
+        }
+    }
+    methods.emplace_back(method, route);
+}
+
+const Route* Router::Find(std::string_view method, std::string_view path, RouteCaptures& captures) const {
+    const Table* table = current_.load(std::memory_order_acquire);
+    captures.count = 0;
+    if (!table) {
+        return nullptr;
+    }
+    return Match(*table, 0, method, path, FirstSegment(path), captures);
+}
+
+const Route* Router::Match(const Table& table, uint32_t node, std::string_view method, std::string_view path,
+                           size_t pos, RouteCaptures& captures) {
+    const Node& current = table.nodes[node];
+    if (pos == std::string_view::npos) {
+        return MatchMethod(current, method);
+    }
+
+    size_t next = 0;
+    std::string_view segment = NextSegment(path, pos, next);
+
+    // Literal segments first
+    auto it = std::lower_bound(current.literals.begin(), current.literals.end(), segment,
+                               [](const auto& item, std::string_view seg) { return item.first < seg; });
+    if (it != current.literals.end() && it->first == segment) {
+        if (const Route* route = Match(table, it->second, method, path, next, captures)) {
+            return route;
+        }
+    }
+
+    // Then a parameter, backtracking if the rest of the path does not match below it
+    if (current.param != 0 && !segment.empty() && captures.count < ROUTER_MAX_CAPTURES) {
+        size_t count = captures.count;
+        captures.items[captures.count++] = {current.param_name, segment};
+        if (const Route* route = Match(table, current.param, method, path, next, captures)) {
+            return route;
+        }
+        captures.count = count;
+    }
+
+    // Finally a wildcard, which takes everything that is left
+    if (current.wildcard != 0 && captures.count < ROUTER_MAX_CAPTURES) {
+        if (const Route* route = MatchMethod(table.nodes[current.wildcard], method)) {
+            captures.items[captures.count++] = {current.wildcard_name, path.substr(pos)};
+            return route;
+        }
+    }
+    return nullptr;
+}
+
+const Route* Router::MatchMethod(const Node& node, std::string_view method) {
+    for (const auto& item : node.methods) {
+        if (item.first == method) {
+            return &item.second;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace http_t
+} // namespace ssgx
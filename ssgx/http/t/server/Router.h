@@ -0,0 +1,107 @@
+#ifndef SSGXLIB_HTTP_T_SERVER_ROUTER_H
+#define SSGXLIB_HTTP_T_SERVER_ROUTER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ssgx_http_t_structs.h"
+
+namespace ssgx {
+namespace http_t {
+namespace internal {
+
+// Path parameters captured by one lookup, at most one per path segment
+constexpr size_t ROUTER_MAX_CAPTURES = 16;
+
+/**
+ * @brief A registered handler, as found by Router::Find().
+ */
+struct Route {
+    std::function<void(Request&, Response&)> handler;
+    bool is_stream = false; // registered with Server::PostStream()
+};
+
+/**
+ * @brief Path parameters of a matched route. Names and values point into the route table and the request path.
+ */
+struct RouteCaptures {
+    std::array<std::pair<std::string_view, std::string_view>, ROUTER_MAX_CAPTURES> items;
+    size_t count = 0;
+};
+
+/**
+ * @brief Routes of an http_t::Server, matched segment by segment in a trie.
+ *
+ * A pattern is a path whose segments are either literal, a parameter "{name}" which matches any one non-empty
+ * segment, or, as the last segment only, a wildcard "*" or "*name" which matches the rest of the path (possibly
+ * empty). Literal segments take precedence over parameters, and parameters over wildcards.
+ *
+ * Registrations go to a staging table, and Publish() copies it to an immutable table which is then published with an
+ * atomic pointer, so Find() takes no lock and allocates nothing. The server publishes once when it starts. A table
+ * superseded by a later Publish() is kept until the router is destroyed, because a lookup running on another thread
+ * may still be walking it; that only happens when a stopped server is started again with new routes.
+ */
+class Router {
+  public:
+    Router() = default;
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    /**
+     * @brief Register (or replace) the handler of a method and a path pattern, which Find() sees after Publish().
+     * @return false if the pattern is invalid, e.g. a wildcard which is not the last segment, and nothing is changed.
+     */
+    bool Add(const std::string& method, const std::string& pattern, const Route& route);
+
+    /**
+     * @brief Make the routes added so far visible to Find(), do nothing if there is no new one.
+     */
+    void Publish();
+
+    /**
+     * @brief Find the route of a request.
+     * @return The route, or nullptr if none matches. The pointer stays valid as long as the router exists.
+     */
+    const Route* Find(std::string_view method, std::string_view path, RouteCaptures& captures) const;
+
+  private:
+    struct Node {
+        std::vector<std::pair<std::string, uint32_t>> literals; // sorted by segment
+        uint32_t param = 0;                                      // child for "{name}", 0 if none
+        std::string param_name;
+        uint32_t wildcard = 0; // child for "*name", 0 if none
+        std::string wildcard_name;
+        std::vector<std::pair<std::string, Route>> methods; // routes ending at this node
+    };
+
+    struct Table {
+        std::vector<Node> nodes; // nodes[0] is the root
+    };
+
+    static bool CanInsert(const Table& table, const std::string& pattern);
+    static void Insert(Table& table, const std::string& method, const std::string& pattern, const Route& route);
+    static const Route* Match(const Table& table, uint32_t node, std::string_view method, std::string_view path,
+                              size_t pos, RouteCaptures& captures);
+    static const Route* MatchMethod(const Node& node, std::string_view method);
+
+    std::mutex mutex_; // serializes registrations only
+    Table staging_{std::vector<Node>(1)};
+    bool staging_changed_ = false;
+    std::vector<std::unique_ptr<const Table>> tables_;
+    std::atomic<const Table*> current_{nullptr};
+};
+
+} // namespace internal
+} // namespace http_t
+} // namespace ssgx
+
+#endif // SSGXLIB_HTTP_T_SERVER_ROUTER_H
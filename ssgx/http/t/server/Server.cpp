@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
 #include "ssgx_http_t_server.h"
 #include "ssgx_http_t_structs.h"
 #include "ssgx_http_t_t.h"
@@ -5,12 +10,38 @@
 #include "ssgx_utils_t.h"
 
 #include "../../ssgx/http/share/ObjectRegistry.h"
+#include "Router.h"
 
 using ssgx::utils_t::EnclaveInfo;
 
+// Size of the pieces in which a streamed body is pulled for a handler which wants it in Request::Body()
+#define BODY_DRAIN_CHUNK_SIZE 64 * 1024
+
 namespace ssgx {
 namespace http_t {
 
+/**
+ * @brief Reader over a body which was delivered with the request, for handlers registered with PostStream().
+ */
+class InlineBodyReader : public BodyReader {
+  public:
+    explicit InlineBodyReader(std::string body) : body_(std::move(body)) {
+    }
+
+    size_t Read(uint8_t* buf, size_t size) override {
+        size_t n = std::min(size, body_.size() - pos_);
+        if (n > 0) {
+            memcpy(buf, body_.data() + pos_, n);
+            pos_ += n;
+        }
+        return n;
+    }
+
+  private:
+    std::string body_;
+    size_t pos_ = 0;
+};
+
 void Server::Listen(const std::string& url) {
     url_ = url;
 }
@@ -39,6 +70,9 @@ bool Server::Start() {
     if (eid == 0)
         return false;
 
+    // The route table is built once here, handlers are registered before the server starts
+    router_->Publish();
+
     // To start a server's listener outside of enclave
     status = ssgx_ocall_http_create_listener(&ret, eid, url_.c_str(), timeout_seconds_, max_threads_, max_queued_);
     if (status != SGX_SUCCESS || ret != 0) {
@@ -74,11 +108,19 @@ void Server::Stop() {
 }
 
 bool Server::ShouldStop() const {
+    // A load from the control page when the host provides it, instead of an OCALL per poll
+    if (ssgx::utils_t::ControlPage::IsAvailable()) {
+        return ssgx::utils_t::ControlPage::StopRequested();
+    }
+
     int ret = 0;
     sgx_status_t status = ssgx_ocall_http_get_server_stop_flag(&ret);
     return (status == SGX_SUCCESS) && (ret != 0);
 }
 
+Server::Server() : router_(std::make_unique<internal::Router>()) {
+}
+
 /// Destructor: Ensures cleanup if `stop()` was never called
 Server::~Server() {
     Stop(); // Now safe from duplicate calls
@@ -93,22 +135,23 @@ void Server::Post(const std::string& path, const std::function<void(Request&, Re
     RegisterHandler(method, path, handler);
 }
 
+void Server::PostStream(const std::string& path,
+                        const std::function<void(Request&, BodyReader&, Response&)>& handler) {
+    std::string method = "POST";
+    // Process() guarantees that the request of a stream handler has a reader
+    RegisterHandler(
+        method, path, [handler](Request& req, Response& resp) { handler(req, *req.BodyStream(), resp); }, true);
+}
+
 void Server::RegisterHandler(const std::string& method, const std::string& path,
-                             const std::function<void(Request&, Response&)>& handler) {
-    std::lock_guard<std::mutex> lock(key_handler_map_mutex_);
-    // key = "{method}_{path}"
-    const std::string key = method + "_" + path;
-    key_handler_map_[key] = handler;
-}
-
-std::function<void(Request&, Response&)> Server::GetHandler(const std::string& method, const std::string& path) {
-    std::lock_guard<std::mutex> lock(key_handler_map_mutex_);
-    // key = "{method}_{path}"
-    const std::string key = method + "_" + path;
-    if (const auto it = key_handler_map_.find(key); it != key_handler_map_.end()) {
-        return it->second;
+                             const std::function<void(Request&, Response&)>& handler, bool is_stream) {
+    if (!is_stopped_) {
+        throw std::logic_error(ssgx::utils_t::FormatStr("Handler of %s %s is registered after Start()", method.c_str(),
+                                                        path.c_str()));
+    }
+    if (!router_->Add(method, path, internal::Route{handler, is_stream})) {
+        throw std::invalid_argument(ssgx::utils_t::FormatStr("Invalid path pattern: %s", path.c_str()));
     }
-    return nullptr;
 }
 
 void Server::AddFilter(std::unique_ptr<Filter>&& filter) {
@@ -116,12 +159,39 @@ void Server::AddFilter(std::unique_ptr<Filter>&& filter) {
 }
 
 void Server::Process(const std::string& method, const std::string& path, Request& req, Response& resp) {
-
-    if (const auto func = GetHandler(method, path); !func) {
+    internal::RouteCaptures captures;
+    const internal::Route* route = router_->Find(method, path, captures);
+    if (!route) {
         resp.SetResp404NotFound();
-    } else {
-        resp = filter_chain_.Execute(req, func);
+        return;
+    }
+    for (size_t i = 0; i < captures.count; ++i) {
+        req.SetPathParam(std::string(captures.items[i].first), std::string(captures.items[i].second));
+    }
+
+    const auto& func = route->handler;
+    if (route->is_stream) {
+        // A body which came with the request is read from memory, through the reader only as with a large body
+        if (!req.BodyStream()) {
+            InlineBodyReader reader(req.Body());
+            req.SetBody(std::string());
+            req.SetBodyStream(&reader);
+            filter_chain_.Execute(req, func, resp);
+            req.SetBodyStream(nullptr);
+            return;
+        }
+    } else if (BodyReader* reader = req.BodyStream()) {
+        // Other handlers get the whole body, pulled from the host now
+        std::string body;
+        std::vector<uint8_t> chunk(BODY_DRAIN_CHUNK_SIZE);
+        size_t n = 0;
+        while ((n = reader->Read(chunk.data(), chunk.size())) > 0) {
+            body.append(reinterpret_cast<const char*>(chunk.data()), n);
+        }
+        req.SetBody(body);
+        req.SetBodyStream(nullptr);
     }
+    filter_chain_.Execute(req, func, resp);
 }
 
 /**
@@ -1,3 +1,4 @@
+#include <stdexcept>
 #include <string>
 
 #include "ssgx_http_t_server.h"
@@ -8,11 +9,15 @@
 
 #include "../../../common/auxilliary.h"
 #include "../../share/ObjectRegistry.h"
+#include "../../share/WireFormat.h"
 
 using namespace ssgx::utils_t;
 using ssgx::http_t::Request;
+using ssgx::http_t::RequestArena;
 using ssgx::http_t::Response;
 using ssgx::http_t::Server;
+using ssgx::internal::WireReader;
+using ssgx::internal::WireWriter;
 
 
 extern "C" int ssgx_ecall_http_on_message(const char* server_id, const char* req_method, const char* req_path,
@@ -33,8 +38,11 @@ extern "C" int ssgx_ecall_http_on_message(const char* server_id, const char* req
     if (!IsNonEmptyString(req_path))
         return -3;
 
+    // the request and the response are allocated from the arena of this thread, released when the call returns
+    RequestArena::Scope arena_scope;
+
     // parse and set headers and params to request
-    Request http_request;
+    Request http_request(arena_scope.Arena());
     if (req_headers_json && !http_request.FromJsonStr(req_headers_json))
         return -4;
     if (req_params_json && !http_request.FromJsonStr(req_params_json))
@@ -52,7 +60,7 @@ extern "C" int ssgx_ecall_http_on_message(const char* server_id, const char* req
         http_request.SetBody(std::string(reinterpret_cast<const char*>(req_body), req_body_size));
     }
     try {
-        Response http_response;
+        Response http_response(arena_scope.Arena());
 
         // process http_request
         ServerProcessBridge(http_server, req_method, req_path, http_request, http_response);
@@ -70,15 +78,14 @@ extern "C" int ssgx_ecall_http_on_message(const char* server_id, const char* req
         // 2. extract body
         if (!http_response.Body().empty()) {
             size_t body_size = http_response.Body().size();
-            auto* outside_buff = static_cast<uint8_t*>(MallocOutside(body_size));
+            // The host releases the body with free(), so it must not come from the pooled arena.
+            auto* outside_buff = static_cast<uint8_t*>(MemdupOutside(http_response.Body().data(), body_size));
             if (!outside_buff) {
                 FreeOutside(*resp_status_headers_json_ptr, strlen(*resp_status_headers_json_ptr));
                 *resp_status_headers_json_ptr = nullptr;
                 return -8;
             }
 
-            memcpy(outside_buff, http_response.Body().data(), body_size);
-
             // return body and size
             *resp_body_ptr = outside_buff;
             *resp_body_size_ptr = body_size;
@@ -92,4 +99,202 @@ extern "C" int ssgx_ecall_http_on_message(const char* server_id, const char* req
         }
         return -9;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Reader of a request body which stays on the host until the handler asks for it.
+ *
+ * Every Read() is one ocall which copies the next part of the body straight into the caller's buffer.
+ */
+class HostBodyReader : public ssgx::http_t::BodyReader {
+  public:
+    explicit HostBodyReader(uint64_t stream_id) : stream_id_(stream_id) {
+    }
+
+    size_t Read(uint8_t* buf, size_t size) override {
+        if (eof_ || !buf || size == 0) {
+            return 0;
+        }
+
+        int ret = 0;
+        size_t read_size = 0;
+        sgx_status_t status = ssgx_ocall_http_read_request_body(&ret, stream_id_, buf, size, &read_size);
+        if (status != SGX_SUCCESS || ret != 0 || read_size > size) {
+            throw std::runtime_error("Failed to read the request body from the host");
+        }
+        eof_ = (read_size == 0);
+        return read_size;
+    }
+
+  private:
+    uint64_t stream_id_;
+    bool eof_ = false;
+};
+
+// Parse a request frame, which has already been copied into the enclave by the edger8r bridge.
+static bool DecodeRequestFrame(const uint8_t* frame, size_t frame_size, Request& http_request,
+                               uint64_t& body_stream_id, uint64_t& response_stream_id) {
+    WireReader reader(frame, frame_size);
+    uint32_t magic = 0;
+    if (!reader.GetU32(magic) || magic != ssgx::internal::HTTP_WIRE_REQUEST_MAGIC)
+        return false;
+
+    const char* ptr = nullptr;
+    size_t len = 0;
+    if (!reader.GetBytes(ptr, len) || len == 0)
+        return false;
+    http_request.SetMethod(ptr, len);
+    if (!reader.GetBytes(ptr, len) || len == 0)
+        return false;
+    http_request.SetPath(ptr, len);
+
+    uint32_t count = 0;
+    std::string key;
+    std::string value;
+    if (!reader.GetU32(count))
+        return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!reader.GetStr(key) || !reader.GetStr(value))
+            return false;
+        http_request.SetParam(key, value);
+    }
+    if (!reader.GetU32(count))
+        return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!reader.GetStr(key) || !reader.GetStr(value))
+            return false;
+        http_request.SetHeader(key, value);
+    }
+
+    if (!reader.GetBytes(ptr, len))
+        return false;
+    if (len > 0) {
+        http_request.SetBody(ptr, len);
+    }
+    if (!reader.GetU64(body_stream_id) || !reader.GetU64(response_stream_id))
+        return false;
+    return reader.AtEnd();
+}
+
+// Serialize status, headers and (optionally) body into a response frame.
+static void BuildResponseFrame(const Response& http_response, bool with_body, std::string& frame) {
+    const std::string no_body;
+    const std::string& body = with_body ? http_response.Body() : no_body;
+
+    size_t size = sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint32_t);
+    for (const auto& item : http_response.Headers()) {
+        size += WireWriter::StrSize(item.first.size()) + WireWriter::StrSize(item.second.size());
+    }
+    size += WireWriter::StrSize(body.size());
+
+    frame.reserve(size);
+    WireWriter writer(frame);
+    writer.PutU32(ssgx::internal::HTTP_WIRE_RESPONSE_MAGIC);
+    writer.PutU16(static_cast<uint16_t>(http_response.StatusCode()));
+    writer.PutU32(static_cast<uint32_t>(http_response.Headers().size()));
+    for (const auto& item : http_response.Headers()) {
+        writer.PutStr(item.first);
+        writer.PutStr(item.second);
+    }
+    writer.PutStr(body);
+}
+
+// Serialize status, headers and body into a single frame allocated outside the enclave.
+static uint8_t* EncodeResponseFrame(const Response& http_response, size_t* frame_size) {
+    std::string frame;
+    BuildResponseFrame(http_response, true, frame);
+
+    auto* outside_buff = static_cast<uint8_t*>(MemdupOutside(frame.data(), frame.size()));
+    if (outside_buff) {
+        *frame_size = frame.size();
+    }
+    return outside_buff;
+}
+
+/**
+ * @brief Hands a streamed response to the host, which sends each piece as an HTTP chunk right away.
+ */
+class HostResponseSink : public ssgx::http_t::ResponseSink {
+  public:
+    explicit HostResponseSink(uint64_t stream_id) : stream_id_(stream_id) {
+    }
+
+    void Begin(const Response& response) override {
+        std::string head;
+        BuildResponseFrame(response, false, head);
+
+        int ret = 0;
+        sgx_status_t status = ssgx_ocall_http_begin_response_stream(
+            &ret, stream_id_, reinterpret_cast<const uint8_t*>(head.data()), head.size());
+        if (status != SGX_SUCCESS || ret != 0) {
+            throw std::runtime_error("Failed to start the response stream on the host");
+        }
+    }
+
+    void Write(const char* data, size_t size) override {
+        int ret = 0;
+        sgx_status_t status =
+            ssgx_ocall_http_write_response_stream(&ret, stream_id_, reinterpret_cast<const uint8_t*>(data), size);
+        if (status != SGX_SUCCESS || ret != 0) {
+            throw std::runtime_error("Failed to write the response stream on the host");
+        }
+    }
+
+  private:
+    uint64_t stream_id_;
+};
+
+extern "C" int ssgx_ecall_http_on_binary_message(const char* server_id, const uint8_t* req_frame,
+                                                 size_t req_frame_size, uint8_t** resp_frame_ptr,
+                                                 size_t* resp_frame_size_ptr) {
+    // initial output pointers
+    *resp_frame_ptr = nullptr;
+    *resp_frame_size_ptr = 0;
+
+    // check parameters
+    if (!IsNonEmptyString(server_id))
+        return -1;
+    if (req_frame == nullptr || req_frame_size == 0)
+        return -2;
+
+    // the request and the response are allocated from the arena of this thread, released when the call returns
+    RequestArena::Scope arena_scope;
+
+    try {
+        // parse method, path, params, headers and body in one pass
+        Request http_request(arena_scope.Arena());
+        uint64_t body_stream_id = 0;
+        uint64_t response_stream_id = 0;
+        if (!DecodeRequestFrame(req_frame, req_frame_size, http_request, body_stream_id, response_stream_id))
+            return -3;
+
+        // a large body is still on the host, Server::Process() decides how it is read
+        HostBodyReader body_reader(body_stream_id);
+        if (body_stream_id != 0) {
+            http_request.SetBodyStream(&body_reader);
+        }
+
+        // find the server object based on server_id
+        Server* http_server = ssgx::internal::ObjectRegistry<std::string, Server>::Query(server_id);
+        if (!http_server)
+            return -6;
+
+        // process http_request, the handler may send its response piece by piece
+        Response http_response(arena_scope.Arena());
+        HostResponseSink response_sink(response_stream_id);
+        if (response_stream_id != 0) {
+            http_response.SetStreamSink(&response_sink);
+        }
+        ServerProcessBridge(http_server, http_request.Method(), http_request.Path(), http_request, http_response);
+
+        // return status, headers and body in one untrusted buffer
+        *resp_frame_ptr = EncodeResponseFrame(http_response, resp_frame_size_ptr);
+        if (*resp_frame_ptr == nullptr) {
+            return -8;
+        }
+
+        return 0;
+    } catch (const std::exception&) {
+        return -9;
+    }
+}
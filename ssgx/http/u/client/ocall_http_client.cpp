@@ -0,0 +1,185 @@
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ssgx_http_t_u.h"
+
+#include "../../../common/auxilliary.h"
+#include "../../share/NetEvents.h"
+
+using namespace ssgx::internal;
+
+static int SetNonBlocking(int fd, bool non_blocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    flags = non_blocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags);
+}
+
+/**
+ * @brief Addresses of a host which are left to try, for a connection in progress.
+ */
+struct PendingConnect {
+    struct addrinfo* addr_list; // released once the connection is settled
+    struct addrinfo* next;      // next address to try, if the current one fails
+};
+
+// Connections in progress by socket. A socket number which is used again replaces what is left of a connection
+// which was abandoned before connect_finish settled it.
+static std::mutex pending_mutex;
+static std::map<int, PendingConnect> pending_connects;
+
+static void ForgetPendingConnect(int fd) {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    auto it = pending_connects.find(fd);
+    if (it != pending_connects.end()) {
+        freeaddrinfo(it->second.addr_list);
+        pending_connects.erase(it);
+    }
+}
+
+static int StartConnect(const struct addrinfo* addr) {
+    int sock = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (sock < 0) {
+        return -1;
+    }
+    if (SetNonBlocking(sock, true) == 0 &&
+        (connect(sock, addr->ai_addr, addr->ai_addrlen) == 0 || errno == EINPROGRESS)) {
+        return sock;
+    }
+    close(sock);
+    return -1;
+}
+
+extern "C" int ssgx_ocall_http_net_connect_start(const char* host, const char* port, int* fd) {
+    if (!IsNonEmptyString(host) || !IsNonEmptyString(port) || !fd) {
+        return -1;
+    }
+    *fd = -1;
+
+    struct addrinfo hints;
+    struct addrinfo* addr_list = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    if (getaddrinfo(host, port, &hints, &addr_list) != 0) {
+        return -2;
+    }
+
+    // Use the first address for which a connection can be started, and keep the others for connect_finish
+    for (struct addrinfo* cur = addr_list; cur != nullptr; cur = cur->ai_next) {
+        int sock = StartConnect(cur);
+        if (sock < 0) {
+            continue;
+        }
+        ForgetPendingConnect(sock);
+        if (cur->ai_next) {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            pending_connects[sock] = PendingConnect{addr_list, cur->ai_next};
+        } else {
+            freeaddrinfo(addr_list);
+        }
+        *fd = sock;
+        return 0;
+    }
+
+    freeaddrinfo(addr_list);
+    return -3;
+}
+
+extern "C" int ssgx_ocall_http_net_connect_finish(int fd) {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+        ForgetPendingConnect(fd);
+        return (SetNonBlocking(fd, false) == 0) ? 0 : -2;
+    }
+
+    // Start the next address of the host on the same socket number, which the enclave holds
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    auto it = pending_connects.find(fd);
+    if (it == pending_connects.end()) {
+        return -1;
+    }
+    PendingConnect& pending = it->second;
+    while (pending.next) {
+        struct addrinfo* cur = pending.next;
+        pending.next = cur->ai_next;
+        int sock = StartConnect(cur);
+        if (sock < 0) {
+            continue;
+        }
+        int ret = dup2(sock, fd);
+        close(sock);
+        if (ret < 0) {
+            continue;
+        }
+        if (!pending.next) {
+            freeaddrinfo(pending.addr_list);
+            pending_connects.erase(it);
+        }
+        return HTTP_NET_CONNECT_NEXT;
+    }
+    freeaddrinfo(pending.addr_list);
+    pending_connects.erase(it);
+    return -1;
+}
+
+extern "C" int ssgx_ocall_http_net_send(int fd, const uint8_t* buf, size_t len) {
+    ssize_t ret = send(fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (ret >= 0) {
+        return static_cast<int>(ret);
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? HTTP_NET_WOULD_BLOCK : HTTP_NET_FAILED;
+}
+
+extern "C" int ssgx_ocall_http_net_recv(int fd, uint8_t* buf, size_t len) {
+    ssize_t ret = recv(fd, buf, len, MSG_DONTWAIT);
+    if (ret >= 0) {
+        return static_cast<int>(ret);
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? HTTP_NET_WOULD_BLOCK : HTTP_NET_FAILED;
+}
+
+extern "C" int ssgx_ocall_http_net_poll(const int* fds, const int* events, int* revents, size_t count,
+                                        int timeout_ms) {
+    if (count == 0 || !fds || !events || !revents) {
+        return -1;
+    }
+
+    std::vector<struct pollfd> poll_fds(count);
+    for (size_t i = 0; i < count; ++i) {
+        poll_fds[i].fd = fds[i];
+        poll_fds[i].events = 0;
+        poll_fds[i].events |= (events[i] & HTTP_NET_EVENT_READ) ? POLLIN : 0;
+        poll_fds[i].events |= (events[i] & HTTP_NET_EVENT_WRITE) ? POLLOUT : 0;
+        poll_fds[i].revents = 0;
+    }
+
+    int ret = 0;
+    do {
+        ret = poll(poll_fds.data(), count, timeout_ms);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0) {
+        return -2;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        revents[i] = 0;
+        revents[i] |= (poll_fds[i].revents & POLLIN) ? HTTP_NET_EVENT_READ : 0;
+        revents[i] |= (poll_fds[i].revents & POLLOUT) ? HTTP_NET_EVENT_WRITE : 0;
+        revents[i] |= (poll_fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) ? HTTP_NET_EVENT_ERROR : 0;
+    }
+    return ret;
+}
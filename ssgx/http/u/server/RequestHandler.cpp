@@ -1,5 +1,7 @@
 #include "RequestHandler.h"
 
+#include <atomic>
+
 #include "nlohmann/json.hpp"
 
 #include "sgx_error.h"
@@ -8,22 +10,265 @@
 #include "ssgx_http_u.h"
 #include "ssgx_log_u.h"
 
+#include "../../share/ObjectRegistry.h"
+#include "../../share/WireFormat.h"
+#include "Poco/Net/HTTPServerRequestImpl.h"
+#include "Poco/Net/StreamSocket.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/URI.h"
 
 using JSON = nlohmann::json;
+using ssgx::internal::WireReader;
+using ssgx::internal::WireWriter;
 
 namespace ssgx {
 namespace http_u {
 
+// Identifiers of request bodies and responses which the enclave accesses by ocalls while handling a request
+static std::atomic<uint64_t> next_body_stream_id{1};
+
+/**
+ * @brief Resets the connection of a request, whatever is left to send on it is dropped.
+ */
+static void AbortConnection(HTTPServerRequest& request) {
+    try {
+        StreamSocket& socket = static_cast<HTTPServerRequestImpl&>(request).socket();
+        socket.setLinger(true, 0);
+        socket.close();
+    } catch (const Poco::Exception&) {
+        // The connection is gone already
+    }
+}
+
+/**
+ * @brief Makes a request body readable by the enclave while the request is being handled.
+ */
+class BodyStreamRegistration {
+  public:
+    explicit BodyStreamRegistration(std::istream& body) : id_(next_body_stream_id++) {
+        ssgx::internal::ObjectRegistry<uint64_t, std::istream>::Register(id_, &body);
+    }
+    ~BodyStreamRegistration() {
+        ssgx::internal::ObjectRegistry<uint64_t, std::istream>::Unregister(id_);
+    }
+    BodyStreamRegistration(const BodyStreamRegistration&) = delete;
+    BodyStreamRegistration& operator=(const BodyStreamRegistration&) = delete;
+
+    uint64_t Id() const {
+        return id_;
+    }
+
+  private:
+    uint64_t id_;
+};
+
+/**
+ * @brief Lets the enclave stream the response of a request while the request is being handled.
+ */
+class ResponseStreamRegistration {
+  public:
+    explicit ResponseStreamRegistration(HTTPServerResponse& response) : id_(next_body_stream_id++) {
+        stream_.response = &response;
+        ssgx::internal::ObjectRegistry<uint64_t, ResponseStream>::Register(id_, &stream_);
+    }
+    ~ResponseStreamRegistration() {
+        ssgx::internal::ObjectRegistry<uint64_t, ResponseStream>::Unregister(id_);
+    }
+    ResponseStreamRegistration(const ResponseStreamRegistration&) = delete;
+    ResponseStreamRegistration& operator=(const ResponseStreamRegistration&) = delete;
+
+    uint64_t Id() const {
+        return id_;
+    }
+
+  private:
+    uint64_t id_;
+    ResponseStream stream_;
+};
+
+bool RequestHandler::ApplyResponseHead(WireReader& reader, HTTPServerResponse& response) {
+    uint32_t magic = 0;
+    uint16_t status_code = 500;
+    uint32_t header_count = 0;
+    if (!reader.GetU32(magic) || magic != ssgx::internal::HTTP_WIRE_RESPONSE_MAGIC || !reader.GetU16(status_code) ||
+        !reader.GetU32(header_count)) {
+        return false;
+    }
+
+    std::string key;
+    std::string value;
+    for (uint32_t i = 0; i < header_count; ++i) {
+        if (!reader.GetStr(key) || !reader.GetStr(value)) {
+            return false;
+        }
+        response.set(key, value);
+    }
+    response.setStatus(static_cast<HTTPResponse::HTTPStatus>(status_code));
+    return true;
+}
+
 void RequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
+    // Parse the request URL
+    Poco::URI uri;
+    try {
+        uri = Poco::URI(request.getURI());
+    } catch (...) {
+        response.setStatus(HTTPResponse::HTTP_BAD_REQUEST);
+        response.send() << "Bad Request, invalid URL.";
+        return;
+    }
+
+    // Prefer the binary framing callback if the enclave has registered one.
+    HttpOnBinaryMessageCallback binary_callback = HttpCallbackManager::GetInstance().GetHttpBinaryCallback(sgx_eid_);
+    if (binary_callback != nullptr) {
+        HandleBinaryMessage(request, response, uri, binary_callback);
+        return;
+    }
+
+    HttpOnMessageCallback callback = HttpCallbackManager::GetInstance().GetHttpCallback(sgx_eid_);
+    if (callback == nullptr) {
+        response.setStatus(HTTPResponse::HTTP_NOT_FOUND);
+        response.send() << "Not Found: HttpOnMessageCallback.";
+        return;
+    }
+    HandleJsonMessage(request, response, uri, callback);
+}
+
+void RequestHandler::HandleBinaryMessage(HTTPServerRequest& request, HTTPServerResponse& response,
+                                         const Poco::URI& uri, HttpOnBinaryMessageCallback callback) {
+    // Bodies of unknown or large size are not copied into the frame, the enclave pulls them when it needs them
+    bool stream_body = false;
+    size_t content_length = 0;
+    if (request.hasContentLength()) {
+        content_length = static_cast<size_t>(request.getContentLength64());
+        stream_body = content_length > ssgx::internal::HTTP_WIRE_INLINE_BODY_LIMIT;
+    } else {
+        stream_body = request.getChunkedTransferEncoding();
+    }
+    std::unique_ptr<BodyStreamRegistration> body_stream;
+    std::unique_ptr<ResponseStreamRegistration> response_stream;
+
+    // Build the request frame: method, path, params, headers and body in one buffer
+    std::string req_frame;
+    try {
+        const Poco::URI::QueryParameters params = uri.getQueryParameters();
+        const std::string& req_path = uri.getPath();
+
+        size_t header_bytes = 0;
+        for (const auto& header : request) {
+            header_bytes += WireWriter::StrSize(header.first.size()) + WireWriter::StrSize(header.second.size());
+        }
+        req_frame.reserve(64 + request.getMethod().size() + req_path.size() + header_bytes +
+                          (stream_body ? 0 : content_length));
+
+        WireWriter writer(req_frame);
+        writer.PutU32(ssgx::internal::HTTP_WIRE_REQUEST_MAGIC);
+        writer.PutStr(request.getMethod());
+        writer.PutStr(req_path);
+        writer.PutU32(static_cast<uint32_t>(params.size()));
+        for (const auto& item : params) {
+            writer.PutStr(item.first);
+            writer.PutStr(item.second);
+        }
+        writer.PutU32(static_cast<uint32_t>(request.size()));
+        for (const auto& header : request) {
+            writer.PutStr(header.first);
+            writer.PutStr(header.second);
+        }
+
+        // Parse Body
+        if (stream_body) {
+            body_stream = std::make_unique<BodyStreamRegistration>(request.stream());
+            writer.PutStr("");
+            writer.PutU64(body_stream->Id());
+        } else {
+            std::string req_body_str;
+            Poco::StreamCopier::copyToString(request.stream(), req_body_str);
+            writer.PutStr(req_body_str);
+            writer.PutU64(0);
+        }
+
+        // The handler may send its response before it returns
+        response_stream = std::make_unique<ResponseStreamRegistration>(response);
+        writer.PutU64(response_stream->Id());
+    } catch (...) {
+        response.setStatus(HTTPResponse::HTTP_BAD_REQUEST);
+        response.send() << "Bad Request, invalid URL.";
+        return;
+    }
+
+    // Invoke request handler in enclave
+    int ret = 0;
+    size_t raw_frame_size = 0;
+    uint8_t* raw_frame_ptr = nullptr;
+    sgx_status_t result =
+        callback(sgx_eid_, &ret, server_id_.c_str(), reinterpret_cast<const uint8_t*>(req_frame.data()),
+                 req_frame.size(), &raw_frame_ptr, &raw_frame_size);
+
+    // Use unique_ptr to host buffer raw_frame_ptr, so that it can be released automatically.
+    std::unique_ptr<uint8_t, decltype(&free)> res_frame_ptr(raw_frame_ptr, free);
+
+    // A handler may stop reading a streamed body early, the rest of it can not be skipped cheaply
+    if (body_stream && !request.stream().eof()) {
+        response.setKeepAlive(false);
+    }
+
+    // The handler streamed its response, which is complete now unless the handler failed on the way: then the
+    // connection is reset without the last chunk, so that the client sees a truncated body rather than a complete one
+    response_stream.reset();
+    if (response.sent()) {
+        if (result != SGX_SUCCESS || ret != 0) {
+            AbortConnection(request);
+        }
+        return;
+    }
+
+    // Failed to handle request in enclave
+    if (result != SGX_SUCCESS || ret != 0) {
+        response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        response.send() << "Internal Server Error, failed to call enclave API.";
+        return;
+    }
+
+    // No response frame, return errors
+    if (!raw_frame_ptr || raw_frame_size == 0) {
+        response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        response.send() << "Internal Server Error, missing headers in response.";
+        return;
+    }
+
+    // Parse status code, headers and body from the response frame
+    WireReader reader(raw_frame_ptr, raw_frame_size);
+    if (!ApplyResponseHead(reader, response)) {
+        response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        response.send() << "Internal Server Error, invalid headers in response.";
+        return;
+    }
+
+    const char* body_ptr = nullptr;
+    size_t body_size = 0;
+    if (!reader.GetBytes(body_ptr, body_size) || !reader.AtEnd()) {
+        response.erase(HTTPMessage::CONTENT_LENGTH);
+        response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        response.send() << "Internal Server Error, invalid body in response.";
+        return;
+    }
+
+    // Set body to Poco response object
+    if (body_size > 0) {
+        response.sendBuffer(body_ptr, body_size);
+    } else {
+        response.send();
+    }
+}
+
+void RequestHandler::HandleJsonMessage(HTTPServerRequest& request, HTTPServerResponse& response, const Poco::URI& uri,
+                                       HttpOnMessageCallback callback) {
     // Parse headers and parameters in request
     JSON params_json;
     JSON headers_json;
     std::string req_path;
     try {
-        Poco::URI uri;
-        uri = Poco::URI(request.getURI());
         for (const auto& item : uri.getQueryParameters()) {
             params_json[item.first] = item.second;
         }
@@ -55,13 +300,6 @@ void RequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerRespons
     uint8_t* raw_body_ptr = nullptr;
     char* raw_status_headers_ptr = nullptr;
 
-    HttpOnMessageCallback callback = HttpCallbackManager::GetInstance().GetHttpCallback(sgx_eid_);
-    if (callback == nullptr) {
-        response.setStatus(HTTPResponse::HTTP_NOT_FOUND);
-        response.send() << "Not Found: HttpOnMessageCallback.";
-        return;
-    }
-
     sgx_status_t result = callback(
         sgx_eid_, &ret, server_id_.c_str(), request.getMethod().c_str(), req_path.c_str(), req_params_json_str.c_str(),
         req_header_json_str.c_str(), (uint8_t*)req_body_str.c_str(), req_body_str.size(), &raw_status_headers_ptr,
@@ -119,4 +357,4 @@ void RequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerRespons
 }
 
 } // namespace http_u
-} // namespace ssgx
\ No newline at end of file
+} // namespace ssgx
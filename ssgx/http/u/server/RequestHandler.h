@@ -1,17 +1,33 @@
 #ifndef SSGXLIB_HTTP_U_SERVER_REQUESTHANDLER_H
 #define SSGXLIB_HTTP_U_SERVER_REQUESTHANDLER_H
 
+#include <ostream>
+
+#include "ssgx_http_u.h"
+
+#include "../../share/WireFormat.h"
+
 #include "Poco/Net/HTTPRequestHandler.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 #include "Poco/Net/HTTPServerParams.h"
 #include "Poco/Net/HTTPServerRequest.h"
 #include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/URI.h"
 
 using namespace Poco::Net;
 
 namespace ssgx {
 namespace http_u {
 
+/**
+ * @brief Response which the enclave streams with ssgx_ocall_http_begin_response_stream() and
+ * ssgx_ocall_http_write_response_stream().
+ */
+struct ResponseStream {
+    HTTPServerResponse* response = nullptr;
+    std::ostream* out = nullptr; // set once the status code and the headers have been sent
+};
+
 class RequestHandler : public HTTPRequestHandler {
   private:
     uint64_t sgx_eid_;
@@ -22,6 +38,18 @@ class RequestHandler : public HTTPRequestHandler {
     }
 
     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override;
+
+    /**
+     * @brief Read status code and headers of a response frame and set them on the response.
+     * @return false if the frame is malformed. On success, the reader is left on the body field.
+     */
+    static bool ApplyResponseHead(ssgx::internal::WireReader& reader, HTTPServerResponse& response);
+
+  private:
+    void HandleJsonMessage(HTTPServerRequest& request, HTTPServerResponse& response, const Poco::URI& uri,
+                           HttpOnMessageCallback callback);
+    void HandleBinaryMessage(HTTPServerRequest& request, HTTPServerResponse& response, const Poco::URI& uri,
+                             HttpOnBinaryMessageCallback callback);
 };
 
 class RequestHandlerFactory : public HTTPRequestHandlerFactory {
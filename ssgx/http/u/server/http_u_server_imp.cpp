@@ -1,10 +1,16 @@
 #include "ssgx_http_u.h"
+#include "ssgx_utils_u.h"
 
 namespace ssgx {
 namespace http_u {
 
 std::atomic<bool> SignalFlag::stop_flag_{false};
 
+void SignalFlag::SetStopFlag() {
+    stop_flag_.store(true, std::memory_order_relaxed);
+    ssgx::utils_u::ControlPage::SetStopFlag(true);
+}
+
 void StopHttpServers() {
     SignalFlag::SetStopFlag();
 }
@@ -1,4 +1,6 @@
+#include <istream>
 #include <memory>
+#include <ostream>
 
 #include "mbedtls/net_sockets.h"
 
@@ -85,3 +87,79 @@ extern "C" void ssgx_ocall_http_release_listener(const char* server_id) {
 extern "C" int ssgx_ocall_http_get_server_stop_flag() {
     return SignalFlag::GetStopFlag() ? 1 : 0;
 }
+
+extern "C" int ssgx_ocall_http_read_request_body(uint64_t stream_id, uint8_t* buf, size_t buf_size,
+                                                 size_t* read_size) {
+    if (!buf || !read_size) {
+        return -1;
+    }
+    *read_size = 0;
+
+    // The stream is registered by RequestHandler for the duration of the ecall which handles its request
+    std::istream* body = ssgx::internal::ObjectRegistry<uint64_t, std::istream>::Query(stream_id);
+    if (!body) {
+        return -2;
+    }
+
+    try {
+        body->read(reinterpret_cast<char*>(buf), static_cast<std::streamsize>(buf_size));
+        *read_size = static_cast<size_t>(body->gcount());
+        if (body->bad()) {
+            return -3;
+        }
+    } catch (...) {
+        return -4;
+    }
+    return 0;
+}
+
+extern "C" int ssgx_ocall_http_begin_response_stream(uint64_t stream_id, const uint8_t* head, size_t head_size) {
+    if (!head || head_size == 0) {
+        return -1;
+    }
+
+    // The stream is registered by RequestHandler for the duration of the ecall which handles its request
+    ResponseStream* stream = ssgx::internal::ObjectRegistry<uint64_t, ResponseStream>::Query(stream_id);
+    if (!stream || stream->out) {
+        return -2;
+    }
+
+    try {
+        ssgx::internal::WireReader reader(head, head_size);
+        if (!RequestHandler::ApplyResponseHead(reader, *stream->response)) {
+            return -3;
+        }
+
+        // The length is not known in advance, every write becomes a chunk
+        stream->response->erase(HTTPMessage::CONTENT_LENGTH);
+        stream->response->setChunkedTransferEncoding(true);
+        std::ostream& out = stream->response->send();
+        out.flush();
+        stream->out = &out;
+    } catch (...) {
+        return -4;
+    }
+    return 0;
+}
+
+extern "C" int ssgx_ocall_http_write_response_stream(uint64_t stream_id, const uint8_t* data, size_t data_size) {
+    ResponseStream* stream = ssgx::internal::ObjectRegistry<uint64_t, ResponseStream>::Query(stream_id);
+    if (!stream || !stream->out) {
+        return -2;
+    }
+    if (!data || data_size == 0) {
+        return 0;
+    }
+
+    try {
+        // Flushed at once, so that each piece reaches the client without waiting for the next one
+        stream->out->write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(data_size));
+        stream->out->flush();
+        if (!stream->out->good()) {
+            return -3;
+        }
+    } catch (...) {
+        return -4;
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef SSGXLIB_LOG_LOGRING_H
+#define SSGXLIB_LOG_LOGRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ssgx {
+namespace internal {
+
+/**
+ * @brief Layout of the log ring, an array of fixed-size slots in untrusted memory shared by one enclave and the host.
+ *
+ * The ring is a bounded multi-producer queue: enclave threads claim slots with a counter kept inside the enclave, copy
+ * their message into the slot and publish it by advancing the slot sequence; a host thread drains the slots in order
+ * and hands the messages to SSGXLogger. A slot holds either a formatted message, or the packed arguments of a
+ * structured log record (see SSGX_LOGF) along with the id of its log site. A slot at position pos is free when its sequence is pos, and holds a message
+ * when its sequence is pos + 1; once drained, its sequence becomes pos + slot_count.
+ *
+ * The enclave never trusts what it reads from the ring: it only writes inside the slot it claimed, and gives up on a
+ * slot whose sequence does not have the expected value, falling back to ssgx_ocall_write_log().
+ */
+constexpr size_t LOG_RING_SLOT_SIZE = 1024;
+constexpr size_t LOG_RING_TRACE_ID_SIZE = 48;
+constexpr size_t LOG_RING_MAX_SLOTS = 64 * 1024;
+
+struct LogRingSlot {
+    std::atomic<uint64_t> sequence;
+    int32_t level;
+    uint32_t size;                         // bytes used in message
+    uint32_t site;                         // 0 for a formatted message, otherwise the log site of the record
+    char trace_id[LOG_RING_TRACE_ID_SIZE]; // NUL terminated, empty if the enclave thread did not set one
+    char message[LOG_RING_SLOT_SIZE - sizeof(uint64_t) - 3 * sizeof(uint32_t) - LOG_RING_TRACE_ID_SIZE];
+};
+
+static_assert(sizeof(LogRingSlot) == LOG_RING_SLOT_SIZE, "A log ring slot must have a fixed size");
+
+} // namespace internal
+} // namespace ssgx
+
+#endif // SSGXLIB_LOG_LOGRING_H
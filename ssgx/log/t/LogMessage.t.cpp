@@ -5,6 +5,9 @@
 
 #include "ssgx_log_t.h"
 #include "ssgx_log_t_t.h"
+#include "ssgx_utils_t_control_page.h"
+
+#include "LogRing.h"
 
 namespace ssgx {
 namespace log_t {
@@ -13,6 +16,11 @@ namespace log_t {
 
 namespace internal {
 
+bool IsLevelEnabled(LogLevel level) {
+    int32_t host_level = ssgx::utils_t::ControlPage::LogLevel();
+    return host_level < 0 || static_cast<int32_t>(level) >= host_level;
+}
+
 void LogMessage::Finish() {
     // format log
     // example: [main.cpp(42)]PrintLog():
@@ -28,7 +36,17 @@ void LogMessage::Finish() {
     log_buf.append(":");
     log_buf.append(message_);
 
-    // output log message
+    // queue the message for the host drain thread, fatal messages are written before going on
+    LogRing& ring = LogRing::GetInstance();
+    if (ring.Push(static_cast<int32_t>(level_), 0, log_buf.data(), log_buf.size())) {
+        if (level_ == LogLevel::FATAL) {
+            ring.Flush();
+        }
+        return;
+    }
+
+    // write it synchronously, after the messages which are already queued
+    ring.Flush();
     int ret;
     sgx_status_t status = ssgx_ocall_write_log(&ret, static_cast<int>(level_), log_buf.c_str());
     if (status != SGX_SUCCESS) {
@@ -0,0 +1,62 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "ssgx_log_t_record.h"
+#include "ssgx_log_t_t.h"
+
+#include "LogRing.h"
+
+namespace ssgx {
+namespace log_t {
+namespace internal {
+
+static uint32_t RegisterLogSite(LogSite& site) {
+    const char* file = strrchr(site.file, '/') ? strrchr(site.file, '/') + 1 : site.file;
+    int ret = 0;
+    uint32_t id = 0;
+    sgx_status_t status = ssgx_ocall_register_log_site(&ret, static_cast<int32_t>(site.level), file, site.line,
+                                                       site.func, site.format, &id);
+    if (status != SGX_SUCCESS) {
+        throw std::runtime_error(std::string("Failed in ssgx_ocall_register_log_site() (error code: ") +
+                                 std::to_string(status) + ")");
+    }
+    if (ret != 0 || id == 0) {
+        throw std::runtime_error(std::string("SSGXLogger has not been initialized!"));
+    }
+    // Two threads may register the same site at once, the host gives them the same id
+    site.id.store(id, std::memory_order_release);
+    return id;
+}
+
+void SubmitLogRecord(LogSite& site, const LogRecordArgs& args) {
+    uint32_t id = site.id.load(std::memory_order_acquire);
+    if (id == 0) {
+        id = RegisterLogSite(site);
+    }
+
+    // queue the record for the host drain thread, fatal records are written before going on
+    LogRing& ring = LogRing::GetInstance();
+    if (ring.Push(static_cast<int32_t>(site.level), id, reinterpret_cast<const char*>(args.Data()), args.Size())) {
+        if (site.level == LogLevel::FATAL) {
+            ring.Flush();
+        }
+        return;
+    }
+
+    // write it synchronously, after the messages which are already queued
+    ring.Flush();
+    int ret = 0;
+    sgx_status_t status = ssgx_ocall_write_log_record(&ret, id, args.Data(), args.Size());
+    if (status != SGX_SUCCESS) {
+        throw std::runtime_error(std::string("Failed in ssgx_ocall_write_log_record() (error code: ") +
+                                 std::to_string(status) + ")");
+    }
+    if (ret == -1) {
+        throw std::runtime_error(std::string("SSGXLogger has not been initialized!"));
+    }
+}
+
+} // namespace internal
+} // namespace log_t
+} // namespace ssgx
@@ -0,0 +1,103 @@
+#include "LogRing.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "sgx_lfence.h"
+#include "sgx_trts.h"
+
+#include "ssgx_log_t_log_message.h"
+#include "ssgx_log_t_t.h"
+
+using ssgx::internal::LogRingSlot;
+
+static_assert(ssgx::log_t::internal::LOG_RECORD_MAX_ARGS_SIZE <= sizeof(LogRingSlot::message),
+              "A log record must fit in a log ring slot");
+
+// A producer gives up after this many slots claimed by other threads in a row, and falls back to the OCALL
+#define LOG_RING_MAX_ATTEMPTS 64
+
+namespace ssgx {
+namespace log_t {
+namespace internal {
+
+static thread_local char thread_trace_id[ssgx::internal::LOG_RING_TRACE_ID_SIZE] = {0};
+
+LogRing& LogRing::GetInstance() {
+    static LogRing instance;
+    return instance;
+}
+
+LogRingSlot* LogRing::Map() {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    LogRingSlot* slots = slots_.load(std::memory_order_relaxed);
+    if (slots || disabled_.load(std::memory_order_relaxed))
+        return slots;
+
+    int ret = 0;
+    uint8_t* base = nullptr;
+    sgx_status_t status = ssgx_ocall_map_log_ring(&ret, SSGX_LOG_RING_SLOTS, &base);
+    if (status == SGX_SUCCESS && ret == -1) {
+        return nullptr; // the host logger is not initialized yet, try again with the next message
+    }
+    if (status != SGX_SUCCESS || ret != 0 || !base ||
+        sgx_is_outside_enclave(base, SSGX_LOG_RING_SLOTS * sizeof(LogRingSlot)) != 1 ||
+        reinterpret_cast<uintptr_t>(base) % alignof(LogRingSlot) != 0) {
+        disabled_.store(true, std::memory_order_relaxed);
+        return nullptr;
+    }
+    sgx_lfence();
+
+    slots = reinterpret_cast<LogRingSlot*>(base);
+    slots_.store(slots, std::memory_order_release);
+    return slots;
+}
+
+bool LogRing::Push(int32_t level, uint32_t site, const char* data, size_t size) {
+    LogRingSlot* slots = slots_.load(std::memory_order_acquire);
+    if (!slots) {
+        if (disabled_.load(std::memory_order_relaxed) || !(slots = Map()))
+            return false;
+    }
+    if (size > sizeof(LogRingSlot::message))
+        return false;
+
+    uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (int attempt = 0; attempt < LOG_RING_MAX_ATTEMPTS; ++attempt) {
+        LogRingSlot& slot = slots[pos & (SSGX_LOG_RING_SLOTS - 1)];
+        auto diff = static_cast<int64_t>(slot.sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.level = level;
+                slot.size = static_cast<uint32_t>(size);
+                slot.site = site;
+                memcpy(slot.trace_id, thread_trace_id, sizeof(thread_trace_id));
+                memcpy(slot.message, data, size);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+            // pos has been reloaded by the failed exchange
+        } else if (diff < 0) {
+            return false; // the host has not drained this slot yet: the ring is full
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    return false;
+}
+
+void LogRing::Flush() {
+    if (slots_.load(std::memory_order_acquire)) {
+        ssgx_ocall_flush_log();
+    }
+}
+
+void LogRing::SetThreadTraceId(const std::string& trace_id) {
+    size_t size = std::min(trace_id.size(), sizeof(thread_trace_id) - 1);
+    memcpy(thread_trace_id, trace_id.data(), size);
+    thread_trace_id[size] = '\0';
+}
+
+} // namespace internal
+} // namespace log_t
+} // namespace ssgx
@@ -0,0 +1,66 @@
+#ifndef SSGXLIB_LOG_T_LOGRING_H
+#define SSGXLIB_LOG_T_LOGRING_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "../share/LogRing.h"
+
+/**
+ * Number of slots of the log ring of the enclave, a power of two. Each slot takes LOG_RING_SLOT_SIZE bytes of untrusted
+ * memory. Define it as 0 at build time to write every message with an OCALL.
+ */
+#ifndef SSGX_LOG_RING_SLOTS
+#define SSGX_LOG_RING_SLOTS 1024
+#endif
+
+static_assert((SSGX_LOG_RING_SLOTS & (SSGX_LOG_RING_SLOTS - 1)) == 0, "SSGX_LOG_RING_SLOTS must be a power of two");
+
+namespace ssgx {
+namespace log_t {
+namespace internal {
+
+/**
+ * @brief Enclave side of the log ring (see ssgx/log/share/LogRing.h), which hands messages to the host without an OCALL.
+ */
+class LogRing {
+  public:
+    static LogRing& GetInstance();
+
+    /**
+     * @brief Queue a formatted message (site is 0), or the packed arguments of a record of a registered log site.
+     * @return false if the message must be written with an OCALL instead: the ring is not available or full, or the
+     * message does not fit in a slot.
+     */
+    bool Push(int32_t level, uint32_t site, const char* data, size_t size);
+
+    /**
+     * @brief Wait until the host has written every message queued so far. Does nothing if the ring is not mapped.
+     */
+    void Flush();
+
+    /**
+     * @brief Set the trace id attached to the messages of the calling thread.
+     */
+    static void SetThreadTraceId(const std::string& trace_id);
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+  private:
+    LogRing() = default;
+    ssgx::internal::LogRingSlot* Map();
+
+    std::mutex map_mutex_;
+    std::atomic<ssgx::internal::LogRingSlot*> slots_{nullptr};
+    std::atomic<bool> disabled_{SSGX_LOG_RING_SLOTS == 0};
+    std::atomic<uint64_t> enqueue_pos_{0}; // kept in the enclave, the host can not make two threads share a slot
+};
+
+} // namespace internal
+} // namespace log_t
+} // namespace ssgx
+
+#endif // SSGXLIB_LOG_T_LOGRING_H
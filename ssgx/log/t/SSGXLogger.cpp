@@ -1,6 +1,8 @@
 #include "ssgx_log_t_logger.h"
 #include "ssgx_log_t_t.h"
 
+#include "LogRing.h"
+
 namespace ssgx {
 namespace log_t {
 
@@ -10,6 +12,8 @@ SSGXLogger& SSGXLogger::GetInstance() {
 }
 
 void SSGXLogger::SetTraceId(const std::string& trace_id) {
+    // for the messages queued in the log ring, which the host writes from another thread
+    internal::LogRing::SetThreadTraceId(trace_id);
     sgx_status_t status = ssgx_ocall_set_trace_id(trace_id.c_str());
     if (status != SGX_SUCCESS) {
         throw std::runtime_error(std::string("Failed in ssgx_ocall_set_trace_id(trace_id) (error code: ") +
@@ -17,6 +21,10 @@ void SSGXLogger::SetTraceId(const std::string& trace_id) {
     }
 }
 
+void SSGXLogger::Flush() {
+    internal::LogRing::GetInstance().Flush();
+}
+
 SSGXLogger::SSGXLogger() = default;
 
 SSGXLogger::~SSGXLogger() = default;
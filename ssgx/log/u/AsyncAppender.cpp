@@ -0,0 +1,167 @@
+#include "AsyncAppender.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "log4cplus/loglevel.h"
+
+namespace ssgx {
+namespace log_u {
+
+void FlushableFileAppender::Flush(bool sync) {
+    out.flush();
+    if (sync) {
+        // fsync() syncs the file whatever the descriptor, and the stream does not expose its own. The name is that of
+        // the file being written, as append() syncs it before a rollover renames it.
+        int fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+}
+
+void FlushableFileAppender::append(const log4cplus::spi::InternalLoggingEvent& event) {
+    if (event.getTimestamp() >= nextRolloverTime) {
+        Flush(true);
+    }
+    log4cplus::DailyRollingFileAppender::append(event);
+}
+
+AsyncAppender::AsyncAppender(log4cplus::helpers::SharedObjectPtr<FlushableFileAppender> file,
+                             std::vector<log4cplus::SharedAppenderPtr> others, const AsyncLogOptions& options)
+    : file_(std::move(file)), others_(std::move(others)), options_(options),
+      last_sync_(std::chrono::steady_clock::now()) {
+    thread_ = std::thread(&AsyncAppender::Run, this);
+}
+
+AsyncAppender::~AsyncAppender() {
+    destructorImpl();
+}
+
+void AsyncAppender::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_)
+            return;
+        stop_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    file_->close();
+    for (auto& appender : others_) {
+        appender->close();
+    }
+    closed = true;
+}
+
+void AsyncAppender::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = queued_;
+    flushed_.wait(lock, [this, target] { return written_count_ >= target || stop_; });
+}
+
+void AsyncAppender::append(const log4cplus::spi::InternalLoggingEvent& event) {
+    // The writer thread has another MDC and thread name: take those of the logging thread now
+    log4cplus::spi::InternalLoggingEvent copy(event);
+    copy.gatherThreadSpecificData();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queue_.size() >= options_.queue_size && !stop_) {
+        if (options_.overflow_policy != LogOverflowPolicy::BLOCK) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        not_full_.wait(lock, [this] { return queue_.size() < options_.queue_size || stop_; });
+    }
+    if (stop_) {
+        // closing: write it on this thread rather than losing it
+        lock.unlock();
+        Write(copy);
+        return;
+    }
+    queue_.push_back(std::move(copy));
+    ++queued_;
+    lock.unlock();
+    not_empty_.notify_one();
+}
+
+void AsyncAppender::Write(const log4cplus::spi::InternalLoggingEvent& event) {
+    file_->doAppend(event);
+    for (auto& appender : others_) {
+        appender->doAppend(event);
+    }
+}
+
+void AsyncAppender::Run() {
+    std::deque<log4cplus::spi::InternalLoggingEvent> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool unsynced = false; // written since the last sync
+    for (;;) {
+        auto has_work = [this] { return !queue_.empty() || stop_; };
+        if (unsynced) {
+            // The last messages are synced when the interval is over, whether more messages come or not
+            auto deadline = last_sync_ + std::chrono::milliseconds(options_.fsync_interval_ms);
+            if (!not_empty_.wait_until(lock, deadline, has_work)) {
+                lock.unlock();
+                file_->Flush(true);
+                lock.lock();
+                last_sync_ = std::chrono::steady_clock::now();
+                unsynced = false;
+                continue;
+            }
+        } else {
+            not_empty_.wait(lock, has_work);
+        }
+        if (queue_.empty() && stop_)
+            break;
+
+        batch.swap(queue_);
+        lock.unlock();
+        not_full_.notify_all();
+
+        for (const auto& event : batch) {
+            Write(event);
+        }
+        if (options_.overflow_policy == LogOverflowPolicy::DROP_AND_REPORT) {
+            uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+            if (dropped > reported_) {
+                Write(log4cplus::spi::InternalLoggingEvent(
+                    batch.back().getLoggerName(), log4cplus::WARN_LOG_LEVEL,
+                    LOG4CPLUS_TEXT("Log queue full, ") + std::to_string(dropped - reported_) +
+                        LOG4CPLUS_TEXT(" message(s) dropped"),
+                    __FILE__, __LINE__, __FUNCTION__));
+                reported_ = dropped;
+            }
+        }
+        bool sync = false;
+        if (options_.fsync_interval_ms > 0) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_sync_ >= std::chrono::milliseconds(options_.fsync_interval_ms)) {
+                last_sync_ = now;
+                sync = true;
+            }
+            unsynced = !sync;
+        }
+        file_->Flush(sync);
+
+        lock.lock();
+        written_count_ += batch.size();
+        batch.clear();
+        flushed_.notify_all();
+    }
+
+    // last sync before the file is closed
+    lock.unlock();
+    file_->Flush(options_.fsync_interval_ms > 0);
+    lock.lock();
+    flushed_.notify_all();
+}
+
+} // namespace log_u
+} // namespace ssgx
@@ -0,0 +1,99 @@
+#ifndef SSGX_LOG_U_ASYNCAPPENDER_H
+#define SSGX_LOG_U_ASYNCAPPENDER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ssgx_log_u_logger.h"
+
+#include "log4cplus/appender.h"
+#include "log4cplus/fileappender.h"
+#include "log4cplus/spi/loggingevent.h"
+
+namespace ssgx {
+namespace log_u {
+
+/**
+ * @brief Daily rolling file appender whose buffered output is written, and optionally synced to disk, on demand.
+ *
+ * The file is also synced before a rollover renames it, so that its last messages are on disk too. An AsyncAppender
+ * writes to it from its writer thread, which also calls Flush().
+ */
+class FlushableFileAppender : public log4cplus::DailyRollingFileAppender {
+  public:
+    using log4cplus::DailyRollingFileAppender::DailyRollingFileAppender;
+
+    /**
+     * @brief Write the buffered messages to the file, then sync it to disk if sync is true.
+     */
+    void Flush(bool sync);
+
+  protected:
+    void append(const log4cplus::spi::InternalLoggingEvent& event) override;
+};
+
+/**
+ * @brief Appender which queues the messages, and hands them to its target appenders on a writer thread.
+ *
+ * The queue holds at most AsyncLogOptions::queue_size messages; when it is full, the logging thread waits or the
+ * message is discarded, according to AsyncLogOptions::overflow_policy. The writer thread takes all queued messages at
+ * once, writes them, then flushes the file, and syncs it every AsyncLogOptions::fsync_interval_ms milliseconds. What
+ * is written in between is synced when the interval is over, even if no message follows.
+ */
+class AsyncAppender : public log4cplus::Appender {
+  public:
+    AsyncAppender(log4cplus::helpers::SharedObjectPtr<FlushableFileAppender> file,
+                  std::vector<log4cplus::SharedAppenderPtr> others, const AsyncLogOptions& options);
+
+    ~AsyncAppender() override;
+
+    /**
+     * @brief Stop the writer thread once every queued message is written, and close the target appenders.
+     */
+    void close() override;
+
+    /**
+     * @brief Wait until every message queued so far is written and flushed to the file.
+     */
+    void Flush();
+
+    uint64_t GetDroppedCount() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+  protected:
+    void append(const log4cplus::spi::InternalLoggingEvent& event) override;
+
+  private:
+    void Run();
+    void Write(const log4cplus::spi::InternalLoggingEvent& event);
+
+    log4cplus::helpers::SharedObjectPtr<FlushableFileAppender> file_;
+    std::vector<log4cplus::SharedAppenderPtr> others_; // e.g. the console appender
+    const AsyncLogOptions options_;
+
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable flushed_;
+    std::deque<log4cplus::spi::InternalLoggingEvent> queue_;
+    uint64_t queued_ = 0;        // messages queued since the start
+    uint64_t written_count_ = 0; // messages written and flushed since the start
+    bool stop_ = false;
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_ = 0; // dropped messages already reported in the log, writer thread only
+    std::chrono::steady_clock::time_point last_sync_;
+    std::thread thread_;
+};
+
+} // namespace log_u
+} // namespace ssgx
+
+#endif // SSGX_LOG_U_ASYNCAPPENDER_H
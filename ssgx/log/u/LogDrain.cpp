@@ -0,0 +1,130 @@
+#include "LogDrain.h"
+
+#include <chrono>
+#include <cstring>
+
+#include <sys/mman.h>
+
+#include "ssgx_log_u_logger.h"
+
+#include "LogHelper.h"
+#include "LogRecords.h"
+
+/**
+ * How long the drain thread sleeps when all rings are empty, in milliseconds.
+ */
+#ifndef SSGX_LOG_DRAIN_INTERVAL_MS
+#define SSGX_LOG_DRAIN_INTERVAL_MS 5
+#endif
+
+using ssgx::internal::LogRingSlot;
+
+namespace ssgx {
+namespace log_u {
+
+LogDrain& LogDrain::GetInstance() {
+    static LogDrain instance;
+    return instance;
+}
+
+// The singletons which the drain writes to are constructed first, so that they are destroyed after the final
+// Flush() of the destructor
+LogDrain::LogDrain() {
+    LogRecords::GetInstance();
+    LogHelper::GetInstance();
+    SSGXLogger::GetInstance();
+}
+
+LogDrain::~LogDrain() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    Flush();
+}
+
+uint8_t* LogDrain::MapRing(size_t slot_count) {
+    if (slot_count == 0 || slot_count > ssgx::internal::LOG_RING_MAX_SLOTS || (slot_count & (slot_count - 1)) != 0) {
+        return nullptr;
+    }
+
+    // The ring stays mapped for the lifetime of the process, like the enclave which writes into it
+    size_t size = slot_count * sizeof(LogRingSlot);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    auto* slots = static_cast<LogRingSlot*>(base);
+    for (size_t i = 0; i < slot_count; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(Ring{slots, slot_count, 0});
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&LogDrain::Run, this);
+    }
+    return static_cast<uint8_t*>(base);
+}
+
+void LogDrain::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (DrainLocked() > 0) {
+    }
+}
+
+size_t LogDrain::DrainLocked() {
+    size_t drained = 0;
+    std::string message;
+    for (Ring& ring : rings_) {
+        for (;;) {
+            LogRingSlot& slot = ring.slots[ring.pos & (ring.slot_count - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != ring.pos + 1) {
+                break;
+            }
+
+            // The enclave is trusted with its own messages, but not with the bounds of the slot
+            size_t size = slot.size < sizeof(slot.message) ? slot.size : sizeof(slot.message);
+            message.assign(slot.message, size);
+            size_t trace_id_size = strnlen(slot.trace_id, sizeof(slot.trace_id));
+            if (trace_id_.compare(0, std::string::npos, slot.trace_id, trace_id_size) != 0) {
+                trace_id_.assign(slot.trace_id, trace_id_size);
+                LogHelper::GetInstance().SetTraceId(trace_id_);
+            }
+            int32_t level = slot.level;
+            uint32_t site = slot.site;
+            slot.sequence.store(ring.pos + ring.slot_count, std::memory_order_release);
+            ++ring.pos;
+            ++drained;
+
+            if (site != 0) {
+                LogRecords::GetInstance().Write(site, trace_id_, reinterpret_cast<const uint8_t*>(message.data()),
+                                                message.size());
+            } else if (level >= static_cast<int32_t>(LogLevel::TRACE) && level <= static_cast<int32_t>(LogLevel::OFF)) {
+                SSGXLogger::GetInstance().WriteLog(static_cast<LogLevel>(level), message.c_str());
+            }
+        }
+    }
+    return drained;
+}
+
+void LogDrain::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (DrainLocked() == 0) {
+            cv_.wait_for(lock, std::chrono::milliseconds(SSGX_LOG_DRAIN_INTERVAL_MS));
+        } else {
+            // Let a Flush() waiting for the lock go first
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace log_u
+} // namespace ssgx
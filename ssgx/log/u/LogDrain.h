@@ -0,0 +1,66 @@
+#ifndef SSGX_LOG_U_LOGDRAIN_H
+#define SSGX_LOG_U_LOGDRAIN_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../share/LogRing.h"
+
+namespace ssgx {
+namespace log_u {
+
+/**
+ * @brief Host side of the enclave log rings: creates them, and writes their messages with SSGXLogger.
+ *
+ * A background thread, started with the first ring, drains all rings every SSGX_LOG_DRAIN_INTERVAL_MS milliseconds
+ * when they are idle, and continuously otherwise. Flush() drains them on the calling thread. The rings are drained a
+ * last time when the process exits, so messages queued by an enclave are written even after it has been destroyed.
+ */
+class LogDrain {
+  public:
+    static LogDrain& GetInstance();
+
+    /**
+     * @brief Create a ring for an enclave.
+     * @return The ring, or nullptr if slot_count is not a power of two up to LOG_RING_MAX_SLOTS or mapping failed.
+     */
+    uint8_t* MapRing(size_t slot_count);
+
+    /**
+     * @brief Write every message published in the rings before returning.
+     */
+    void Flush();
+
+    LogDrain(const LogDrain&) = delete;
+    LogDrain& operator=(const LogDrain&) = delete;
+
+  private:
+    LogDrain();
+    ~LogDrain();
+
+    struct Ring {
+        ssgx::internal::LogRingSlot* slots;
+        size_t slot_count;
+        uint64_t pos; // next slot to drain
+    };
+
+    size_t DrainLocked();
+    void Run();
+
+    std::mutex mutex_; // protects the rings, and serializes the writes of drained messages
+    std::condition_variable cv_;
+    std::vector<Ring> rings_;
+    std::string trace_id_; // trace id of the last message written by the drain
+    std::thread thread_;
+    bool stop_ = false;
+};
+
+} // namespace log_u
+} // namespace ssgx
+
+#endif // SSGX_LOG_U_LOGDRAIN_H
@@ -17,6 +17,8 @@ LogHelper& LogHelper::GetInstance() {
 // Constructor
 LogHelper::LogHelper() {
     log4cplus::initialize();
+    loggers_.emplace_back(new log4cplus::Logger());
+    logger_.store(loggers_.back().get());
 }
 
 // Destructor
@@ -26,27 +28,45 @@ LogHelper::~LogHelper() {
 
 // Initialize the logging system
 void LogHelper::SetLogger(const std::string& logger_name, const std::string& log_file, log4cplus::LogLevel log_level,
-                          bool append_console) {
+                          bool append_console, const AsyncLogOptions* async_options) {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT(logger_name));
     logger.removeAllAppenders();
+    if (async_appender_) {
+        async_appender_->close();
+        async_appender_ = log4cplus::helpers::SharedObjectPtr<AsyncAppender>();
+    }
 
     log4cplus::tstring pattern = LOG4CPLUS_TEXT("%D{%Y-%m-%d %H:%M:%S.%q}[%c{2}][%-4p][%X{TraceId}][%t]%m%n");
 
     // Automatically create a new log file daily, with a maximum of 30 files.
-    log4cplus::SharedAppenderPtr file_appender(
-        new log4cplus::DailyRollingFileAppender(LOG4CPLUS_TEXT(log_file), log4cplus::DAILY, true, 30, false, false));
+    // The writer thread of an asynchronous logger flushes the file after each batch instead of each message.
+    bool immediate_flush = async_options == nullptr;
+    log4cplus::helpers::SharedObjectPtr<FlushableFileAppender> file_appender(new FlushableFileAppender(
+        LOG4CPLUS_TEXT(log_file), log4cplus::DAILY, immediate_flush, 30, false, false));
     file_appender->setLayout(std::unique_ptr<log4cplus::Layout>(new log4cplus::PatternLayout(pattern)));
 
-    logger.addAppender(file_appender);
-    logger.setLogLevel(log_level);
-
     // Configure console logging if needed
+    std::vector<log4cplus::SharedAppenderPtr> console_appenders;
     if (append_console) {
         log4cplus::SharedAppenderPtr console_appender(new log4cplus::ConsoleAppender());
         console_appender->setLayout(std::unique_ptr<log4cplus::Layout>(new log4cplus::PatternLayout(pattern)));
+        console_appenders.push_back(console_appender);
+    }
 
-        logger.addAppender(console_appender);
+    if (async_options) {
+        async_appender_ = log4cplus::helpers::SharedObjectPtr<AsyncAppender>(
+            new AsyncAppender(file_appender, console_appenders, *async_options));
+        logger.addAppender(log4cplus::SharedAppenderPtr(async_appender_.get()));
+    } else {
+        logger.addAppender(log4cplus::SharedAppenderPtr(file_appender.get()));
+        for (auto& console_appender : console_appenders) {
+            logger.addAppender(console_appender);
+        }
     }
+    logger.setLogLevel(log_level);
+    loggers_.emplace_back(new log4cplus::Logger(logger));
+    logger_.store(loggers_.back().get(), std::memory_order_release);
 }
 
 // Get a logger for a specific module (lazy initialization)
@@ -54,6 +74,26 @@ log4cplus::Logger LogHelper::GetLogger(const std::string& logger_name) {
     return log4cplus::Logger::getInstance(LOG4CPLUS_TEXT(logger_name));
 }
 
+const log4cplus::Logger& LogHelper::GetLogger() {
+    return *logger_.load(std::memory_order_acquire);
+}
+
+void LogHelper::FlushAsync() {
+    log4cplus::helpers::SharedObjectPtr<AsyncAppender> async_appender;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        async_appender = async_appender_;
+    }
+    if (async_appender) {
+        async_appender->Flush();
+    }
+}
+
+uint64_t LogHelper::GetDroppedCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return async_appender_ ? async_appender_->GetDroppedCount() : 0;
+}
+
 // Set the log level for a specific logger
 void LogHelper::SetLogLevel(const std::string& logger_name, log4cplus::LogLevel log_level) {
     auto logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT(logger_name));
@@ -65,6 +105,13 @@ void LogHelper::SetTraceId(const std::string& trace_id) {
     log4cplus::getMDC().put(LOG4CPLUS_TEXT("TraceId"), LOG4CPLUS_TEXT(trace_id));
 }
 
+// Get the TraceID from the MDC, empty if it is not set
+std::string LogHelper::GetTraceId() {
+    log4cplus::tstring trace_id;
+    log4cplus::getMDC().get(&trace_id, LOG4CPLUS_TEXT("TraceId"));
+    return trace_id;
+}
+
 // Remove the TraceID from the MDC
 void LogHelper::ClearTraceId() {
     log4cplus::getMDC().remove(LOG4CPLUS_TEXT("TraceId"));
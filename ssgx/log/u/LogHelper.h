@@ -1,13 +1,17 @@
 #ifndef SSGX_LOG_U_LOGHELPER_H
 #define SSGX_LOG_U_LOGHELPER_H
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "ssgx_log_u.h"
 
 #include "log4cplus/logger.h"
 #include "log4cplus/loglevel.h"
+#include "AsyncAppender.h"
 
 namespace ssgx {
 namespace log_u {
@@ -16,15 +20,27 @@ class LogHelper {
   public:
     static LogHelper& GetInstance();
 
+    // Messages are written by a background thread if async_options is not null
     void SetLogger(const std::string& logger_name, const std::string& log_file, log4cplus::LogLevel log_level,
-                   bool append_console = false);
+                   bool append_console = false, const AsyncLogOptions* async_options = nullptr);
 
     log4cplus::Logger GetLogger(const std::string& logger_name);
 
+    // The logger configured by SetLogger(), resolved once rather than looked up by name for every message, and read
+    // without a lock. A later SetLogger() publishes a new one, the reference stays valid.
+    const log4cplus::Logger& GetLogger();
+
+    // Wait until the asynchronous appender, if any, has written every queued message
+    void FlushAsync();
+
+    uint64_t GetDroppedCount();
+
     void SetLogLevel(const std::string& logger_name, log4cplus::LogLevel log_level);
 
     void SetTraceId(const std::string& trace_id);
 
+    std::string GetTraceId();
+
     void ClearTraceId();
 
   private:
@@ -33,6 +49,9 @@ class LogHelper {
     ~LogHelper();
 
     std::mutex mutex_; // Protects global initialization and shared resources
+    std::atomic<const log4cplus::Logger*> logger_;
+    std::vector<std::unique_ptr<log4cplus::Logger>> loggers_; // Every logger published, kept for readers holding one
+    log4cplus::helpers::SharedObjectPtr<AsyncAppender> async_appender_;
 };
 
 } // namespace log_u
@@ -0,0 +1,287 @@
+#include "LogRecords.h"
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+
+#include "ssgx_log_u_logger.h"
+
+namespace ssgx {
+namespace log_u {
+
+using internal::LogArgType;
+
+static const char RECORD_LOG_MAGIC[8] = {'S', 'S', 'G', 'X', 'R', 'E', 'C', '1'};
+static const char RECORD_LOG_SITE = 'S';
+static const char RECORD_LOG_RECORD = 'R';
+
+static void PutU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void PutString(std::string& out, const char* value, size_t size) {
+    PutU32(out, static_cast<uint32_t>(size));
+    out.append(value, size);
+}
+
+template <typename T>
+static bool Read(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static bool ReadString(std::istream& in, std::string& value) {
+    uint32_t size = 0;
+    if (!Read(in, size))
+        return false;
+    // The size comes from the file, check it against the bytes left before allocating
+    std::streampos pos = in.tellg();
+    if (pos < 0 || !in.seekg(0, std::ios::end))
+        return false;
+    std::streampos end = in.tellg();
+    if (end < pos || !in.seekg(pos) || static_cast<uint64_t>(end - pos) < size)
+        return false;
+    value.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&value[0], size));
+}
+
+// Append the next packed argument to out, or return false if it is malformed
+static bool FormatArg(const uint8_t*& p, const uint8_t* end, std::string& out) {
+    if (p == end)
+        return false;
+    auto type = static_cast<LogArgType>(*p++);
+    size_t available = static_cast<size_t>(end - p);
+    switch (type) {
+    case LogArgType::INT: {
+        int64_t value;
+        if (available < sizeof(value))
+            return false;
+        memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        out.append(std::to_string(value));
+        return true;
+    }
+    case LogArgType::UINT: {
+        uint64_t value;
+        if (available < sizeof(value))
+            return false;
+        memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        out.append(std::to_string(value));
+        return true;
+    }
+    case LogArgType::DOUBLE: {
+        double value;
+        if (available < sizeof(value))
+            return false;
+        memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        out.append(std::to_string(value));
+        return true;
+    }
+    case LogArgType::CHAR:
+        if (available < 1)
+            return false;
+        out.push_back(static_cast<char>(*p++));
+        return true;
+    case LogArgType::STRING: {
+        uint32_t size;
+        if (available < sizeof(size))
+            return false;
+        memcpy(&size, p, sizeof(size));
+        p += sizeof(size);
+        if (available - sizeof(size) < size)
+            return false;
+        out.append(reinterpret_cast<const char*>(p), size);
+        p += size;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+LogRecords& LogRecords::GetInstance() {
+    static LogRecords instance;
+    return instance;
+}
+
+uint32_t LogRecords::RegisterSite(LogLevel level, const char* file, int32_t line, const char* func,
+                                  const char* format) {
+    std::string key;
+    PutString(key, file, strlen(file));
+    PutU32(key, static_cast<uint32_t>(line));
+    PutString(key, func, strlen(func));
+    PutString(key, format, strlen(format));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(key);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    sites_.push_back(Site{level, file, line, func, format});
+    auto id = static_cast<uint32_t>(sites_.size());
+    ids_.emplace(std::move(key), id);
+    return id;
+}
+
+int LogRecords::Write(uint32_t site_id, const std::string& trace_id, const uint8_t* args, size_t size) {
+    if (!SSGXLogger::GetInstance().IsInitialized())
+        return -1;
+
+    const Site* site = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (site_id == 0 || site_id > sites_.size())
+            return -2;
+        site = &sites_[site_id - 1];
+
+        if (record_log_.is_open()) {
+            std::string entry;
+            if (record_log_sites_.size() < site_id) {
+                record_log_sites_.resize(site_id, false);
+            }
+            if (!record_log_sites_[site_id - 1]) {
+                entry.push_back(RECORD_LOG_SITE);
+                PutU32(entry, site_id);
+                PutU32(entry, static_cast<uint32_t>(site->level));
+                PutU32(entry, static_cast<uint32_t>(site->line));
+                PutString(entry, site->file.data(), site->file.size());
+                PutString(entry, site->func.data(), site->func.size());
+                PutString(entry, site->format.data(), site->format.size());
+                record_log_sites_[site_id - 1] = true;
+            }
+            auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch());
+            auto time_ms = static_cast<uint64_t>(now.count());
+            entry.push_back(RECORD_LOG_RECORD);
+            PutU32(entry, site_id);
+            entry.append(reinterpret_cast<const char*>(&time_ms), sizeof(time_ms));
+            PutString(entry, trace_id.data(), trace_id.size());
+            PutString(entry, reinterpret_cast<const char*>(args), size);
+            record_log_.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+            if (site->level == LogLevel::FATAL) {
+                record_log_.flush();
+            }
+            return 0;
+        }
+    }
+
+    std::string message;
+    Format(*site, args, size, message);
+    return SSGXLogger::GetInstance().WriteLog(site->level, message.c_str());
+}
+
+int LogRecords::SetRecordLog(const std::string& record_file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (record_log_.is_open()) {
+        record_log_.close();
+    }
+    record_log_sites_.clear();
+    if (record_file.empty()) {
+        return 0;
+    }
+
+    record_log_.open(record_file, std::ios::binary | std::ios::trunc);
+    if (!record_log_.is_open()) {
+        return -1;
+    }
+    record_log_.write(RECORD_LOG_MAGIC, sizeof(RECORD_LOG_MAGIC));
+    return 0;
+}
+
+void LogRecords::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (record_log_.is_open()) {
+        record_log_.flush();
+    }
+}
+
+void LogRecords::Format(const Site& site, const uint8_t* args, size_t size, std::string& out) {
+    // same layout as the messages formatted by the enclave: [main.cpp(42)]PrintLog():
+    out.reserve(site.file.size() + site.func.size() + site.format.size() + size + 16);
+    out.append("[");
+    out.append(site.file);
+    out.append("(");
+    out.append(std::to_string(site.line));
+    out.append(")");
+    out.append("]");
+    out.append(site.func);
+    out.append(":");
+
+    // Each {} takes the next argument, and stays as is once the arguments run out or are malformed
+    const uint8_t* p = args;
+    const uint8_t* end = args + size;
+    bool valid = true;
+    const std::string& format = site.format;
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}') {
+            if (!valid || !(valid = FormatArg(p, end, out))) {
+                out.append("{}");
+            }
+            ++i;
+        } else {
+            out.push_back(format[i]);
+        }
+    }
+}
+
+int LogRecords::DecodeRecordLog(const std::string& record_file, std::ostream& out) {
+    static const char* const LEVEL_NAMES[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "OFF"};
+
+    std::ifstream in(record_file, std::ios::binary);
+    char magic[sizeof(RECORD_LOG_MAGIC)];
+    if (!in.is_open() || !in.read(magic, sizeof(magic)) || memcmp(magic, RECORD_LOG_MAGIC, sizeof(magic)) != 0) {
+        return -1;
+    }
+
+    std::unordered_map<uint32_t, Site> sites;
+    std::string trace_id;
+    std::string args;
+    std::string message;
+    char type;
+    while (in.get(type)) {
+        uint32_t site_id = 0;
+        if (!Read(in, site_id))
+            return -2;
+
+        if (type == RECORD_LOG_SITE) {
+            int32_t level = 0;
+            Site site;
+            if (!Read(in, level) || !Read(in, site.line) || !ReadString(in, site.file) || !ReadString(in, site.func) ||
+                !ReadString(in, site.format))
+                return -2;
+            if (level < static_cast<int32_t>(LogLevel::TRACE) || level > static_cast<int32_t>(LogLevel::OFF))
+                return -2;
+            site.level = static_cast<LogLevel>(level);
+            sites[site_id] = std::move(site);
+        } else if (type == RECORD_LOG_RECORD) {
+            uint64_t time_ms = 0;
+            if (!Read(in, time_ms) || !ReadString(in, trace_id) || !ReadString(in, args))
+                return -2;
+            auto it = sites.find(site_id);
+            if (it == sites.end())
+                return -2;
+
+            // same layout as the log4cplus pattern: %D{%Y-%m-%d %H:%M:%S.%q}[%-4p][%X{TraceId}]%m%n
+            time_t seconds = static_cast<time_t>(time_ms / 1000);
+            struct tm tm_time {};
+            localtime_r(&seconds, &tm_time);
+            char time_buf[32];
+            size_t time_size = strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &tm_time);
+            snprintf(time_buf + time_size, sizeof(time_buf) - time_size, ".%03u",
+                     static_cast<unsigned>(time_ms % 1000));
+
+            message.clear();
+            Format(it->second, reinterpret_cast<const uint8_t*>(args.data()), args.size(), message);
+            out << time_buf << "[" << LEVEL_NAMES[static_cast<int>(it->second.level)] << "][" << trace_id << "]"
+                << message << "\n";
+        } else {
+            return -2;
+        }
+    }
+    return 0;
+}
+
+} // namespace log_u
+} // namespace ssgx
@@ -0,0 +1,90 @@
+#ifndef SSGX_LOG_U_LOGRECORDS_H
+#define SSGX_LOG_U_LOGRECORDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ssgx_log_u.h"
+
+namespace ssgx {
+namespace log_u {
+
+/**
+ * @brief Host side of the structured log records of enclaves (SSGX_LOGF).
+ *
+ * Keeps the log sites registered by enclaves, and either formats their records into the log4cplus log, or appends them
+ * as is to a binary record log which DecodeRecordLog() turns into text offline. The record log starts with
+ * RECORD_LOG_MAGIC, followed by entries in host byte order, where a string is a uint32 length followed by its bytes:
+ *
+ * - 'S', uint32 site id, int32 level, int32 line, string file, string function, string format: the definition of a
+ *   site, written before its first record;
+ * - 'R', uint32 site id, uint64 time in milliseconds since the epoch, string trace id, string packed arguments.
+ */
+class LogRecords {
+  public:
+    static LogRecords& GetInstance();
+
+    /**
+     * @brief Register a log site, or find the id of an identical one.
+     * @return The id of the site, never 0.
+     */
+    uint32_t RegisterSite(LogLevel level, const char* file, int32_t line, const char* func, const char* format);
+
+    /**
+     * @brief Write a record of a site.
+     * @return 0 on success, -1 if SSGXLogger is not initialized, -2 if the site is unknown.
+     */
+    int Write(uint32_t site_id, const std::string& trace_id, const uint8_t* args, size_t size);
+
+    /**
+     * @brief Append the records to record_file instead of formatting them, or format them again if it is empty.
+     * @return 0 on success, -1 if the file can not be opened.
+     */
+    int SetRecordLog(const std::string& record_file);
+
+    /**
+     * @brief Write the records buffered for the record log to its file.
+     */
+    void Flush();
+
+    /**
+     * @brief Write the records of a record log as text, one line per record.
+     * @return 0 on success, -1 if the file can not be opened or is not a record log, -2 if it is truncated or
+     * corrupted.
+     */
+    static int DecodeRecordLog(const std::string& record_file, std::ostream& out);
+
+    LogRecords(const LogRecords&) = delete;
+    LogRecords& operator=(const LogRecords&) = delete;
+
+  private:
+    LogRecords() = default;
+
+    struct Site {
+        LogLevel level;
+        std::string file;
+        int32_t line;
+        std::string func;
+        std::string format;
+    };
+
+    static void Format(const Site& site, const uint8_t* args, size_t size, std::string& out);
+
+    std::mutex mutex_;
+    std::deque<Site> sites_;              // site id - 1, never shrinks so that references stay valid
+    std::map<std::string, uint32_t> ids_; // site ids by file, line, function and format
+    std::ofstream record_log_;            // open if the records are written as is
+    std::vector<bool> record_log_sites_;  // sites whose definition has been written to record_log_
+};
+
+} // namespace log_u
+} // namespace ssgx
+
+#endif // SSGX_LOG_U_LOGRECORDS_H
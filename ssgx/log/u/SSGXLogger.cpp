@@ -4,6 +4,7 @@
 #include <unordered_map>
 
 #include "ssgx_log_u_logger.h"
+#include "ssgx_utils_u.h"
 
 #include "log4cplus/consoleappender.h"
 #include "log4cplus/fileappender.h"
@@ -11,7 +12,9 @@
 #include "log4cplus/logger.h"
 #include "log4cplus/loggingmacros.h"
 #include "log4cplus/mdc.h"
+#include "LogDrain.h"
 #include "LogHelper.h"
+#include "LogRecords.h"
 
 namespace ssgx {
 namespace log_u {
@@ -28,10 +31,32 @@ SSGXLogger& SSGXLogger::GetInstance() {
 
 void SSGXLogger::Init(const std::string& logger_name, const std::string& log_file, LogLevel log_level,
                       bool append_console) {
-    ssgx::log_u::LogHelper::GetInstance().SetLogger(logger_name, log_file, MapLogLevel(log_level), append_console);
+    InitLogger(logger_name, log_file, log_level, append_console, nullptr);
+}
+
+void SSGXLogger::Init(const std::string& logger_name, const std::string& log_file, LogLevel log_level,
+                      bool append_console, const AsyncLogOptions& options) {
+    InitLogger(logger_name, log_file, log_level, append_console, &options);
+}
+
+void SSGXLogger::InitLogger(const std::string& logger_name, const std::string& log_file, LogLevel log_level,
+                            bool append_console, const AsyncLogOptions* async_options) {
+    ssgx::log_u::LogHelper::GetInstance().SetLogger(logger_name, log_file, MapLogLevel(log_level), append_console,
+                                                    async_options);
     ssgx::log_u::LogHelper::GetInstance().SetTraceId("main");
     logger_name_ = logger_name;
     initialized_ = true;
+
+    // Let enclaves drop the messages below this level without an OCALL
+    ssgx::utils_u::ControlPage::SetLogLevel(static_cast<int32_t>(log_level));
+}
+
+void SSGXLogger::SetLogLevel(LogLevel log_level) {
+    if (!initialized_) {
+        return;
+    }
+    ssgx::log_u::LogHelper::GetInstance().SetLogLevel(logger_name_, MapLogLevel(log_level));
+    ssgx::utils_u::ControlPage::SetLogLevel(static_cast<int32_t>(log_level));
 }
 
 void SSGXLogger::SetTraceId(const std::string& trace_id) {
@@ -60,6 +85,26 @@ int SSGXLogger::MapLogLevel(LogLevel log_level) const {
     }
 }
 
+void SSGXLogger::Flush() {
+    LogDrain::GetInstance().Flush();
+    LogRecords::GetInstance().Flush();
+    LogHelper::GetInstance().FlushAsync();
+}
+
+uint64_t SSGXLogger::GetDroppedCount() {
+    return LogHelper::GetInstance().GetDroppedCount();
+}
+
+int SSGXLogger::SetRecordLog(const std::string& record_file) {
+    // the records queued so far go to the previous destination
+    LogDrain::GetInstance().Flush();
+    return LogRecords::GetInstance().SetRecordLog(record_file);
+}
+
+int SSGXLogger::DecodeRecordLog(const std::string& record_file, std::ostream& out) {
+    return LogRecords::DecodeRecordLog(record_file, out);
+}
+
 bool SSGXLogger::IsInitialized() {
     return initialized_;
 }
@@ -67,36 +112,25 @@ bool SSGXLogger::IsInitialized() {
 int SSGXLogger::WriteLog(ssgx::log_u::LogLevel log_level, const char* msg) {
     if (!GetInstance().IsInitialized())
         return -1;
+    const log4cplus::Logger& logger = ssgx::log_u::LogHelper::GetInstance().GetLogger();
     switch (log_level) {
     case ssgx::log_u::LogLevel::INFO:
-        LOG4CPLUS_INFO_FMT(
-            ssgx::log_u::LogHelper::GetInstance().GetLogger(ssgx::log_u::SSGXLogger::GetInstance().GetLoggerName()),
-            "%s", msg);
+        LOG4CPLUS_INFO_STR(logger, msg);
         break;
     case ssgx::log_u::LogLevel::WARN:
-        LOG4CPLUS_WARN_FMT(
-            ssgx::log_u::LogHelper::GetInstance().GetLogger(ssgx::log_u::SSGXLogger::GetInstance().GetLoggerName()),
-            "%s", msg);
+        LOG4CPLUS_WARN_STR(logger, msg);
         break;
     case ssgx::log_u::LogLevel::ERROR:
-        LOG4CPLUS_ERROR_FMT(
-            ssgx::log_u::LogHelper::GetInstance().GetLogger(ssgx::log_u::SSGXLogger::GetInstance().GetLoggerName()),
-            "%s", msg);
+        LOG4CPLUS_ERROR_STR(logger, msg);
         break;
     case ssgx::log_u::LogLevel::FATAL:
-        LOG4CPLUS_FATAL_FMT(
-            ssgx::log_u::LogHelper::GetInstance().GetLogger(ssgx::log_u::SSGXLogger::GetInstance().GetLoggerName()),
-            "%s", msg);
+        LOG4CPLUS_FATAL_STR(logger, msg);
         break;
     case ssgx::log_u::LogLevel::DEBUG:
-        LOG4CPLUS_DEBUG_FMT(
-            ssgx::log_u::LogHelper::GetInstance().GetLogger(ssgx::log_u::SSGXLogger::GetInstance().GetLoggerName()),
-            "%s", msg);
+        LOG4CPLUS_DEBUG_STR(logger, msg);
         break;
     case ssgx::log_u::LogLevel::TRACE:
-        LOG4CPLUS_TRACE_FMT(
-            ssgx::log_u::LogHelper::GetInstance().GetLogger(ssgx::log_u::SSGXLogger::GetInstance().GetLoggerName()),
-            "%s", msg);
+        LOG4CPLUS_TRACE_STR(logger, msg);
         break;
     default:
         break;
@@ -5,7 +5,9 @@
 #include "ssgx_log_u.h"
 
 #include "log4cplus/loggingmacros.h"
+#include "LogDrain.h"
 #include "LogHelper.h"
+#include "LogRecords.h"
 
 extern "C" {
 
@@ -20,4 +22,33 @@ void ssgx_ocall_set_trace_id(const char* trace_id) {
     ssgx::log_u::LogHelper::GetInstance().SetTraceId(trace_id);
 }
 
+int ssgx_ocall_map_log_ring(size_t slot_count, uint8_t** ring) {
+    *ring = nullptr;
+    if (!ssgx::log_u::SSGXLogger::GetInstance().IsInitialized())
+        return -1;
+    *ring = ssgx::log_u::LogDrain::GetInstance().MapRing(slot_count);
+    return *ring ? 0 : -2;
+}
+
+void ssgx_ocall_flush_log() {
+    ssgx::log_u::LogDrain::GetInstance().Flush();
+}
+
+int ssgx_ocall_register_log_site(int32_t level, const char* file, int32_t line, const char* func, const char* format,
+                                 uint32_t* site_id) {
+    *site_id = 0;
+    if (!ssgx::log_u::SSGXLogger::GetInstance().IsInitialized())
+        return -1;
+    if (level < 0 || level > 6)
+        return -2;
+    auto log_level = static_cast<ssgx::log_u::LogLevel>(level);
+    *site_id = ssgx::log_u::LogRecords::GetInstance().RegisterSite(log_level, file, line, func, format);
+    return 0;
+}
+
+int ssgx_ocall_write_log_record(uint32_t site_id, const uint8_t* args, size_t size) {
+    std::string trace_id = ssgx::log_u::LogHelper::GetInstance().GetTraceId();
+    return ssgx::log_u::LogRecords::GetInstance().Write(site_id, trace_id, args, size);
+}
+
 } // extern "C"
@@ -2,11 +2,11 @@ include(CMakeFindDependencyMacro)
 
 include(${CMAKE_CURRENT_LIST_DIR}/ssgx-build.cmake)
 
+include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_utils_t/ssgx_utils_tTargets.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_utils_u/ssgx_utils_uTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_log_t/ssgx_log_tTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_log_u/ssgx_log_uTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_json_t/ssgx_json_tTargets.cmake)
-include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_utils_t/ssgx_utils_tTargets.cmake)
-include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_utils_u/ssgx_utils_uTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_attestation_t/ssgx_attestation_tTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_attestation_u/ssgx_attestation_uTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/../ssgx_config_t/ssgx_config_tTargets.cmake)
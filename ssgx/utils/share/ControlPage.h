@@ -0,0 +1,52 @@
+#ifndef SSGXLIB_UTILS_CONTROLPAGE_H
+#define SSGXLIB_UTILS_CONTROLPAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ssgx {
+namespace internal {
+
+/**
+ * @brief Layout of the control page, a page of untrusted memory written by the host and read by the enclave.
+ *
+ * The host maps the page once and hands it to the enclave with ssgx_ocall_map_control_page(). From then on the enclave
+ * reads the signals below with a plain atomic load instead of an OCALL. Every field sits on its own cache line, so a
+ * host write to one field does not invalidate the lines of the others in the cores polling them.
+ *
+ * Everything in the page is controlled by the host: the enclave checks magic and version once, and validates each value
+ * it loads (see ssgx::utils_t::ControlPage).
+ */
+constexpr uint32_t CONTROL_PAGE_MAGIC = 0x31504353; // "SCP1"
+constexpr uint32_t CONTROL_PAGE_VERSION = 1;
+constexpr size_t CONTROL_PAGE_SIZE = 4096;
+constexpr size_t CONTROL_PAGE_LINE = 64;
+
+// Value of log_level while the host logger has not been initialized
+constexpr int32_t CONTROL_PAGE_LOG_LEVEL_UNSET = -1;
+
+struct ControlPageData {
+    alignas(CONTROL_PAGE_LINE) uint32_t magic;
+    uint32_t version;
+
+    // Non-zero once the host has asked the servers to stop (ssgx::http_u::StopHttpServers())
+    alignas(CONTROL_PAGE_LINE) std::atomic<uint32_t> stop_flag;
+
+    // Minimum level written by the host logger, a LogLevel value, or CONTROL_PAGE_LOG_LEVEL_UNSET
+    alignas(CONTROL_PAGE_LINE) std::atomic<int32_t> log_level;
+
+    // Milliseconds since the UNIX epoch, refreshed by the host every SSGX_CONTROL_PAGE_TICK_MS
+    alignas(CONTROL_PAGE_LINE) std::atomic<uint64_t> coarse_time_ms;
+};
+
+static_assert(sizeof(ControlPageData) <= CONTROL_PAGE_SIZE, "The control page data must fit in one page");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "Atomics must have the layout of plain integers");
+#if ATOMIC_INT_LOCK_FREE != 2 || ATOMIC_LLONG_LOCK_FREE != 2
+#error "The control page needs lock-free atomics, both sides of the enclave boundary access them"
+#endif
+
+} // namespace internal
+} // namespace ssgx
+
+#endif // SSGXLIB_UTILS_CONTROLPAGE_H
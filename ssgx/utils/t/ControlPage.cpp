@@ -0,0 +1,83 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "sgx_lfence.h"
+#include "sgx_trts.h"
+
+#include "ssgx_utils_t.h"
+#include "ssgx_utils_t_t.h"
+
+#include "../share/ControlPage.h"
+
+using ssgx::internal::ControlPageData;
+
+namespace ssgx {
+namespace utils_t {
+
+static std::mutex map_mutex;
+static std::atomic<bool> map_attempted{false};
+static std::atomic<const ControlPageData*> control_page{nullptr};
+static std::atomic<uint64_t> last_coarse_time{0};
+
+static const ControlPageData* GetControlPage() {
+    const ControlPageData* page = control_page.load(std::memory_order_acquire);
+    if (page || map_attempted.load(std::memory_order_acquire))
+        return page;
+
+    std::lock_guard<std::mutex> lock(map_mutex);
+    if (map_attempted.load(std::memory_order_relaxed))
+        return control_page.load(std::memory_order_relaxed);
+
+    // Only one attempt is made: if the host refuses, every read falls back to its default.
+    uint8_t* base = nullptr;
+    sgx_status_t status = ssgx_ocall_map_control_page(&base);
+    if (status == SGX_SUCCESS && base && sgx_is_outside_enclave(base, ssgx::internal::CONTROL_PAGE_SIZE) == 1 &&
+        reinterpret_cast<uintptr_t>(base) % alignof(ControlPageData) == 0) {
+        sgx_lfence();
+        const auto* candidate = reinterpret_cast<const ControlPageData*>(base);
+        if (candidate->magic == ssgx::internal::CONTROL_PAGE_MAGIC &&
+            candidate->version == ssgx::internal::CONTROL_PAGE_VERSION) {
+            page = candidate;
+        }
+    }
+    control_page.store(page, std::memory_order_release);
+    map_attempted.store(true, std::memory_order_release);
+    return page;
+}
+
+bool ControlPage::IsAvailable() {
+    return GetControlPage() != nullptr;
+}
+
+bool ControlPage::StopRequested() {
+    const ControlPageData* page = GetControlPage();
+    return page && page->stop_flag.load(std::memory_order_acquire) != 0;
+}
+
+int32_t ControlPage::LogLevel() {
+    const ControlPageData* page = GetControlPage();
+    if (!page)
+        return ssgx::internal::CONTROL_PAGE_LOG_LEVEL_UNSET;
+
+    // Anything outside LogLevel::TRACE (0) .. LogLevel::OFF (6) is treated as unset
+    int32_t level = page->log_level.load(std::memory_order_acquire);
+    if (level < 0 || level > 6)
+        return ssgx::internal::CONTROL_PAGE_LOG_LEVEL_UNSET;
+    return level;
+}
+
+int64_t ControlPage::CoarseNowInMilliseconds() {
+    const ControlPageData* page = GetControlPage();
+    if (!page)
+        return PreciseTime::NowInMilliseconds();
+
+    uint64_t now = page->coarse_time_ms.load(std::memory_order_acquire);
+    uint64_t last = last_coarse_time.load(std::memory_order_relaxed);
+    while (now > last && !last_coarse_time.compare_exchange_weak(last, now, std::memory_order_relaxed)) {
+    }
+    return static_cast<int64_t>(now > last ? now : last);
+}
+
+} // namespace utils_t
+} // namespace ssgx
@@ -12,13 +12,11 @@ EnclaveInfo& EnclaveInfo::GetCurrentEnclave() {
 }
 
 void EnclaveInfo::SetEnclaveEid(sgx_enclave_id_t eid) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    enclave_eid_ = eid;
+    enclave_eid_.store(eid, std::memory_order_release);
 }
 
 sgx_enclave_id_t EnclaveInfo::GetEnclaveEid() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return enclave_eid_;
+    return enclave_eid_.load(std::memory_order_acquire);
 }
 
 } // namespace utils_t
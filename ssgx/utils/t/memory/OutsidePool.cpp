@@ -0,0 +1,129 @@
+#include "OutsidePool.h"
+
+#include "sgx_lfence.h"
+#include "sgx_trts.h"
+
+#include "ssgx_utils_t_t.h"
+
+namespace ssgx {
+namespace utils_t {
+
+static int SizeClassOf(size_t size, size_t min_shift, size_t class_count) {
+    size_t block = size_t(1) << min_shift;
+    for (size_t i = 0; i < class_count; ++i, block <<= 1) {
+        if (size <= block)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+OutsidePool& OutsidePool::GetInstance() {
+    static OutsidePool instance;
+    return instance;
+}
+
+bool OutsidePool::MapArena() {
+    // Only one attempt is made: if the host refuses, every allocation falls back to the OCALL path.
+    map_attempted_ = true;
+    if (SSGX_OUTSIDE_ARENA_SIZE < kPageSize)
+        return false;
+
+    size_t size = (SSGX_OUTSIDE_ARENA_SIZE / kPageSize) * kPageSize;
+    uint8_t* base = nullptr;
+    sgx_status_t status = ssgx_ocall_map_outside_arena(size, &base);
+    if (status != SGX_SUCCESS || !base)
+        return false;
+    if (sgx_is_outside_enclave(base, size) != 1)
+        return false;
+    sgx_lfence();
+
+    arena_size_ = size;
+    pages_.resize(size / kPageSize);
+    stats_.arena_size = size;
+    arena_base_.store(base, std::memory_order_release);
+    return true;
+}
+
+void* OutsidePool::Allocate(size_t size) {
+    int size_class = SizeClassOf(size, kMinBlockShift, kClassCount);
+    if (size_class < 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!arena_base_.load(std::memory_order_relaxed) && (map_attempted_ || !MapArena()))
+        return nullptr;
+
+    size_t block_size = size_t(1) << (kMinBlockShift + size_class);
+    std::vector<uint32_t>& free_list = free_lists_[size_class];
+    if (free_list.empty()) {
+        // Bind a fresh page to this class
+        if (next_free_page_ >= pages_.size())
+            return nullptr;
+        size_t page_index = next_free_page_++;
+        size_t blocks = kPageSize / block_size;
+        pages_[page_index].size_class = size_class;
+        pages_[page_index].in_use.assign((blocks + 63) / 64, 0);
+        free_list.reserve(free_list.size() + blocks);
+        for (size_t i = blocks; i > 0; --i) {
+            free_list.push_back(static_cast<uint32_t>(page_index * kPageSize + (i - 1) * block_size));
+        }
+    }
+
+    uint32_t offset = free_list.back();
+    free_list.pop_back();
+    Page& page = pages_[offset / kPageSize];
+    size_t block_index = (offset % kPageSize) / block_size;
+    page.in_use[block_index / 64] |= (uint64_t(1) << (block_index % 64));
+
+    stats_.pooled_allocs++;
+    stats_.bytes_in_use += block_size;
+    return arena_base_.load(std::memory_order_relaxed) + offset;
+}
+
+bool OutsidePool::Owns(const void* ptr) const {
+    const auto* p = static_cast<const uint8_t*>(ptr);
+    const uint8_t* base = arena_base_.load(std::memory_order_acquire);
+    return base && p >= base && p < base + arena_size_;
+}
+
+bool OutsidePool::Release(void* ptr) {
+    // The arena does not move once mapped, so a pointer outside of it is told apart without the lock
+    if (!Owns(ptr))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t offset = static_cast<size_t>(static_cast<uint8_t*>(ptr) - arena_base_.load(std::memory_order_relaxed));
+    Page& page = pages_[offset / kPageSize];
+    if (page.size_class < 0)
+        return true;
+    size_t block_size = size_t(1) << (kMinBlockShift + page.size_class);
+    if ((offset % kPageSize) % block_size != 0)
+        return true;
+
+    size_t block_index = (offset % kPageSize) / block_size;
+    uint64_t mask = uint64_t(1) << (block_index % 64);
+    if ((page.in_use[block_index / 64] & mask) == 0)
+        return true; // double free
+    page.in_use[block_index / 64] &= ~mask;
+
+    free_lists_[page.size_class].push_back(static_cast<uint32_t>(offset));
+    stats_.pooled_frees++;
+    stats_.bytes_in_use -= block_size;
+    return true;
+}
+
+void OutsidePool::CountFallback() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.fallback_allocs++;
+}
+
+OutsidePoolStats OutsidePool::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    OutsidePoolStats stats = stats_;
+    stats.pages_in_use = next_free_page_;
+    stats.pages_total = pages_.size();
+    return stats;
+}
+
+} // namespace utils_t
+} // namespace ssgx
@@ -0,0 +1,83 @@
+#ifndef SSGXLIB_UTILS_T_OUTSIDEPOOL_H
+#define SSGXLIB_UTILS_T_OUTSIDEPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ssgx_utils_t.h"
+
+/**
+ * Size of the untrusted arena requested from the host on the first pooled allocation.
+ * Define it as 0 at build time to disable the pool, in which case every allocation goes through an OCALL.
+ */
+#ifndef SSGX_OUTSIDE_ARENA_SIZE
+#define SSGX_OUTSIDE_ARENA_SIZE (8 * 1024 * 1024)
+#endif
+
+namespace ssgx {
+namespace utils_t {
+
+/**
+ * @brief Size-classed slab allocator over an untrusted arena mapped once by the host.
+ *
+ * The arena is split into 64 KB pages, and each page is bound to one power-of-two size class (32 bytes to 64 KB) the
+ * first time that class runs dry. All bookkeeping (free lists and per-page in-use bitmaps) lives inside the enclave,
+ * so nothing the host writes into the arena can redirect an allocation or a free.
+ *
+ * Blocks handed out here must be released with FreeOutside() from inside the enclave: the host cannot free() them.
+ */
+class OutsidePool {
+  public:
+    static OutsidePool& GetInstance();
+
+    /**
+     * @brief Take a block of at least size bytes from the arena.
+     * @return nullptr if size is larger than the biggest class, the arena is full or unavailable.
+     */
+    void* Allocate(size_t size);
+
+    /**
+     * @brief Give a block back to its free list. Pointers that are not the start of a live block are ignored.
+     * @return false if ptr does not point into the arena, in which case the caller still owns it. That case is
+     * told without taking the lock.
+     */
+    bool Release(void* ptr);
+
+    /**
+     * @brief Record an allocation that had to go through the OCALL path.
+     */
+    void CountFallback();
+
+    OutsidePoolStats GetStats();
+
+  private:
+    OutsidePool() = default;
+    bool MapArena();
+    bool Owns(const void* ptr) const;
+
+    struct Page {
+        int size_class = -1;
+        std::vector<uint64_t> in_use;
+    };
+
+    static constexpr size_t kPageSize = 64 * 1024;
+    static constexpr size_t kMinBlockShift = 5; // 32 bytes
+    static constexpr size_t kClassCount = 12;   // 32 bytes .. 64 KB
+
+    std::mutex mutex_;
+    bool map_attempted_ = false;
+    std::atomic<uint8_t*> arena_base_{nullptr}; // published once the arena is mapped, never unmapped
+    size_t arena_size_ = 0;
+    size_t next_free_page_ = 0;
+    std::vector<Page> pages_;
+    std::vector<uint32_t> free_lists_[kClassCount]; // block offsets from arena_base_
+    OutsidePoolStats stats_{};
+};
+
+} // namespace utils_t
+} // namespace ssgx
+
+#endif // SSGXLIB_UTILS_T_OUTSIDEPOOL_H
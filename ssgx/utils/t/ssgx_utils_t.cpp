@@ -10,6 +10,8 @@
 #include "ssgx_utils_t.h"
 #include "ssgx_utils_t_t.h"
 
+#include "memory/OutsidePool.h"
+
 using ssgx::utils_t::Printf;
 using ssgx::utils_t::FormatStr;
 using ssgx::utils_t::MallocOutside;
@@ -102,9 +104,27 @@ void* MallocOutside(size_t size) {
     return outside_buf;
 }
 
+void* MallocOutsidePooled(size_t size) {
+    if (size == 0)
+        return nullptr;
+
+    OutsidePool& pool = OutsidePool::GetInstance();
+    void* pooled_buf = pool.Allocate(size);
+    if (pooled_buf) {
+        // Pooled blocks are recycled, so clear them on every allocation
+        memset(pooled_buf, 0, size);
+        return pooled_buf;
+    }
+
+    pool.CountFallback();
+    return MallocOutside(size);
+}
+
 void* CallocOutside(size_t num, size_t size) {
     if (size == 0 || num == 0)
         return nullptr;
+    if (num > SIZE_MAX / size)
+        return nullptr;
 
     uint8_t* outside_buf = nullptr;
     sgx_status_t status = ssgx_ocall_calloc(num, size, &outside_buf);
@@ -123,12 +143,20 @@ void* CallocOutside(size_t num, size_t size) {
 }
 
 void FreeOutside(void* ptr_outside, size_t size) {
-    if (ptr_outside != nullptr && sgx_is_outside_enclave(ptr_outside, size) == 1) {
+    if (ptr_outside == nullptr)
+        return;
+    if (OutsidePool::GetInstance().Release(ptr_outside))
+        return;
+    if (sgx_is_outside_enclave(ptr_outside, size) == 1) {
         ssgx_ocall_free((uint8_t*)ptr_outside);
         ptr_outside = nullptr;
     }
 }
 
+OutsidePoolStats GetOutsidePoolStats() {
+    return OutsidePool::GetInstance().GetStats();
+}
+
 void* MemcpyToOutside(void* dest_outside_enclave, const void* src, std::size_t count) {
     if (dest_outside_enclave == nullptr || (sgx_is_outside_enclave(dest_outside_enclave, count) != 1)) {
         throw std::invalid_argument(std::string("Failed in \"dest_outside_enclave != nullptr && "
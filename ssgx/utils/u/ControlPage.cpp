@@ -0,0 +1,147 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include <sys/mman.h>
+
+#include "ssgx_utils_u.h"
+
+#include "../share/ControlPage.h"
+
+/**
+ * Period of the coarse clock of the control page, in milliseconds.
+ */
+#ifndef SSGX_CONTROL_PAGE_TICK_MS
+#define SSGX_CONTROL_PAGE_TICK_MS 10
+#endif
+
+using ssgx::internal::ControlPageData;
+
+namespace ssgx {
+namespace utils_u {
+
+static uint64_t NowInMilliseconds() {
+    auto duration = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+}
+
+// Values set before the page exists, copied into it when it is created
+static std::mutex page_mutex;
+static ControlPageData* page = nullptr;
+static bool pending_stop = false;
+static int32_t pending_log_level = ssgx::internal::CONTROL_PAGE_LOG_LEVEL_UNSET;
+
+/**
+ * @brief The host thread which refreshes the coarse clock of the page.
+ *
+ * It is stopped and joined by ControlPage::Shutdown(), or at the latest when the process exits, before the page it
+ * writes to could be unmapped or the statics it uses destroyed.
+ */
+class CoarseClockTicker {
+  public:
+    ~CoarseClockTicker() {
+        Stop();
+    }
+
+    // Start the thread if it is not running
+    void Start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (thread_.joinable()) {
+            return;
+        }
+        stop_ = false;
+        thread_ = std::thread(&CoarseClockTicker::Run, this);
+    }
+
+    void Stop() {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            thread.swap(thread_);
+        }
+        cv_.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+  private:
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_for(lock, std::chrono::milliseconds(SSGX_CONTROL_PAGE_TICK_MS), [this] { return stop_; })) {
+            lock.unlock();
+            ControlPage::UpdateCoarseClock();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+static CoarseClockTicker ticker;
+
+uint8_t* ControlPage::Map() {
+    std::lock_guard<std::mutex> lock(page_mutex);
+    if (page) {
+        ticker.Start();
+        return reinterpret_cast<uint8_t*>(page);
+    }
+
+    // The page stays mapped for the lifetime of the process, enclaves keep reading it until they are destroyed
+    void* base = mmap(nullptr, ssgx::internal::CONTROL_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1, 0);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    auto* data = new (base) ControlPageData();
+    data->stop_flag.store(pending_stop ? 1 : 0, std::memory_order_relaxed);
+    data->log_level.store(pending_log_level, std::memory_order_relaxed);
+    data->coarse_time_ms.store(NowInMilliseconds(), std::memory_order_relaxed);
+    data->version = ssgx::internal::CONTROL_PAGE_VERSION;
+    data->magic = ssgx::internal::CONTROL_PAGE_MAGIC;
+    page = data;
+
+    ticker.Start();
+    return reinterpret_cast<uint8_t*>(page);
+}
+
+void ControlPage::Shutdown() {
+    ticker.Stop();
+}
+
+void ControlPage::SetStopFlag(bool stop) {
+    std::lock_guard<std::mutex> lock(page_mutex);
+    pending_stop = stop;
+    if (page) {
+        page->stop_flag.store(stop ? 1 : 0, std::memory_order_release);
+    }
+}
+
+void ControlPage::SetLogLevel(int32_t level) {
+    std::lock_guard<std::mutex> lock(page_mutex);
+    pending_log_level = level;
+    if (page) {
+        page->log_level.store(level, std::memory_order_release);
+    }
+}
+
+void ControlPage::UpdateCoarseClock() {
+    ControlPageData* data = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(page_mutex);
+        data = page;
+    }
+    if (data) {
+        data->coarse_time_ms.store(NowInMilliseconds(), std::memory_order_release);
+    }
+}
+
+} // namespace utils_u
+} // namespace ssgx
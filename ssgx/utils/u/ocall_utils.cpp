@@ -6,6 +6,10 @@
 #include <ctime>
 #include <thread> // std::this_thread::sleep_for
 
+#include <sys/mman.h>
+
+#include "ssgx_utils_u.h"
+
 extern "C" {
 
 int ssgx_ocall_printf(const char* str) {
@@ -52,6 +56,25 @@ void ssgx_ocall_free(uint8_t* ptr_out_side) {
     ptr_out_side = NULL;
 }
 
+void ssgx_ocall_map_outside_arena(size_t size, uint8_t** ret) {
+    /**
+     * The arena stays mapped for the lifetime of the process. Anonymous pages are zero-filled and only become resident
+     * once the enclave touches them, so reserving the whole arena up front costs nothing.
+     */
+    *ret = NULL;
+    if (size == 0) {
+        return;
+    }
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base != MAP_FAILED) {
+        *ret = (uint8_t*)base;
+    }
+}
+
+void ssgx_ocall_map_control_page(uint8_t** ret) {
+    *ret = ssgx::utils_u::ControlPage::Map();
+}
+
 void ssgx_ocall_time_in_milliseconds(uint64_t* now) {
     auto t_now = std::chrono::system_clock::now();
     auto duration = t_now.time_since_epoch();
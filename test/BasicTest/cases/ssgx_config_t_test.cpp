@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "ssgx_config_t.h"
+#include "ssgx_config_t_reloadable.h"
 #include "ssgx_testframework_t.h"
 #include "ssgx_utils_t.h"
 using namespace ssgx::config_t;
@@ -184,4 +185,73 @@ TEST(ConfigTestSuite, TestErrorHandle) {
     ASSERT_FALSE(value_array.has_value());
     // Output the error details message
     //ssgx::utils_t::Printf("Error Message: %s\n", config.GetLastErrorMsg().c_str());
-}
\ No newline at end of file
+}
+
+TEST(ConfigTestSuite, TestLoadInEnclave) {
+    TomlConfig config;
+    const std::string data_dir(TEST_DATA_DIR);
+    const std::string file_name = data_dir + "/BasicTest/test.toml";
+    ASSERT_TRUE(config.LoadFile(file_name.c_str(), TomlConfig::LoadMode::Enclave));
+    ASSERT_EQ(config.GetFileDigest().size(), 32);
+
+    ASSERT_EQ(config.GetInteger("hex1"), 0xDEADBEEF);
+    ASSERT_EQ(config.GetInteger("negative_extreme_number"), std::numeric_limits<long>::min());
+    ASSERT_EQ(config.GetString("string2"), "Roses are red\nViolets are blue");
+    ASSERT_EQ(config.GetString("string4"), "Tom \"Dubs\" Preston-Werner");
+    ASSERT_EQ(config.GetInteger("clothes", "price", 1, "dress"), 39);
+    ASSERT_EQ(config.GetString("fruits", 1, 1, 0), "watermelon");
+    ASSERT_EQ(config.GetString("animal", "dog", "name"), "Tina");
+    ASSERT_EQ(config.GetStringArray("fruits", 1, 0), (std::vector<std::string>{"pear", "grapes", "strawberry"}));
+    ASSERT_EQ(config.GetIntegerArray("empty", "empty_array"), std::vector<int64_t>{});
+
+    ASSERT_FALSE(config.GetInteger("string2").has_value());
+    ASSERT_FALSE(config.GetString("animal").has_value());
+    ASSERT_FALSE(config.GetString("clothes", "price", 2, "shirt").has_value());
+    ASSERT_FALSE(config.GetStringArray("string3").has_value());
+    ASSERT_TRUE(!config.GetLastErrorMsg().empty());
+
+    // Content which is not read from a file, e.g. unsealed: a content which fails to parse keeps the previous one
+    TomlConfig config2;
+    ASSERT_TRUE(config2.LoadString("key = \"value\"\n"));
+    ASSERT_EQ(config2.GetString("key"), "value");
+    ASSERT_TRUE(config2.GetFileDigest() != config.GetFileDigest());
+    ASSERT_FALSE(config2.LoadString("key = \n"));
+    ASSERT_EQ(config2.GetString("key"), "value");
+}
+
+TEST(ConfigTestSuite, TestReloadableConfig) {
+    ReloadableTomlConfig config;
+    ASSERT_FALSE(config.GetSnapshot());
+    ASSERT_EQ(config.GetVersion(), 0);
+
+    const std::string data_dir(TEST_DATA_DIR);
+    const std::string file_name = data_dir + "/BasicTest/test.toml";
+    ASSERT_TRUE(config.LoadFile(file_name.c_str()));
+    ASSERT_EQ(config.GetVersion(), 1);
+
+    TomlSnapshot first = config.GetSnapshot();
+    ASSERT_TRUE(first);
+    ASSERT_EQ(first.GetVersion(), 1);
+    ASSERT_EQ(first.GetString("animal", "dog", "name"), "Tina");
+
+    // A snapshot stays the same while the configuration is reloaded
+    ASSERT_TRUE(config.LoadString("[animal]\ndog.name = \"Rex\"\n"));
+    ASSERT_EQ(config.GetVersion(), 2);
+    ASSERT_EQ(first.GetString("animal", "dog", "name"), "Tina");
+    ASSERT_EQ(config.GetSnapshot().GetString("animal", "dog", "name"), "Rex");
+
+    // A failed reload keeps the current version
+    ASSERT_FALSE(config.LoadString("[animal\n"));
+    ASSERT_TRUE(!config.GetLastErrorMsg().empty());
+    ASSERT_EQ(config.GetVersion(), 2);
+
+    // Released versions are reclaimed, so reloads do not run out of them
+    first = TomlSnapshot();
+    for (int i = 0; i < 2 * SSGX_CONFIG_SNAPSHOT_SLOTS; ++i) {
+        ASSERT_TRUE(config.Reload());
+    }
+    TomlSnapshot last = config.GetSnapshot();
+    ASSERT_EQ(last.GetVersion(), 2 + 2 * SSGX_CONFIG_SNAPSHOT_SLOTS);
+    ASSERT_EQ(last.GetInteger("hex1"), 0xDEADBEEF);
+    ASSERT_EQ(last.GetFileDigest().size(), 32);
+}
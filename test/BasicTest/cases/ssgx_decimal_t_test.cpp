@@ -532,3 +532,124 @@ TEST(DecimalTestSuite, TestOther) {
     result = a.Div(b, prec2);
     ASSERT_EQ(result.ToStr(), std::string("33333333.3333333333333333333"));
 }
+
+TEST(DecimalTestSuite, TestInlineBoundary) {
+    BigDecimal a;
+    BigDecimal b;
+
+    // 38 digits are held inline, results which do not fit are carried on by mpdecimal
+    a = BigDecimal("99999999999999999999999999999999999999");
+    ASSERT_EQ(a.Add(BigDecimal("1")).ToStr(), std::string("100000000000000000000000000000000000000"));
+    ASSERT_EQ(a.Add(BigDecimal("1")).Sub(BigDecimal("1")), a);
+    ASSERT_EQ(a.Multiply(a).ToStr(),
+              std::string("9999999999999999999999999999999999999800000000000000000000000000000000000001"));
+    ASSERT_EQ(a.Multiply(a).Div(a), a);
+    ASSERT_TRUE(a.Add(BigDecimal("1")) > a);
+    ASSERT_TRUE(a.Neg() < BigDecimal("-9.9E+37"));
+
+    // Exponents and signed zeros are kept as mpdecimal keeps them
+    ASSERT_EQ(BigDecimal("1.20").ToStr(), std::string("1.20"));
+    ASSERT_EQ(BigDecimal("1.20").Multiply(BigDecimal("1.5")).ToStr(), std::string("1.800"));
+    ASSERT_EQ(BigDecimal("1E+3").ToStr(), std::string("1E+3"));
+    ASSERT_EQ(BigDecimal("0.0000001").ToStr(), std::string("1E-7"));
+    ASSERT_EQ(BigDecimal("-0").ToStr(), std::string("-0"));
+    ASSERT_EQ(BigDecimal("-0"), BigDecimal("0"));
+    ASSERT_EQ(BigDecimal("0").Neg().ToStr(), std::string("0"));
+
+    // Inline operands of mpdecimal operations keep their exponent and sign
+    ASSERT_EQ(BigDecimal("-0.00").Multiply(a.Multiply(a)).ToStr(), std::string("-0.00"));
+    ASSERT_EQ(BigDecimal("-1.20").Multiply(a.Multiply(a)).Add(a.Multiply(a).Multiply(BigDecimal("1.2"))).ToStr(),
+              std::string("0.00"));
+
+    // Rounding on both sides of the boundary
+    ASSERT_EQ(BigDecimal("0.125").SetScale(2, RoundType::RoundHalfEven).ToStr(), std::string("0.12"));
+    ASSERT_EQ(BigDecimal("-0.125").SetScale(2, RoundType::RoundFloor).ToStr(), std::string("-0.13"));
+    ASSERT_EQ(BigDecimal("1234567890123456789012345678901234567890.5").SetScale(0, RoundType::RoundHalfUp).ToStr(),
+              std::string("1234567890123456789012345678901234567891"));
+    ASSERT_EQ(a.SetScale(2).ToStr(), std::string("99999999999999999999999999999999999999.00"));
+
+    // Copies and moves of both representations
+    b = a.Multiply(a);
+    BigDecimal c(b);
+    BigDecimal d(std::move(b));
+    ASSERT_EQ(c, d);
+    ASSERT_EQ(b, BigDecimal("0"));
+    b = a;
+    ASSERT_EQ(b, a);
+}
+
+TEST(DecimalTestSuite, TestBatch) {
+    std::vector<BigDecimal> amounts = {BigDecimal("1200.50"), BigDecimal("-0.75"), BigDecimal("99.999"),
+                                       BigDecimal("1E+40")};
+    std::vector<BigDecimal> rates = {BigDecimal("0.001"), BigDecimal("0.002"), BigDecimal("0.0015"), BigDecimal("0")};
+    Precision prec(RoundType::RoundHalfEven, 2);
+
+    // The sum is exact before its single rounding, even across the inline and mpdecimal representations
+    ASSERT_EQ(Sum(amounts), BigDecimal("10000000000000000000000000000000000001299.749"));
+    ASSERT_EQ(Sum(amounts).Sub(BigDecimal("1E+40")), BigDecimal("1299.749"));
+    ASSERT_EQ(Sum(amounts, prec).ToStr(), std::string("10000000000000000000000000000000000001299.75"));
+    ASSERT_EQ(Sum(std::vector<BigDecimal>()), BigDecimal("0"));
+
+    ASSERT_EQ(DotProduct(amounts, rates), BigDecimal("1.3489985"));
+    ASSERT_EQ(DotProduct(amounts, rates, prec).ToStr(), std::string("1.35"));
+    ASSERT_THROW(DotProduct(amounts, std::vector<BigDecimal>(2)), ssgx::exception_t::LocatedException);
+
+    std::vector<BigDecimal> prices = {BigDecimal("10"), BigDecimal("20")};
+    std::vector<BigDecimal> weights = {BigDecimal("1"), BigDecimal("2")};
+    ASSERT_EQ(WeightedAverage(prices, weights, prec).ToStr(), std::string("16.67"));
+    ASSERT_THROW(WeightedAverage(prices, weights), ssgx::exception_t::LocatedException);
+    ASSERT_THROW(WeightedAverage(prices, std::vector<BigDecimal>(2), prec), ssgx::exception_t::LocatedException);
+
+    std::vector<BigDecimal> scaled = ScaleAll(amounts, prec);
+    ASSERT_EQ(scaled.size(), amounts.size());
+    for (size_t i = 0; i < amounts.size(); ++i) {
+        ASSERT_EQ(scaled[i].ToStr(), amounts[i].SetScale(2, RoundType::RoundHalfEven).ToStr());
+    }
+
+    // Partial sums of slices, as filled by several threads, merge into the same sum
+    DecimalAccumulator part1;
+    DecimalAccumulator part2;
+    part1.Add(amounts[0]);
+    part1.Add(amounts[1]);
+    part2.Add(amounts[2]);
+    part2.AddProduct(amounts[3], BigDecimal("1"));
+    part1.Merge(part2);
+    ASSERT_EQ(part1.Result(), Sum(amounts));
+}
+
+TEST(DecimalTestSuite, TestBytes) {
+    const char* values[] = {"0", "-0", "1234.56", "-0.000001", "1E+100", "-99999999999999999999999999999999999999",
+                            "123456789012345678901234567890123456789012345678901234567890.123456789"};
+    std::vector<uint8_t> snapshot;
+
+    ASSERT_EQ(BigDecimal("1234.56").ToBytes(), std::vector<uint8_t>({0x03, 0x03, 0x01, 0xE2, 0x40}));
+    for (const char* value : values) {
+        BigDecimal a(value);
+        std::vector<uint8_t> bytes = a.ToBytes();
+        ASSERT_EQ(BigDecimal::FromBytes(bytes.data(), bytes.size()).ToStr(), a.ToStr());
+        a.AppendBytes(snapshot);
+    }
+
+    // Values appended one after another are read back in order
+    size_t pos = 0;
+    for (const char* value : values) {
+        size_t consumed = 0;
+        BigDecimal a = BigDecimal::FromBytes(snapshot.data() + pos, snapshot.size() - pos, &consumed);
+        ASSERT_EQ(a.ToStr(), BigDecimal(value).ToStr());
+        pos += consumed;
+    }
+    ASSERT_EQ(pos, snapshot.size());
+
+    const uint8_t truncated[] = {0x03, 0x03, 0x01, 0xE2};
+    const uint8_t too_long[] = {0x7F, 0x00};
+    ASSERT_THROW((void)BigDecimal::FromBytes(truncated, sizeof(truncated)), ssgx::exception_t::LocatedException);
+    ASSERT_THROW((void)BigDecimal::FromBytes(too_long, sizeof(too_long)), ssgx::exception_t::LocatedException);
+    ASSERT_THROW((void)BigDecimal::FromBytes(snapshot.data(), snapshot.size()), ssgx::exception_t::LocatedException);
+
+    ASSERT_EQ(BigDecimal::FromInt64(INT64_MIN).ToStr(), std::string("-9223372036854775808"));
+    ASSERT_EQ(BigDecimal::FromInt64(INT64_MAX).ToInt64(), INT64_MAX);
+    ASSERT_EQ(BigDecimal("-12.00").ToInt64(), -12);
+    ASSERT_EQ(BigDecimal("1E+18").ToInt64(), 1000000000000000000);
+    ASSERT_THROW((void)BigDecimal("12.5").ToInt64(), ssgx::exception_t::LocatedException);
+    ASSERT_THROW((void)BigDecimal("9223372036854775808").ToInt64(), ssgx::exception_t::LocatedException);
+}
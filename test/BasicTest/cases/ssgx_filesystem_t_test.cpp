@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <string.h>
 
 #include "ssgx_exception_t.h"
 #include "ssgx_filesystem_t.h"
 #include "ssgx_filesystem_t_enum.h"
+#include "ssgx_filesystem_t_kv_store.h"
 #include "ssgx_testframework_t.h"
 #include "ssgx_utils_t.h"
 
@@ -253,6 +255,122 @@ TEST(FilesystemTestSuite, PlainFileExceedLimited) {
     ASSERT_THROW(writer.WriteAllBytes(file_content), FileSystemException);
 }
 
+TEST(FilesystemTestSuite, PlainFileStream) {
+    Path plain_file(test_dir.c_str());
+    plain_file /= Path(test_sub_dir.c_str());
+    plain_file /= Path(plain_file_name.c_str());
+
+    // Far beyond the 100 KB limit of ReadAllBytes()/WriteAllBytes(), and not a multiple of the chunk size
+    std::vector<uint8_t> file_content(3 * 1024 * 1024 + 100);
+    for (size_t i = 0; i < file_content.size(); i++) {
+        file_content[i] = static_cast<uint8_t>(i * 31 + (i >> 12));
+    }
+
+    {
+        PlainFileWriter writer(plain_file.String());
+        ASSERT_NO_THROW(writer.Open(FileMode::OpenOrCreate));
+        for (size_t offset = 0; offset < file_content.size(); offset += 1000) {
+            const size_t size = std::min<size_t>(1000, file_content.size() - offset);
+            ASSERT_NO_THROW(writer.Write(file_content.data() + offset, size));
+        }
+        ASSERT_NO_THROW(writer.Close());
+    }
+
+    // CreateNew refuses an existing file
+    {
+        PlainFileWriter writer(plain_file.String());
+        ASSERT_THROW(writer.Open(FileMode::CreateNew), FileSystemException);
+    }
+
+    {
+        PlainFileReader reader(plain_file.String());
+        ASSERT_THROW(reader.Tell(), FileSystemException);
+        ASSERT_NO_THROW(reader.Open());
+        ASSERT_EQ(reader.Size(), file_content.size());
+
+        std::vector<uint8_t> content;
+        uint8_t buffer[4096] = {0};
+        size_t read_size = 0;
+        while ((read_size = reader.Read(buffer, sizeof(buffer))) > 0) {
+            content.insert(content.end(), buffer, buffer + read_size);
+        }
+        ASSERT_EQ(content, file_content);
+        ASSERT_EQ(reader.Tell(), file_content.size());
+
+        // ReadAt spans several chunks and stops at the end of file
+        std::vector<uint8_t> range(2 * 1024 * 1024 + 7);
+        ASSERT_EQ(reader.ReadAt(12345, range.data(), range.size()), range.size());
+        ASSERT_TRUE(std::equal(range.begin(), range.end(), file_content.begin() + 12345));
+        ASSERT_EQ(reader.ReadAt(file_content.size() - 10, range.data(), 100), 10);
+        ASSERT_TRUE(std::equal(range.begin(), range.begin() + 10, file_content.end() - 10));
+        ASSERT_EQ(reader.ReadAt(file_content.size(), range.data(), 100), 0);
+        ASSERT_NO_THROW(reader.Close());
+    }
+
+    {
+        PlainFileWriter writer(plain_file.String());
+        ASSERT_NO_THROW(writer.Open(FileMode::Append));
+        ASSERT_NO_THROW(writer.Write("tail", 4));
+        ASSERT_NO_THROW(writer.Flush());
+        ASSERT_NO_THROW(writer.Close());
+    }
+    {
+        PlainFileReader reader(plain_file.String());
+        ASSERT_NO_THROW(reader.Open());
+        ASSERT_EQ(reader.Size(), file_content.size() + 4);
+        char tail[4] = {0};
+        ASSERT_EQ(reader.ReadAt(file_content.size(), tail, sizeof(tail)), 4);
+        ASSERT_EQ(std::string(tail, 4), "tail");
+    }
+
+    ASSERT_TRUE(Remove(plain_file));
+}
+
+TEST(FilesystemTestSuite, MappedPlainFile) {
+    Path plain_file(test_dir.c_str());
+    plain_file /= Path(test_sub_dir.c_str());
+    plain_file /= Path(plain_file_name.c_str());
+
+    std::vector<uint8_t> file_content(2 * 1024 * 1024 + 5);
+    for (size_t i = 0; i < file_content.size(); i++) {
+        file_content[i] = static_cast<uint8_t>(i * 7 + (i >> 9));
+    }
+    memcpy(file_content.data() + 1000000, "abc", 3);
+    {
+        PlainFileWriter writer(plain_file.String());
+        ASSERT_NO_THROW(writer.Open(FileMode::OpenOrCreate));
+        ASSERT_NO_THROW(writer.Write(file_content.data(), file_content.size()));
+        ASSERT_NO_THROW(writer.Close());
+    }
+
+    MappedPlainFile mapped(plain_file.String());
+    ASSERT_EQ(mapped.Size(), file_content.size());
+
+    uint8_t buffer[64] = {0};
+    ASSERT_NO_THROW(mapped.Read(123456, buffer, sizeof(buffer)));
+    ASSERT_TRUE(std::equal(buffer, buffer + sizeof(buffer), file_content.begin() + 123456));
+    ASSERT_EQ(mapped.Read(file_content.size() - 5, 5), std::vector<uint8_t>(file_content.end() - 5, file_content.end()));
+    ASSERT_THROW(mapped.Read(file_content.size() - 4, buffer, 5), FileSystemException);
+    ASSERT_THROW(mapped.Read(UINT64_MAX, buffer, 2), FileSystemException);
+
+    // SHA256("abc")
+    const std::vector<uint8_t> digest = {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40,
+                                         0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17,
+                                         0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+    ASSERT_NO_THROW(mapped.ReadVerified(1000000, buffer, 3, digest));
+    ASSERT_THROW(mapped.ReadVerified(1000001, buffer, 3, digest), FileSystemException);
+
+    // The mapping holds a shared lock
+    {
+        PlainFileWriter writer(plain_file.String());
+        ASSERT_THROW(writer.Open(FileMode::OpenOrCreate), FileSystemException);
+    }
+
+    ASSERT_NO_THROW(mapped.Close());
+    ASSERT_THROW(mapped.Size(), FileSystemException);
+    ASSERT_TRUE(Remove(plain_file));
+}
+
 void write_protected_file(const Path& file_name, FileMode file_mode, uint16_t key_policy, const std::string& content) {
     // The size of data to read/write each time.
     // For small files, the recommended size is 4KB;
@@ -505,6 +623,263 @@ TEST(FilesystemTestSuite, ProtectedFile_BigFile) {
     ASSERT_EQ(content, input_content);
 }
 
+TEST(FilesystemTestSuite, ProtectedFile_Options) {
+    Path working_dir(test_dir.c_str());
+    working_dir /= Path(test_sub_dir.c_str());
+    Path protected_file = working_dir / Path(protected_file_name.c_str());
+    Path protected_meta_file = working_dir / Path(protected_meta_file_name.c_str());
+
+    if (Exists(protected_file)) {
+        ASSERT_TRUE(Remove(protected_file));
+    }
+    if (Exists(protected_meta_file)) {
+        ASSERT_TRUE(Remove(protected_meta_file));
+    }
+
+    std::string input_content;
+    for (int i = 0; i < 20000; i++) {
+        input_content.append(protected_file_content);
+    }
+
+    ProtectedFileOptions options;
+    options.cache_size = 1024 * ProtectedFileOptions::NODE_SIZE;
+    options.read_ahead = 64 * 1024;
+    ASSERT_NO_THROW({
+        ProtectedFileWriter writer(protected_file.String().c_str(), FileMode::CreateNew, SGX_KEYPOLICY_MRENCLAVE,
+                                   options);
+        writer.Write(input_content.c_str(), input_content.size());
+        writer.Close();
+    });
+
+    // Small sequential reads are served by the read-ahead buffer
+    std::string content;
+    uint8_t buffer[100] = {0};
+    size_t read_size = 0;
+    ProtectedFileReader reader(protected_file.String().c_str(), options);
+    while ((read_size = reader.Read(buffer, sizeof(buffer))) > 0) {
+        content.append((char*)buffer, read_size);
+        ASSERT_EQ(reader.Tell(), static_cast<int64_t>(content.size()));
+    }
+    ASSERT_EQ(content, input_content);
+
+    const ProtectedFileStats stats = reader.Stats();
+    ASSERT_EQ(stats.reads, stats.hits + stats.misses);
+    ASSERT_EQ(stats.bytes_fetched, input_content.size());
+    ASSERT_TRUE(stats.hits > stats.misses);
+    ASSERT_TRUE(stats.fetches < stats.reads / 100);
+
+    // Seeking drops the read-ahead buffer, SEEK_CUR counts from what has been read
+    reader.Seek(10, SEEK_SET);
+    ASSERT_EQ(reader.Read(buffer, 5), 5);
+    reader.Seek(-3, SEEK_CUR);
+    ASSERT_EQ(reader.Tell(), 12);
+    ASSERT_EQ(reader.Read(buffer, 5), 5);
+    ASSERT_EQ(std::string((char*)buffer, 5), input_content.substr(12, 5));
+    reader.Close();
+}
+
+TEST(FilesystemTestSuite, ChunkedFile) {
+    Path working_dir(test_dir.c_str());
+    working_dir /= Path(test_sub_dir.c_str());
+    Path chunked_file = working_dir / Path(protected_file_name.c_str());
+    Path chunked_meta_file = working_dir / Path(protected_meta_file_name.c_str());
+
+    if (Exists(chunked_file)) {
+        ASSERT_TRUE(Remove(chunked_file));
+    }
+    if (Exists(chunked_meta_file)) {
+        ASSERT_TRUE(Remove(chunked_meta_file));
+    }
+
+    constexpr size_t CHUNK_SIZE = 64 * 1024;
+    std::vector<uint8_t> input_content(CHUNK_SIZE * 5 + 1234);
+    for (size_t i = 0; i < input_content.size(); i++) {
+        input_content[i] = static_cast<uint8_t>(i * 131 + (i >> 10));
+    }
+    const uint64_t chunk_count = (input_content.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    ASSERT_THROW(ChunkedFileWriter(chunked_file.String().c_str(), FileMode::Append, SGX_KEYPOLICY_MRENCLAVE, CHUNK_SIZE),
+                 FileSystemException);
+    {
+        // Chunks may be written in any order
+        ChunkedFileWriter writer(chunked_file.String().c_str(), FileMode::CreateNew, SGX_KEYPOLICY_MRENCLAVE,
+                                 CHUNK_SIZE);
+        ASSERT_EQ(writer.ChunkSize(), CHUNK_SIZE);
+        for (uint64_t i = chunk_count; i-- > 0;) {
+            const size_t size = std::min(CHUNK_SIZE, input_content.size() - i * CHUNK_SIZE);
+            ASSERT_NO_THROW(writer.WriteChunk(i, input_content.data() + i * CHUNK_SIZE, size));
+        }
+        ASSERT_THROW(writer.WriteChunk(1, input_content.data(), CHUNK_SIZE), FileSystemException);
+        ASSERT_NO_THROW(writer.Close());
+    }
+
+    {
+        ChunkedFileReader reader(chunked_file.String().c_str());
+        ASSERT_EQ(reader.Size(), input_content.size());
+        ASSERT_EQ(reader.ChunkSize(), CHUNK_SIZE);
+        ASSERT_EQ(reader.ChunkCount(), chunk_count);
+
+        std::vector<uint8_t> buffer(CHUNK_SIZE * 2);
+        ASSERT_EQ(reader.ReadChunk(chunk_count - 1, buffer.data(), CHUNK_SIZE), 1234);
+        ASSERT_TRUE(std::equal(buffer.begin(), buffer.begin() + 1234, input_content.end() - 1234));
+        ASSERT_THROW(reader.ReadChunk(chunk_count, buffer.data(), CHUNK_SIZE), FileSystemException);
+
+        // Random access across chunk boundaries
+        const uint64_t offset = CHUNK_SIZE - 100;
+        ASSERT_EQ(reader.Read(offset, buffer.data(), buffer.size()), buffer.size());
+        ASSERT_TRUE(std::equal(buffer.begin(), buffer.end(), input_content.begin() + offset));
+        ASSERT_EQ(reader.Read(input_content.size() - 10, buffer.data(), buffer.size()), 10);
+        ASSERT_EQ(reader.Read(input_content.size(), buffer.data(), buffer.size()), 0);
+        ASSERT_NO_THROW(reader.Close());
+    }
+
+    // A missing chunk is reported on Close()
+    {
+        ChunkedFileWriter writer(chunked_file.String().c_str(), FileMode::OpenOrCreate, SGX_KEYPOLICY_MRENCLAVE,
+                                 CHUNK_SIZE);
+        ASSERT_NO_THROW(writer.WriteChunk(1, input_content.data(), CHUNK_SIZE));
+        ASSERT_THROW(writer.Close(), FileSystemException);
+    }
+
+    ASSERT_TRUE(Remove(chunked_file));
+    ASSERT_TRUE(Remove(chunked_meta_file));
+}
+
+// Shared with ecall_write_chunked_file(), which the host calls from several threads at once
+static ChunkedFileWriter* chunked_writer = nullptr;
+static const std::vector<uint8_t>* chunked_content = nullptr;
+
+int ecall_write_chunked_file(int worker, int workers) {
+    if (chunked_writer == nullptr || chunked_content == nullptr || worker < 0 || workers <= 0) {
+        return -1;
+    }
+    const size_t chunk_size = chunked_writer->ChunkSize();
+    const uint64_t chunk_count = (chunked_content->size() + chunk_size - 1) / chunk_size;
+    try {
+        for (uint64_t i = worker; i < chunk_count; i += workers) {
+            const size_t size = std::min(chunk_size, chunked_content->size() - i * chunk_size);
+            chunked_writer->WriteChunk(i, chunked_content->data() + i * chunk_size, size);
+        }
+    } catch (const std::exception&) {
+        return -1;
+    }
+    return 0;
+}
+
+TEST(FilesystemTestSuite, ChunkedFile_Threads) {
+    Path working_dir(test_dir.c_str());
+    working_dir /= Path(test_sub_dir.c_str());
+    Path chunked_file = working_dir / Path(protected_file_name.c_str());
+    Path chunked_meta_file = working_dir / Path(protected_meta_file_name.c_str());
+
+    constexpr size_t CHUNK_SIZE = 4 * 1024;
+    std::vector<uint8_t> input_content(CHUNK_SIZE * 64 + 100);
+    for (size_t i = 0; i < input_content.size(); i++) {
+        input_content[i] = static_cast<uint8_t>(i * 7 + (i >> 12));
+    }
+
+    {
+        ChunkedFileWriter writer(chunked_file.String().c_str(), FileMode::OpenOrCreate, SGX_KEYPOLICY_MRENCLAVE,
+                                 CHUNK_SIZE);
+        chunked_writer = &writer;
+        chunked_content = &input_content;
+        int ret = -1;
+        sgx_status_t status = ocall_write_chunked_file_in_threads(&ret, 8);
+        chunked_writer = nullptr;
+        chunked_content = nullptr;
+        ASSERT_EQ(status, SGX_SUCCESS);
+        ASSERT_EQ(ret, 0);
+        ASSERT_NO_THROW(writer.Close());
+    }
+
+    {
+        ChunkedFileReader reader(chunked_file.String().c_str());
+        ASSERT_EQ(reader.Size(), input_content.size());
+        std::vector<uint8_t> buffer(input_content.size());
+        ASSERT_EQ(reader.Read(0, buffer.data(), buffer.size()), buffer.size());
+        ASSERT_TRUE(buffer == input_content);
+    }
+
+    ASSERT_TRUE(Remove(chunked_file));
+    ASSERT_TRUE(Remove(chunked_meta_file));
+}
+
+TEST(FilesystemTestSuite, ChunkedFile_Tamper) {
+    Path working_dir(test_dir.c_str());
+    working_dir /= Path(test_sub_dir.c_str());
+    Path chunked_file = working_dir / Path(protected_file_name.c_str());
+    Path chunked_meta_file = working_dir / Path(protected_meta_file_name.c_str());
+
+    constexpr size_t CHUNK_SIZE = 4 * 1024;
+    constexpr size_t TAG_SIZE = 16;
+    std::vector<uint8_t> input_content(CHUNK_SIZE * 3 + 100, 0x5a);
+    const uint64_t chunk_count = 4;
+    {
+        ChunkedFileWriter writer(chunked_file.String().c_str(), FileMode::OpenOrCreate, SGX_KEYPOLICY_MRENCLAVE,
+                                 CHUNK_SIZE);
+        for (uint64_t i = 0; i < chunk_count; i++) {
+            const size_t size = std::min(CHUNK_SIZE, input_content.size() - i * CHUNK_SIZE);
+            writer.WriteChunk(i, input_content.data() + i * CHUNK_SIZE, size);
+        }
+        ASSERT_NO_THROW(writer.Close());
+    }
+    const std::vector<uint8_t> original = PlainFileReader(chunked_file.String()).ReadAllBytes();
+    ASSERT_EQ(original.size(), input_content.size() + chunk_count * TAG_SIZE + 64);
+
+    std::vector<uint8_t> buffer(CHUNK_SIZE);
+
+    // A flipped ciphertext byte fails that chunk only
+    std::vector<uint8_t> tampered = original;
+    tampered[CHUNK_SIZE + 10] ^= 0x01;
+    PlainFileWriter(chunked_file.String()).WriteAllBytes(tampered);
+    {
+        ChunkedFileReader reader(chunked_file.String().c_str());
+        ASSERT_EQ(reader.ReadChunk(0, buffer.data(), buffer.size()), CHUNK_SIZE);
+        ASSERT_THROW(reader.ReadChunk(1, buffer.data(), buffer.size()), FileSystemException);
+    }
+
+    // Swapped chunks, with their tags swapped too, fail as their position is authenticated
+    tampered = original;
+    std::swap_ranges(tampered.begin(), tampered.begin() + CHUNK_SIZE, tampered.begin() + CHUNK_SIZE);
+    const size_t index_offset = input_content.size();
+    std::swap_ranges(tampered.begin() + index_offset, tampered.begin() + index_offset + TAG_SIZE,
+                     tampered.begin() + index_offset + TAG_SIZE);
+    PlainFileWriter(chunked_file.String()).WriteAllBytes(tampered);
+    ASSERT_THROW(ChunkedFileReader(chunked_file.String().c_str()), FileSystemException);
+
+    // Swapped chunks alone fail on read
+    tampered = original;
+    std::swap_ranges(tampered.begin(), tampered.begin() + CHUNK_SIZE, tampered.begin() + CHUNK_SIZE);
+    PlainFileWriter(chunked_file.String()).WriteAllBytes(tampered);
+    {
+        ChunkedFileReader reader(chunked_file.String().c_str());
+        ASSERT_THROW(reader.ReadChunk(0, buffer.data(), buffer.size()), FileSystemException);
+        ASSERT_THROW(reader.ReadChunk(1, buffer.data(), buffer.size()), FileSystemException);
+        ASSERT_EQ(reader.ReadChunk(2, buffer.data(), buffer.size()), CHUNK_SIZE);
+    }
+
+    // A truncated index fails to open
+    tampered = original;
+    tampered.erase(tampered.begin() + index_offset, tampered.begin() + index_offset + TAG_SIZE);
+    PlainFileWriter(chunked_file.String()).WriteAllBytes(tampered);
+    ASSERT_THROW(ChunkedFileReader(chunked_file.String().c_str()), FileSystemException);
+
+    // So does a forged chunk count in the trailer
+    tampered = original;
+    tampered[index_offset + chunk_count * TAG_SIZE + 24] = 0xff;
+    PlainFileWriter(chunked_file.String()).WriteAllBytes(tampered);
+    ASSERT_THROW(ChunkedFileReader(chunked_file.String().c_str()), FileSystemException);
+
+    // And a truncated file
+    tampered = original;
+    tampered.resize(tampered.size() - 1);
+    PlainFileWriter(chunked_file.String()).WriteAllBytes(tampered);
+    ASSERT_THROW(ChunkedFileReader(chunked_file.String().c_str()), FileSystemException);
+
+    ASSERT_TRUE(Remove(chunked_file));
+    ASSERT_TRUE(Remove(chunked_meta_file));
+}
+
 TEST(FilesystemTestSuite, ProtectedFile_MRSINGER_and_MRENCLAVE) {
     Path working_dir(test_dir.c_str());
     working_dir /= Path(test_sub_dir.c_str());
@@ -549,6 +924,102 @@ TEST(FilesystemTestSuite, ProtectedFile_ALL) {
     ASSERT_EQ(content, protected_file_content);
 }
 
+static std::string kv_key(int i) {
+    return ssgx::utils_t::FormatStr("key%06d", i);
+}
+
+static std::string kv_value(int i) {
+    return std::string(100, static_cast<char>('a' + i % 26)) + std::to_string(i);
+}
+
+static void verify_kv_store(const KvStore& store, int count) {
+    for (int i = 0; i < count; i++) {
+        std::optional<std::string> value = store.Get(kv_key(i));
+        if (i % 5 == 0) {
+            ASSERT_TRUE(value.has_value());
+            ASSERT_EQ(value.value(), "overwritten" + std::to_string(i));
+        } else if (i % 3 == 0) {
+            ASSERT_FALSE(value.has_value());
+        } else {
+            ASSERT_TRUE(value.has_value());
+            ASSERT_EQ(value.value(), kv_value(i));
+        }
+    }
+    ASSERT_FALSE(store.Get("missing").has_value());
+
+    // [key000100, key000120) without the deleted keys
+    std::vector<std::pair<std::string, std::string>> range = store.Scan(kv_key(100), kv_key(120));
+    ASSERT_EQ(range.size(), 15);
+    ASSERT_EQ(range[0].first, kv_key(100));
+    ASSERT_EQ(range[1].first, kv_key(101));
+    ASSERT_EQ(range[2].first, kv_key(103));
+    ASSERT_EQ(range[2].second, kv_value(103));
+    ASSERT_EQ(store.Scan(kv_key(100), kv_key(120), 3).size(), 3);
+    ASSERT_EQ(store.Scan(kv_key(120), kv_key(100)).size(), 0);
+}
+
+TEST(FilesystemTestSuite, KvStore) {
+    constexpr int KEY_COUNT = 1000;
+    Path store_dir(test_dir.c_str());
+    store_dir /= Path(test_sub_dir.c_str());
+    store_dir /= Path("kv_store");
+
+    KvStoreOptions options;
+    options.memtable_size = 16 * 1024;
+    {
+        KvStore store(store_dir.String(), options);
+        // The directory is locked
+        ASSERT_THROW(KvStore(store_dir.String(), options), FileSystemException);
+
+        for (int i = 0; i < KEY_COUNT; i++) {
+            ASSERT_NO_THROW(store.Put(kv_key(i), kv_value(i)));
+        }
+        ASSERT_TRUE(store.SegmentCount() > 1);
+        for (int i = 0; i < KEY_COUNT; i += 3) {
+            ASSERT_NO_THROW(store.Delete(kv_key(i)));
+        }
+        for (int i = 0; i < KEY_COUNT; i += 5) {
+            ASSERT_NO_THROW(store.Put(kv_key(i), "overwritten" + std::to_string(i)));
+        }
+        verify_kv_store(store, KEY_COUNT);
+
+        ASSERT_NO_THROW(store.Compact());
+        ASSERT_EQ(store.SegmentCount(), 1);
+        verify_kv_store(store, KEY_COUNT);
+
+        // Left in the WAL, replayed by the next open
+        ASSERT_NO_THROW(store.Put("last", "value"));
+        ASSERT_NO_THROW(store.Close());
+        ASSERT_THROW(store.Get("last"), FileSystemException);
+    }
+    {
+        KvStore store(store_dir.String(), options);
+        verify_kv_store(store, KEY_COUNT);
+        ASSERT_EQ(store.Get("last").value(), "value");
+        ASSERT_NO_THROW(store.Close());
+    }
+
+    // Without its manifests, the store refuses to open rather than start afresh over its segments
+    for (int i = 0; i < 2; i++) {
+        ASSERT_TRUE(RemoveProtectedFile(store_dir / Path(ssgx::utils_t::FormatStr("%06d.manifest", i).c_str())));
+    }
+    ASSERT_THROW(KvStore(store_dir.String(), options), FileSystemException);
+
+    // Remove the store, its file ids are below 256 in this test
+    for (int i = 0; i < 2; i++) {
+        RemoveProtectedFile(store_dir / Path(ssgx::utils_t::FormatStr("%06d.manifest", i).c_str()));
+    }
+    for (int i = 1; i < 256; i++) {
+        Path segment_file = store_dir / Path(ssgx::utils_t::FormatStr("%06d.seg", i).c_str());
+        Remove(segment_file);
+        segment_file += std::string(".pfsmeta");
+        Remove(segment_file);
+        Remove(store_dir / Path(ssgx::utils_t::FormatStr("%06d.wal", i).c_str()));
+    }
+    ASSERT_TRUE(Remove(store_dir / Path("LOCK")));
+    ASSERT_TRUE(Remove(store_dir));
+}
+
 TEST(FilesystemTestSuite, RemoveDirectory) {
     Path working_dir(test_dir.c_str());
     working_dir /= Path(test_sub_dir.c_str());
@@ -523,6 +523,104 @@ TEST(HttpClientTestSuite, Parse_PostResponseBody) {
     ASSERT_TRUE(json_json["fiedl2"] == 1000);
 }
 
+TEST(HttpClientTestSuite, ConnectionPool_SequentialRequests) {
+    // The second and third requests go over the connection kept alive by the first one
+    ssgx::http_t::Client client(postman_host, postman_port, postman_ca);
+    for (int i = 0; i < 3; ++i) {
+        ssgx::http_t::Result result = client.Get(postman_path_get);
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result->StatusCode() == ssgx::http_t::HttpStatusCode::OK200);
+    }
+
+    // A client trusting other certificates must not pick up the pooled connection
+    ssgx::http_t::Client other_ca_client(postman_host, postman_port, binance_ca);
+    ssgx::http_t::Result result = other_ca_client.Get(postman_path_get);
+    ASSERT_TRUE(!result);
+    ASSERT_EQ(result.error().code(), ssgx::http_t::ErrorCode::VerifyCertFailed);
+
+    // Same requests with the pool turned off
+    ssgx::http_t::ConnectionPoolOptions options;
+    options.enabled = false;
+    ssgx::http_t::Client::SetConnectionPoolOptions(options);
+    for (int i = 0; i < 2; ++i) {
+        ssgx::http_t::Result res = client.Post(postman_path_post);
+        ASSERT_TRUE(res);
+        ASSERT_TRUE(res->StatusCode() == ssgx::http_t::HttpStatusCode::OK200);
+    }
+    ssgx::http_t::Client::SetConnectionPoolOptions(ssgx::http_t::ConnectionPoolOptions());
+}
+
+TEST(HttpClientTestSuite, TlsSessionCache_ResumeOnNewConnection) {
+    // Without the connection pool every request needs a new handshake, which can resume the cached session
+    ssgx::http_t::ConnectionPoolOptions pool_options;
+    pool_options.enabled = false;
+    ssgx::http_t::Client::SetConnectionPoolOptions(pool_options);
+
+    ssgx::http_t::Client client(postman_host, postman_port, postman_ca);
+    ssgx::http_t::Result result = client.Get(postman_path_get);
+    ASSERT_TRUE(result);
+    ssgx::http_t::TlsSessionCacheStats before = ssgx::http_t::Client::GetTlsSessionCacheStats();
+    ASSERT_TRUE(before.entries > 0);
+
+    // The second connection must have resumed the session, not merely offered it
+    result = client.Get(postman_path_get);
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result->StatusCode() == ssgx::http_t::HttpStatusCode::OK200);
+    ASSERT_TRUE(result.tls_session_resumed());
+    ssgx::http_t::TlsSessionCacheStats after = ssgx::http_t::Client::GetTlsSessionCacheStats();
+    ASSERT_EQ(after.hits, before.hits + 1);
+
+    // Opt out: no session is offered any more
+    ssgx::http_t::TlsSessionCacheOptions cache_options;
+    cache_options.enabled = false;
+    ssgx::http_t::Client::SetTlsSessionCacheOptions(cache_options);
+    result = client.Get(postman_path_get);
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(!result.tls_session_resumed());
+    ASSERT_EQ(ssgx::http_t::Client::GetTlsSessionCacheStats().hits, after.hits);
+    ASSERT_EQ(ssgx::http_t::Client::GetTlsSessionCacheStats().entries, 0);
+
+    ssgx::http_t::Client::SetTlsSessionCacheOptions(ssgx::http_t::TlsSessionCacheOptions());
+    ssgx::http_t::Client::SetConnectionPoolOptions(ssgx::http_t::ConnectionPoolOptions());
+}
+
+TEST(HttpClientTestSuite, SendAll_ParallelRequests) {
+    ssgx::http_t::Client postman(postman_host, postman_port, postman_ca);
+    ssgx::http_t::Client httpbin(httpbin_host, httpbin_port, httpbin_ca);
+
+    std::vector<ssgx::http_t::RequestSpec> specs(3);
+    specs[0].path = postman_path_get;
+    specs[0].params = {{"index", "0"}};
+    specs[1].path = postman_path_get;
+    specs[1].params = {{"index", "1"}};
+    specs[2].method = "POST";
+    specs[2].path = postman_path_post;
+    specs[2].body = R"({"index":2})";
+    specs[2].content_type = "application/json";
+
+    std::vector<ssgx::http_t::Result> results = postman.SendAll(specs);
+    ASSERT_EQ(results.size(), 3);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(results[i]);
+        ASSERT_TRUE(results[i]->StatusCode() == ssgx::http_t::HttpStatusCode::OK200);
+        ASSERT_TRUE(results[i]->Body().find("\"index\"") != std::string::npos);
+    }
+
+    // Different servers in one batch; a failing request does not affect the others
+    std::vector<std::pair<const ssgx::http_t::Client*, ssgx::http_t::RequestSpec>> targeted;
+    targeted.emplace_back(&postman, specs[0]);
+    targeted.emplace_back(&httpbin, ssgx::http_t::RequestSpec());
+    targeted.back().second.path = httpbin_path_get;
+    targeted.emplace_back(&httpbin, ssgx::http_t::RequestSpec());
+    results = ssgx::http_t::Client::SendAll(targeted);
+    ASSERT_EQ(results.size(), 3);
+    ASSERT_TRUE(results[0]);
+    ASSERT_TRUE(results[1]);
+    ASSERT_TRUE(results[1]->StatusCode() == ssgx::http_t::HttpStatusCode::OK200);
+    ASSERT_TRUE(!results[2]);
+    ASSERT_EQ(results[2].error().code(), ssgx::http_t::ErrorCode::InvalidParam);
+}
+
 TEST(HttpClientTestSuite, ErrorHandling_InvalidUrl) {
     const std::string no_scheme_host = "127.0.0.1"; // No scheme
     ssgx::http_t::Client client(no_scheme_host);
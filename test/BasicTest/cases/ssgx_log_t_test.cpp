@@ -3,6 +3,9 @@
 
 #include "ssgx_log_t.h"
 #include "ssgx_testframework_t.h"
+#include "ssgx_utils_t.h"
+
+#include "Enclave_t.h"
 
 TEST(LogTestSuite, TestLog) {
     // INFO log with a string
@@ -122,3 +125,50 @@ TEST(LogTestSuite, TestLog_LongMessage) {
     SSGX_LOG(WARN) << longText.c_str();
     SSGX_LOG(FATAL) << longText.c_str();
 }
+
+TEST(LogTestSuite, TestLogBurst) {
+    // More messages than slots in the log ring, and one too long for a slot: all of them must reach the host
+    ssgx::log_t::SSGXLogger::GetInstance().SetTraceId("burst");
+    for (int i = 0; i < 4096; ++i) {
+        SSGX_LOG(INFO) << "Burst message " << i;
+    }
+    SSGX_LOG(INFO) << "Long message: " << std::string(4096, 'x');
+    ssgx::log_t::SSGXLogger::GetInstance().Flush();
+    ssgx::log_t::SSGXLogger::GetInstance().SetTraceId("main");
+}
+
+TEST(LogTestSuite, TestLogLevelFilter) {
+    // The host logger is initialized at INFO: a DEBUG message is dropped before anything streamed into it is evaluated
+    if (!ssgx::utils_t::ControlPage::IsAvailable()) {
+        return;
+    }
+    int evaluated = 0;
+    auto count = [&evaluated]() { return ++evaluated; };
+    SSGX_LOG(DEBUG) << "Not evaluated " << count();
+    SSGX_LOG_IF(DEBUG, true) << "Not evaluated " << count();
+    SSGX_LOG_IF(INFO, false) << "Not evaluated " << count();
+    ASSERT_EQ(evaluated, 0);
+    SSGX_LOG(INFO) << "Evaluated " << count();
+    ASSERT_EQ(evaluated, 1);
+}
+
+TEST(LogTestSuite, TestLogRecord) {
+    std::string symbol = "BTC";
+    for (int i = 0; i < 16; ++i) {
+        SSGX_LOGF(INFO, "Order {} of {} filled at {}, side {}", i, symbol, 61234.5 + i, 'B');
+    }
+    SSGX_LOGF(WARN, "No argument");
+    SSGX_LOGF(ERROR, "Missing argument {} {}", 42u);
+    SSGX_LOGF(INFO, "Long argument {}", std::string(4096, 'x'));
+    SSGX_LOGF(DEBUG, "Dropped at INFO {}", symbol);
+    ssgx::log_t::SSGXLogger::GetInstance().Flush();
+}
+
+TEST(LogTestSuite, TestAsyncLogger) {
+    // The host logs from several threads through an asynchronous logger, and checks that every message is in its file
+    int ret = -1;
+    ASSERT_TRUE(ocall_write_async_log(&ret, 4, 1000) == SGX_SUCCESS);
+    ASSERT_EQ(ret, 0);
+    SSGX_LOG(INFO) << "Logged after the asynchronous logger is replaced";
+    ssgx::log_t::SSGXLogger::GetInstance().Flush();
+}
@@ -214,4 +214,55 @@ TEST(MemdupOutsideTest, NullSourceReturnsNull) {
 TEST(MemdupOutsideTest, ZeroSizeReturnsNull) {
     uint8_t dummy[1] = {0};
     ASSERT_EQ(MemdupOutside(dummy, 0), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(OutsidePoolTest, SmallBlocksAreRecycled) {
+    OutsidePoolStats before = GetOutsidePoolStats();
+
+    void* first = MallocOutsidePooled(100);
+    ASSERT_NE(first, nullptr);
+    memset(first, 0xAB, 100);
+    FreeOutside(first, 100);
+
+    // The same class hands the freed block back, cleared again
+    auto* second = static_cast<uint8_t*>(MallocOutsidePooled(120));
+    ASSERT_NE(second, nullptr);
+    for (size_t i = 0; i < 120; ++i) {
+        ASSERT_EQ(second[i], 0);
+    }
+    FreeOutside(second, 120);
+
+    OutsidePoolStats after = GetOutsidePoolStats();
+    if (after.arena_size > 0) {
+        ASSERT_EQ(first, static_cast<void*>(second));
+        ASSERT_EQ(after.pooled_allocs - before.pooled_allocs, 2);
+        ASSERT_EQ(after.pooled_frees - before.pooled_frees, 2);
+        ASSERT_EQ(after.bytes_in_use, before.bytes_in_use);
+    }
+}
+
+TEST(OutsidePoolTest, LargeBlocksFallBackToOcall) {
+    OutsidePoolStats before = GetOutsidePoolStats();
+
+    constexpr size_t alloc_size = 256 * 1024;
+    void* p = MallocOutsidePooled(alloc_size);
+    ASSERT_NE(p, nullptr);
+    FreeOutside(p, alloc_size);
+
+    OutsidePoolStats after = GetOutsidePoolStats();
+    ASSERT_EQ(after.fallback_allocs - before.fallback_allocs, 1);
+    ASSERT_EQ(after.pooled_allocs, before.pooled_allocs);
+}
+
+TEST(OutsidePoolTest, MallocOutsideIsNotPooled) {
+    OutsidePoolStats before = GetOutsidePoolStats();
+
+    // Buffers from MallocOutside() may be handed to the host and released with free(), so they never come from the pool
+    void* p = MallocOutside(100);
+    ASSERT_NE(p, nullptr);
+    FreeOutside(p, 100);
+
+    OutsidePoolStats after = GetOutsidePoolStats();
+    ASSERT_EQ(after.pooled_allocs, before.pooled_allocs);
+    ASSERT_EQ(after.fallback_allocs, before.fallback_allocs);
+}
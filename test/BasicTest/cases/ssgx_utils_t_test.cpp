@@ -48,6 +48,20 @@ TEST(UtilsTestSuite, TestMemcpyToOutside) {
     FreeOutside(dest, len);
 }
 
+TEST(UtilsTestSuite, TestControlPage) {
+    ASSERT_TRUE(ControlPage::IsAvailable());
+    ASSERT_FALSE(ControlPage::StopRequested());
+    // The host logger is initialized with LogLevel::INFO
+    ASSERT_EQ(ControlPage::LogLevel(), 2);
+
+    int64_t coarse = ControlPage::CoarseNowInMilliseconds();
+    int64_t precise = PreciseTime::NowInMilliseconds();
+    ASSERT_TRUE(coarse <= precise && precise - coarse < 1000);
+
+    ssgx::utils_t::Sleep(1);
+    ASSERT_GE(ControlPage::CoarseNowInMilliseconds() - coarse, 900);
+}
+
 TEST(UtilsTestSuite, TestSleep) {
     int64_t start = PreciseTime::NowInNanoseconds();
     ssgx::utils_t::Printf("Sleeping for 5s...\n");
@@ -9,6 +9,7 @@
 
 #include "ssgx_attestation_u.h"
 #include "ssgx_log_u.h"
+#include "ssgx_utils_u.h"
 
 #include "Enclave_u.h"
 
@@ -47,6 +48,7 @@ int SGX_CDECL main(int argc, char* argv[]) {
 _exit:
     printf("Destroy enclave!\n\n");
     sgx_destroy_enclave(test_enclave_id);
+    ssgx::utils_u::ControlPage::Shutdown();
 
     return ret;
 }
\ No newline at end of file
@@ -1,16 +1,22 @@
+#include <fstream>
 #include <iomanip>
 #include <stdio.h>
 #include <string.h>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "sgx_urts.h"
 
 #include "ssgx_attestation_u.h"
+#include "ssgx_log_u.h"
 
 #include "Enclave_u.h"
 
 using namespace ssgx::attestation_u;
 
+extern sgx_enclave_id_t test_enclave_id;
+
 #define PRINT_REMOTE_ATTESTOR_STATUS(info, attestor)                                                                         \
     do {                                                                                                               \
         auto qv = (attestor).GetRawQvResult();                                                                         \
@@ -39,6 +45,68 @@ extern "C" int ocall_symlink_file(const char* path, const char* link_path) {
     return symlink(path, link_path) == 0 ? 0 : -1;
 }
 
+extern "C" int ocall_write_chunked_file_in_threads(int workers) {
+    std::vector<int> results(workers, -1);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; i++) {
+        threads.emplace_back([i, workers, &results]() {
+            if (ecall_write_chunked_file(test_enclave_id, &results[i], i, workers) != SGX_SUCCESS) {
+                results[i] = -1;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int result : results) {
+        if (result != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+extern "C" int ocall_write_async_log(int threads, int messages) {
+    const std::string log_file = "/tmp/ssgx-async-log-test.log";
+    auto& logger = ssgx::log_u::SSGXLogger::GetInstance();
+    std::remove(log_file.c_str());
+
+    // A small queue, so that the logging threads wait for the writer thread
+    ssgx::log_u::AsyncLogOptions options;
+    options.queue_size = 64;
+    options.overflow_policy = ssgx::log_u::LogOverflowPolicy::BLOCK;
+    options.fsync_interval_ms = 1;
+    logger.Init("AsyncLogTest", log_file, ssgx::log_u::LogLevel::INFO, false, options);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([&logger, i, messages]() {
+            for (int j = 0; j < messages; j++) {
+                std::string msg = "async message " + std::to_string(i) + "-" + std::to_string(j);
+                logger.WriteLog(ssgx::log_u::LogLevel::INFO, msg.c_str());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    logger.Flush();
+    uint64_t dropped = logger.GetDroppedCount();
+
+    int lines = 0;
+    std::ifstream in(log_file);
+    for (std::string line; std::getline(in, line);) {
+        if (line.find("async message ") != std::string::npos) {
+            lines++;
+        }
+    }
+
+    // Back to the logger of host.cpp
+    logger.Init("PROJECT_NAME", "/tmp/tee-log", ssgx::log_u::LogLevel::INFO, true);
+    std::remove(log_file.c_str());
+    return (dropped == 0 && lines == threads * messages) ? 0 : -1;
+}
+
 extern "C" int ocall_verify_quote_untrusted(const uint8_t* quote, int quote_size, uint64_t time_stamp, uint64_t validity_seconds,
                                  const char* user_info) {
     int ret;
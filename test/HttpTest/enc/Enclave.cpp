@@ -1,5 +1,6 @@
 #include <ctime>
 #include <pthread.h>
+#include <stdexcept>
 #include <vector>
 
 #include "nlohmann/json.hpp"
@@ -59,6 +60,102 @@ void PostHandler(Request& request, Response& response) {
     response.SetResp(reply, "application/json", ssgx::http_t::HttpStatusCode::OK200);
 }
 
+// Body size and a simple checksum, computed while the body is read piece by piece
+void StreamHandler(Request& request, ssgx::http_t::BodyReader& reader, Response& response) {
+    uint8_t buf[4096];
+    size_t total = 0;
+    uint64_t checksum = 0;
+    size_t n = 0;
+    while ((n = reader.Read(buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            checksum += buf[i];
+        }
+        total += n;
+    }
+    JSON json;
+    json["size"] = total;
+    json["checksum"] = checksum;
+    json["body_in_memory"] = !request.Body().empty();
+    response.SetResp(json.dump(), "application/json", ssgx::http_t::HttpStatusCode::OK200);
+}
+
+// A regular handler gets the whole body, even when the host streamed it
+void SizeHandler(Request& request, Response& response) {
+    JSON json;
+    json["size"] = request.Body().size();
+    response.SetResp(json.dump(), "application/json", ssgx::http_t::HttpStatusCode::OK200);
+}
+
+// Sends its body in several pieces
+void StreamingResponseHandler(Request& request, Response& response) {
+    response.SetStatusCode(ssgx::http_t::HttpStatusCode::OK200);
+    response.SetHeader("Content-Type", "text/plain");
+    response.BeginStream();
+    for (int i = 0; i < 3; ++i) {
+        response.Write("part" + std::to_string(i) + ";");
+    }
+    response.End();
+}
+
+// Fails after a part of the response is sent
+void StreamAbortedHandler(Request& request, Response& response) {
+    response.SetStatusCode(ssgx::http_t::HttpStatusCode::OK200);
+    response.SetHeader("Content-Type", "text/plain");
+    response.BeginStream();
+    response.Write("part0;");
+    throw std::runtime_error("failed in the middle of the stream");
+}
+
+// Reports, on the stream, whether the status code, the headers and the body can still be changed
+void StreamLockedHandler(Request& request, Response& response) {
+    response.SetStatusCode(ssgx::http_t::HttpStatusCode::OK200);
+    response.BeginStream();
+    int rejected = 0;
+    try {
+        response.SetHeader("X-Late", "1");
+    } catch (const std::runtime_error&) {
+        rejected++;
+    }
+    try {
+        response.SetStatusCode(ssgx::http_t::HttpStatusCode::NotFound404);
+    } catch (const std::runtime_error&) {
+        rejected++;
+    }
+    try {
+        response.SetBody("replaced");
+    } catch (const std::runtime_error&) {
+        rejected++;
+    }
+    response.Write("rejected:" + std::to_string(rejected));
+    response.End();
+}
+
+void EventsHandler(Request& request, Response& response) {
+    response.SetStatusCode(ssgx::http_t::HttpStatusCode::OK200);
+    response.SetHeader("Content-Type", "text/event-stream");
+    response.BeginStream();
+    response.WriteEvent("hello", "greeting");
+    response.WriteEvent("line1\nline2");
+    response.WriteEvent("line3\r\nline4\rline5");
+    try {
+        response.WriteEvent("forged", "greeting\ndata: forged");
+    } catch (const std::invalid_argument&) {
+        response.WriteEvent("rejected");
+    }
+    response.End();
+}
+
+// Echoes the parameters matched in the path, and which route matched
+void RouteHandler(const std::string& route, Request& request, Response& response) {
+    JSON json;
+    json["route"] = route;
+    json["path_params"] = JSON::object();
+    for (const auto& item : request.PathParams()) {
+        json["path_params"][item.first] = item.second;
+    }
+    response.SetResp(json.dump(), "application/json", ssgx::http_t::HttpStatusCode::OK200);
+}
+
 void HandlerThrowException(Request& request, Response& response) {
     throw std::runtime_error("Exception in HandlerThrowException");
 }
@@ -173,6 +270,184 @@ TEST(HttpServerTestSuite, Post_Request_Throw_Exception) {
     ASSERT_EQ(result->StatusCode(), ssgx::http_t::HttpStatusCode::InternalServerError500);
 }
 
+TEST(HttpServerTestSuite, PostStream_LargeBody) {
+    Client client = Client("http://0.0.0.0:83");
+    std::string body(300 * 1024, '\0');
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>(i % 251);
+        checksum += static_cast<uint8_t>(body[i]);
+    }
+
+    // Above the inline limit: the handler pulls the body from the host
+    ssgx::http_t::Result result = client.Post("/upload", body, "application/octet-stream", 5);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->StatusCode(), ssgx::http_t::HttpStatusCode::OK200);
+    JSON body_json = JSON::parse(result->Body());
+    ASSERT_EQ(body_json["size"].get<size_t>(), body.size());
+    ASSERT_EQ(body_json["checksum"].get<uint64_t>(), checksum);
+    ASSERT_TRUE(!body_json["body_in_memory"].get<bool>());
+
+    // Small bodies come with the request and are read through the same interface
+    result = client.Post("/upload", std::string("abc"), "application/octet-stream", 5);
+    ASSERT_TRUE(result);
+    body_json = JSON::parse(result->Body());
+    ASSERT_EQ(body_json["size"].get<size_t>(), 3);
+    ASSERT_EQ(body_json["checksum"].get<uint64_t>(), 'a' + 'b' + 'c');
+    ASSERT_TRUE(!body_json["body_in_memory"].get<bool>());
+
+    // A regular handler still sees the whole large body in Request::Body()
+    result = client.Post("/size", body, "application/octet-stream", 5);
+    ASSERT_TRUE(result);
+    body_json = JSON::parse(result->Body());
+    ASSERT_EQ(body_json["size"].get<size_t>(), body.size());
+}
+
+TEST(HttpServerTestSuite, Get_StreamedResponse) {
+    Client client = Client("http://0.0.0.0:84");
+    ssgx::http_t::Result result = client.Get("/stream", 5);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->StatusCode(), ssgx::http_t::HttpStatusCode::OK200);
+    ASSERT_EQ("chunked", result->GetHeaderValue("Transfer-Encoding"));
+    ASSERT_EQ("part0;part1;part2;", result->Body());
+
+    result = client.Get("/events", 5);
+    ASSERT_TRUE(result);
+    ASSERT_EQ("text/event-stream", result->GetHeaderValue("Content-Type"));
+    ASSERT_EQ("event: greeting\ndata: hello\n\ndata: line1\ndata: line2\n\n"
+              "data: line3\ndata: line4\ndata: line5\n\ndata: rejected\n\n",
+              result->Body());
+}
+
+TEST(HttpServerTestSuite, Get_StreamedResponse_HeadLocked) {
+    Client client = Client("http://0.0.0.0:84");
+    ssgx::http_t::Result result = client.Get("/stream_locked", 5);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->StatusCode(), ssgx::http_t::HttpStatusCode::OK200);
+    ASSERT_TRUE(!result->HasHeader("X-Late"));
+    ASSERT_EQ("rejected:3", result->Body());
+}
+
+TEST(HttpServerTestSuite, Get_StreamedResponse_Aborted) {
+    Client client = Client("http://0.0.0.0:84");
+    ssgx::http_t::Result result = client.Get("/stream_aborted", 5);
+    ASSERT_TRUE(!result);
+
+    // The server is still up
+    result = client.Get("/stream", 5);
+    ASSERT_TRUE(result);
+    ASSERT_EQ("part0;part1;part2;", result->Body());
+}
+
+TEST(HttpServerTestSuite, Get_PathParams) {
+    Client client = Client("http://0.0.0.0:83");
+    ssgx::http_t::Result result = client.Get("/orders/1024", 5);
+    ASSERT_TRUE(result);
+    JSON body_json = JSON::parse(result->Body());
+    ASSERT_EQ("order", body_json["route"].get<std::string>());
+    ASSERT_EQ("1024", body_json["path_params"]["id"].get<std::string>());
+
+    // A literal segment wins over a parameter
+    result = client.Get("/orders/latest", 5);
+    ASSERT_TRUE(result);
+    body_json = JSON::parse(result->Body());
+    ASSERT_EQ("latest", body_json["route"].get<std::string>());
+    ASSERT_TRUE(body_json["path_params"].empty());
+
+    result = client.Get("/orders/7/items/3", 5);
+    ASSERT_TRUE(result);
+    body_json = JSON::parse(result->Body());
+    ASSERT_EQ("item", body_json["route"].get<std::string>());
+    ASSERT_EQ("7", body_json["path_params"]["id"].get<std::string>());
+    ASSERT_EQ("3", body_json["path_params"]["item"].get<std::string>());
+
+    result = client.Get("/files/a/b/c.txt", 5);
+    ASSERT_TRUE(result);
+    body_json = JSON::parse(result->Body());
+    ASSERT_EQ("file", body_json["route"].get<std::string>());
+    ASSERT_EQ("a/b/c.txt", body_json["path_params"]["name"].get<std::string>());
+
+    result = client.Get("/orders/7/unknown", 5);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->StatusCode(), ssgx::http_t::HttpStatusCode::NotFound404);
+}
+
+TEST(HttpServerTestSuite, RegisterHandler_InvalidPattern) {
+    Server srv;
+    srv.Get("/orders/{id}", [](auto& req, auto& resp) { RouteHandler("order", req, resp); });
+    ASSERT_THROW(srv.Get("/files/*name/meta", [](auto& req, auto& resp) { RouteHandler("file", req, resp); }),
+                 std::invalid_argument);
+    ASSERT_THROW(srv.Get("/orders/{name}", [](auto& req, auto& resp) { RouteHandler("order", req, resp); }),
+                 std::invalid_argument);
+    srv.Get("/orders/{id}/items", [](auto& req, auto& resp) { RouteHandler("items", req, resp); });
+}
+
+TEST(HttpServerTestSuite, RequestArena_CopiesOutliveScope) {
+    Request kept;
+    for (int round = 0; round < 3; ++round) {
+        ssgx::http_t::RequestArena::Scope scope;
+        Request request(scope.Arena());
+        for (int i = 0; i < 100; ++i) {
+            request.SetHeader("key" + std::to_string(i), "value" + std::to_string(round));
+        }
+        request.SetAttribute("round", round);
+        kept = request;
+        ASSERT_EQ(request.GetAttribute<int>("round"), round);
+    }
+    ASSERT_EQ(kept.Headers().size(), 100);
+    ASSERT_EQ("value2", kept.GetHeaderValue("KEY42"));
+    ASSERT_EQ(kept.GetAttribute<int>("round"), 2);
+}
+
+TEST(HttpServerTestSuite, RequestArena_MovesOutliveScope) {
+    Request kept;
+    TypeHeaders kept_headers;
+    std::vector<Request> kept_requests;
+    std::vector<Response> kept_responses;
+    for (int round = 0; round < 3; ++round) {
+        ssgx::http_t::RequestArena::Scope scope;
+        Request request(scope.Arena());
+        TypeHeaders headers(TypeHeaders::allocator_type(scope.Arena()));
+        for (int i = 0; i < 100; ++i) {
+            request.SetHeader("key" + std::to_string(i), "value" + std::to_string(round));
+            headers.emplace("key" + std::to_string(i), "value" + std::to_string(round));
+        }
+        request.SetAttribute("round", round);
+        Response response(scope.Arena());
+        response.SetHeader("Round", std::to_string(round));
+        response.SetBody("body" + std::to_string(round));
+
+        // Move construction rebuilds them on the heap
+        Request moved(std::move(request));
+        kept_requests.push_back(std::move(moved));
+        kept_responses.emplace_back(std::move(response));
+        kept = kept_requests.back();
+        kept_headers = std::move(headers);
+        // The moved-to map keeps the heap
+        ASSERT_TRUE(kept_headers.get_allocator().Arena() == nullptr);
+    }
+    {
+        // Reuse the arena blocks, which would overwrite anything left on them
+        ssgx::http_t::RequestArena::Scope scope;
+        Request request(scope.Arena());
+        for (int i = 0; i < 100; ++i) {
+            request.SetHeader("key" + std::to_string(i), "overwritten");
+        }
+    }
+    ASSERT_EQ(kept.Headers().size(), 100);
+    ASSERT_EQ("value2", kept.GetHeaderValue("KEY42"));
+    ASSERT_EQ(kept.GetAttribute<int>("round"), 2);
+    ASSERT_EQ(kept_headers.size(), 100);
+    ASSERT_EQ("value2", kept_headers["key42"]);
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_EQ(kept_requests[round].Headers().size(), 100);
+        ASSERT_EQ("value" + std::to_string(round), kept_requests[round].GetHeaderValue("key7"));
+        ASSERT_EQ(kept_requests[round].GetAttribute<int>("round"), round);
+        ASSERT_EQ(std::to_string(round), kept_responses[round].GetHeaderValue("round"));
+        ASSERT_EQ("body" + std::to_string(round), kept_responses[round].Body());
+    }
+}
+
 int ecall_run_server(int alive_time_sec) {
     Server srv;
     std::string url = "http://0.0.0.0:83";
@@ -180,12 +455,29 @@ int ecall_run_server(int alive_time_sec) {
     srv.Get("/sample1", [](auto& req, auto& resp) { GetHandler(req, resp); });
     srv.Post("/sample2", [](auto& req, auto& resp) { PostHandler(req, resp); });
     srv.Post("/handlerthrow", [](auto& req, auto& resp) { HandlerThrowException(req, resp); });
+    srv.PostStream("/upload", [](auto& req, auto& reader, auto& resp) { StreamHandler(req, reader, resp); });
+    srv.Post("/size", [](auto& req, auto& resp) { SizeHandler(req, resp); });
+    srv.Get("/orders/{id}", [](auto& req, auto& resp) { RouteHandler("order", req, resp); });
+    srv.Get("/orders/latest", [](auto& req, auto& resp) { RouteHandler("latest", req, resp); });
+    srv.Get("/orders/{id}/items/{item}", [](auto& req, auto& resp) { RouteHandler("item", req, resp); });
+    srv.Get("/files/*name", [](auto& req, auto& resp) { RouteHandler("file", req, resp); });
     srv.AddFilter(std::make_unique<TimingFilter>());
 
     if (!srv.Start()) {
         return -1;
     }
 
+    // Streamed responses are sent before the filters run their After(), so they get a server without TimingFilter
+    Server stream_srv;
+    stream_srv.Listen("http://0.0.0.0:84");
+    stream_srv.Get("/stream", [](auto& req, auto& resp) { StreamingResponseHandler(req, resp); });
+    stream_srv.Get("/events", [](auto& req, auto& resp) { EventsHandler(req, resp); });
+    stream_srv.Get("/stream_locked", [](auto& req, auto& resp) { StreamLockedHandler(req, resp); });
+    stream_srv.Get("/stream_aborted", [](auto& req, auto& resp) { StreamAbortedHandler(req, resp); });
+    if (!stream_srv.Start()) {
+        return -1;
+    }
+
     ssgx::utils_t::Sleep(alive_time_sec);
     return 0;
 }
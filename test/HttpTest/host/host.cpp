@@ -11,6 +11,7 @@
 
 #include "ssgx_log_u.h"
 #include "ssgx_http_u.h"
+#include "ssgx_utils_u.h"
 
 #include "Enclave_u.h"
 
@@ -37,6 +38,7 @@ int SGX_CDECL main(int argc, char* argv[]) {
     int ret = 0;
     sgx_status_t sgx_status = SGX_SUCCESS;
     bool ok = true;
+    ssgx::log_u::AsyncLogOptions log_options;
 
     printf("Try to create testing enclave ...\n");
     sgx_status = sgx_create_enclave((const char*)argv[1], 0, nullptr, nullptr, &test_enclave_id, nullptr);
@@ -47,15 +49,17 @@ int SGX_CDECL main(int argc, char* argv[]) {
     }
     printf("Enclave is created!\n\n");
 
-    ok = ssgx::http_u::HttpCallbackManager::GetInstance().RegisterCallbacks(test_enclave_id, ssgx_ecall_register_enclave_eid, ssgx_ecall_http_on_message);
+    ok = ssgx::http_u::HttpCallbackManager::GetInstance().RegisterCallbacks(test_enclave_id, ssgx_ecall_register_enclave_eid, ssgx_ecall_http_on_message, ssgx_ecall_http_on_binary_message);
     if(!ok){
         printf("\nFailed to register callback function for HTTP module.\n");
         goto _exit;
     }
 
-    // Initialize SSGXLogger
+    // Initialize SSGXLogger, written by a background thread so that slow disks do not hold up the requests
+    log_options.overflow_policy = ssgx::log_u::LogOverflowPolicy::DROP_AND_REPORT;
+    log_options.fsync_interval_ms = 1000;
     ssgx::log_u::SSGXLogger::GetInstance().Init("/opt/logs/tee-log/log-safeheron-mpc-engine", "PROJECT_NAME",
-                                                ssgx::log_u::LogLevel::INFO, true);
+                                                ssgx::log_u::LogLevel::INFO, true, log_options);
 
     // Run server in child thread
     pthread_t pthread;
@@ -76,6 +80,7 @@ _exit:
     // Waiting for server exit
     pthread_join(pthread, nullptr);
     sgx_destroy_enclave(test_enclave_id);
+    ssgx::utils_u::ControlPage::Shutdown();
     printf("End!\n\n");
 
     return ret;